@@ -72,6 +72,14 @@ public class Matrix implements Cloneable, java.io.Serializable {
    */
    private int m, n;
 
+   /** Products with fewer multiplications are computed by a single thread.
+   */
+   private static final long PARALLEL_TIMES_MIN_FLOPS = 1L << 21;
+
+   /** Size of the square blocks of the blocked matrix product.
+   */
+   private static final int TIMES_BLOCK_SIZE = 128;
+
 /* ------------------------
    Constructors
  * ------------------------ */
@@ -744,6 +752,9 @@ public class Matrix implements Cloneable, java.io.Serializable {
       if (B.m != n) {
          throw new IllegalArgumentException("Matrix inner dimensions must agree.");
       }
+      if ((long)m * n * B.n >= PARALLEL_TIMES_MIN_FLOPS && m > 1) {
+         return timesBlocked(B);
+      }
       Matrix X = new Matrix(m,B.n);
       double[][] C = X.getArray();
       double[] Bcolj = new double[n];
@@ -763,6 +774,66 @@ public class Matrix implements Cloneable, java.io.Serializable {
       return X;
    }
 
+   /** Linear algebraic matrix multiplication for large matrices. The product
+   is computed in square blocks that fit into the cache, and the rows of the
+   result are distributed among as many threads as processors are available.
+   @param B    another matrix
+   @return     Matrix product, A * B
+   */
+
+   private Matrix timesBlocked (final Matrix B) {
+      final Matrix X = new Matrix(m,B.n);
+      final double[][] C = X.getArray();
+      int nThreads = Math.max(1, Math.min(
+              Runtime.getRuntime().availableProcessors(), m / 32));
+      Thread[] threads = new Thread[nThreads];
+      final int chunk = (m / nThreads) + 1;
+      for (int t = 0; t < nThreads; t++) {
+         final int first = t * chunk;
+         final int end = Math.min(m, first + chunk);
+         threads[t] = new Thread() {
+            public void run() {
+               timesBlocked(B, C, first, end);
+            }
+         };
+         threads[t].start();
+      }
+      for (int t = 0; t < nThreads; t++) {
+         try {
+            threads[t].join();
+         } catch (InterruptedException e) {
+            throw new RuntimeException(e);
+         }
+      }
+      return X;
+   }
+
+   /** Computes rows first to end - 1 of A * B. Rows of B are streamed in
+   blocks of columns, so that rows of A, B and C are accessed sequentially.
+   */
+
+   private void timesBlocked (Matrix B, double[][] C, int first, int end) {
+      final double[][] BA = B.A;
+      final int p = B.n;
+      for (int jj = 0; jj < p; jj += TIMES_BLOCK_SIZE) {
+         final int jEnd = Math.min(p, jj + TIMES_BLOCK_SIZE);
+         for (int kk = 0; kk < n; kk += TIMES_BLOCK_SIZE) {
+            final int kEnd = Math.min(n, kk + TIMES_BLOCK_SIZE);
+            for (int i = first; i < end; i++) {
+               final double[] Arowi = A[i];
+               final double[] Crowi = C[i];
+               for (int k = kk; k < kEnd; k++) {
+                  final double a = Arowi[k];
+                  final double[] Browk = BA[k];
+                  for (int j = jj; j < jEnd; j++) {
+                     Crowi[j] += a * Browk[j];
+                  }
+               }
+            }
+         }
+      }
+   }
+
    /** LU Decomposition
    @return     LUDecomposition
    @see LUDecomposition
@@ -0,0 +1,514 @@
+/*
+ * Benchmark.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+
+package ika.app;
+
+import com.jhlabs.map.proj.EquidistantCylindricalProjection;
+import com.jhlabs.map.proj.Projection;
+import ika.geo.FlexProjectorModel;
+import ika.geo.GeoBinaryCodec;
+import ika.geo.GeoGrid;
+import ika.geo.GeoImage;
+import ika.geo.GeoMap;
+import ika.geo.GeoSet;
+import ika.geo.GridProjector;
+import ika.geo.ImageProjector;
+import ika.geo.RasterProjector;
+import ika.geoimport.CompiledPaths;
+import ika.geoimport.GeoImporter;
+import ika.geoimport.ShapeGeometryImporter;
+import ika.geoimport.SynchroneDataReceiver;
+import ika.proj.AbstractMixerProjection;
+import ika.proj.DesignProjection;
+import ika.proj.FlexProjectionModel;
+import ika.proj.FlexProjectionOptimizer;
+import ika.proj.ProjectionDistortionParameters;
+import ika.proj.QModel;
+import ika.utils.NanoTimer;
+import ika.utils.PropertiesLoader;
+import ika.utils.Serializer;
+import java.awt.geom.Point2D;
+import java.awt.geom.Rectangle2D;
+import java.awt.image.BufferedImage;
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.FileWriter;
+import java.io.IOException;
+import java.io.ObjectInputStream;
+import java.io.ObjectOutputStream;
+import java.io.PrintWriter;
+import java.util.Date;
+import java.util.Properties;
+import java.util.zip.GZIPOutputStream;
+
+/**
+ * Throughput benchmarks for the design projections and the raster and vector
+ * paths of Flex Projector. Runs without a display: start with
+ * -Djava.awt.headless=true, or use the benchmark target of build.xml.<br>
+ * Each result is written as a line with a name, a value and a unit, separated
+ * by tabulators, to the file passed as first argument, or to the standard
+ * output if no argument is passed. Lines starting with # contain information
+ * about the system.
+ */
+public class Benchmark {
+
+    /**
+     * Minimum duration of a measurement in nanoseconds.
+     */
+    private static final long MIN_DURATION = 1000L * 1000L * 1000L;
+
+    /**
+     * Cell size in degrees of the graticule of projected points.
+     */
+    private static final double POINTS_CELL_SIZE = 1;
+
+    /**
+     * Size of the synthetic source image and grid for raster projections.
+     */
+    private static final int RASTER_COLS = 1000;
+    private static final int RASTER_ROWS = 500;
+
+    private final NanoTimer timer = new NanoTimer();
+    private final PrintWriter out;
+
+    private Benchmark(PrintWriter out) {
+        this.out = out;
+    }
+
+    public static void main(String[] args) throws IOException {
+
+        PrintWriter out;
+        if (args.length > 0) {
+            out = new PrintWriter(new FileWriter(args[0]));
+        } else {
+            out = new PrintWriter(System.out, true);
+        }
+        try {
+            new Benchmark(out).run();
+        } finally {
+            out.close();
+        }
+    }
+
+    private void run() throws IOException {
+
+        out.println("# Flex Projector benchmark " + new Date());
+        out.println("# java " + System.getProperty("java.version")
+                + " " + System.getProperty("java.vm.name"));
+        out.println("# os " + System.getProperty("os.name")
+                + " " + System.getProperty("os.arch"));
+        out.println("# processors " + Runtime.getRuntime().availableProcessors());
+
+        GeoSet coastlines = loadCoastlines();
+        benchmarkCompiledCoastlines();
+        benchmarkCodec(coastlines);
+
+        FlexProjectorModel model = new FlexProjectorModel();
+        model.getUnprojectedData().add(coastlines);
+        DesignProjection[] projections = new DesignProjection[]{
+            model.getFlexProjection(),
+            model.getFlexMixProjection(),
+            model.getMeanProjection(),
+            model.getLatitudeMixerProjection()
+        };
+        for (DesignProjection p : projections) {
+            if (p instanceof AbstractMixerProjection) {
+                ((AbstractMixerProjection) p).getProjection1().initialize();
+                ((AbstractMixerProjection) p).getProjection2().initialize();
+            }
+            p.initialize();
+        }
+
+        for (DesignProjection p : projections) {
+            String name = p.getClass().getSimpleName();
+            benchmarkForward(name, p);
+            benchmarkInverse(name, p);
+            benchmarkDistortionParameters(name, p);
+        }
+        for (DesignProjection p : projections) {
+            String name = p.getClass().getSimpleName();
+            benchmarkImageProjection(name, p);
+            benchmarkGridProjection(name, p);
+        }
+        benchmarkOptimizer();
+        benchmarkMapChanged(model);
+        out.flush();
+    }
+
+    private void result(String name, double value, String unit) {
+        out.println(name + "\t" + value + "\t" + unit);
+        out.flush();
+    }
+
+    /**
+     * Measures the time to load the bundled coastlines.
+     */
+    private GeoSet loadCoastlines() throws IOException {
+
+        Properties props = PropertiesLoader.loadProperties("ika.app.Application.properties");
+        java.net.URL url = Benchmark.class.getResource(props.getProperty("MapData"));
+
+        // warm up
+        readShape(url);
+
+        int count = 0;
+        GeoSet geoSet = null;
+        long start = timer.nanoTime();
+        long duration;
+        do {
+            geoSet = readShape(url);
+            count++;
+            duration = timer.nanoTime() - start;
+        } while (duration < MIN_DURATION);
+        result("ShapeGeometryImporter.coastlines", duration / 1e6 / count, "ms");
+        return geoSet;
+    }
+
+    /**
+     * Measures the time to create GeoPaths from the coastlines converted to
+     * compiled paths by the build. Nothing is measured if they are missing.
+     */
+    private void benchmarkCompiledCoastlines() throws IOException {
+
+        Properties props = PropertiesLoader.loadProperties("ika.app.Application.properties");
+        java.net.URL url = Benchmark.class.getResource(props.getProperty("CompiledMapData"));
+        if (url == null) {
+            out.println("# no compiled coastlines");
+            return;
+        }
+
+        long start = timer.nanoTime();
+        CompiledPaths paths = CompiledPaths.load(url);
+        result("CompiledPaths.load", (timer.nanoTime() - start) / 1e6, "ms");
+
+        // warm up
+        paths.toGeoSet(0);
+
+        int count = 0;
+        start = timer.nanoTime();
+        long duration;
+        do {
+            paths.toGeoSet(0);
+            count++;
+            duration = timer.nanoTime() - start;
+        } while (duration < MIN_DURATION);
+        result("CompiledPaths.toGeoSet", duration / 1e6 / count, "ms");
+    }
+
+    /**
+     * Compares the size and speed of GeoBinaryCodec with Java object
+     * serialization for the coastlines, with and without zip compression as
+     * used for undo snapshots.
+     */
+    private void benchmarkCodec(GeoSet coastlines) throws IOException {
+
+        byte[] binary = GeoBinaryCodec.encode(coastlines);
+        byte[] serialized = javaSerialize(coastlines);
+        result("GeoBinaryCodec.size", binary.length / 1024d, "KB");
+        result("GeoBinaryCodec.zippedSize", Serializer.serialize(coastlines, true).length / 1024d, "KB");
+        result("ObjectOutputStream.size", serialized.length / 1024d, "KB");
+        result("ObjectOutputStream.zippedSize", zip(serialized).length / 1024d, "KB");
+
+        int count = 0;
+        long start = timer.nanoTime();
+        long duration;
+        do {
+            GeoBinaryCodec.decode(GeoBinaryCodec.encode(coastlines));
+            count++;
+            duration = timer.nanoTime() - start;
+        } while (duration < MIN_DURATION);
+        result("GeoBinaryCodec.encodeDecode", duration / 1e6 / count, "ms");
+
+        count = 0;
+        start = timer.nanoTime();
+        do {
+            javaDeserialize(javaSerialize(coastlines));
+            count++;
+            duration = timer.nanoTime() - start;
+        } while (duration < MIN_DURATION);
+        result("ObjectOutputStream.encodeDecode", duration / 1e6 / count, "ms");
+    }
+
+    private static byte[] javaSerialize(Object obj) throws IOException {
+        ByteArrayOutputStream bos = new ByteArrayOutputStream();
+        ObjectOutputStream oos = new ObjectOutputStream(bos);
+        oos.writeObject(obj);
+        oos.close();
+        return bos.toByteArray();
+    }
+
+    private static Object javaDeserialize(byte[] b) throws IOException {
+        ObjectInputStream ois = new ObjectInputStream(new ByteArrayInputStream(b));
+        try {
+            return ois.readObject();
+        } catch (ClassNotFoundException exc) {
+            throw new IOException(exc.toString());
+        } finally {
+            ois.close();
+        }
+    }
+
+    private static byte[] zip(byte[] b) throws IOException {
+        ByteArrayOutputStream bos = new ByteArrayOutputStream();
+        GZIPOutputStream zos = new GZIPOutputStream(bos);
+        zos.write(b);
+        zos.close();
+        return bos.toByteArray();
+    }
+
+    private static GeoSet readShape(java.net.URL url) throws IOException {
+        GeoMap geoSet = new GeoMap();
+        SynchroneDataReceiver receiver = new SynchroneDataReceiver(geoSet);
+        receiver.setShowMessageOnError(false);
+        new ShapeGeometryImporter().read(url, receiver, GeoImporter.SAME_THREAD);
+        if (receiver.hasReceivedError()) {
+            throw new IOException("Could not read " + url);
+        }
+        return geoSet;
+    }
+
+    /**
+     * Returns longitudes and latitudes in radians of the nodes of a graticule.
+     */
+    private static double[][] graticule() {
+        final int cols = (int) (360 / POINTS_CELL_SIZE) + 1;
+        final int rows = (int) (180 / POINTS_CELL_SIZE) + 1;
+        double[][] lonLat = new double[2][cols * rows];
+        int i = 0;
+        for (int r = 0; r < rows; r++) {
+            for (int c = 0; c < cols; c++) {
+                lonLat[0][i] = Math.toRadians(-180 + c * POINTS_CELL_SIZE);
+                lonLat[1][i] = Math.toRadians(-90 + r * POINTS_CELL_SIZE);
+                i++;
+            }
+        }
+        return lonLat;
+    }
+
+    private void benchmarkForward(String name, Projection projection) {
+
+        final double[][] lonLat = graticule();
+        final int n = lonLat[0].length;
+        Point2D.Double pt = new Point2D.Double();
+        long points = 0;
+        long start = 0;
+        long duration = 0;
+        for (int pass = 0; duration < MIN_DURATION; pass++) {
+            if (pass == 1) {
+                // the first pass warms up
+                points = 0;
+                start = timer.nanoTime();
+            }
+            for (int i = 0; i < n; i++) {
+                projection.project(lonLat[0][i], lonLat[1][i], pt);
+            }
+            points += n;
+            duration = pass == 0 ? 0 : timer.nanoTime() - start;
+        }
+        result(name + ".forward", points / (duration / 1e9), "points/s");
+    }
+
+    private void benchmarkInverse(String name, Projection projection) {
+
+        final double[][] lonLat = graticule();
+        final int n = lonLat[0].length;
+        final double[] x = new double[n];
+        final double[] y = new double[n];
+        Point2D.Double pt = new Point2D.Double();
+        for (int i = 0; i < n; i++) {
+            projection.project(lonLat[0][i], lonLat[1][i], pt);
+            x[i] = pt.x;
+            y[i] = pt.y;
+        }
+
+        long points = 0;
+        long start = 0;
+        long duration = 0;
+        for (int pass = 0; duration < MIN_DURATION; pass++) {
+            if (pass == 1) {
+                points = 0;
+                start = timer.nanoTime();
+            }
+            for (int i = 0; i < n; i++) {
+                projection.projectInverse(x[i], y[i], pt);
+            }
+            points += n;
+            duration = pass == 0 ? 0 : timer.nanoTime() - start;
+        }
+        result(name + ".inverse", points / (duration / 1e9), "points/s");
+    }
+
+    private void benchmarkDistortionParameters(String name, Projection projection) {
+
+        QModel qModel = new QModel();
+        new ProjectionDistortionParameters(projection, qModel);
+        int count = 0;
+        long start = timer.nanoTime();
+        long duration;
+        do {
+            new ProjectionDistortionParameters(projection, qModel);
+            count++;
+            duration = timer.nanoTime() - start;
+        } while (duration < MIN_DURATION);
+        result(name + ".distortionParameters", duration / 1e6 / count, "ms");
+    }
+
+    /**
+     * Projects a synthetic world image from plate carree to a projection with
+     * ImageProjector.projectRow() and bicubic interpolation, without reading
+     * and writing files.
+     */
+    private void benchmarkImageProjection(String name, Projection projection) {
+
+        final double R = projection.getEquatorRadius();
+        BufferedImage bi = new BufferedImage(RASTER_COLS, RASTER_ROWS,
+                BufferedImage.TYPE_INT_RGB);
+        for (int r = 0; r < RASTER_ROWS; r++) {
+            for (int c = 0; c < RASTER_COLS; c++) {
+                bi.setRGB(c, r, (c * 255 / RASTER_COLS) << 16 | (r * 255 / RASTER_ROWS) << 8);
+            }
+        }
+        GeoImage image = new GeoImage(bi, -Math.PI * R, Math.PI / 2 * R,
+                2 * Math.PI * R / RASTER_COLS);
+        Projection srcProj = new EquidistantCylindricalProjection();
+        srcProj.initialize();
+
+        Rectangle2D projBounds = RasterProjector.findProjectedExtension(projection, null);
+        final double cellSize = Math.min(projBounds.getWidth() / RASTER_COLS,
+                projBounds.getHeight() / RASTER_ROWS);
+        final int cols = (int) Math.ceil(projBounds.getWidth() / cellSize);
+        final int rows = (int) Math.ceil(projBounds.getHeight() / cellSize);
+        final double west = projBounds.getMinX();
+        final double north = projBounds.getMaxY();
+
+        int[] argb = new int[cols];
+        long pixels = 0;
+        long start = 0;
+        long duration = 0;
+        for (int pass = 0; duration < MIN_DURATION; pass++) {
+            if (pass == 1) {
+                pixels = 0;
+                start = timer.nanoTime();
+            }
+            for (int r = 0; r < rows; r++) {
+                final double y = (north - r * cellSize) / R;
+                ImageProjector.projectRow(image, srcProj, projection, y, west,
+                        cellSize, false, argb);
+            }
+            pixels += (long) rows * cols;
+            duration = pass == 0 ? 0 : timer.nanoTime() - start;
+        }
+        result(name + ".imageProjector", pixels / (duration / 1e3), "megapixels/s");
+    }
+
+    /**
+     * Projects a synthetic world grid with GridProjector.projectRow() and
+     * bicubic interpolation, without reading and writing files.
+     */
+    private void benchmarkGridProjection(String name, Projection projection) {
+
+        final double R = projection.getEquatorRadius();
+        final double gridCellSize = 360d / RASTER_COLS;
+        GeoGrid grid = new GeoGrid(RASTER_COLS, RASTER_ROWS, gridCellSize);
+        grid.setWest(-180);
+        grid.setNorth(90);
+        for (int r = 0; r < RASTER_ROWS; r++) {
+            for (int c = 0; c < RASTER_COLS; c++) {
+                grid.setValue((float) Math.sin(c * 0.01) * r, c, r);
+            }
+        }
+
+        Rectangle2D projBounds = RasterProjector.findProjectedExtension(projection, grid);
+        final double cellSize = Math.min(projBounds.getWidth() / RASTER_COLS,
+                projBounds.getHeight() / RASTER_ROWS);
+        final int cols = (int) Math.ceil(projBounds.getWidth() / cellSize);
+        final int rows = (int) Math.ceil(projBounds.getHeight() / cellSize);
+        final double west = projBounds.getMinX();
+        final double north = projBounds.getMaxY();
+
+        float[] values = new float[cols];
+        long pixels = 0;
+        long start = 0;
+        long duration = 0;
+        for (int pass = 0; duration < MIN_DURATION; pass++) {
+            if (pass == 1) {
+                pixels = 0;
+                start = timer.nanoTime();
+            }
+            for (int r = 0; r < rows; r++) {
+                final double y = (north - r * cellSize) / R;
+                GridProjector.projectRow(grid, projection, y, west, cellSize,
+                        true, values);
+            }
+            pixels += (long) rows * cols;
+            duration = pass == 0 ? 0 : timer.nanoTime() - start;
+        }
+        result(name + ".gridProjector", pixels / (duration / 1e3), "megapixels/s");
+    }
+
+    /**
+     * Measures the time for evaluating the objective of the optimizer and
+     * for optimizing the default Flex projection for 50 generations.
+     */
+    private void benchmarkOptimizer() {
+
+        FlexProjectionModel robinson = new FlexProjectionModel();
+        FlexProjectionOptimizer optimizer = new FlexProjectionOptimizer(robinson, new QModel());
+        optimizer.setWeights(1, 1, 0, 1);
+
+        optimizer.computeObjective(robinson);
+        int count = 0;
+        long start = timer.nanoTime();
+        long duration;
+        do {
+            optimizer.computeObjective(robinson);
+            count++;
+            duration = timer.nanoTime() - start;
+        } while (duration < MIN_DURATION);
+        result("FlexProjectionOptimizer.objective", duration / 1e3 / count, "us");
+
+        optimizer.setMaxGenerations(50);
+        start = timer.nanoTime();
+        optimizer.optimize();
+        duration = timer.nanoTime() - start;
+        result("FlexProjectionOptimizer.optimize50", duration / 1e6, "ms");
+    }
+
+    /**
+     * Measures the latency of FlexProjectorModel.mapChanged() with a single
+     * layer shown.
+     */
+    private void benchmarkMapChanged(FlexProjectorModel model) {
+
+        final String[] layers = new String[]{
+            "coastlines", "graticule", "tissot", "isolines", "acceptance"
+        };
+        FlexProjectorModel.DisplayModel display = model.getDisplayModel();
+        model.flexProjectionToForeground();
+        display.showSecondProjection = false;
+
+        for (String layer : layers) {
+            display.showCoastline = "coastlines".equals(layer);
+            display.showGraticule = "graticule".equals(layer);
+            display.showTissot = "tissot".equals(layer);
+            display.showAngularIsolines = "isolines".equals(layer);
+            display.showArealIsolines = "isolines".equals(layer);
+            display.qModel.setShowAcceptableArea("acceptance".equals(layer));
+
+            model.mapChanged();
+            int count = 0;
+            long start = timer.nanoTime();
+            long duration;
+            do {
+                model.mapChanged();
+                count++;
+                duration = timer.nanoTime() - start;
+            } while (duration < MIN_DURATION);
+            result("mapChanged." + layer, duration / 1e6 / count, "ms");
+        }
+    }
+}
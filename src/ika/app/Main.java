@@ -24,6 +24,9 @@ public class Main {
      */
     public static void main(String args[]) {
         
+        // load coastlines and other resources while the window is built
+        Startup.start();
+        
         // on Mac OS X: take the menu bar out of the window and put it on top
         // of the main screen.
         if (ika.utils.Sys.isMacOSX()) {
@@ -0,0 +1,142 @@
+/*
+ * Startup.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+
+package ika.app;
+
+import ika.geoimport.DataPreloader;
+import ika.proj.ProjectionDistortionParameters;
+import ika.proj.ProjectionsManager;
+import ika.utils.Instrumentation;
+import ika.utils.PropertiesLoader;
+import java.util.Properties;
+
+/**
+ * Loads resources needed by the first document window in background threads,
+ * while the Event Dispatching Thread sets up the look and feel and builds the
+ * window. The coastlines are imported by a DataPreloader; the list of
+ * projections and the continental mask for the distortion indices are loaded
+ * by a second thread. Users of these resources that need them earlier wait
+ * for the loading to finish. The first window is shown before the coastlines
+ * are loaded, and adds them when they are ready.<br>
+ * The time from the start of the virtual machine until the first window can
+ * be edited is always recorded as "startup.timeToInteractive", also if
+ * instrumentation is disabled.
+ */
+public final class Startup {
+
+    /**
+     * Imports the default coastlines. Null once taken by a window.
+     */
+    private static DataPreloader coastlinesPreloader;
+
+    private static boolean started = false;
+
+    private static boolean interactive = false;
+
+    /**
+     * Milliseconds from the start of the virtual machine until the first
+     * window could be edited, or -1.
+     */
+    private static long timeToInteractive = -1;
+
+    private Startup() {
+    }
+
+    /**
+     * Starts loading the resources. Call once at the start of main().
+     */
+    public static synchronized void start() {
+        if (started) {
+            return;
+        }
+        started = true;
+
+        try {
+            java.net.URL url = getDefaultMapDataURL();
+            if (url != null) {
+                coastlinesPreloader = new DataPreloader(url);
+                coastlinesPreloader.start();
+            }
+        } catch (Exception exc) {
+            exc.printStackTrace();
+        }
+
+        Thread thread = new Thread("Startup") {
+
+            @Override
+            public void run() {
+                long t = Instrumentation.start();
+                ProjectionsManager.preloadProjections();
+                Instrumentation.stop("startup.projections", t);
+
+                t = Instrumentation.start();
+                ProjectionDistortionParameters.preloadContinentalMask();
+                Instrumentation.stop("startup.continentalMask", t);
+            }
+        };
+        thread.setDaemon(true);
+        thread.setPriority(Thread.NORM_PRIORITY - 1);
+        thread.start();
+    }
+
+    /**
+     * Returns the URL of the default data displayed in a new window. This is
+     * the data converted to compiled paths by the build if available, and
+     * the original data otherwise.
+     */
+    public static java.net.URL getDefaultMapDataURL() {
+        Properties props = PropertiesLoader.loadProperties("ika.app.Application.properties");
+        String compiledMapData = props.getProperty("CompiledMapData");
+        if (compiledMapData != null) {
+            java.net.URL url = Startup.class.getResource(compiledMapData);
+            if (url != null) {
+                return url;
+            }
+        }
+        return Startup.class.getResource(props.getProperty("MapData"));
+    }
+
+    /**
+     * Returns the DataPreloader importing the data at a URL, if the data is
+     * loaded at startup. The preloaded data can only be taken once.
+     * @param url The URL of the data.
+     * @return The DataPreloader or null.
+     */
+    public static synchronized DataPreloader takePreloadedData(java.net.URL url) {
+        DataPreloader preloader = coastlinesPreloader;
+        if (preloader == null || url == null
+                || !url.toExternalForm().equals(preloader.getURL().toExternalForm())) {
+            return null;
+        }
+        coastlinesPreloader = null;
+        return preloader;
+    }
+
+    /**
+     * Records the time to interactive when called for the first time. Call
+     * when the first window is visible and its data has been added.
+     */
+    public static synchronized void windowReady() {
+        if (interactive) {
+            return;
+        }
+        interactive = true;
+        final long jvmStart = java.lang.management.ManagementFactory.getRuntimeMXBean().getStartTime();
+        timeToInteractive = System.currentTimeMillis() - jvmStart;
+        Instrumentation.recordAlways("startup.timeToInteractive",
+                timeToInteractive * 1000000L);
+    }
+
+    /**
+     * Returns the milliseconds from the start of the virtual machine until
+     * the first window could be edited.
+     * @return The time to interactive, or -1 if the first window is not ready.
+     */
+    public static synchronized long getTimeToInteractive() {
+        return timeToInteractive;
+    }
+}
@@ -37,6 +37,10 @@ public class FeatureProjector {
     protected Projection projection;
     protected double curveTolerance = 5000;
     protected boolean addIntermediatePointsAlongCurves;
+    /**
+     * Receives the projected points of a path. Reused for all paths.
+     */
+    protected final GeoPathBuffer pathBuffer = new GeoPathBuffer();
 
     public FeatureProjector(Projection projection, double curveTolerance,
             boolean addIntermediatePointsAlongCurves) {
@@ -50,7 +54,7 @@ public class FeatureProjector {
         this.addIntermediatePointsAlongCurves = false;
     }
 
-    protected void curvedLineTo(double lonStart, double latStart, double lonEnd, double latEnd, GeoPathModel projPath) {
+    protected void curvedLineTo(double lonStart, double latStart, double lonEnd, double latEnd, GeoPathBuffer projPath) {
         Point2D xyEnd = projectPoint(lonEnd, latEnd);
         double lonStartNorm = normalizeLongitude(lonStart);
         double lonEndNorm = normalizeLongitude(lonEnd);
@@ -86,7 +90,7 @@ public class FeatureProjector {
         return MapMath.normalizeLongitude(lon - lon0Rad) * MapMath.RTD;
     }
 
-    protected void lineTo(double lonStart, double latStart, double lonEnd, double latEnd, GeoPathModel projPath) {
+    protected void lineTo(double lonStart, double latStart, double lonEnd, double latEnd, GeoPathBuffer projPath) {
 
         if (lonStart == lonEnd && latStart == latEnd) {
             return;
@@ -98,7 +102,7 @@ public class FeatureProjector {
         }
     }
 
-    protected void projectMoveTo(double x, double y, GeoPathModel projPath) {
+    protected void projectMoveTo(double x, double y, GeoPathBuffer projPath) {
 
         // project the point
         Point2D.Double dst = new Point2D.Double();
@@ -127,12 +131,12 @@ public class FeatureProjector {
         return dst;
     }
 
-    protected void straightLineTo(double lonEnd, double latEnd, GeoPathModel projPath) {
+    protected void straightLineTo(double lonEnd, double latEnd, GeoPathBuffer projPath) {
         Point2D xy = this.projectPoint(lonEnd, latEnd);
         if (xy == null) {
             return;
         }
-        if (projPath.getEndPoint().equals(xy)) {
+        if (projPath.endsAt(xy.getX(), xy.getY())) {
             return;
         }
         projPath.lineTo(xy.getX(), xy.getY());
@@ -15,6 +15,7 @@ import ika.proj.*;
 import com.jhlabs.map.Ellipsoid;
 import com.jhlabs.map.proj.Projection;
 import ika.utils.GeometryUtils;
+import ika.utils.Instrumentation;
 import java.awt.geom.Point2D;
 import java.awt.geom.Rectangle2D;
 import java.io.IOException;
@@ -24,6 +25,9 @@ import java.io.ObjectOutputStream;
 import java.io.Serializable;
 import java.text.DecimalFormat;
 import java.util.ArrayList;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import javax.swing.SwingUtilities;
 
 /**
  * The model object for the Flex Projector application. Holds all model data.
@@ -57,6 +61,19 @@ public class FlexProjectorModel extends GeoMap implements Serializable,
      * tolerance for interpolating projected curved lines.
      */
     private static final double CURVE_TOLERANCE = 500;
+    /**
+     * tolerance for interpolating the graticule while a slider is dragged.
+     */
+    private static final double INTERACTIVE_CURVE_TOLERANCE = 5000;
+    /**
+     * Target time in nanoseconds for constructing the map while a slider is
+     * dragged.
+     */
+    private static final long INTERACTIVE_FRAME_BUDGET = 16000000L;
+    /**
+     * Maximum decimation of the coastlines while a slider is dragged.
+     */
+    private static final int MAX_INTERACTIVE_STEP = 64;
     private final GeoGrid flexAngleGrid;
     private final GeoGrid flexAreaGrid;
     private final GeoGrid secondAngleGrid;
@@ -167,6 +184,26 @@ public class FlexProjectorModel extends GeoMap implements Serializable,
      * projected data (coast lines, graticule, etc) is stored in this GeoSet
      */
     private GeoSet projectedDataDestination = new GeoSet();
+    /**
+     * Decimated copy of unprojectedData that is projected while a slider is
+     * dragged. Constructed when needed, and reset by mapChanged().
+     */
+    private GeoSet interactiveData = null;
+    /**
+     * Only every interactiveStep-th point of unprojectedData is kept in
+     * interactiveData.
+     */
+    private int interactiveStep = 4;
+    /**
+     * Computes the visualizations of mapChangedInBackground() sequentially
+     * in a single thread.
+     */
+    private final ExecutorService mapExecutor = Executors.newSingleThreadExecutor();
+    /**
+     * Identifies the most recent update of the map. Incremented in the Event
+     * Dispatching Thread and read by the worker thread of mapExecutor.
+     */
+    private volatile long mapRequest = 0;
 
     /**
      * Creates a new instance of FlexProjectorModel
@@ -176,6 +213,16 @@ public class FlexProjectorModel extends GeoMap implements Serializable,
         projectedDataDestination.setSelectable(false);
         this.add(this.projectedDataDestination);
 
+        // select the projections to mix before initializing the mixers, so
+        // that each mixer is only initialized once with its final projections
+        AbstractMixerProjection[] mixerProjections = getMixerProjections();
+        for (AbstractMixerProjection p : mixerProjections) {
+            Projection mixerProjection1 = searchProjectionForMixer(null, p);
+            Projection mixerProjection2 = searchProjectionForMixer(mixerProjection1, p);
+            p.setProjection1(mixerProjection1);
+            p.setProjection2(mixerProjection2);
+        }
+
         DesignProjection[] designProjections = getDesignProjections();
         for (Projection p : designProjections) {
             p.setProjectionLongitude(0);
@@ -183,35 +230,23 @@ public class FlexProjectorModel extends GeoMap implements Serializable,
             p.initialize();
         }
 
-        final double west = -GRID_COLS / 2d;
-        final double north = GRID_ROWS / 2d;
-
-        this.flexAreaGrid = new GeoGrid(GRID_COLS, GRID_ROWS, GRID_CELL_SIZE);
-        this.flexAreaGrid.setNorth(north);
-        this.flexAreaGrid.setWest(west);
-
-        this.flexAngleGrid = new GeoGrid(GRID_COLS, GRID_ROWS, GRID_CELL_SIZE);
-        this.flexAngleGrid.setNorth(north);
-        this.flexAngleGrid.setWest(west);
-
-        this.secondAreaGrid = new GeoGrid(GRID_COLS, GRID_ROWS, GRID_CELL_SIZE);
-        this.secondAreaGrid.setNorth(north);
-        this.secondAreaGrid.setWest(west);
-
-        this.secondAngleGrid = new GeoGrid(GRID_COLS, GRID_ROWS, GRID_CELL_SIZE);
-        this.secondAngleGrid.setNorth(north);
-        this.secondAngleGrid.setWest(west);
+        this.flexAreaGrid = newDistortionGrid();
+        this.flexAngleGrid = newDistortionGrid();
+        this.secondAreaGrid = newDistortionGrid();
+        this.secondAngleGrid = newDistortionGrid();
 
         this.displayModel.qModel.addQListener(this);
 
-        AbstractMixerProjection[] mixerProjections = getMixerProjections();
-        for (AbstractMixerProjection p : mixerProjections) {
-            Projection mixerProjection1 = searchProjectionForMixer(null, p);
-            Projection mixerProjection2 = searchProjectionForMixer(mixerProjection1, p);
-            p.setProjection1(mixerProjection1);
-            p.setProjection2(mixerProjection2);
-        }
+    }
 
+    /**
+     * Returns a new global grid for computing distortion isolines.
+     */
+    private static GeoGrid newDistortionGrid() {
+        GeoGrid grid = new GeoGrid(GRID_COLS, GRID_ROWS, GRID_CELL_SIZE);
+        grid.setNorth(GRID_ROWS / 2d);
+        grid.setWest(-GRID_COLS / 2d);
+        return grid;
     }
 
     private DesignProjection[] getDesignProjections() {
@@ -290,11 +325,12 @@ public class FlexProjectorModel extends GeoMap implements Serializable,
     }
 
     /**
-     * Computes the visualizations for the map and redraws the map.
+     * Computes the visualizations for the map in a separate thread and
+     * redraws the map when they are ready.
      */
     @Override
     public void designProjectionChanged(Projection p) {
-        mapChanged();
+        mapChangedInBackground();
     }
 
     /**
@@ -402,144 +438,335 @@ public class FlexProjectorModel extends GeoMap implements Serializable,
     public void mapChanged() {
 
         designProjection.initialize();
+        interactiveData = null;
+
+        // discard the results of pending background updates
+        ++mapRequest;
 
         if (unprojectedData.getNumberOfChildren() == 0) {
             return;
         }
 
+        final long mapChangedStart = Instrumentation.start();
         MapEventTrigger trigger = new MapEventTrigger(this);
         try {
             projectedDataDestination.removeAllGeoObjects();
+            GeoGrid[] grids = new GeoGrid[]{flexAreaGrid, flexAngleGrid,
+                secondAreaGrid, secondAngleGrid};
+            constructMap(projectedDataDestination, designProjection,
+                    displayModel.projection, unprojectedData, grids);
+        } finally {
+            trigger.inform();
+            Instrumentation.stop("mapChanged", mapChangedStart);
+        }
 
-            GeoPath flexBoundingBox = constructBoundingBox(designProjection);
-            java.awt.geom.Rectangle2D flexBounds = null;
-            if (flexBoundingBox != null) {
-                flexBounds = flexBoundingBox.getBounds2D(GeoObject.UNDEFINED_SCALE);
-            }
+    }
 
-            if (displayModel.showFlexProjection) {
+    /**
+     * Computes the visualizations for the map in a separate thread, and
+     * replaces the content of the map in the Event Dispatching Thread when
+     * they are ready. The map is not changed if mapChanged(),
+     * mapChangedInteractive() or mapChangedInBackground() is called before
+     * the visualizations are ready. Must be called in the Event Dispatching
+     * Thread.
+     */
+    public void mapChangedInBackground() {
 
-                // destination GeoSet
-                GeoSet flexGeoSet = new GeoSet();
-                flexGeoSet.setName("Flex");
-                projectedDataDestination.add(flexGeoSet);
+        designProjection.initialize();
+        interactiveData = null;
 
-                VectorSymbol symbol = this.getForegroundVectorSymbol();
+        final long request = ++mapRequest;
 
-                // Q acceptance
-                if (displayModel.qModel.isShowAcceptableArea()) {
-                    ProjectionDistortionParameters p;
-                    p = displayModel.getDistortionParameters(designProjection);
-                    GeoImage img = p.computeAcceptanceImage(displayModel.qModel);
-                    flexGeoSet.add(img);
-                }
+        if (unprojectedData.getNumberOfChildren() == 0) {
+            return;
+        }
 
-                // copy and project unprojected coastlines
-                if (displayModel.showCoastline) {
-                    GeoSet geoSet = constructProjectedCoastlines(designProjection);
-                    geoSet.setVectorSymbol(symbol);
-                    flexGeoSet.add(geoSet);
-                }
+        // the worker thread uses copies of the projections and the data, and
+        // its own distortion grids
+        final Projection flexProj = (Projection) designProjection.clone();
+        final Projection secondProj = displayModel.projection == null
+                ? null : (Projection) displayModel.projection.clone();
+        final GeoSet data = unprojectedData.clone();
 
-                // graticule
-                if (displayModel.showGraticule) {
-                    GeoSet graticule = constructGraticule(designProjection);
-                    graticule.setVectorSymbol(symbol);
-                    flexGeoSet.add(graticule);
-                }
+        mapExecutor.execute(new Runnable() {
 
-                // Tissot indicatrices
-                if (displayModel.showTissot) {
-                    GeoSet tiss = constructTissotIndicatrices(designProjection);
-                    tiss.setVectorSymbol(symbol);
-                    flexGeoSet.add(tiss);
+            @Override
+            public void run() {
+                try {
+                    if (request != mapRequest) {
+                        return;
+                    }
+                    final long start = Instrumentation.start();
+                    GeoSet map = new GeoSet();
+                    GeoGrid[] grids = new GeoGrid[]{newDistortionGrid(),
+                        newDistortionGrid(), newDistortionGrid(),
+                        newDistortionGrid()};
+                    constructMap(map, flexProj, secondProj, data, grids);
+                    Instrumentation.stop("mapChangedInBackground", start);
+                    publishMap(request, map);
+                } catch (RuntimeException exc) {
+                    exc.printStackTrace();
                 }
+            }
+        });
+    }
 
-                // isolines
-                if (displayModel.showAngularIsolines
-                        || displayModel.showArealIsolines) {
-                    flexGeoSet.add(constructIsolines(designProjection,
-                            flexAreaGrid, flexAngleGrid));
-                }
+    /**
+     * Replaces the content of the map in the Event Dispatching Thread, unless
+     * a newer request has been made.
+     */
+    private void publishMap(final long request, final GeoSet map) {
+
+        SwingUtilities.invokeLater(new Runnable() {
 
-                // outline
-                if (needsOutline(designProjection)) {
-                    GeoPath outline = FlexProjectorModel.constructOutline(designProjection);
-                    outline.setVectorSymbol(symbol);
-                    GeoSet outlineGeoSet = constructOutlineGeoSet(outline);
-                    flexGeoSet.add(outlineGeoSet);
+            @Override
+            public void run() {
+                if (request != mapRequest) {
+                    return;
                 }
+                MapEventTrigger trigger = new MapEventTrigger(FlexProjectorModel.this);
+                try {
+                    projectedDataDestination.removeAllGeoObjects();
+                    while (map.getNumberOfChildren() > 0) {
+                        projectedDataDestination.add(map.remove(0));
+                    }
+                } finally {
+                    trigger.inform();
+                }
+            }
+        });
+    }
 
+    /**
+     * Constructs the visualizations of the design projection and the second
+     * projection.
+     * @param destination The visualizations are added to this GeoSet.
+     * @param flexProjection The design projection.
+     * @param secondProjection The projection in the background. Its central
+     * meridian is changed. Can be null.
+     * @param data The unprojected coastlines. Not changed.
+     * @param grids Grids for the isolines of areal and angular distortion of
+     * the design projection, followed by the grids for the second projection.
+     */
+    private void constructMap(GeoSet destination, Projection flexProjection,
+            Projection secondProjection, GeoSet data, GeoGrid[] grids) {
+
+        GeoPath flexBoundingBox = constructBoundingBox(flexProjection);
+        java.awt.geom.Rectangle2D flexBounds = null;
+        if (flexBoundingBox != null) {
+            flexBounds = flexBoundingBox.getBounds2D(GeoObject.UNDEFINED_SCALE);
+        }
+
+        if (displayModel.showFlexProjection) {
+
+            // destination GeoSet
+            GeoSet flexGeoSet = new GeoSet();
+            flexGeoSet.setName("Flex");
+            destination.add(flexGeoSet);
+
+            VectorSymbol symbol = this.getForegroundVectorSymbol();
+
+            // Q acceptance
+            if (displayModel.qModel.isShowAcceptableArea()) {
+                final long t = Instrumentation.start();
+                ProjectionDistortionParameters p;
+                p = displayModel.getDistortionParameters(flexProjection);
+                GeoImage img = p.computeAcceptanceImage(displayModel.qModel);
+                flexGeoSet.add(img);
+                Instrumentation.stop("mapChanged.acceptance", t);
             }
 
-            if (displayModel.showSecondProjection) {
-                if (displayModel.projection == null) {
-                    return;
-                }
+            // copy and project unprojected coastlines
+            if (displayModel.showCoastline) {
+                final long t = Instrumentation.start();
+                GeoSet geoSet = constructProjectedCoastlines(data, flexProjection);
+                geoSet.setVectorSymbol(symbol);
+                flexGeoSet.add(geoSet);
+                Instrumentation.stop("mapChanged.coastlines", t);
+            }
 
-                GeoSet projGeoSet = new GeoSet();
-                projGeoSet.setName(displayModel.projection.getName()); // toString instead of getName ? FIXME
-                projectedDataDestination.add(0, projGeoSet);
+            // graticule
+            if (displayModel.showGraticule) {
+                final long t = Instrumentation.start();
+                GeoSet graticule = constructGraticule(flexProjection);
+                graticule.setVectorSymbol(symbol);
+                flexGeoSet.add(graticule);
+                Instrumentation.stop("mapChanged.graticule", t);
+            }
 
-                double lon0 = designProjection.getProjectionLongitude();
-                displayModel.projection.setProjectionLongitude(lon0);
-                displayModel.projection.setEllipsoid(Ellipsoid.SPHERE);
-                displayModel.projection.initialize();
+            // Tissot indicatrices
+            if (displayModel.showTissot) {
+                final long t = Instrumentation.start();
+                GeoSet tiss = constructTissotIndicatrices(flexProjection);
+                tiss.setVectorSymbol(symbol);
+                flexGeoSet.add(tiss);
+                Instrumentation.stop("mapChanged.tissot", t);
+            }
 
-                VectorSymbol symbol = this.getBackgroundVectorSymbol();
+            // isolines
+            if (displayModel.showAngularIsolines
+                    || displayModel.showArealIsolines) {
+                final long t = Instrumentation.start();
+                flexGeoSet.add(constructIsolines(flexProjection,
+                        grids[0], grids[1]));
+                Instrumentation.stop("mapChanged.isolines", t);
+            }
 
-                // Q acceptance
-                if (this.displayModel.qModel.isShowAcceptableArea()) {
-                    ProjectionDistortionParameters p;
-                    p = displayModel.getDistortionParameters(displayModel.projection);
-                    GeoImage img = p.computeAcceptanceImage(displayModel.qModel);
-                    projGeoSet.add(img);
-                }
+            // outline
+            if (needsOutline(flexProjection)) {
+                GeoPath outline = FlexProjectorModel.constructOutline(flexProjection);
+                outline.setVectorSymbol(symbol);
+                GeoSet outlineGeoSet = constructOutlineGeoSet(outline);
+                flexGeoSet.add(outlineGeoSet);
+            }
 
-                // copy and project unprojected data
-                if (this.displayModel.showCoastline) {
-                    GeoSet geoSet = constructProjectedCoastlines(displayModel.projection);
-                    geoSet.setVectorSymbol(symbol);
-                    projGeoSet.add(geoSet);
-                }
+        }
 
-                // graticule
-                if (this.displayModel.showGraticule) {
-                    GeoSet graticule = constructGraticule(displayModel.projection);
-                    graticule.setVectorSymbol(symbol);
-                    projGeoSet.add(graticule);
-                }
+        if (displayModel.showSecondProjection && secondProjection != null) {
+            final long t = Instrumentation.start();
 
-                // Tissot indicatrices
-                if (this.displayModel.showTissot) {
-                    GeoSet tiss = constructTissotIndicatrices(displayModel.projection);
-                    tiss.setVectorSymbol(symbol);
-                    projGeoSet.add(tiss);
-                }
+            GeoSet projGeoSet = new GeoSet();
+            projGeoSet.setName(secondProjection.getName()); // toString instead of getName ? FIXME
+            destination.add(0, projGeoSet);
 
-                // outline
-                GeoPath outline = FlexProjectorModel.constructOutline(displayModel.projection);
-                if (this.needsOutline(displayModel.projection)) {
-                    outline.setVectorSymbol(symbol);
-                    GeoSet outlineGeoSet = this.constructOutlineGeoSet(outline);
-                    projGeoSet.add(outlineGeoSet);
-                }
+            double lon0 = flexProjection.getProjectionLongitude();
+            secondProjection.setProjectionLongitude(lon0);
+            secondProjection.setEllipsoid(Ellipsoid.SPHERE);
+            secondProjection.initialize();
 
-                // isolines
-                if (this.displayModel.showAngularIsolines
-                        || this.displayModel.showArealIsolines) {
-                    projGeoSet.add(constructIsolines(displayModel.projection,
-                            secondAreaGrid, secondAngleGrid));
+            VectorSymbol symbol = this.getBackgroundVectorSymbol();
+
+            // Q acceptance
+            if (this.displayModel.qModel.isShowAcceptableArea()) {
+                ProjectionDistortionParameters p;
+                p = displayModel.getDistortionParameters(secondProjection);
+                GeoImage img = p.computeAcceptanceImage(displayModel.qModel);
+                projGeoSet.add(img);
+            }
+
+            // copy and project unprojected data
+            if (this.displayModel.showCoastline) {
+                GeoSet geoSet = constructProjectedCoastlines(data, secondProjection);
+                geoSet.setVectorSymbol(symbol);
+                projGeoSet.add(geoSet);
+            }
+
+            // graticule
+            if (this.displayModel.showGraticule) {
+                GeoSet graticule = constructGraticule(secondProjection);
+                graticule.setVectorSymbol(symbol);
+                projGeoSet.add(graticule);
+            }
+
+            // Tissot indicatrices
+            if (this.displayModel.showTissot) {
+                GeoSet tiss = constructTissotIndicatrices(secondProjection);
+                tiss.setVectorSymbol(symbol);
+                projGeoSet.add(tiss);
+            }
+
+            // outline
+            GeoPath outline = FlexProjectorModel.constructOutline(secondProjection);
+            if (this.needsOutline(secondProjection)) {
+                outline.setVectorSymbol(symbol);
+                GeoSet outlineGeoSet = this.constructOutlineGeoSet(outline);
+                projGeoSet.add(outlineGeoSet);
+            }
+
+            // isolines
+            if (this.displayModel.showAngularIsolines
+                    || this.displayModel.showArealIsolines) {
+                projGeoSet.add(constructIsolines(secondProjection,
+                        grids[2], grids[3]));
+            }
+
+            // scale the second projection to the size of the flexed projection
+            Rectangle2D backBounds = outline.getBounds2D(GeoObject.UNDEFINED_SCALE);
+            scaleBackgroundProjection(flexBounds, backBounds, projGeoSet);
+            Instrumentation.stop("mapChanged.secondProjection", t);
+        }
+    }
+
+    /**
+     * Quickly updates the map while the user drags a slider. Only decimated
+     * coastlines, a coarse graticule and the outline of the design projection
+     * are constructed. The acceptance image, Tissot indicatrices, isolines and
+     * the second projection are not shown. The decimation of the coastlines is
+     * adapted so that constructing the map takes about
+     * INTERACTIVE_FRAME_BUDGET. Call mapChanged() when the user releases the
+     * slider to construct the complete map.
+     */
+    public void mapChangedInteractive() {
+
+        designProjection.initialize();
+
+        if (unprojectedData.getNumberOfChildren() == 0
+                || !displayModel.showFlexProjection) {
+            return;
+        }
+
+        // discard the results of pending background updates
+        ++mapRequest;
+
+        final long start = System.nanoTime();
+        MapEventTrigger trigger = new MapEventTrigger(this);
+        try {
+            projectedDataDestination.removeAllGeoObjects();
+
+            GeoSet flexGeoSet = new GeoSet();
+            flexGeoSet.setName("Flex");
+            projectedDataDestination.add(flexGeoSet);
+
+            VectorSymbol symbol = this.getForegroundVectorSymbol();
+
+            // decimated coastlines
+            if (displayModel.showCoastline) {
+                if (interactiveData == null) {
+                    interactiveData = GeoPathDecimator.decimate(unprojectedData,
+                            interactiveStep);
                 }
+                GeoSet geoSet = interactiveData.clone();
+                new GeoProjector(designProjection).project(geoSet);
+                geoSet.setVectorSymbol(symbol);
+                flexGeoSet.add(geoSet);
+            }
 
-                // scale the second projection to the size of the flexed projection
-                Rectangle2D backBounds = outline.getBounds2D(GeoObject.UNDEFINED_SCALE);
-                scaleBackgroundProjection(flexBounds, backBounds, projGeoSet);
+            // coarse graticule
+            if (displayModel.showGraticule) {
+                GeoSet graticule = constructGraticule(designProjection,
+                        INTERACTIVE_CURVE_TOLERANCE);
+                graticule.setVectorSymbol(symbol);
+                flexGeoSet.add(graticule);
             }
+
+            // outline
+            GeoPath outline = FlexProjectorModel.constructOutline(designProjection);
+            outline.setVectorSymbol(symbol);
+            flexGeoSet.add(constructOutlineGeoSet(outline));
         } finally {
             trigger.inform();
+            final long duration = System.nanoTime() - start;
+            adaptInteractiveStep(duration);
+            Instrumentation.record("mapChangedInteractive", duration);
         }
+    }
 
+    /**
+     * Doubles the decimation of the coastlines if constructing the map took
+     * longer than INTERACTIVE_FRAME_BUDGET, and halves it if it took less than
+     * a third. The gap avoids alternating between two decimations.
+     * @param duration The time in nanoseconds for constructing the map.
+     */
+    private void adaptInteractiveStep(long duration) {
+        if (duration > INTERACTIVE_FRAME_BUDGET
+                && interactiveStep < MAX_INTERACTIVE_STEP) {
+            interactiveStep *= 2;
+            interactiveData = null;
+        } else if (duration < INTERACTIVE_FRAME_BUDGET / 3
+                && interactiveStep > 1) {
+            interactiveStep /= 2;
+            interactiveData = null;
+        }
     }
 
     public void scaleBackgroundProjection(Rectangle2D foreBounds,
@@ -576,10 +803,23 @@ public class FlexProjectorModel extends GeoMap implements Serializable,
         }
     }
 
+    /**
+     * Projects the unprojected data. The copy of the unprojected data shares
+     * its coordinates with the original, and the projector replaces them with
+     * new projected coordinates, so the unprojected coordinates are not copied.
+     */
     public GeoSet constructProjectedCoastlines(Projection projection) {
+        return constructProjectedCoastlines(this.unprojectedData, projection);
+    }
+
+    /**
+     * Projects a copy of unprojected data.
+     */
+    private static GeoSet constructProjectedCoastlines(GeoSet data,
+            Projection projection) {
 //        ika.utils.NanoTimer timer = new ika.utils.NanoTimer();
 //        long start = timer.nanoTime();
-        GeoSet geoSet = (GeoSet) this.unprojectedData.clone();
+        GeoSet geoSet = (GeoSet) data.clone();
         new GeoProjector(projection).project(geoSet);
 //        long end = timer.nanoTime();
 //        System.out.println("Projecting Coastlines: " + (end - start) / 1000 / 1000 + "ms");
@@ -724,9 +964,18 @@ public class FlexProjectorModel extends GeoMap implements Serializable,
      * @return The projected graticule.
      */
     public GeoSet constructGraticule(Projection projection) {
+        return constructGraticule(projection, CURVE_TOLERANCE);
+    }
+
+    /**
+     * Construct a projected graticule.
+     * @param curveTolerance The tolerance for interpolating curved lines.
+     * @return The projected graticule.
+     */
+    private GeoSet constructGraticule(Projection projection, double curveTolerance) {
 
         projection = (Projection) projection.clone();
-        LineProjector projector = new LineProjector(projection, CURVE_TOLERANCE, true);
+        LineProjector projector = new LineProjector(projection, curveTolerance, true);
         GeoSet geoSet = new GeoSet();
         geoSet.setName("Graticule");
 
@@ -777,15 +1026,16 @@ public class FlexProjectorModel extends GeoMap implements Serializable,
 
     /**
      * Constructs an array of Tissot indicatrices for the passed projection.
-     * Very small circles are constructed from straight lines. The circles are
-     * projected and then enlarged for display. This approach gives the
-     * indicatrices a more regular ellipse-like shape. It requires that all
-     * computations are done with doubles (and not floats). Also, the clipping
-     * along the outlines of the projection of GeoPath.project() cannot be used,
-     * since the ellipses are enlarged after projecting them.
+     * Very small circles are projected to ellipses, which are then enlarged
+     * for display. The ellipses are computed from the projected center and
+     * two projected points on each circle by BulkTissotIndicatrices. This
+     * requires that all computations are done with doubles (and not floats).
+     * Also, the clipping along the outlines of the projection of
+     * GeoPath.project() cannot be used, since the ellipses are enlarged after
+     * projecting them.
      *
      * @param projection The projection for which indicatrices are constructed.
-     * @return A GeoSet containing the indicatrices as GeoPath objects.
+     * @return A GeoSet containing a single GeoPath with all indicatrices.
      */
     public GeoSet constructTissotIndicatrices(Projection projection) {
 
@@ -804,24 +1054,17 @@ public class FlexProjectorModel extends GeoMap implements Serializable,
             // the number of ellipses in vertical direction
             final int nVertical = (int) (Math.PI / ellDist);
 
-            // container for the coordinates of a projected point
-            java.awt.geom.Point2D.Double projPt = new java.awt.geom.Point2D.Double();
-
-            // array holding the coordinates of an ellipse. This array will be
-            // reused for each ellipse. x1, y1, x2, y2, ...
-            double[] circlePts = new double[TISSOT_CIRCLE_POINT_COUNT * 2];
-
-            // scale factor to convert from the unary sphere to earth coordinates
-            final double scale = projection.getEquatorRadius();
-
-            // scale factor to enlarge the small ellipses
-            final double indicatrixScale = TISSOT_SCALE * this.displayModel.tissotScale;
-
             // the number of ellipses per hemisphere.
             final int l = (int) Math.floor(Math.PI / ellDist) + 1;
             final int r = (int) Math.ceil(Math.PI / ellDist) + 1;
 
-            // construct the ellipses per columns, from left to right
+            // the centers of the ellipses
+            final int maxCount = (l + r + 1) * Math.max(0, nVertical - 1);
+            double[] lons = new double[maxCount];
+            double[] lats = new double[maxCount];
+            int n = 0;
+
+            // place the ellipses per columns, from left to right
             for (int h = -l; h <= r; h++) {
 
                 // the longitude of the current column of ellipses
@@ -832,59 +1075,34 @@ public class FlexProjectorModel extends GeoMap implements Serializable,
                     continue;
                 }
 
-                // construct a column of ellipses from bottom to top
+                // place a column of ellipses from bottom to top
                 for (int v = 1; v < nVertical; v++) {
+                    lons[n] = lon;
+                    lats[n] = -Math.PI / 2. + v * ellDist;
+                    ++n;
+                }
+            }
+            if (n < maxCount) {
+                double[] tmp = new double[n];
+                System.arraycopy(lons, 0, tmp, 0, n);
+                lons = tmp;
+                tmp = new double[n];
+                System.arraycopy(lats, 0, tmp, 0, n);
+                lats = tmp;
+            }
 
-                    // the latitude of the current ellipse
-                    final double lat = -Math.PI / 2. + v * ellDist;
-
-                    // construct the circle in radians around lon/lat
-                    this.constructPlateCarreeCircle(lon, lat, circlePts);
-
-                    // compute the center of the indicatrix in earth coordinates
-                    try {
-                        projection.project(lon, lat, projPt);
-                    } catch (ProjectionException exc) {
-                        continue;
-                    }
-                    final double cx = scale * projPt.x;
-                    final double cy = scale * projPt.y;
-                    if (Double.isNaN(cx) || Double.isNaN(cy)
-                            || Double.isInfinite(cx) || Double.isInfinite(cy)) {
-                        continue;
-                    }
+            // scale factor to convert from the unary sphere to earth coordinates
+            final double scale = projection.getEquatorRadius();
 
-                    // project the small circle to an ellipse, enlarge it and
-                    // add each point to a new GeoPath.
-                    GeoPath ellipse = new GeoPath();
-                    for (int i = 0; i < circlePts.length / 2; i++) {
-                        // project the point
-                        try {
-                            projection.project(circlePts[i * 2], circlePts[i * 2 + 1], projPt);
-                        } catch (ProjectionException exc) {
-                            continue;
-                        }
-                        // convert from the unary sphere to earth coordinates
-                        double x = scale * projPt.x;
-                        double y = scale * projPt.y;
-
-                        if (!Double.isNaN(x) && !Double.isNaN(y)
-                                && !Double.isInfinite(x) && !Double.isInfinite(y)) {
-                            // scale the point relative to the ellipse center
-                            x = (x - cx) * indicatrixScale + cx;
-                            y = (y - cy) * indicatrixScale + cy;
-
-                            // add the point to the GeoPath
-                            ellipse.moveOrLineTo(x, y);
-                        }
-                    }
+            // scale factor to enlarge the small ellipses
+            final double indicatrixScale = TISSOT_SCALE * this.displayModel.tissotScale;
 
-                    // close the ellipse and add it to the GeoSet
-                    ellipse.closePath();
-                    geoSet.add(ellipse);
-                }
+            GeoPath ellipses = BulkTissotIndicatrices.construct(projection,
+                    lons, lats, TISSOT_CIRCLE_RADIUS, TISSOT_CIRCLE_POINT_COUNT,
+                    scale, indicatrixScale);
+            if (ellipses != null) {
+                geoSet.add(ellipses);
             }
-
             return geoSet;
         } finally {
             // reset to the initial central meridian
@@ -892,26 +1110,6 @@ public class FlexProjectorModel extends GeoMap implements Serializable,
         }
     }
 
-    /**
-     * Constructs a circle around lon/lat in Plate Carree projection. The 
-     * outline consists of straight line segments. 
-     * The number of points is TISSOT_CIRCLE_POINT_COUNT and the radius is
-     * TISSOT_CIRCLE_RADIUS.
-     * @param lon The horizontal coordinate of the center.
-     * @param lat The vertical coordinate of the center.
-     * @param circle An array that will receive the coordinates of the outline
-     * of the circle.
-     */
-    private void constructPlateCarreeCircle(double lon, double lat, double[] circle) {
-
-        final double angleIncrement = Math.PI * 2. / TISSOT_CIRCLE_POINT_COUNT;
-        for (int i = 0; i < TISSOT_CIRCLE_POINT_COUNT; i++) {
-            final double a = i * angleIncrement;
-            circle[i * 2] = lon + Math.cos(a) * TISSOT_CIRCLE_RADIUS / Math.cos(lat);
-            circle[i * 2 + 1] = lat + Math.sin(a) * TISSOT_CIRCLE_RADIUS;
-        }
-    }
-
     /*
     public GeoSet constructTissotIndicatrices(Projection projection) {
 
@@ -1038,28 +1236,29 @@ public class FlexProjectorModel extends GeoMap implements Serializable,
     }
     }
      */
+    /**
+     * Fills the grids with distortion values for the isolines that are shown.
+     * The distortion is only computed where the isolines require it, and
+     * interpolated elsewhere. No isolines are traced for the areal distortion
+     * of equal-area projections and the angular distortion of conformal
+     * projections, so these values do not require refinement.
+     * @param projection The projection with a central meridian of 0.
+     */
     private void fillDistortionGrids(Projection projection,
             GeoGrid areaGrid, GeoGrid projGrid) {
 
-        final double dh = 1e-5; // DEFAULT_H;
-
-        // fill the grids
-        ProjectionFactors projFactors = new ProjectionFactors();
-        for (int r = 0; r < GRID_ROWS; r++) {
-            final double lat = FlexProjectorModel.GRID_ROWS / 2 - r;
-            for (int c = 0; c < GRID_COLS; c++) {
-                final double lon = -180 + c;
-
-                try {
-                    projFactors.compute(projection, lon * MapMath.DTR, lat * MapMath.DTR, dh);
-                    areaGrid.setValue((float) projFactors.s, c, r);
-                    flexAngleGrid.setValue((float) (projFactors.omega * MapMath.RTD), c, r);
-                } catch (Exception exc) {
-                    areaGrid.setValue(Float.NaN, c, r);
-                    flexAngleGrid.setValue(Float.NaN, c, r);
-                }
-            }
-        }
+        final long t = Instrumentation.start();
+        final double areaInterval = displayModel.showArealIsolines
+                && !projection.isEqualArea()
+                ? displayModel.arealIsolinesEquidistance : Double.NaN;
+        final double angleInterval = displayModel.showAngularIsolines
+                && !projection.isConformal()
+                ? displayModel.angularIsolinesEquidistance : Double.NaN;
+        final int computedCount = AdaptiveDistortionSampler.fill(projection,
+                areaGrid.getGrid(), projGrid.getGrid(),
+                areaInterval, angleInterval);
+        Instrumentation.count("isolines.computedCells", computedCount);
+        Instrumentation.stop("isolines.distortionGrids", t);
     }
 
     /**
@@ -1117,7 +1316,7 @@ public class FlexProjectorModel extends GeoMap implements Serializable,
             Contourer contourer = new Contourer();
             contourer.setInterval(displayModel.angularIsolinesEquidistance);
             contourer.setTreatDegreeJump(true);
-            GeoSet angleContours = (GeoSet) contourer.operate(flexAngleGrid, 0, 120);
+            GeoSet angleContours = (GeoSet) contourer.operate(projGrid, 0, 120);
             angleContours.setName("Isolines of Maximum Angular Distortion");
 
             // project the angle contours
@@ -0,0 +1,602 @@
+/*
+ * GeoBinaryCodec.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+
+package ika.geo;
+
+import java.awt.Color;
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.io.ObjectInputStream;
+import java.io.ObjectOutputStream;
+import java.nio.BufferUnderflowException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.Charset;
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.IdentityHashMap;
+
+/**
+ * A versioned binary codec for trees of GeoObjects. This is a replacement for
+ * Java object serialization of GeoSets and GeoPaths, which is slow and
+ * produces bloated streams for the flat arrays of GeoPathModel.<br>
+ * GeoSets and GeoPaths are encoded natively: the drawing instructions and the
+ * coordinates of a GeoPathModel are written as raw blocks of bytes and doubles,
+ * and VectorSymbols are stored once in a table of distinct symbols that paths
+ * reference by index. Any other GeoObject is embedded as a Java serialization
+ * blob.<br>
+ * Each node in the encoded tree is prefixed with the length of its body. A
+ * Decoder can therefore skip over sub-trees and decode the children of the
+ * root GeoSet individually and on demand.<br>
+ * All values are stored in little-endian byte order.
+ */
+public final class GeoBinaryCodec {
+
+    /**
+     * Identifies an encoded tree of GeoObjects: 'G' 'E' 'O' 'B'.
+     */
+    public static final int MAGIC = 0x47454F42;
+    /**
+     * The current version of the format. Decoders accept this and all older
+     * versions.
+     */
+    public static final short VERSION = 1;
+    private static final byte TAG_NULL = 0;
+    private static final byte TAG_SET = 1;
+    private static final byte TAG_PATH = 2;
+    private static final byte TAG_SERIALIZED = 3;
+    private static final byte FLAG_SELECTED = 1;
+    private static final byte FLAG_SELECTABLE = 2;
+    private static final byte FLAG_VISIBLE = 4;
+    private static final byte FLAG_NAME = 8;
+    private static final byte FLAG_GROUPED = 16;
+    private static final byte FLAG_SPATIAL_INDEX = 32;
+    private static final byte SYMBOL_FILLED = 1;
+    private static final byte SYMBOL_STROKED = 2;
+    private static final byte SYMBOL_SCALE_INVARIANT = 4;
+    private static final byte SYMBOL_FILL_COLOR = 8;
+    private static final byte SYMBOL_STROKE_COLOR = 16;
+    /**
+     * Size of the tag and the length that precede the body of every node.
+     */
+    private static final int NODE_HEADER_SIZE = 5;
+    private static final Charset UTF8 = Charset.forName("UTF-8");
+
+    private GeoBinaryCodec() {
+    }
+
+    /**
+     * Returns true if the passed bytes start with the header of an encoded
+     * tree of GeoObjects.
+     * @param b The bytes to test.
+     * @return True if b can be passed to decode().
+     */
+    public static boolean isEncoded(byte[] b) {
+        if (b == null || b.length < 6) {
+            return false;
+        }
+        final int magic = (b[0] & 0xff) | (b[1] & 0xff) << 8
+                | (b[2] & 0xff) << 16 | (b[3] & 0xff) << 24;
+        return magic == MAGIC;
+    }
+
+    /**
+     * Encodes a GeoObject and all its children.
+     * @param geoObject The GeoObject to encode. Can be null.
+     * @return The encoded tree.
+     */
+    public static byte[] encode(GeoObject geoObject) throws IOException {
+        return new Encoder().encode(geoObject);
+    }
+
+    /**
+     * Decodes a complete tree of GeoObjects.
+     * @param b The bytes generated by encode().
+     * @return The decoded GeoObject or null.
+     */
+    public static GeoObject decode(byte[] b) throws IOException {
+        return new Decoder(b).decode();
+    }
+
+    /**
+     * Collects VectorSymbols and writes the tree of GeoObjects.
+     */
+    private static final class Encoder {
+
+        private ByteBuffer buffer = ByteBuffer.allocate(64 * 1024).order(ByteOrder.LITTLE_ENDIAN);
+        private final ArrayList<VectorSymbol> symbols = new ArrayList<VectorSymbol>();
+        private final HashMap<SymbolKey, Integer> symbolIDs = new HashMap<SymbolKey, Integer>();
+        private final IdentityHashMap<VectorSymbol, Integer> symbolInstanceIDs =
+                new IdentityHashMap<VectorSymbol, Integer>();
+
+        private byte[] encode(GeoObject geoObject) throws IOException {
+            collectSymbols(geoObject);
+
+            ensureCapacity(6);
+            buffer.putInt(MAGIC);
+            buffer.putShort(VERSION);
+
+            // table of distinct symbols
+            ensureCapacity(4 + symbols.size() * 20);
+            buffer.putInt(symbols.size());
+            for (VectorSymbol symbol : symbols) {
+                writeSymbol(symbol);
+            }
+
+            writeNode(geoObject);
+
+            byte[] b = new byte[buffer.position()];
+            buffer.flip();
+            buffer.get(b);
+            return b;
+        }
+
+        private void collectSymbols(GeoObject geoObject) {
+            if (geoObject instanceof GeoSet && isNativeSet(geoObject)) {
+                GeoSet geoSet = (GeoSet) geoObject;
+                final int nbrChildren = geoSet.getNumberOfChildren();
+                for (int i = 0; i < nbrChildren; i++) {
+                    collectSymbols(geoSet.getGeoObject(i));
+                }
+            } else if (isNativePath(geoObject)) {
+                symbolID(((GeoPath) geoObject).getVectorSymbol());
+            }
+        }
+
+        /**
+         * Returns the index of a symbol in the table of symbols. Adds the
+         * symbol to the table if no equal symbol is in the table yet.
+         */
+        private int symbolID(VectorSymbol symbol) {
+            if (symbol == null) {
+                return -1;
+            }
+            Integer id = symbolInstanceIDs.get(symbol);
+            if (id == null) {
+                SymbolKey key = new SymbolKey(symbol);
+                id = symbolIDs.get(key);
+                if (id == null) {
+                    id = Integer.valueOf(symbols.size());
+                    symbols.add(symbol);
+                    symbolIDs.put(key, id);
+                }
+                symbolInstanceIDs.put(symbol, id);
+            }
+            return id.intValue();
+        }
+
+        private void ensureCapacity(int n) {
+            if (buffer.remaining() >= n) {
+                return;
+            }
+            final int capacity = Math.max(buffer.capacity() * 2, buffer.position() + n);
+            ByteBuffer b = ByteBuffer.allocate(capacity).order(ByteOrder.LITTLE_ENDIAN);
+            buffer.flip();
+            b.put(buffer);
+            buffer = b;
+        }
+
+        private void writeSymbol(VectorSymbol symbol) {
+            final Color fillColor = symbol.getFillColor();
+            final Color strokeColor = symbol.getStrokeColor();
+            byte flags = 0;
+            if (symbol.isFilled()) {
+                flags |= SYMBOL_FILLED;
+            }
+            if (symbol.isStroked()) {
+                flags |= SYMBOL_STROKED;
+            }
+            if (symbol.isScaleInvariant()) {
+                flags |= SYMBOL_SCALE_INVARIANT;
+            }
+            if (fillColor != null) {
+                flags |= SYMBOL_FILL_COLOR;
+            }
+            if (strokeColor != null) {
+                flags |= SYMBOL_STROKE_COLOR;
+            }
+            buffer.put(flags);
+            buffer.put((byte) symbol.getCap());
+            buffer.putInt(fillColor == null ? 0 : fillColor.getRGB());
+            buffer.putInt(strokeColor == null ? 0 : strokeColor.getRGB());
+            buffer.putFloat(symbol.getStrokeWidth());
+            buffer.putFloat(symbol.getDashLength());
+        }
+
+        private void writeString(String str) {
+            byte[] b = str.getBytes(UTF8);
+            ensureCapacity(4 + b.length);
+            buffer.putInt(b.length);
+            buffer.put(b);
+        }
+
+        private void writeAttributes(GeoObject geoObject, byte flags) {
+            if (geoObject.isSelected()) {
+                flags |= FLAG_SELECTED;
+            }
+            if (geoObject.isSelectable()) {
+                flags |= FLAG_SELECTABLE;
+            }
+            if (geoObject.isVisible()) {
+                flags |= FLAG_VISIBLE;
+            }
+            final String name = geoObject.getName();
+            if (name != null) {
+                flags |= FLAG_NAME;
+            }
+            ensureCapacity(9);
+            buffer.put(flags);
+            buffer.putLong(geoObject.getID());
+            if (name != null) {
+                writeString(name);
+            }
+        }
+
+        private void writeNode(GeoObject geoObject) throws IOException {
+            ensureCapacity(NODE_HEADER_SIZE);
+            final int lengthPosition = buffer.position() + 1;
+            if (geoObject == null) {
+                buffer.put(TAG_NULL);
+                buffer.putInt(0);
+                return;
+            }
+
+            if (isNativeSet(geoObject)) {
+                buffer.put(TAG_SET);
+                buffer.putInt(0);
+                GeoSet geoSet = (GeoSet) geoObject;
+                byte setFlags = geoSet.isGrouped() ? FLAG_GROUPED : 0;
+                if (geoSet.isSpatialIndexEnabled()) {
+                    setFlags |= FLAG_SPATIAL_INDEX;
+                }
+                writeAttributes(geoSet, setFlags);
+                final int nbrChildren = geoSet.getNumberOfChildren();
+                ensureCapacity(4);
+                buffer.putInt(nbrChildren);
+                for (int i = 0; i < nbrChildren; i++) {
+                    writeNode(geoSet.getGeoObject(i));
+                }
+            } else if (isNativePath(geoObject)) {
+                buffer.put(TAG_PATH);
+                buffer.putInt(0);
+                GeoPath geoPath = (GeoPath) geoObject;
+                writeAttributes(geoPath, (byte) 0);
+                GeoPathModel pm = geoPath.getPathModel();
+                final byte[] instructions = pm.instructions;
+                final double[] points = pm.points;
+                ensureCapacity(12 + instructions.length + points.length * 8);
+                buffer.putInt(symbolID(geoPath.getVectorSymbol()));
+                buffer.putInt(instructions.length);
+                buffer.putInt(points.length);
+                buffer.put(instructions);
+                buffer.asDoubleBuffer().put(points);
+                buffer.position(buffer.position() + points.length * 8);
+            } else {
+                buffer.put(TAG_SERIALIZED);
+                buffer.putInt(0);
+                // serialize a copy without parent, as the parent is not
+                // transient and would drag the rest of the tree along.
+                GeoObject copy = geoObject.clone();
+                ByteArrayOutputStream bos = new ByteArrayOutputStream();
+                ObjectOutputStream oos = new ObjectOutputStream(bos);
+                oos.writeObject(copy != null ? copy : geoObject);
+                oos.close();
+                byte[] b = bos.toByteArray();
+                ensureCapacity(b.length);
+                buffer.put(b);
+            }
+
+            // store the length of the body following the node header
+            final int bodyLength = buffer.position() - lengthPosition - 4;
+            buffer.putInt(lengthPosition, bodyLength);
+        }
+    }
+
+    /**
+     * Only plain GeoSets are encoded natively. Derived classes carry
+     * additional state and are serialized.
+     */
+    private static boolean isNativeSet(GeoObject geoObject) {
+        return geoObject.getClass() == GeoSet.class;
+    }
+
+    /**
+     * Only plain GeoPaths with a plain VectorSymbol are encoded natively.
+     */
+    private static boolean isNativePath(GeoObject geoObject) {
+        if (geoObject == null || geoObject.getClass() != GeoPath.class) {
+            return false;
+        }
+        VectorSymbol symbol = ((GeoPath) geoObject).getVectorSymbol();
+        return symbol == null || symbol.getClass() == VectorSymbol.class;
+    }
+
+    /**
+     * Value-based key for identifying equal VectorSymbols. Unlike
+     * VectorSymbol.equals, this tolerates null colors.
+     */
+    private static final class SymbolKey {
+
+        private final int flags;
+        private final int fillRGB;
+        private final int strokeRGB;
+        private final int strokeWidth;
+        private final int dashLength;
+
+        private SymbolKey(VectorSymbol s) {
+            final Color fill = s.getFillColor();
+            final Color stroke = s.getStrokeColor();
+            flags = (s.isFilled() ? 1 : 0) | (s.isStroked() ? 2 : 0)
+                    | (s.isScaleInvariant() ? 4 : 0)
+                    | (fill != null ? 8 : 0) | (stroke != null ? 16 : 0)
+                    | s.getCap() << 8;
+            fillRGB = fill == null ? 0 : fill.getRGB();
+            strokeRGB = stroke == null ? 0 : stroke.getRGB();
+            strokeWidth = Float.floatToIntBits(s.getStrokeWidth());
+            dashLength = Float.floatToIntBits(s.getDashLength());
+        }
+
+        @Override
+        public boolean equals(Object obj) {
+            if (!(obj instanceof SymbolKey)) {
+                return false;
+            }
+            SymbolKey k = (SymbolKey) obj;
+            return k.flags == flags && k.fillRGB == fillRGB
+                    && k.strokeRGB == strokeRGB && k.strokeWidth == strokeWidth
+                    && k.dashLength == dashLength;
+        }
+
+        @Override
+        public int hashCode() {
+            int h = flags;
+            h = 31 * h + fillRGB;
+            h = 31 * h + strokeRGB;
+            h = 31 * h + strokeWidth;
+            return 31 * h + dashLength;
+        }
+    }
+
+    /**
+     * Decodes an encoded tree. The header and the table of symbols are read
+     * when the Decoder is constructed. The tree can then either be decoded
+     * completely with decode(), or the children of the root GeoSet can be
+     * decoded individually with decodeChild(), which skips all other sub-trees
+     * without decoding them.
+     */
+    public static final class Decoder {
+
+        private final ByteBuffer buffer;
+        private final short version;
+        private final VectorSymbol[] symbols;
+        /**
+         * Position of the root node.
+         */
+        private final int rootPosition;
+        /**
+         * Positions of the nodes of the children of the root GeoSet. Null
+         * until first needed.
+         */
+        private int[] childPositions;
+
+        public Decoder(byte[] b) throws IOException {
+            if (!isEncoded(b)) {
+                throw new IOException("Not an encoded GeoObject.");
+            }
+            buffer = ByteBuffer.wrap(b).order(ByteOrder.LITTLE_ENDIAN);
+            try {
+                buffer.getInt();
+                version = buffer.getShort();
+                if (version < 1 || version > VERSION) {
+                    throw new IOException("Unsupported version of GeoObject encoding: "
+                            + version);
+                }
+                final int nbrSymbols = buffer.getInt();
+                symbols = new VectorSymbol[nbrSymbols];
+                for (int i = 0; i < nbrSymbols; i++) {
+                    symbols[i] = readSymbol();
+                }
+            } catch (BufferUnderflowException exc) {
+                throw new IOException("Truncated GeoObject encoding.");
+            } catch (RuntimeException exc) {
+                throw new IOException("Corrupt GeoObject encoding.");
+            }
+            rootPosition = buffer.position();
+        }
+
+        /**
+         * Returns the version of the format that was used to encode the data.
+         */
+        public short getVersion() {
+            return version;
+        }
+
+        /**
+         * Decodes the complete tree.
+         * @return The root of the tree, or null.
+         */
+        public GeoObject decode() throws IOException {
+            return readNode(rootPosition);
+        }
+
+        /**
+         * Returns the number of children of the root GeoSet without decoding
+         * the children.
+         * @return The number of children, or 0 if the root is not a GeoSet.
+         */
+        public int getChildCount() throws IOException {
+            return findChildPositions().length;
+        }
+
+        /**
+         * Decodes a single child of the root GeoSet. The other children are
+         * skipped without being decoded.
+         * @param index The index of the child.
+         * @return The decoded child. Its parent is null.
+         */
+        public GeoObject decodeChild(int index) throws IOException {
+            return readNode(findChildPositions()[index]);
+        }
+
+        private int[] findChildPositions() throws IOException {
+            if (childPositions != null) {
+                return childPositions;
+            }
+            try {
+                if (buffer.get(rootPosition) != TAG_SET) {
+                    childPositions = new int[0];
+                    return childPositions;
+                }
+                buffer.position(rootPosition + NODE_HEADER_SIZE);
+                skipAttributes();
+                final int nbrChildren = buffer.getInt();
+                int[] positions = new int[nbrChildren];
+                int pos = buffer.position();
+                for (int i = 0; i < nbrChildren; i++) {
+                    positions[i] = pos;
+                    pos += NODE_HEADER_SIZE + buffer.getInt(pos + 1);
+                }
+                childPositions = positions;
+                return positions;
+            } catch (RuntimeException exc) {
+                throw new IOException("Corrupt GeoObject encoding.");
+            }
+        }
+
+        private VectorSymbol readSymbol() {
+            final byte flags = buffer.get();
+            final int cap = buffer.get();
+            final int fillRGB = buffer.getInt();
+            final int strokeRGB = buffer.getInt();
+            VectorSymbol symbol = new VectorSymbol();
+            symbol.setFilled((flags & SYMBOL_FILLED) != 0);
+            symbol.setStroked((flags & SYMBOL_STROKED) != 0);
+            symbol.setScaleInvariant((flags & SYMBOL_SCALE_INVARIANT) != 0);
+            symbol.setFillColor((flags & SYMBOL_FILL_COLOR) != 0
+                    ? new Color(fillRGB, true) : null);
+            symbol.setStrokeColor((flags & SYMBOL_STROKE_COLOR) != 0
+                    ? new Color(strokeRGB, true) : null);
+            symbol.setCap(cap);
+            symbol.setStrokeWidth(buffer.getFloat());
+            symbol.setDashLength(buffer.getFloat());
+            return symbol;
+        }
+
+        private String readString() {
+            final int length = buffer.getInt();
+            String str = new String(buffer.array(), buffer.position(), length, UTF8);
+            buffer.position(buffer.position() + length);
+            return str;
+        }
+
+        private void skipAttributes() {
+            final byte flags = buffer.get();
+            buffer.getLong();
+            if ((flags & FLAG_NAME) != 0) {
+                buffer.position(buffer.position() + buffer.getInt());
+            }
+        }
+
+        private byte readAttributes(GeoObject geoObject) {
+            final byte flags = buffer.get();
+            final long id = buffer.getLong();
+            final String name = (flags & FLAG_NAME) != 0 ? readString() : null;
+            geoObject.restoreAttributes(name, id,
+                    (flags & FLAG_SELECTED) != 0,
+                    (flags & FLAG_SELECTABLE) != 0,
+                    (flags & FLAG_VISIBLE) != 0);
+            return flags;
+        }
+
+        private GeoObject readNode(int position) throws IOException {
+            try {
+                buffer.position(position);
+                final byte tag = buffer.get();
+                final int bodyLength = buffer.getInt();
+                final int end = buffer.position() + bodyLength;
+                GeoObject geoObject;
+                switch (tag) {
+                    case TAG_NULL:
+                        geoObject = null;
+                        break;
+                    case TAG_SET:
+                        geoObject = readSet();
+                        break;
+                    case TAG_PATH:
+                        geoObject = readPath();
+                        break;
+                    case TAG_SERIALIZED:
+                        geoObject = readSerialized(bodyLength);
+                        break;
+                    default:
+                        throw new IOException("Unknown GeoObject tag: " + tag);
+                }
+                if (buffer.position() != end) {
+                    throw new IOException("Corrupt GeoObject encoding.");
+                }
+                return geoObject;
+            } catch (BufferUnderflowException exc) {
+                throw new IOException("Truncated GeoObject encoding.");
+            } catch (RuntimeException exc) {
+                throw new IOException("Corrupt GeoObject encoding.");
+            }
+        }
+
+        private GeoSet readSet() throws IOException {
+            GeoSet geoSet = new GeoSet();
+            final byte flags = readAttributes(geoSet);
+            final int nbrChildren = buffer.getInt();
+            for (int i = 0; i < nbrChildren; i++) {
+                // children are appended in order, reading advances the buffer.
+                // GeoSets do not store null children.
+                GeoObject child = readNode(buffer.position());
+                if (child != null) {
+                    geoSet.add(child);
+                }
+            }
+            geoSet.setGrouped((flags & FLAG_GROUPED) != 0);
+            geoSet.setSpatialIndexEnabled((flags & FLAG_SPATIAL_INDEX) != 0);
+            return geoSet;
+        }
+
+        private GeoPath readPath() {
+            GeoPath geoPath = new GeoPath();
+            readAttributes(geoPath);
+            final int symbolID = buffer.getInt();
+            final int nbrInstructions = buffer.getInt();
+            final int nbrCoordinates = buffer.getInt();
+
+            GeoPathModel pm = new GeoPathModel();
+            pm.instructions = new byte[nbrInstructions];
+            buffer.get(pm.instructions);
+            pm.points = new double[nbrCoordinates];
+            buffer.asDoubleBuffer().get(pm.points);
+            buffer.position(buffer.position() + nbrCoordinates * 8);
+            pm.updateBounds();
+            geoPath.setPathModel(pm);
+
+            // the table is shared, but symbols of GeoPaths are not
+            geoPath.setVectorSymbol(symbolID < 0 ? null : symbols[symbolID].clone());
+            return geoPath;
+        }
+
+        private GeoObject readSerialized(int length) throws IOException {
+            ByteArrayInputStream bis = new ByteArrayInputStream(buffer.array(),
+                    buffer.position(), length);
+            ObjectInputStream ois = new ObjectInputStream(bis);
+            try {
+                buffer.position(buffer.position() + length);
+                return (GeoObject) ois.readObject();
+            } catch (ClassNotFoundException exc) {
+                throw new IOException(exc.getMessage());
+            } finally {
+                ois.close();
+            }
+        }
+    }
+}
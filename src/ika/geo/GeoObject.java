@@ -558,6 +558,19 @@ public abstract class GeoObject implements Serializable, Cloneable {
         }
     }
 
+    /**
+     * Restores the state of this GeoObject when it is decoded. The state of
+     * children is not changed, and no MapEvent is generated.
+     */
+    void restoreAttributes(String name, long id, boolean selected,
+            boolean selectable, boolean visible) {
+        this.name = name;
+        this.id = id;
+        this.selected = selected;
+        this.selectable = selectable;
+        this.visible = visible;
+    }
+
     /**
      * Returns the parent GeoSet, i.e. the GeoSet that contains this GeoObject.
      *
@@ -591,6 +591,13 @@ public class GeoPath extends GeoObject implements Serializable, Cloneable {
         MapEventTrigger.inform(this);
     }
 
+    /**
+     * Returns the shared geometry of this GeoPath, not a copy.
+     */
+    GeoPathModel getPathModel() {
+        return path;
+    }
+
     /**
      * Removes the last point of the path that was added with moveto, lineto, etc.
      */
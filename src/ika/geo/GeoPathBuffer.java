@@ -0,0 +1,130 @@
+/*
+ * GeoPathBuffer.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+
+package ika.geo;
+
+import java.awt.geom.Point2D;
+
+/**
+ * A growable buffer for straight line paths, used by the projectors to
+ * construct projected paths. GeoPathModel allocates new arrays for every
+ * added point; this buffer grows its arrays by doubling their size and is
+ * reused for all paths projected by a projector. toPathModel() copies the
+ * content into a GeoPathModel with arrays of the exact size.
+ */
+final class GeoPathBuffer {
+
+    private double[] points = new double[256];
+    private byte[] instructions = new byte[128];
+    private int coordinatesCount = 0;
+    private int instructionsCount = 0;
+
+    GeoPathBuffer() {
+    }
+
+    /**
+     * Removes all points and instructions. The arrays are kept for reuse.
+     */
+    void reset() {
+        this.coordinatesCount = 0;
+        this.instructionsCount = 0;
+    }
+
+    private void add(double x, double y, byte instruction) {
+        if (this.coordinatesCount + 2 > this.points.length) {
+            double[] newPoints = new double[this.points.length * 2];
+            System.arraycopy(this.points, 0, newPoints, 0, this.coordinatesCount);
+            this.points = newPoints;
+        }
+        this.points[this.coordinatesCount++] = x;
+        this.points[this.coordinatesCount++] = y;
+        this.pushInstruction(instruction);
+    }
+
+    private void pushInstruction(byte instruction) {
+        if (this.instructionsCount == this.instructions.length) {
+            byte[] newInstructions = new byte[this.instructions.length * 2];
+            System.arraycopy(this.instructions, 0, newInstructions, 0, this.instructionsCount);
+            this.instructions = newInstructions;
+        }
+        this.instructions[this.instructionsCount++] = instruction;
+    }
+
+    /**
+     * Starts a new sub-path. Replaces the last instruction if it is a
+     * move-to instruction, as GeoPathModel.moveTo does.
+     */
+    void moveTo(double x, double y) {
+        if (this.getLastInstruction() == GeoPathModel.MOVETO) {
+            this.removeLastInstruction();
+        }
+        this.add(x, y, GeoPathModel.MOVETO);
+    }
+
+    void lineTo(double x, double y) {
+        this.add(x, y, GeoPathModel.LINETO);
+    }
+
+    void closePath() {
+        if (this.instructionsCount > 0) {
+            this.pushInstruction(GeoPathModel.CLOSE);
+        }
+    }
+
+    /**
+     * Removes the last move-to, line-to or close instruction.
+     */
+    void removeLastInstruction() {
+        if (this.instructionsCount == 0) {
+            return;
+        }
+        final byte instruction = this.instructions[--this.instructionsCount];
+        if (instruction == GeoPathModel.MOVETO || instruction == GeoPathModel.LINETO) {
+            this.coordinatesCount -= 2;
+        }
+    }
+
+    byte getLastInstruction() {
+        if (this.instructionsCount == 0) {
+            return GeoPathModel.NONE;
+        }
+        return this.instructions[this.instructionsCount - 1];
+    }
+
+    /**
+     * Returns the last point or null if the buffer is empty.
+     */
+    Point2D getEndPoint() {
+        if (this.coordinatesCount == 0) {
+            return null;
+        }
+        return new Point2D.Double(this.points[this.coordinatesCount - 2],
+                this.points[this.coordinatesCount - 1]);
+    }
+
+    /**
+     * Returns true if the last point is at x/y.
+     */
+    boolean endsAt(double x, double y) {
+        return this.coordinatesCount > 0
+                && this.points[this.coordinatesCount - 2] == x
+                && this.points[this.coordinatesCount - 1] == y;
+    }
+
+    /**
+     * Copies the content of this buffer to a new GeoPathModel.
+     */
+    GeoPathModel toPathModel() {
+        double[] pathPoints = new double[this.coordinatesCount];
+        System.arraycopy(this.points, 0, pathPoints, 0, this.coordinatesCount);
+        byte[] pathInstructions = new byte[this.instructionsCount];
+        System.arraycopy(this.instructions, 0, pathInstructions, 0, this.instructionsCount);
+        GeoPathModel pathModel = new GeoPathModel();
+        pathModel.setPointsAndInstructions(pathPoints, pathInstructions);
+        return pathModel;
+    }
+}
@@ -0,0 +1,125 @@
+/*
+ * GeoPathDecimator.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+
+package ika.geo;
+
+/**
+ * Reduces the number of points of straight line paths by keeping every n-th
+ * point. This is much faster than a line simplification and is used for
+ * quick previews of maps that are projected many times per second.
+ */
+public final class GeoPathDecimator {
+
+    private GeoPathDecimator() {
+    }
+
+    /**
+     * Returns a copy of a GeoSet with a reduced number of points. Of each
+     * line or ring, the first and the last point and every step-th point are
+     * kept. Rings with less than three points are removed. Paths with curves
+     * are copied unchanged.
+     * @param geoSet The GeoSet to copy. Is not changed.
+     * @param step Keep every step-th point.
+     * @return The new GeoSet.
+     */
+    public static GeoSet decimate(GeoSet geoSet, int step) {
+        GeoSet decimated = new GeoSet();
+        decimated.setName(geoSet.getName());
+        final int n = geoSet.getNumberOfChildren();
+        for (int i = 0; i < n; i++) {
+            GeoObject geoObject = geoSet.getGeoObject(i);
+            if (geoObject instanceof GeoSet) {
+                decimated.add(decimate((GeoSet) geoObject, step));
+            } else if (geoObject instanceof GeoPath) {
+                GeoPath geoPath = (GeoPath) geoObject;
+                GeoPath decimatedPath = geoPath.hasBezierSegment()
+                        ? geoPath.clone() : decimate(geoPath, step);
+                if (decimatedPath != null) {
+                    decimated.add(decimatedPath);
+                }
+            }
+        }
+        return decimated;
+    }
+
+    /**
+     * Returns a copy of a straight line GeoPath with a reduced number of
+     * points, or null if no line is left.
+     */
+    private static GeoPath decimate(GeoPath geoPath, int step) {
+        final int pointsCount = geoPath.getPointsCount();
+        if (pointsCount == 0) {
+            return null;
+        }
+        final boolean closed = geoPath.isClosed();
+        final int minPoints = closed ? 3 : 2;
+        double[] xy = new double[pointsCount * 2];
+        int[] firstPoints = new int[pointsCount];
+        int linesCount = 0;
+        int n = 0; // number of points in xy
+        int lineStart = 0; // first point of the current line in xy
+        int k = 0; // index of the point in the current line
+        double lastX = 0, lastY = 0; // last point of the current line
+
+        GeoPathIterator it = geoPath.getIterator();
+        do {
+            final byte instruction = it.getInstruction();
+            if (instruction == GeoPathModel.MOVETO) {
+                // finish the previous line and start a new one
+                n = finishLine(xy, n, lineStart, k, step, lastX, lastY, minPoints);
+                if (n > lineStart) {
+                    firstPoints[linesCount++] = lineStart;
+                }
+                lineStart = n;
+                k = 0;
+            }
+            if (instruction == GeoPathModel.MOVETO || instruction == GeoPathModel.LINETO) {
+                lastX = it.getX();
+                lastY = it.getY();
+                if (k % step == 0) {
+                    xy[n * 2] = lastX;
+                    xy[n * 2 + 1] = lastY;
+                    ++n;
+                }
+                ++k;
+            }
+        } while (it.next());
+        n = finishLine(xy, n, lineStart, k, step, lastX, lastY, minPoints);
+        if (n > lineStart) {
+            firstPoints[linesCount++] = lineStart;
+        }
+        if (linesCount == 0) {
+            return null;
+        }
+
+        double[] decimatedXY = new double[n * 2];
+        System.arraycopy(xy, 0, decimatedXY, 0, n * 2);
+        int[] decimatedFirstPoints = new int[linesCount];
+        System.arraycopy(firstPoints, 0, decimatedFirstPoints, 0, linesCount);
+        GeoPathModel pathModel = new GeoPathModel();
+        pathModel.setStraightLines(decimatedXY, decimatedFirstPoints, closed);
+        GeoPath decimatedPath = new GeoPath();
+        decimatedPath.setPathModel(pathModel);
+        decimatedPath.setName(geoPath.getName());
+        return decimatedPath;
+    }
+
+    /**
+     * Adds the last point of a line if it has not been kept, and removes the
+     * line if it has too few points.
+     * @return The new number of points in xy.
+     */
+    private static int finishLine(double[] xy, int n, int lineStart, int k,
+            int step, double lastX, double lastY, int minPoints) {
+        if (k > 0 && (k - 1) % step != 0) {
+            xy[n * 2] = lastX;
+            xy[n * 2 + 1] = lastY;
+            ++n;
+        }
+        return n - lineStart < minPoints ? lineStart : n;
+    }
+}
@@ -44,6 +44,11 @@ public final class GeoPathModel implements Serializable, Cloneable {
      * Rectangle2D is not serializable!
      */
     private transient Rectangle2D bounds = null;
+    /**
+     * True if this.points and this.instructions may be shared with a clone.
+     * Shared arrays are copied before they are changed in place.
+     */
+    private transient boolean shared = false;
 
     /** Creates a new instance of PathModel */
     public GeoPathModel() {
@@ -62,21 +67,16 @@ public final class GeoPathModel implements Serializable, Cloneable {
     }
 
     /**
-     * Create and return a copy of this path.
+     * Create and return a copy of this path. The copy shares the arrays
+     * with the points and the instructions with this path until one of the
+     * two paths is changed.
      */
     @Override
     public Object clone() {
         GeoPathModel copy = new GeoPathModel();
-
-        final int instructionsCount = this.instructions.length;
-        final byte[] instructionsCopy = new byte[instructionsCount];
-        System.arraycopy(this.instructions, 0, instructionsCopy, 0, instructionsCount);
-        copy.instructions = instructionsCopy;
-
-        final int coordinatesCount = this.points.length;
-        final double[] pointsCopy = new double[coordinatesCount];
-        System.arraycopy(this.points, 0, pointsCopy, 0, coordinatesCount);
-        copy.points = pointsCopy;
+        copy.instructions = this.instructions;
+        copy.points = this.points;
+        copy.shared = this.shared = true;
 
         if (this.bounds != null) {
             copy.bounds = (Rectangle2D) this.bounds.clone();
@@ -128,6 +128,18 @@ public final class GeoPathModel implements Serializable, Cloneable {
 
     }
 
+    /**
+     * Makes sure this.points is not shared with a clone before the points are
+     * changed in place. Methods adding or removing points replace the arrays
+     * and do not need to call this.
+     */
+    private void unshare() {
+        if (this.shared) {
+            this.points = this.points.clone();
+            this.shared = false;
+        }
+    }
+
     /**
      * Adds the passed drawing instruction to this.instructions. This method does
      * not alter any other variable of this object.
@@ -291,6 +303,52 @@ public final class GeoPathModel implements Serializable, Cloneable {
         append(pathIterator);
     }
 
+    /**
+     * Replaces the current geometry by a series of sub-paths consisting of
+     * straight lines. This is considerably faster than adding points one by
+     * one with moveTo and lineTo. The passed points array is not copied.
+     * @param points The x and y coordinates of all sub-paths: x1, y1, x2, y2, etc.
+     * @param firstPoints The index of the first point (not coordinate) of
+     * each sub-path. A sub-path ends where the next one starts. The last
+     * sub-path ends with the last point. Each sub-path must have at least
+     * one point.
+     * @param closed If true, each sub-path is closed.
+     */
+    public void setStraightLines(double[] points, int[] firstPoints, boolean closed) {
+        final int pointsCount = points.length / 2;
+        final int subPathsCount = firstPoints.length;
+        final byte[] newInstructions =
+                new byte[pointsCount + (closed ? subPathsCount : 0)];
+        int instructionID = 0;
+        for (int s = 0; s < subPathsCount; s++) {
+            final int first = firstPoints[s];
+            final int end = s + 1 < subPathsCount ? firstPoints[s + 1] : pointsCount;
+            newInstructions[instructionID++] = MOVETO;
+            for (int i = first + 1; i < end; i++) {
+                newInstructions[instructionID++] = LINETO;
+            }
+            if (closed) {
+                newInstructions[instructionID++] = CLOSE;
+            }
+        }
+        this.points = points;
+        this.instructions = newInstructions;
+        this.shared = false;
+        updateBounds();
+    }
+
+    /**
+     * Replaces the current geometry. The passed arrays are not copied.
+     * @param points The x and y coordinates of all points.
+     * @param instructions The drawing instructions.
+     */
+    void setPointsAndInstructions(double[] points, byte[] instructions) {
+        this.points = points;
+        this.instructions = instructions;
+        this.shared = false;
+        updateBounds();
+    }
+
     /**
      * Append a move-to command to the current path. Places the virtual pen at
      * the specified location without drawing any line.
@@ -628,6 +686,7 @@ public final class GeoPathModel implements Serializable, Cloneable {
             bounds = null;
             return;
         }
+        unshare();
 
         for (int i = 0; i < pointsCount; i++) {
             final double x = points[2 * i];
@@ -644,6 +703,7 @@ public final class GeoPathModel implements Serializable, Cloneable {
      * @param affineTransform The transformation to apply.
      */
     public void transform(AffineTransform affineTransform) {
+        unshare();
         affineTransform.transform(points, 0, points, 0, points.length / 2);
         updateBounds();
     }
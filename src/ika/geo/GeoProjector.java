@@ -8,6 +8,7 @@ package ika.geo;
 
 import com.jhlabs.map.proj.ProjectionException;
 import ika.gui.ProgressIndicator;
+import ika.utils.Instrumentation;
 import com.jhlabs.map.proj.Projection;
 import java.awt.geom.Point2D;
 
@@ -56,6 +57,12 @@ public class GeoProjector {
      * @param geoSet
      */
     public void project(GeoSet geoSet) {
+        final long t = Instrumentation.start();
+        this.projectGeoSet(geoSet);
+        Instrumentation.stop("GeoProjector.project", t);
+    }
+
+    private void projectGeoSet(GeoSet geoSet) {
 
         MapEventTrigger trigger = new MapEventTrigger(geoSet);
         try {
@@ -76,9 +83,10 @@ public class GeoProjector {
                 } else if (geoObject instanceof GeoPoint) {
                     this.project((GeoPoint) geoObject);
                 } else if (geoObject instanceof GeoSet) {
-                    this.project((GeoSet) geoObject);
+                    this.projectGeoSet((GeoSet) geoObject);
                 }
             }
+            Instrumentation.count("GeoProjector.features", featureCount);
         } finally {
             trigger.inform();
         }
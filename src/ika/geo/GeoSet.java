@@ -23,6 +23,24 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
     private java.util.Vector vector = new java.util.Vector();
     private boolean grouped = false;
 
+    /**
+     * The minimum number of children for which a spatial index is built.
+     */
+    private static final int MIN_CHILDREN_FOR_SPATIAL_INDEX = 64;
+
+    /**
+     * If true, a spatial index over the children accelerates drawing, hit
+     * detection and selection with a rectangle.
+     */
+    private boolean spatialIndexEnabled = false;
+
+    /**
+     * The spatial index over the children. It is built when first needed and
+     * discarded when the children change. It is volatile, because it can be
+     * discarded without locking this GeoSet.
+     */
+    private transient volatile SpatialIndex spatialIndex;
+
     /**
      * Creates a new instance of GeoSet
      */
@@ -51,6 +69,7 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
 
             // clone all children in this GeoSet and add them to the copy
             copy.vector = new Vector(this.vector.size());
+            copy.spatialIndex = null;
             final int nbrChildren = this.getNumberOfChildren();
             for (int i = 0; i < nbrChildren; i++) {
                 GeoObject geoObject = this.getGeoObject(i);
@@ -148,6 +167,16 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
         vector.add(index, geoObject);
         geoObject.setParent(this);
 
+        // appended children are registered with the index, which is rebuilt
+        // when too many children are not in its tree
+        final SpatialIndex currentIndex = this.spatialIndex;
+        if (currentIndex != null) {
+            if (index != this.vector.size() - 1
+                    || !currentIndex.appendChild(index)) {
+                this.spatialIndex = null;
+            }
+        }
+
         MapEventTrigger.inform(MapEvent.structureChange(), this);
     }
 
@@ -251,6 +280,7 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
                 }
             }
             vector.clear();
+            this.spatialIndex = null;
         } finally {
             trigger.inform(new MapEvent(true, hasSelected, true));
         }
@@ -266,6 +296,7 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
         }
         vector.remove(index);
         geoObject.setParent(null);
+        this.spatialIndex = null;
         MapEventTrigger.inform(new MapEvent(true, geoObject.isSelected(), false), this);
     }
 
@@ -282,6 +313,7 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
         }
         vector.remove(index);
         geoObject.setParent(null);
+        this.spatialIndex = null;
         MapEventTrigger.inform(new MapEvent(true, geoObject.isSelected(), false), this);
         return geoObject;
     }
@@ -302,6 +334,7 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
                 if (geoObject.isSelected()) {
                     vector.remove(i);
                     geoObject.setParent(null);
+                    this.spatialIndex = null;
                     if (geoObject instanceof GeoSet) {
                         final GeoSet geoSet = (GeoSet) geoObject;
                     }
@@ -340,6 +373,7 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
                 if (name.equals(geoObject.getName())) {
                     vector.remove(i);
                     geoObject.setParent(null);
+                    this.spatialIndex = null;
                     removedObject = true;
                 } else {
                     if (geoObject instanceof GeoSet) {
@@ -379,6 +413,29 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
             return null;
         }
 
+        // the bounding box of the paths in the tree of the spatial index is
+        // known, only the remaining children have to be visited.
+        final SpatialIndex index = onlyVisible || onlySelected
+                ? null : this.getSpatialIndex();
+        if (index != null) {
+            Rectangle2D rect = index.getTreeBounds();
+            final int[] extraChildren = index.getExtraChildren();
+            for (int i = 0; i < extraChildren.length; i++) {
+                final GeoObject geoObject = (GeoObject) this.vector.get(extraChildren[i]);
+                final Rectangle2D objBounds = geoObject.getBounds2D(scale, false, false);
+                if (objBounds == null
+                        || !ika.utils.GeometryUtils.isRectangleValid(objBounds)) {
+                    continue;
+                }
+                if (rect == null) {
+                    rect = (Rectangle2D) objBounds.clone();
+                } else {
+                    Rectangle2D.union(rect, objBounds, rect);
+                }
+            }
+            return rect;
+        }
+
         // search through children for first object with valid bounding box
         Rectangle2D rect = null;
         java.util.Iterator iterator = this.vector.iterator();
@@ -438,6 +495,20 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
             boolean onlySelectable,
             boolean onlyVisible) {
 
+        final int[] candidates = this.getCandidates(point, tolDist);
+        if (candidates != null) {
+            for (int i = candidates.length - 1; i >= 0; i--) {
+                final GeoObject geoObject = (GeoObject) vector.get(candidates[i]);
+                final GeoObject geoObjectAtPosition =
+                        geoObject.getObjectAtPosition(point, tolDist, scale,
+                        onlySelectable, onlyVisible);
+                if (geoObjectAtPosition != null) {
+                    return geoObjectAtPosition;
+                }
+            }
+            return null;
+        }
+
         // search in inverse order
         for (int i = vector.size() - 1; i >= 0; i--) {
             final GeoObject geoObject = (GeoObject) vector.get(i);
@@ -479,7 +550,11 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
         boolean selectionChanged = false;
 
         boolean objectHit = false;
-        for (int i = this.vector.size() - 1; i >= 0; i--) {
+        final int[] candidates = this.getCandidates(point, tolDist);
+        final int nbrCandidates = candidates != null
+                ? candidates.length : this.vector.size();
+        for (int j = nbrCandidates - 1; j >= 0; j--) {
+            final int i = candidates != null ? candidates[j] : j;
             final GeoObject geoObject = (GeoObject) this.vector.get(i);
             if (!geoObject.isVisible()) {
                 continue;
@@ -549,10 +624,17 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
         boolean selectionChanged = false;
         MapEventTrigger trigger = new MapEventTrigger(this);
         try {
+            final SpatialIndex index = this.getSpatialIndex();
+            final int[] candidates = index == null ? null
+                    : index.query(rect.getMinX(), rect.getMinY(),
+                    rect.getMaxX(), rect.getMaxY());
             if (this.grouped) {
                 // this is a group, test if rectangle hits any child.
                 boolean objectHit = false;
-                for (int i = this.vector.size() - 1; i >= 0; i--) {
+                final int nbrCandidates = candidates != null
+                        ? candidates.length : this.vector.size();
+                for (int j = nbrCandidates - 1; j >= 0; j--) {
+                    final int i = candidates != null ? candidates[j] : j;
                     final GeoObject geoObject = (GeoObject) this.vector.get(i);
                     objectHit = geoObject.isIntersectedByRectangle(rect, scale);
                     if (objectHit) {
@@ -577,6 +659,22 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
 
                 this.setSelected(select);
 
+            } else if (candidates != null) {
+                // paths that are not candidates cannot intersect the
+                // rectangle, but may have to be deselected.
+                int c = 0;
+                final int nbrChildren = this.vector.size();
+                for (int i = 0; i < nbrChildren; i++) {
+                    final GeoObject geoObject = (GeoObject) this.vector.get(i);
+                    if (c < candidates.length && candidates[c] == i) {
+                        ++c;
+                        selectionChanged |= geoObject.selectByRectangle(rect, scale, extendSelection);
+                    } else if (!extendSelection && geoObject.isSelectable()
+                            && geoObject.isSelected()) {
+                        geoObject.setSelected(false);
+                        selectionChanged = true;
+                    }
+                }
             } else {
                 java.util.Iterator iterator = this.vector.iterator();
                 while (iterator.hasNext()) {
@@ -797,7 +895,18 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
     }
 
     public synchronized void drawNormalState(RenderParams rp) {
-        if (this.isVisible()) {
+        if (!this.isVisible()) {
+            return;
+        }
+        final int[] candidates = this.getVisibleCandidates(rp);
+        if (candidates != null) {
+            for (int i = 0; i < candidates.length; i++) {
+                final GeoObject geoObject = (GeoObject) vector.get(candidates[i]);
+                if (geoObject.isVisible()) {
+                    geoObject.drawNormalState(rp);
+                }
+            }
+        } else {
             final java.util.Iterator iterator = vector.iterator();
             while (iterator.hasNext()) {
                 final GeoObject geoObject = (GeoObject) iterator.next();
@@ -809,7 +918,18 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
     }
 
     public synchronized void drawSelectedState(RenderParams rp) {
-        if (this.isVisible()) {
+        if (!this.isVisible()) {
+            return;
+        }
+        final int[] candidates = this.getVisibleCandidates(rp);
+        if (candidates != null) {
+            for (int i = 0; i < candidates.length; i++) {
+                final GeoObject geoObject = (GeoObject) vector.get(candidates[i]);
+                if (geoObject.isVisible()) {
+                    geoObject.drawSelectedState(rp);
+                }
+            }
+        } else {
             final java.util.Iterator iterator = this.vector.iterator();
             while (iterator.hasNext()) {
                 final GeoObject geoObject = (GeoObject) iterator.next();
@@ -1072,6 +1192,7 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
                 geoObject.move(dx, dy);
             }
         } finally {
+            this.spatialIndex = null;
             trigger.inform();
         }
     }
@@ -1085,6 +1206,7 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
                 geoObject.rotate(rotRad);
             }
         } finally {
+            this.spatialIndex = null;
             trigger.inform();
         }
     }
@@ -1098,6 +1220,7 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
                 geoObject.transform(affineTransform);
             }
         } finally {
+            this.spatialIndex = null;
             trigger.inform();
         }
     }
@@ -1118,6 +1241,7 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
             return transformedChild;
         } finally {
             if (transformedChild) {
+                this.spatialIndex = null;
                 trigger.inform();
             } else {
                 trigger.abort();
@@ -1143,6 +1267,7 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
             return movedChild;
         } finally {
             if (movedChild) {
+                this.spatialIndex = null;
                 trigger.inform();
             } else {
                 trigger.abort();
@@ -1163,6 +1288,7 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
             }
             return foundSelected;
         } finally {
+            this.spatialIndex = null;
             trigger.inform();
         }
     }
@@ -1187,6 +1313,7 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
                 geoObject.scale(hScale, vScale);
             }
         } finally {
+            this.spatialIndex = null;
             trigger.inform();
         }
     }
@@ -1213,6 +1340,7 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
             return scaledChild;
         } finally {
             if (scaledChild) {
+                this.spatialIndex = null;
                 trigger.inform();
             } else {
                 trigger.abort();
@@ -1268,4 +1396,94 @@ public class GeoSet extends GeoObject implements Serializable, Cloneable {
     public synchronized ArrayList toArrayList() {
         return new ArrayList(this.vector);
     }
+
+    public synchronized boolean isSpatialIndexEnabled() {
+        return spatialIndexEnabled;
+    }
+
+    /**
+     * Enables or disables the spatial index over the children of this GeoSet.
+     * The index is only built for GeoSets with many children and is useful
+     * for large layers, such as imported Shape files. The index is updated
+     * when children are added, removed or transformed through this GeoSet or
+     * when a child GeoPath sends a MapEvent. Paths that are changed without
+     * generating a MapEvent require a call to invalidateSpatialIndex().
+     * @param spatialIndexEnabled If true, the index is used.
+     */
+    public synchronized void setSpatialIndexEnabled(boolean spatialIndexEnabled) {
+        this.spatialIndexEnabled = spatialIndexEnabled;
+        this.spatialIndex = null;
+    }
+
+    /**
+     * Discards the spatial index. It will be rebuilt when it is needed next.
+     * This does not lock this GeoSet.
+     */
+    public void invalidateSpatialIndex() {
+        this.spatialIndex = null;
+    }
+
+    /**
+     * Discards the spatial index of the parent of a GeoPath whose geometry
+     * changed.
+     */
+    static void childGeometryChanged(GeoObject geoObject) {
+        if (geoObject instanceof GeoPath) {
+            final GeoSet parent = geoObject.getParent();
+            if (parent != null) {
+                parent.invalidateSpatialIndex();
+            }
+        }
+    }
+
+    /**
+     * Returns the spatial index, which is built if necessary.
+     * @return The index or null if no index is used for this GeoSet.
+     */
+    private SpatialIndex getSpatialIndex() {
+        if (!this.spatialIndexEnabled
+                || this.vector.size() < MIN_CHILDREN_FOR_SPATIAL_INDEX) {
+            return null;
+        }
+        SpatialIndex index = this.spatialIndex;
+        if (index == null) {
+            index = new SpatialIndex(this.vector);
+            this.spatialIndex = index;
+        }
+        return index;
+    }
+
+    /**
+     * Returns the positions of the children that may be hit by a point.
+     * @return The positions in ascending order or null if all children must
+     * be tested.
+     */
+    private int[] getCandidates(Point2D point, double tolDist) {
+        final SpatialIndex index = this.getSpatialIndex();
+        if (index == null || point == null) {
+            return null;
+        }
+        final double d = Math.abs(tolDist);
+        return index.query(point.getX() - d, point.getY() - d,
+                point.getX() + d, point.getY() + d);
+    }
+
+    /**
+     * Returns the positions of the children that may be visible in the area
+     * to draw.
+     * @return The positions in ascending order or null if all children must
+     * be drawn.
+     */
+    private int[] getVisibleCandidates(RenderParams rp) {
+        final SpatialIndex index = this.getSpatialIndex();
+        if (index == null || rp.selectedTransform != null
+                || !(rp.scale > 0) || !(rp.visWidth > 0) || !(rp.visHeight > 0)
+                || Double.isInfinite(rp.visWidth) || Double.isInfinite(rp.visHeight)) {
+            return null;
+        }
+        final double margin = index.getStrokeMargin(rp.scale);
+        final double visBottom = rp.visTop - rp.visHeight;
+        return index.query(rp.visLeft - margin, visBottom - margin,
+                rp.visLeft + rp.visWidth + margin, rp.visTop + margin);
+    }
 }
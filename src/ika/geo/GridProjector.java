@@ -60,6 +60,56 @@ public class GridProjector extends RasterProjector {
         gridProjectorTask.execute();
     }
 
+    /**
+     * Projects a row of the destination grid. Every cell is projected
+     * inversely to longitude/latitude, where the value of the source grid is
+     * interpolated. Also used by ika.app.Benchmark.
+     * @param grid The source grid in geographic coordinates.
+     * @param projection The projection of the destination grid, must be
+     * initialized.
+     * @param y The vertical coordinate of the row, scaled to the unary sphere.
+     * @param projWest The horizontal coordinate of the first column.
+     * @param projCellSize The size of a cell in the destination grid.
+     * @param bicubic If true, bicubic interpolation is used, otherwise nearest
+     * neighbor resampling.
+     * @param values Receives the values of the row. Cells outside of the
+     * graticule are NaN.
+     */
+    public static void projectRow(GeoGrid grid, Projection projection,
+            double y, double projWest, double projCellSize, boolean bicubic,
+            float[] values) {
+
+        final double earthRadius = projection.getEquatorRadius();
+        final double lon0 = projection.getProjectionLongitude();
+        Point2D.Double pt = new Point2D.Double();
+        for (int c = 0; c < values.length; c++) {
+            final double x = (projWest + c * projCellSize) / earthRadius;
+
+            // don't use inverseTransformRadians here. The lon/lat values
+            // have to be checked after the inverse projection to make
+            // sure they fall in [-PI..+PI] for the longitude, and
+            // [-PI/2..+PI/2] for the latitude.
+            projection.projectInverse(x, y, pt);
+            if (Double.isNaN(pt.x) || Double.isNaN(pt.y)
+                    || pt.x < -Math.PI || pt.x > Math.PI
+                    || pt.y < -Math.PI / 2 || pt.y > Math.PI / 2) {
+                values[c] = Float.NaN;
+                continue;
+            }
+
+            if (lon0 != 0)
+                pt.x = MapMath.normalizeLongitude(pt.x+lon0);
+
+            pt.x = Math.toDegrees(pt.x);
+            pt.y = Math.toDegrees(pt.y);
+
+            if (bicubic)
+                values[c] = grid.getBicubicInterpol(pt.x, pt.y);
+            else
+                values[c] = grid.getNearestNeighbor(pt.x, pt.y);
+        }
+    }
+
     class GridProjectorTask extends SwingWorkerWithProgressIndicator <Object> {
 
         public GridProjectorTask(Frame owner,
@@ -141,8 +191,9 @@ public class GridProjector extends RasterProjector {
                         projWest, projNorth - projHeight, projCellSize, noDataValue);
                 
                 final double earthRadius = projection.getEquatorRadius();
-                final double lon0 = projection.getProjectionLongitude();
-                Point2D.Double pt = new Point2D.Double();
+                final boolean bicubic = interpolationMethod ==
+                        FlexProjectorPreferencesPanel.INTERPOLATION_BICUBIC;
+                float[] values = new float[projCols];
                 for (int r = 0; r < projRows; r++) {
                     
                     if (!this.progress((int)((double)r / projRows * 100))) {
@@ -152,34 +203,13 @@ public class GridProjector extends RasterProjector {
                     }
                     
                     final double y = (projNorth - r * projCellSize) / earthRadius;
+                    projectRow(grid, projection, y, projWest, projCellSize,
+                            bicubic, values);
                     for (int c = 0; c < projCols; c++) {
-                        final double x = (projWest + c * projCellSize) / earthRadius;
-                        
-                        // don't use inverseTransformRadians here. The lon/lat values
-                        // have to be checked after the inverse projection to make
-                        // sure they fall in [-PI..+PI] for the longitude, and
-                        // [-PI/2..+PI/2] for the latitude.
-                        projection.projectInverse(x, y, pt);
-                        if (Double.isNaN(pt.x) || Double.isNaN(pt.y)
-                                || pt.x < -Math.PI || pt.x > Math.PI
-                                || pt.y < -Math.PI / 2 || pt.y > Math.PI / 2) {
+                        if (Float.isNaN(values[c]))
                             gridWriter.writeNoData();
-                            continue;
-                        }
-                        
-                        if (lon0 != 0)
-                            pt.x = MapMath.normalizeLongitude(pt.x+lon0);
-                        
-                        pt.x = Math.toDegrees(pt.x);
-                        pt.y = Math.toDegrees(pt.y);
-                        
-                        final float v;
-                        if (interpolationMethod ==
-                                FlexProjectorPreferencesPanel.INTERPOLATION_BICUBIC)
-                            v = grid.getBicubicInterpol(pt.x, pt.y);
                         else
-                            v = grid.getNearestNeighbor(pt.x, pt.y);
-                        gridWriter.write(v);
+                            gridWriter.write(values[c]);
                     }
                     gridWriter.newLine();
                 }
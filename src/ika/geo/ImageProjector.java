@@ -93,10 +93,69 @@ public class ImageProjector extends RasterProjector {
         imageProjectorTask.setTotalTasksCount(2);
         imageProjectorTask.execute();
     }
+
+    /**
+     * Projects a row of the destination image. Every pixel is projected
+     * inversely to longitude/latitude with the destination projection, then
+     * forward to the source image with the source projection, where the color
+     * is interpolated. Also used by ika.app.Benchmark.
+     * @param image The source image.
+     * @param srcProj The projection of the source image, must be initialized.
+     * @param destProj The projection of the destination image, must be
+     * initialized.
+     * @param dstY The vertical coordinate of the row in the destination
+     * projection, scaled to the unary sphere.
+     * @param projWest The horizontal coordinate of the first column.
+     * @param projCellSize The size of a cell in the destination image.
+     * @param nearestNeighbor If true, nearest neighbor resampling is used,
+     * otherwise bicubic interpolation.
+     * @param argb Receives the premultiplied argb colors of the row. Pixels
+     * outside of the graticule are 0.
+     */
+    public static void projectRow(GeoImage image, Projection srcProj,
+            Projection destProj, double dstY, double projWest,
+            double projCellSize, boolean nearestNeighbor, int[] argb) {
+
+        final double earthRadius = destProj.getEquatorRadius();
+        final double lon0 = destProj.getProjectionLongitude();
+        Point2D.Double lonlat = new Point2D.Double();
+        Point2D.Double srcXY = new Point2D.Double();
+        for (int col = 0; col < argb.length; col++) {
+            final double dstX = (projWest + col * projCellSize) / earthRadius;
+
+            // inverse projection from projected destination grid
+            // to intermediat longitude/latitude graticule
+
+            // don't use inverseTransformRadians here. The lon/lat values
+            // have to be checked after the inverse projection to make
+            // sure they fall in [-PI..+PI] for the longitude, and
+            // [-PI/2..+PI/2] for the latitude.
+            destProj.projectInverse(dstX, dstY, lonlat);
+            if (Double.isNaN(lonlat.x) || Double.isNaN(lonlat.y)
+                    || lonlat.x < -Math.PI || lonlat.x > Math.PI
+                    || lonlat.y < -Math.PI / 2 || lonlat.y > Math.PI / 2) {
+                argb[col] = 0;
+                continue;
+            }
+            if (lon0 != 0) {
+                lonlat.x = MapMath.normalizeLongitude(lonlat.x + lon0);
+            }
+
+            // forward projection from longitude/latitude graticule
+            // to projected source image
+            srcProj.project(lonlat.x, lonlat.y, srcXY);
+            srcXY.x *= earthRadius;
+            srcXY.y *= earthRadius;
+
+            if (nearestNeighbor) {
+                argb[col] = image.getNearestNeighbor(srcXY.x, srcXY.y);
+            } else {
+                argb[col] = image.getBicubicInterpol(srcXY.x, srcXY.y);
+            }
+        }
+    }
     
     class ImageProjectorTask extends SwingWorkerWithProgressIndicator {
-        
-        private final double HALFPI = Math.PI / 2.;
 
         public ImageProjectorTask(Frame owner,
                 String dialogTitle,
@@ -202,9 +261,7 @@ public class ImageProjector extends RasterProjector {
                 ImageWriter writer = new TIFFImageWriter(out, projCols, projRows);
                 
                 final double earthRadius = destProj.getEquatorRadius();
-                final double lon0 = destProj.getProjectionLongitude();
-                Point2D.Double lonlat = new Point2D.Double();
-                Point2D.Double srcXY = new Point2D.Double();
+                int[] argb = new int[projCols];
 
                 for (int row = 0; row < projRows; row++) {
                     
@@ -215,41 +272,10 @@ public class ImageProjector extends RasterProjector {
                     this.progress((int)((double)row / projRows * 100));
                     
                     final double dstY = (projNorth - row * projCellSize) / earthRadius;
+                    projectRow(image, srcProj, destProj, dstY, projWest,
+                            projCellSize, nearestNeighbor, argb);
                     for (int col = 0; col < projCols; col++) {
-                        final double dstX = (projWest + col * projCellSize) / earthRadius;
-
-                        // inverse projection from projected destination grid
-                        // to intermediat longitude/latitude graticule
-
-                        // don't use inverseTransformRadians here. The lon/lat values
-                        // have to be checked after the inverse projection to make
-                        // sure they fall in [-PI..+PI] for the longitude, and
-                        // [-PI/2..+PI/2] for the latitude.
-                        destProj.projectInverse(dstX, dstY, lonlat);
-                        if (Double.isNaN(lonlat.x) || Double.isNaN(lonlat.y)
-                                || lonlat.x < -Math.PI || lonlat.x > Math.PI
-                                || lonlat.y < -HALFPI || lonlat.y > HALFPI) {
-                            writer.write(0, 0, 0, 0);
-                            continue;
-                        }
-                        if (lon0 != 0) {
-                            lonlat.x = MapMath.normalizeLongitude(lonlat.x+lon0);
-                        }
-                        
-                        // forward projection from longitude/latitude graticule
-                        // to projected source image
-                        srcProj.project(lonlat.x, lonlat.y, srcXY);
-                        srcXY.x *= earthRadius;
-                        srcXY.y *= earthRadius;
-                       
-                        final int color;
-                        if (nearestNeighbor) {
-                            color = image.getNearestNeighbor(srcXY.x, srcXY.y);
-                        } else {
-                            color = image.getBicubicInterpol(srcXY.x, srcXY.y);
-                        }
-
-                        writer.write(color);
+                        writer.write(argb[col]);
                     }
                 }
                 
@@ -30,7 +30,8 @@ public class LineProjector extends FeatureProjector {
             return;
         }
         
-        GeoPathModel projPath = new GeoPathModel();
+        GeoPathBuffer projPath = this.pathBuffer;
+        projPath.reset();
         GeoPathIterator iterator = geoPath.getIterator();
         
         prevPointOutOfRange = false;
@@ -71,7 +72,7 @@ public class LineProjector extends FeatureProjector {
             projPath.removeLastInstruction();
         }
         
-        geoPath.setPathModel(projPath);
+        geoPath.setPathModel(projPath.toPathModel());
 
     }
     
@@ -90,7 +91,7 @@ public class LineProjector extends FeatureProjector {
      */
     private void projectLineTo(double lonEnd, double latEnd,
             double lonStart, double latStart,
-            GeoPathModel projPath) {
+            GeoPathBuffer projPath) {
 
         // test if the point is outside of lon0 +/- 180deg
         final double lon0 = projection.getProjectionLongitudeDegrees();
@@ -117,7 +118,7 @@ public class LineProjector extends FeatureProjector {
     }
 
     @Override
-     protected void projectMoveTo(double x, double y, GeoPathModel projPath) {
+     protected void projectMoveTo(double x, double y, GeoPathBuffer projPath) {
 
         // test if the point is outside of lon0 +/- 180deg
         final double lon0 = projection.getProjectionLongitudeDegrees();
@@ -153,7 +154,7 @@ public class LineProjector extends FeatureProjector {
      */
     private void projectIntersectingLineTo(double lonEnd, double latEnd,
             double lonStart, double latStart,
-            GeoPathModel projPath) {
+            GeoPathBuffer projPath) {
 
         final double dLon = lonEnd - lonStart;
         final double dLat = latEnd - latStart;
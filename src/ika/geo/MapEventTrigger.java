@@ -46,6 +46,11 @@ public class MapEventTrigger {
      */
     private transient GeoSetBroadcaster root;
     
+    /**
+     * The GeoObject passed to the constructor.
+     */
+    private transient GeoObject geoObject;
+    
     /**
      * Creates a new instance of MapEventTrigger
      * @param geoObject Any object in the tree of geo objects.
@@ -53,6 +58,7 @@ public class MapEventTrigger {
     public MapEventTrigger(GeoObject geoObject) {
         if (geoObject == null)
             throw new IllegalArgumentException();
+        this.geoObject = geoObject;
         this.root = geoObject.getRoot();
         if (this.root != null) {
             this.eventsSuspendedInitially = this.root.mapEventListenersSuspended();
@@ -86,6 +92,9 @@ public class MapEventTrigger {
      * @param evt The MapEvent that is sent to all registered listeners.
      */
     public void inform(MapEvent evt) {
+        if (!evt.isSelectionChanged() && !evt.isVisibilityChanged()) {
+            GeoSet.childGeometryChanged(this.geoObject);
+        }
         if (this.root != null && this.eventsSuspendedInitially == false) {
             this.root.activateMapEventListeners();
             this.root.informMapEventListeners(evt);
@@ -108,6 +117,9 @@ public class MapEventTrigger {
      * the GeoObject that changed, but this is not required.
      */
     static public void inform(MapEvent evt, GeoObject geoObject) {
+        if (!evt.isSelectionChanged() && !evt.isVisibilityChanged()) {
+            GeoSet.childGeometryChanged(geoObject);
+        }
         final GeoSetBroadcaster root = geoObject.getRoot();
         if (root != null)
             root.informMapEventListeners(evt);
@@ -32,7 +32,8 @@ public class PolygonProjector extends FeatureProjector {
         double latMin = projection.getMinLatitudeDegrees();
         Rectangle2D bounds = new Rectangle2D.Double(lonMin, latMin, 360, -latMin + latMax);
 
-        GeoPathModel projPath = new GeoPathModel();
+        GeoPathBuffer projPath = this.pathBuffer;
+        projPath.reset();
         Area maskArea = rectToIntersectingArea(geoPath, bounds);
         if (maskArea == null) {
             projectArea(geoPath, projPath, false, latMin, latMax);
@@ -40,7 +41,7 @@ public class PolygonProjector extends FeatureProjector {
             projectArea(cutInner(geoPath, maskArea, lon0), projPath, false, latMin, latMax);
             projectArea(cutOutter(geoPath, maskArea, lon0), projPath, true, latMin, latMax);
         }
-        geoPath.setPathModel(projPath);
+        geoPath.setPathModel(projPath.toPathModel());
         
     }
 
@@ -108,7 +109,7 @@ public class PolygonProjector extends FeatureProjector {
      * @param outOfGraticule True if the area is outside the boundaries of the
      * graticule, false otherwise.
      */
-    private void projectArea(GeoPath srcPath, GeoPathModel dstPath,
+    private void projectArea(GeoPath srcPath, GeoPathBuffer dstPath,
             boolean outOfGraticule, double latMin, double latMax) {
 
         if (srcPath == null || dstPath == null) {
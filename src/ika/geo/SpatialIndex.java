@@ -0,0 +1,328 @@
+/*
+ * SpatialIndex.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+
+package ika.geo;
+
+import java.awt.geom.Rectangle2D;
+import java.util.Arrays;
+import java.util.List;
+
+/**
+ * A packed Hilbert R-tree over the children of a GeoSet. Only GeoPaths are
+ * stored in the tree, as their bounding boxes do not depend on the map scale.
+ * All other children, and children appended after the tree was built, are
+ * kept in a short list and are returned by every query. Queries return the
+ * positions of the children in the GeoSet in ascending order, so that the
+ * drawing order is retained.<br>
+ * The index does not observe the children. The owning GeoSet discards it
+ * when children are removed, reordered or transformed.
+ */
+final class SpatialIndex {
+
+    /**
+     * Number of entries in a node of the tree.
+     */
+    private static final int NODE_SIZE = 16;
+
+    /**
+     * Resolution of the grid used to compute Hilbert values.
+     */
+    private static final int HILBERT_MAX = (1 << 16) - 1;
+
+    /**
+     * Bounding boxes of all nodes: minX, minY, maxX, maxY. Leaves come first,
+     * followed by the levels of inner nodes. The root is the last node.
+     */
+    private final double[] boxes;
+
+    /**
+     * For leaves the position of the child in the GeoSet; for inner nodes the
+     * position of the first child node.
+     */
+    private final int[] nodeIndices;
+
+    /**
+     * The end position of each level of the tree in nodes.
+     */
+    private final int[] levelBounds;
+
+    /**
+     * The number of GeoPaths in the tree.
+     */
+    private final int nbrItems;
+
+    /**
+     * Positions of children that are not in the tree, in ascending order.
+     */
+    private int[] extraChildren;
+
+    private int nbrExtraChildren;
+
+    /**
+     * The maximum stroke width of GeoPaths in the tree in world coordinates.
+     */
+    private double maxStrokeWidth = 0;
+
+    /**
+     * The maximum stroke width of GeoPaths in the tree with scale-invariant
+     * symbols, in pixels.
+     */
+    private double maxScaleInvariantStrokeWidth = 0;
+
+    /**
+     * Builds an index for the children of a GeoSet.
+     * @param children The GeoObjects of the GeoSet.
+     */
+    SpatialIndex(List children) {
+        final int nbrChildren = children.size();
+        double[] itemBoxes = new double[nbrChildren * 4];
+        int[] itemPositions = new int[nbrChildren];
+        int n = 0;
+        this.extraChildren = new int[16];
+        double minX = Double.POSITIVE_INFINITY;
+        double minY = Double.POSITIVE_INFINITY;
+        double maxX = Double.NEGATIVE_INFINITY;
+        double maxY = Double.NEGATIVE_INFINITY;
+        for (int i = 0; i < nbrChildren; i++) {
+            final Object obj = children.get(i);
+            Rectangle2D bounds = null;
+            if (obj instanceof GeoPath) {
+                bounds = ((GeoPath) obj).getBounds2D(GeoObject.UNDEFINED_SCALE);
+            }
+            if (bounds == null || !ika.utils.GeometryUtils.isRectangleValid(bounds)) {
+                this.appendExtraChild(i);
+                continue;
+            }
+            itemBoxes[n * 4] = bounds.getMinX();
+            itemBoxes[n * 4 + 1] = bounds.getMinY();
+            itemBoxes[n * 4 + 2] = bounds.getMaxX();
+            itemBoxes[n * 4 + 3] = bounds.getMaxY();
+            itemPositions[n++] = i;
+            minX = Math.min(minX, bounds.getMinX());
+            minY = Math.min(minY, bounds.getMinY());
+            maxX = Math.max(maxX, bounds.getMaxX());
+            maxY = Math.max(maxY, bounds.getMaxY());
+
+            VectorSymbol symbol = ((GeoPath) obj).getVectorSymbol();
+            if (symbol == null || !symbol.isStroked()) {
+                continue;
+            }
+            if (symbol.isScaleInvariant()) {
+                maxScaleInvariantStrokeWidth = Math.max(
+                        maxScaleInvariantStrokeWidth, symbol.getStrokeWidth());
+            } else {
+                maxStrokeWidth = Math.max(maxStrokeWidth, symbol.getStrokeWidth());
+            }
+        }
+        this.nbrItems = n;
+
+        // compute the number of nodes on each level
+        int[] bounds = new int[32];
+        int nbrLevels = 0;
+        int nbrNodes = n;
+        int levelSize = n;
+        bounds[nbrLevels++] = nbrNodes;
+        if (n > 0) {
+            do {
+                levelSize = (levelSize + NODE_SIZE - 1) / NODE_SIZE;
+                nbrNodes += levelSize;
+                bounds[nbrLevels++] = nbrNodes;
+            } while (levelSize != 1);
+        }
+        this.levelBounds = new int[nbrLevels];
+        System.arraycopy(bounds, 0, this.levelBounds, 0, nbrLevels);
+        this.boxes = new double[nbrNodes * 4];
+        this.nodeIndices = new int[nbrNodes];
+        if (n == 0) {
+            return;
+        }
+
+        // sort the items along a Hilbert curve through their centers. The
+        // Hilbert value is stored in the upper bits, the item in the lower.
+        final double w = maxX - minX;
+        final double h = maxY - minY;
+        long[] keys = new long[n];
+        for (int i = 0; i < n; i++) {
+            final double cx = (itemBoxes[i * 4] + itemBoxes[i * 4 + 2]) / 2;
+            final double cy = (itemBoxes[i * 4 + 1] + itemBoxes[i * 4 + 3]) / 2;
+            final int hx = w > 0 ? (int) (HILBERT_MAX * (cx - minX) / w) : 0;
+            final int hy = h > 0 ? (int) (HILBERT_MAX * (cy - minY) / h) : 0;
+            keys[i] = (hilbert(hx, hy) << 32) | i;
+        }
+        Arrays.sort(keys);
+        for (int i = 0; i < n; i++) {
+            final int item = (int) (keys[i] & 0xffffffffL);
+            System.arraycopy(itemBoxes, item * 4, this.boxes, i * 4, 4);
+            this.nodeIndices[i] = itemPositions[item];
+        }
+
+        // build the inner nodes bottom-up
+        int pos = 0;
+        int parent = n;
+        for (int level = 0; level < nbrLevels - 1; level++) {
+            final int end = this.levelBounds[level];
+            while (pos < end) {
+                double nodeMinX = Double.POSITIVE_INFINITY;
+                double nodeMinY = Double.POSITIVE_INFINITY;
+                double nodeMaxX = Double.NEGATIVE_INFINITY;
+                double nodeMaxY = Double.NEGATIVE_INFINITY;
+                this.nodeIndices[parent] = pos;
+                for (int i = 0; i < NODE_SIZE && pos < end; i++, pos++) {
+                    nodeMinX = Math.min(nodeMinX, this.boxes[pos * 4]);
+                    nodeMinY = Math.min(nodeMinY, this.boxes[pos * 4 + 1]);
+                    nodeMaxX = Math.max(nodeMaxX, this.boxes[pos * 4 + 2]);
+                    nodeMaxY = Math.max(nodeMaxY, this.boxes[pos * 4 + 3]);
+                }
+                this.boxes[parent * 4] = nodeMinX;
+                this.boxes[parent * 4 + 1] = nodeMinY;
+                this.boxes[parent * 4 + 2] = nodeMaxX;
+                this.boxes[parent * 4 + 3] = nodeMaxY;
+                parent++;
+            }
+        }
+    }
+
+    /**
+     * Computes the distance of a point along a Hilbert curve filling a square
+     * grid of 2^16 x 2^16 cells.
+     */
+    private static long hilbert(int x, int y) {
+        long d = 0;
+        for (int s = 1 << 15; s > 0; s >>= 1) {
+            final int rx = (x & s) > 0 ? 1 : 0;
+            final int ry = (y & s) > 0 ? 1 : 0;
+            d += (long) s * s * ((3 * rx) ^ ry);
+            // rotate the quadrant
+            if (ry == 0) {
+                if (rx == 1) {
+                    x = HILBERT_MAX - x;
+                    y = HILBERT_MAX - y;
+                }
+                final int t = x;
+                x = y;
+                y = t;
+            }
+        }
+        return d;
+    }
+
+    private void appendExtraChild(int position) {
+        if (this.nbrExtraChildren == this.extraChildren.length) {
+            int[] a = new int[this.extraChildren.length * 2];
+            System.arraycopy(this.extraChildren, 0, a, 0, this.nbrExtraChildren);
+            this.extraChildren = a;
+        }
+        this.extraChildren[this.nbrExtraChildren++] = position;
+    }
+
+    /**
+     * Registers a child that was appended to the GeoSet after the index was
+     * built. The child is not added to the tree, but returned by all queries.
+     * @param position The position of the new child in the GeoSet. This must
+     * be larger than the position of all other children.
+     * @return False if the index should be rebuilt, because too many
+     * children are not in the tree.
+     */
+    boolean appendChild(int position) {
+        this.appendExtraChild(position);
+        return this.nbrExtraChildren <= Math.max(64, this.nbrItems / 8);
+    }
+
+    /**
+     * Returns the bounding box of all GeoPaths in the tree.
+     * @return The bounding box or null if the tree is empty.
+     */
+    Rectangle2D getTreeBounds() {
+        if (this.nbrItems == 0) {
+            return null;
+        }
+        final int root = this.nodeIndices.length - 1;
+        return new Rectangle2D.Double(this.boxes[root * 4],
+                this.boxes[root * 4 + 1],
+                this.boxes[root * 4 + 2] - this.boxes[root * 4],
+                this.boxes[root * 4 + 3] - this.boxes[root * 4 + 1]);
+    }
+
+    /**
+     * Returns the positions of the children that are not in the tree.
+     * @return The positions in ascending order.
+     */
+    int[] getExtraChildren() {
+        int[] a = new int[this.nbrExtraChildren];
+        System.arraycopy(this.extraChildren, 0, a, 0, this.nbrExtraChildren);
+        return a;
+    }
+
+    /**
+     * Returns the distance in world coordinates by which a query rectangle
+     * must be enlarged to include all paths whose stroke may be visible in
+     * the rectangle.
+     * @param scale The current scale of the map.
+     */
+    double getStrokeMargin(double scale) {
+        return (maxStrokeWidth + maxScaleInvariantStrokeWidth / scale) / 2
+                + 1 / scale;
+    }
+
+    /**
+     * Searches the children whose bounding box intersects a rectangle. The
+     * children not in the tree are always included.
+     * @return The positions of the children in ascending order.
+     */
+    int[] query(double minX, double minY, double maxX, double maxY) {
+        int[] result = new int[64];
+        int nbrResults = 0;
+
+        if (this.nbrItems > 0) {
+            // stack of node positions and levels to visit
+            int[] stack = new int[64];
+            int stackSize = 0;
+            int nodePos = this.nodeIndices.length - 1;
+            int level = this.levelBounds.length - 1;
+            while (true) {
+                final int end = Math.min(nodePos + NODE_SIZE,
+                        this.levelBounds[level]);
+                for (int pos = nodePos; pos < end; pos++) {
+                    if (maxX < this.boxes[pos * 4]
+                            || maxY < this.boxes[pos * 4 + 1]
+                            || minX > this.boxes[pos * 4 + 2]
+                            || minY > this.boxes[pos * 4 + 3]) {
+                        continue;
+                    }
+                    if (nodePos < this.nbrItems) {
+                        if (nbrResults == result.length) {
+                            int[] a = new int[result.length * 2];
+                            System.arraycopy(result, 0, a, 0, nbrResults);
+                            result = a;
+                        }
+                        result[nbrResults++] = this.nodeIndices[pos];
+                    } else {
+                        if (stackSize + 2 > stack.length) {
+                            int[] a = new int[stack.length * 2];
+                            System.arraycopy(stack, 0, a, 0, stackSize);
+                            stack = a;
+                        }
+                        stack[stackSize++] = this.nodeIndices[pos];
+                        stack[stackSize++] = level - 1;
+                    }
+                }
+                if (stackSize == 0) {
+                    break;
+                }
+                level = stack[--stackSize];
+                nodePos = stack[--stackSize];
+            }
+        }
+
+        int[] positions = new int[nbrResults + this.nbrExtraChildren];
+        System.arraycopy(result, 0, positions, 0, nbrResults);
+        System.arraycopy(this.extraChildren, 0, positions, nbrResults,
+                this.nbrExtraChildren);
+        Arrays.sort(positions);
+        return positions;
+    }
+}
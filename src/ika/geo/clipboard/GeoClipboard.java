@@ -24,7 +24,7 @@ public class GeoClipboard {
     }
     
     
-    public static void setClipboard(GeoSet geoSet) {
+    public static void setClipboard(GeoSet geoSet) throws java.io.IOException {
         GeoTransferable geoSelection = new GeoTransferable(geoSet);
         Clipboard clipboard = Toolkit.getDefaultToolkit().getSystemClipboard();
         clipboard.setContents(geoSelection, null);
@@ -74,7 +74,7 @@ public class GeoClipboard {
     }
     
     
-    public static void main(String[] args) {
+    public static void main(String[] args) throws java.io.IOException {
         
         GeoSet geoSet = new GeoSet();
         ika.geo.GeoPath geoPath = new ika.geo.GeoPath();
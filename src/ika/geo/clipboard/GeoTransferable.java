@@ -7,6 +7,7 @@
 
 package ika.geo.clipboard;
 
+import ika.geo.GeoBinaryCodec;
 import ika.geo.GeoSet;
 import ika.geoexport.*;
 import java.awt.Toolkit;
@@ -64,10 +65,42 @@ public class GeoTransferable implements Transferable, ClipboardOwner {
         GEOFLAVOR
     };
     
+    /**
+     * The binary encoded GeoSet. Encoding takes a snapshot, later changes to
+     * the GeoSet passed to the constructor are not reflected.
+     */
+    private byte[] data;
+    
+    /**
+     * The GeoSet decoded from data for exporting to other applications.
+     */
     private GeoSet geoSet;
     
-    public GeoTransferable(GeoSet geoSet) {
-        this.geoSet = geoSet;
+    /**
+     * Creates a new GeoTransferable.
+     * @param geoSet The GeoSet to transfer.
+     * @throws IOException If the GeoSet cannot be encoded.
+     */
+    public GeoTransferable(GeoSet geoSet) throws IOException {
+        this.data = GeoBinaryCodec.encode(geoSet);
+    }
+    
+    /**
+     * Returns a new copy of the transferred GeoSet.
+     */
+    private GeoSet decode() throws IOException {
+        if (this.data == null)
+            return null;
+        return (GeoSet)GeoBinaryCodec.decode(this.data);
+    }
+    
+    /**
+     * Returns a shared copy of the transferred GeoSet for exporters.
+     */
+    private GeoSet getGeoSet() throws IOException {
+        if (this.geoSet == null)
+            this.geoSet = this.decode();
+        return this.geoSet;
     }
     
     /**
@@ -97,7 +130,7 @@ public class GeoTransferable implements Transferable, ClipboardOwner {
         if (DataFlavor.stringFlavor.equals(flavor)) {
             UngenerateExporter exporter = new UngenerateExporter();
             ByteArrayOutputStream outputStream = new java.io.ByteArrayOutputStream();
-            exporter.export(this.geoSet, outputStream);
+            exporter.export(this.getGeoSet(), outputStream);
             return outputStream.toString();
         } else if (DXFFLAVOR.equals(flavor)) {
             return this.exportToFileInputStream(new DXFExporter());
@@ -117,7 +150,7 @@ public class GeoTransferable implements Transferable, ClipboardOwner {
         } else if (WMFFLAVOR.equals(flavor)) {
             return this.exportToFileInputStream(new WMFExporter());
         } else if (GEOFLAVOR.equals(flavor)) {
-            return this.geoSet;
+            return this.decode();
         } else {
             throw new UnsupportedFlavorException(flavor);
         }
@@ -134,7 +167,7 @@ public class GeoTransferable implements Transferable, ClipboardOwner {
         
         java.io.FileOutputStream outputStream = new java.io.FileOutputStream(file);
         try {
-            exporter.export(this.geoSet, outputStream);
+            exporter.export(this.getGeoSet(), outputStream);
         } finally {
             outputStream.close();
         }
@@ -153,12 +186,12 @@ public class GeoTransferable implements Transferable, ClipboardOwner {
     
     /**
      * Put the passed GeoSet onto the system clipboard.
-     * The programmer must make sure that the passed GeoObjects are not altered
-     * after being put into the clipboard. Cloning the referenced objects before
-     * storing them in the clipboard is the solution.
+     * The passed GeoSet is encoded immediately, later changes to it are not
+     * transferred.
      * @param geoSet The GeoSet to share with other applications.
+     * @throws IOException If the GeoSet cannot be encoded.
      */
-    public static void storeInSystemClipboard(GeoSet geoSet) {
+    public static void storeInSystemClipboard(GeoSet geoSet) throws IOException {
         GeoTransferable geoTrans = new GeoTransferable(geoSet);
         Clipboard clipboard = Toolkit.getDefaultToolkit().getSystemClipboard();
         clipboard.setContents(geoTrans, geoTrans);
@@ -170,9 +203,8 @@ public class GeoTransferable implements Transferable, ClipboardOwner {
             Transferable trans = clipboard.getContents(null);
             if (trans != null && 
                     trans.isDataFlavorSupported(GEOFLAVOR)) {
-                    GeoSet geoSet = (GeoSet)trans.getTransferData(GEOFLAVOR);
-                    if (geoSet != null)
-                        return (GeoSet)geoSet.clone();
+                    // every request decodes a new copy
+                    return (GeoSet)trans.getTransferData(GEOFLAVOR);
             }
         } catch (Exception e) {
             e.printStackTrace();
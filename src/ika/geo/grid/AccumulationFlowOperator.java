@@ -8,9 +8,18 @@ package ika.geo.grid;
 
 import ika.geo.GeoGrid;
 import ika.geoimport.EsriASCIIGridReader;
+import java.util.ArrayList;
+import java.util.logging.Level;
+import java.util.logging.Logger;
 
 /**
- *
+ * Computes the flow accumulation of a digital elevation model. The value of a
+ * cell is the number of interior cells that drain through it. Water flows from
+ * a cell to the lowest of its eight neighbors that is lower than the cell.
+ * Flow ends at the border of the grid and in cells without lower neighbors.<br>
+ * The flow direction of each cell is first computed in parallel. The flow is
+ * then accumulated in topological order, starting at cells without inflow,
+ * which visits every cell once.
  * @author Bernhard Jenny, Institute of Cartography, ETH Zurich.
  */
 public class AccumulationFlowOperator implements GridOperator {
@@ -26,10 +35,24 @@ public class AccumulationFlowOperator implements GridOperator {
         }
     }
 
-    private enum FlowDirection {
+    /**
+     * Flow direction of a cell without lower neighbor or on the border.
+     */
+    private static final byte NONE = 0;
+
+    /**
+     * Column and row offsets of the flow directions TOPRIGHT, RIGHT,
+     * BOTTOMRIGHT, BOTTOM, BOTTOMLEFT, LEFT, TOPLEFT and TOP. Direction d is
+     * stored as d + 1. Neighbors are tested in this order and the first of
+     * equally low neighbors is chosen.
+     */
+    private static final int[] DCOL = {1, 1, 1, 0, -1, -1, -1, 0};
+    private static final int[] DROW = {-1, 0, 1, 1, 1, 0, -1, -1};
 
-        NONE, TOPRIGHT, RIGHT, BOTTOMRIGHT, BOTTOM, BOTTOMLEFT, LEFT, TOPLEFT, TOP
-    };
+    /**
+     * Marks a cell whose inflow has been completely accumulated.
+     */
+    private static final byte DONE = -1;
 
     public AccumulationFlowOperator() {
     }
@@ -49,113 +72,159 @@ public class AccumulationFlowOperator implements GridOperator {
         GeoGrid newGrid = new GeoGrid(cols, rows, meshSize);
         newGrid.setWest(geoGrid.getWest());
         newGrid.setNorth(geoGrid.getNorth());
-
-        for (int row = 1; row < rows - 1; row++) {
-            System.out.println(row);
-            for (int col = 1; col < cols - 1; col++) {
-                incrementFlow(geoGrid, newGrid, col, row);
-            }
+        if (cols < 3 || rows < 3) {
+            return newGrid;
         }
 
+        // flow direction and number of inflowing neighbors of each cell
+        final byte[] dir = new byte[cols * rows];
+        final byte[] inflow = new byte[cols * rows];
+        runThreads(geoGrid.getGrid(), dir, null, cols, rows);
+        runThreads(null, dir, inflow, cols, rows);
+
+        accumulate(dir, inflow, newGrid.getGrid(), cols, rows);
         return newGrid;
     }
 
-    private void incrementFlow(GeoGrid dem, GeoGrid accflow, int col, int row) {
+    /**
+     * Passes the accumulated flow of each cell to its downstream neighbor. A
+     * path is followed from every cell without inflow until a cell is reached
+     * that still expects flow from other neighbors.
+     */
+    private static void accumulate(byte[] dir, byte[] inflow, float[][] acc,
+            int cols, int rows) {
 
-        for (;;) {
-            FlowDirection dir = FlowDirection.NONE;
-            try {
-                dir = this.getFlowDirection(dem, col, row);
-            } catch (IndexOutOfBoundsException exc) {
-                break;
-            }
-            switch (dir) {
-                case NONE:
-                    break;
-                case TOPRIGHT:
-                    col++;
-                    row--;
-                    break;
-                case RIGHT:
-                    col++;
-                    break;
-                case BOTTOMRIGHT:
-                    col++;
-                    row++;
-                    break;
-                case BOTTOM:
-                    row++;
-                    break;
-                case BOTTOMLEFT:
-                    col--;
-                    row++;
-                    break;
-                case LEFT:
-                    col--;
-                    break;
-                case TOPLEFT:
-                    col--;
-                    row--;
-                    break;
-                case TOP:
-                    row--;
-                    break;
-            }
-            try {
-                float v = accflow.getValue(col, row);
-                accflow.setValue(v + 1, col, row);
-            } catch (IndexOutOfBoundsException exc) {
-                break;
+        for (int row = 0; row < rows; row++) {
+            for (int col = 0; col < cols; col++) {
+                if (inflow[row * cols + col] != 0) {
+                    continue;
+                }
+                int c = col;
+                int r = row;
+                int d = dir[r * cols + c];
+                while (d != NONE) {
+                    final int nc = c + DCOL[d - 1];
+                    final int nr = r + DROW[d - 1];
+                    acc[nr][nc] += acc[r][c] + 1;
+                    final int id = nr * cols + nc;
+                    if (--inflow[id] != 0) {
+                        break;
+                    }
+                    // all inflow has arrived, continue downstream
+                    inflow[id] = DONE;
+                    c = nc;
+                    r = nr;
+                    d = dir[id];
+                }
             }
         }
     }
 
-    private FlowDirection getFlowDirection(GeoGrid geoGrid, int col, int row) {
+    /**
+     * Computes the flow direction of the cells in a range of rows.
+     */
+    private static void computeDirections(float[][] grid, byte[] dir,
+            int cols, int rows, int startRow, int endRow) {
 
-        // search for direction of flow
-        final float hc = geoGrid.getValue(col, row);
-        FlowDirection dir = FlowDirection.NONE;
-        float diff = 0;
-        float d = geoGrid.getValue(col + 1, row - 1) - hc;
-        if (d < diff) {
-            diff = d;
-            dir = FlowDirection.TOPRIGHT;
-        }
-        d = geoGrid.getValue(col + 1, row) - hc;
-        if (d < diff) {
-            diff = d;
-            dir = FlowDirection.RIGHT;
-        }
-        d = geoGrid.getValue(col + 1, row + 1) - hc;
-        if (d < diff) {
-            diff = d;
-            dir = FlowDirection.BOTTOMRIGHT;
+        for (int row = Math.max(1, startRow); row < Math.min(rows - 1, endRow); row++) {
+            final float[] r = grid[row];
+            for (int col = 1; col < cols - 1; col++) {
+                final float hc = r[col];
+                byte cellDir = NONE;
+                float diff = 0;
+                for (int i = 0; i < 8; i++) {
+                    final float d = grid[row + DROW[i]][col + DCOL[i]] - hc;
+                    if (d < diff) {
+                        diff = d;
+                        cellDir = (byte) (i + 1);
+                    }
+                }
+                dir[row * cols + col] = cellDir;
+            }
         }
-        d = geoGrid.getValue(col, row + 1) - hc;
-        if (d < diff) {
-            diff = d;
-            dir = FlowDirection.BOTTOM;
+    }
+
+    /**
+     * Counts the neighbors flowing into each cell in a range of rows.
+     */
+    private static void countInflow(byte[] dir, byte[] inflow,
+            int cols, int rows, int startRow, int endRow) {
+
+        for (int row = startRow; row < endRow; row++) {
+            for (int col = 0; col < cols; col++) {
+                byte n = 0;
+                for (int i = 0; i < 8; i++) {
+                    // the neighbor flows into this cell if it is in the
+                    // opposite direction of the neighbor's flow
+                    final int nc = col - DCOL[i];
+                    final int nr = row - DROW[i];
+                    if (nc >= 0 && nc < cols && nr >= 0 && nr < rows
+                            && dir[nr * cols + nc] == i + 1) {
+                        ++n;
+                    }
+                }
+                inflow[row * cols + col] = n;
+            }
         }
-        d = geoGrid.getValue(col - 1, row + 1) - hc;
-        if (d < diff) {
-            diff = d;
-            dir = FlowDirection.BOTTOMLEFT;
+    }
+
+    /**
+     * Computes flow directions if grid is not null, otherwise counts inflowing
+     * neighbors. Rows are distributed among as many threads as CPU cores are
+     * available.
+     */
+    private static void runThreads(float[][] grid, byte[] dir, byte[] inflow,
+            int cols, int rows) {
+
+        int nThreads = Runtime.getRuntime().availableProcessors();
+        ArrayList<FlowThread> threads = new ArrayList<FlowThread>(nThreads);
+        int rowChunk = (rows / nThreads) + 1;
+        for (int i = 0; i < nThreads; i++) {
+            int startRow = i * rowChunk;
+            int endRow = Math.min(rows, startRow + rowChunk);
+            FlowThread t = new FlowThread(grid, dir, inflow, cols, rows,
+                    startRow, endRow);
+            threads.add(t);
+            t.start();
         }
-        d = geoGrid.getValue(col - 1, row) - hc;
-        if (d < diff) {
-            diff = d;
-            dir = FlowDirection.LEFT;
+
+        for (Thread t : threads) {
+            try {
+                t.join();
+            } catch (InterruptedException ex) {
+                Logger.getLogger(AccumulationFlowOperator.class.getName()).log(Level.SEVERE, null, ex);
+            }
         }
-        d = geoGrid.getValue(col - 1, row - 1) - hc;
-        if (d < diff) {
-            diff = d;
-            dir = FlowDirection.TOPLEFT;
+    }
+
+    private static class FlowThread extends Thread {
+
+        private final float[][] grid;
+        private final byte[] dir;
+        private final byte[] inflow;
+        private final int cols;
+        private final int rows;
+        private final int startRow;
+        private final int endRow;
+
+        public FlowThread(float[][] grid, byte[] dir, byte[] inflow,
+                int cols, int rows, int startRow, int endRow) {
+            this.grid = grid;
+            this.dir = dir;
+            this.inflow = inflow;
+            this.cols = cols;
+            this.rows = rows;
+            this.startRow = startRow;
+            this.endRow = endRow;
         }
-        d = geoGrid.getValue(col, row - 1) - hc;
-        if (d < diff) {
-            diff = d;
-            dir = FlowDirection.TOP;
+
+        @Override
+        public void run() {
+            if (grid != null) {
+                computeDirections(grid, dir, cols, rows, startRow, endRow);
+            } else {
+                countInflow(dir, inflow, cols, rows, startRow, endRow);
+            }
         }
-        return dir;
     }
 }
@@ -7,6 +7,7 @@
 package ika.geo.grid;
 
 import ika.geo.*;
+import ika.utils.Instrumentation;
 
 /**
  *
@@ -49,6 +50,7 @@ public class Contourer implements GridOperator {
     public GeoObject operate(GeoGrid geoGrid, 
             double firstContourLevel, 
             double lastContourLevel) {
+        final long t = Instrumentation.start();
         flags = new boolean[geoGrid.getRows()][geoGrid.getCols()];
 
         GeoSet geoSet = new GeoSet();
@@ -68,6 +70,8 @@ public class Contourer implements GridOperator {
             levelGeoSet.setName(Double.toString(contourLevel));
             geoSet.add(levelGeoSet);
         }
+        Instrumentation.count("Contourer.levels", nlevels);
+        Instrumentation.stop("Contourer", t);
         return geoSet;
     }
 
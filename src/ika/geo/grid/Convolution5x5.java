@@ -1,6 +1,9 @@
 package ika.geo.grid;
 
 import ika.geo.GeoGrid;
+import java.util.ArrayList;
+import java.util.logging.Level;
+import java.util.logging.Logger;
 
 /**
  *
@@ -8,6 +11,11 @@ import ika.geo.GeoGrid;
  */
 public class Convolution5x5 {
 
+    /**
+     * Minimum number of rows of the grid of half size computed by a thread.
+     */
+    private static final int MIN_ROWS_PER_THREAD = 16;
+
     private float wa = 0.4f;
     private float wb = 0.25f;
     private float wc = 0.05f;
@@ -29,31 +37,125 @@ public class Convolution5x5 {
         convGrid.setWest(geoGrid.getWest());
         convGrid.setNorth(geoGrid.getNorth());
 
-        // top and bottom rows
-        for (int c = 0; c < cols; c += 2) {
-            float g = this.convolveBorder(geoGrid, c, 0);
-            convGrid.setValue(g, c / 2, 0);
-            g = this.convolveBorder(geoGrid, c, rows - 1);
-            convGrid.setValue(g, c / 2, rows / 2 - 1 + rows % 2);
+        // distribute bands of rows of the new grid among threads
+        int nThreads = Math.max(1, Math.min(Runtime.getRuntime().availableProcessors(),
+                newRows / MIN_ROWS_PER_THREAD));
+        ArrayList<HalfSizeThread> threads = new ArrayList<HalfSizeThread>(nThreads);
+        int rowChunk = (newRows / nThreads) + 1;
+        for (int i = 0; i < nThreads; i++) {
+            int startRow = i * rowChunk;
+            int endRow = Math.min(newRows, startRow + rowChunk);
+            HalfSizeThread t = new HalfSizeThread(geoGrid, convGrid, startRow, endRow);
+            threads.add(t);
+            t.start();
+        }
+        for (Thread t : threads) {
+            try {
+                t.join();
+            } catch (InterruptedException ex) {
+                Logger.getLogger(Convolution5x5.class.getName()).log(Level.SEVERE, null, ex);
+            }
         }
 
-        // left and right columns
-        for (int r = 0; r < rows; r += 2) {
-            float g = this.convolveBorder(geoGrid, 0, r);
-            convGrid.setValue(g, 0, r / 2);
-            g = this.convolveBorder(geoGrid, cols - 1, r);
-            convGrid.setValue(g, cols / 2 - 1 + cols % 2, r / 2);
+        return convGrid;
+    }
+
+    /**
+     * Convolves a band of rows of the grid of half size. The 5x5 kernel is
+     * separated: source rows are first filtered horizontally at every second
+     * column, and the filtered rows are then combined vertically. Filtered
+     * rows are kept in a ring buffer of five rows, as neighboring rows of the
+     * new grid share three source rows.<br>
+     * The last column of the new grid is centered on the last source column.
+     * The last row is centered on the last source row, except for its first
+     * and last cell, which are centered on the row of index 2 * row.
+     */
+    private void convolveToHalfSize(GeoGrid geoGrid, float[][] dst,
+            int startRow, int endRow) {
+
+        final float[][] src = geoGrid.getGrid();
+        final int rows = src.length;
+        final int newRows = dst.length;
+        final int newCols = dst[0].length;
+
+        final float[][] filteredRows = new float[5][newCols];
+        final int[] filteredRowIDs = {-1, -1, -1, -1, -1};
+
+        for (int row = startRow; row < endRow; row++) {
+            if (row < newRows - 1) {
+                this.convolveRow(geoGrid, dst[row], row * 2, 0, newCols,
+                        filteredRows, filteredRowIDs);
+            } else {
+                this.convolveRow(geoGrid, dst[row], row * 2, 0, 1,
+                        filteredRows, filteredRowIDs);
+                this.convolveRow(geoGrid, dst[row], rows - 1, 1, newCols - 1,
+                        filteredRows, filteredRowIDs);
+                this.convolveRow(geoGrid, dst[row], row * 2, newCols - 1, newCols,
+                        filteredRows, filteredRowIDs);
+            }
         }
+    }
 
-        // interior of grid
-        for (int r = 2; r < rows - 2; r += 2) {
-            for (int c = 2; c < cols - 2; c += 2) {
-                final float g = this.convolve(geoGrid, c, r);
-                convGrid.setValue(g, c / 2, r / 2);
+    /**
+     * Combines five horizontally filtered rows centered on a source row.
+     */
+    private void convolveRow(GeoGrid geoGrid, float[] dstRow, int srcRow,
+            int startCol, int endCol, float[][] filteredRows, int[] filteredRowIDs) {
+
+        final float[][] src = geoGrid.getGrid();
+        final int rows = src.length;
+        final int cols = src[0].length;
+        final int newCols = dstRow.length;
+
+        // use border values. First derivative is zero.
+        final float[] h0 = this.filteredRow(src, Math.max(0, srcRow - 2), filteredRows, filteredRowIDs);
+        final float[] h1 = this.filteredRow(src, Math.max(0, srcRow - 1), filteredRows, filteredRowIDs);
+        final float[] h2 = this.filteredRow(src, srcRow, filteredRows, filteredRowIDs);
+        final float[] h3 = this.filteredRow(src, Math.min(rows - 1, srcRow + 1), filteredRows, filteredRowIDs);
+        final float[] h4 = this.filteredRow(src, Math.min(rows - 1, srcRow + 2), filteredRows, filteredRowIDs);
+        for (int col = startCol; col < endCol; col++) {
+            final float res = wc * (h0[col] + h4[col]) + wb * (h1[col] + h3[col]) + wa * h2[col];
+            if (Float.isNaN(res)) {
+                final int srcCol = col == newCols - 1 ? cols - 1 : col * 2;
+                dstRow[col] = this.convolveWithVoid(geoGrid, srcCol, srcRow);
+            } else {
+                dstRow[col] = res;
             }
         }
+    }
 
-        return convGrid;
+    /**
+     * Returns a source row filtered horizontally at the columns of the grid
+     * of half size. Uses a ring buffer to avoid filtering rows repeatedly.
+     */
+    private float[] filteredRow(float[][] src, int row, float[][] filteredRows,
+            int[] filteredRowIDs) {
+
+        final int slot = row % filteredRows.length;
+        final float[] filtered = filteredRows[slot];
+        if (filteredRowIDs[slot] == row) {
+            return filtered;
+        }
+        filteredRowIDs[slot] = row;
+
+        final float[] srcRow = src[row];
+        final int cols = srcRow.length;
+        final int newCols = filtered.length;
+        for (int col = 0; col < newCols; col++) {
+            final int c = col == newCols - 1 ? cols - 1 : col * 2;
+            if (c >= 2 && c + 2 < cols) {
+                filtered[col] = wc * (srcRow[c - 2] + srcRow[c + 2])
+                        + wb * (srcRow[c - 1] + srcRow[c + 1]) + wa * srcRow[c];
+            } else {
+                // use border values. First derivative is zero.
+                final float v0 = srcRow[Math.max(0, c - 2)];
+                final float v1 = srcRow[Math.max(0, c - 1)];
+                final float v3 = srcRow[Math.min(cols - 1, c + 1)];
+                final float v4 = srcRow[Math.min(cols - 1, c + 2)];
+                filtered[col] = wc * (v0 + v4) + wb * (v1 + v3) + wa * srcRow[c];
+            }
+        }
+        return filtered;
     }
 
     public GeoGrid convolve(GeoGrid geoGrid) {
@@ -222,4 +324,24 @@ public class Convolution5x5 {
         return convolveWithVoid(v0, v1, v2, v3, v4);
 
     }
+
+    private class HalfSizeThread extends Thread {
+
+        private final GeoGrid src;
+        private final GeoGrid dst;
+        private final int startRow;
+        private final int endRow;
+
+        public HalfSizeThread(GeoGrid src, GeoGrid dst, int startRow, int endRow) {
+            this.src = src;
+            this.dst = dst;
+            this.startRow = startRow;
+            this.endRow = endRow;
+        }
+
+        @Override
+        public void run() {
+            convolveToHalfSize(src, dst.getGrid(), startRow, endRow);
+        }
+    }
 }
@@ -20,17 +20,23 @@ public class GridEdgeMarker {
         markedGrid.setWest(grid.getWest());
         markedGrid.setNorth(grid.getNorth());
 
+        final float[][] src = grid.getGrid();
+        final float[][] dst = markedGrid.getGrid();
         for (int r = 1; r < rows - 1; r++) {
+            final float[] prevRow = src[r - 1];
+            final float[] row = src[r];
+            final float[] nextRow = src[r + 1];
+            final float[] dstRow = dst[r];
             for (int c = 1; c < cols - 1; c++) {
 
-                if (grid.getValue(c, r) == 1f) {
-                    if (grid.getValue(c - 1, r) == 0 
-                            || grid.getValue(c + 1, r) == 0 
-                            || grid.getValue(c, r - 1) == 0 
-                            || grid.getValue(c, r + 1) == 0) {
-                        markedGrid.setValue(0.5f, c, r);
+                if (row[c] == 1f) {
+                    if (row[c - 1] == 0 
+                            || row[c + 1] == 0 
+                            || prevRow[c] == 0 
+                            || nextRow[c] == 0) {
+                        dstRow[c] = 0.5f;
                     } else {
-                        markedGrid.setValue(1f, c, r);
+                        dstRow[c] = 1f;
                     }
                 }
             }
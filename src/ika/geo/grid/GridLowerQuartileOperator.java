@@ -29,4 +29,9 @@ public class GridLowerQuartileOperator extends GridPercentileFilterOperator {
         return ika.utils.Median.lowerQuartile(values);
     }
 
+    @Override
+    protected final int percentileRank(int nbrValues) {
+        return ika.utils.Median.lowerQuartileRank(nbrValues);
+    }
+
 }
@@ -30,5 +30,10 @@ public class GridMedianOperator extends GridPercentileFilterOperator{
     protected final float percentile(float[] values) {
         return ika.utils.Median.median(values, false);
     }
+
+    @Override
+    protected final int percentileRank(int nbrValues) {
+        return ika.utils.Median.medianRank(nbrValues);
+    }
     
 }
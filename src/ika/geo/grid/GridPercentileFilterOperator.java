@@ -19,6 +19,18 @@ public abstract class GridPercentileFilterOperator implements GridOperator {
     }
 
     protected abstract float percentile(float[] values);
+
+    /**
+     * Returns the rank of the value that percentile() selects from an array.
+     * If a derived class returns a valid rank, a fast sliding window filter
+     * is used instead of percentile().
+     * @param nbrValues The number of values in the filter window.
+     * @return The rank starting with 0, or -1 if percentile() does not select
+     * a value of fixed rank.
+     */
+    protected int percentileRank(int nbrValues) {
+        return -1;
+    }
     
     public GeoGrid operate(GeoGrid geoGrid) {
         if (geoGrid == null) {
@@ -42,6 +54,12 @@ public abstract class GridPercentileFilterOperator implements GridOperator {
         float[][] srcGrid = geoGrid.getGrid();
         float[][] dstGrid = newGrid.getGrid();
 
+        final int rank = this.percentileRank(this.filterSize * this.filterSize);
+        if (rank >= 0) {
+            SlidingRankFilter.kthSmallest(srcGrid, dstGrid, this.filterSize, rank);
+            return newGrid;
+        }
+
         // filter interior of grid
         float[] values = new float[this.filterSize * this.filterSize];
         for (int row = halfFilterSize; row < nrows - halfFilterSize; row++) {
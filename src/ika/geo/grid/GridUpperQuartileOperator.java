@@ -27,4 +27,9 @@ public class GridUpperQuartileOperator extends GridPercentileFilterOperator {
     protected final float percentile(float[] values) {
         return ika.utils.Median.upperQuartile(values);
     }
+
+    @Override
+    protected final int percentileRank(int nbrValues) {
+        return ika.utils.Median.upperQuartileRank(nbrValues);
+    }
 }
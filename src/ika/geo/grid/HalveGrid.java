@@ -14,14 +14,21 @@ public class HalveGrid {
         int cols = grid.getCols();
         int rows = grid.getRows();
         double cellsize = grid.getCellSize();
-        GeoGrid halfGrid = new GeoGrid(cols / 2, rows / 2, cellsize * 2);
+        final int halfCols = cols / 2;
+        final int halfRows = rows / 2;
+        GeoGrid halfGrid = new GeoGrid(halfCols, halfRows, cellsize * 2);
         halfGrid.setWest(grid.getWest());
         halfGrid.setNorth(grid.getNorth());
         
-        for (int r = 0; r < rows; r += 2) {
-            for (int c = 0; c < cols; c += 2) {
-                final float v = grid.getValue(c, r);
-                halfGrid.setValue(v, c / 2, r / 2);
+        // copy every second cell. The last row and column of grids with an
+        // odd size are dropped.
+        final float[][] src = grid.getGrid();
+        final float[][] dst = halfGrid.getGrid();
+        for (int r = 0; r < halfRows; r++) {
+            final float[] srcRow = src[r * 2];
+            final float[] dstRow = dst[r];
+            for (int c = 0; c < halfCols; c++) {
+                dstRow[c] = srcRow[c * 2];
             }
         }
         
@@ -4,6 +4,9 @@ import ika.geo.GeoGrid;
 import ika.geoexport.ESRIASCIIGridExporter;
 import ika.utils.FileUtils;
 import java.io.IOException;
+import java.util.ArrayList;
+import java.util.logging.Level;
+import java.util.logging.Logger;
 
 /**
  *
@@ -17,6 +20,11 @@ public class LaplacianPyramid {
     private static final float wb = 0.25f;
     private static final float wc = 0.05f;
 
+    /**
+     * Minimum number of rows computed by a thread.
+     */
+    private static final int MIN_ROWS_PER_THREAD = 32;
+
     public void createPyramid(GeoGrid[] gaussianPyramid) {
 
         levels = new GeoGrid[gaussianPyramid.length];
@@ -25,127 +33,47 @@ public class LaplacianPyramid {
         levels[levels.length - 1] = gaussianPyramid[gaussianPyramid.length - 1];
 
         // compute the levels of this Laplacian pyramid by computing differences
-        // between the levels of the Gaussian pyramid.
+        // between the levels of the Gaussian pyramid. The smaller grid is 
+        // expanded to the size of the larger grid and subtracted in one pass.
         for (int i = gaussianPyramid.length - 1; i > 0; i--) {
-
-            GeoGrid nextLargerGrid = gaussianPyramid[i - 1];
-
-            // expand the smaller grid to the size of the larger grid
-            GeoGrid expanded = LaplacianPyramid.expand(gaussianPyramid[i],
-                    nextLargerGrid.getCols(), nextLargerGrid.getRows());
-
-            // compute the difference
-            levels[i - 1] = LaplacianPyramid.difGrids(nextLargerGrid, expanded);
-        }
-
-    }
-
-    private static void expandBorderColumns(GeoGrid src, float[][] dst) {
-
-        final int cols = src.getCols();
-        final int rows = src.getRows();
-
-        // left column
-        for (int r = 0; r < rows; r++) {
-            float v0 = src.getValue(0, r);
-            float v1 = v0;
-            float v2 = src.getValue(1, r);
-            float vEven = 2.f * (wc * (v0 + v2) + wa * v1);
-            float vOdd = 2.f * wb * (v1 + v2);
-
-            if (Float.isNaN(vEven) || Float.isNaN(vOdd)) {
-                if (Float.isNaN(vEven) && Float.isNaN(vOdd)) {
-                    dst[r][0] = Float.NaN;
-                    dst[r][1] = Float.NaN;
-                } else {
-                    expandWithVoid(src.getGrid(), dst, 0, r, true);
-                }
-            } else {
-                dst[r][0] = vEven;
-                dst[r][1] = vOdd;
-            }
-
-        }
-
-        // right column
-        for (int r = 0; r < rows; r++) {
-            float v0 = src.getValue(cols - 2, r);
-            float v1 = src.getValue(cols - 1, r);
-            float v2 = v1;
-            float vEven = 2.f * (wc * (v0 + v2) + wa * v1);
-            float vOdd = 2.f * wb * (v1 + v2);
-            int c = (cols - 1) * 2;
-
-            if (Float.isNaN(vEven) || Float.isNaN(vOdd)) {
-                if (Float.isNaN(vEven) && Float.isNaN(vOdd)) {
-                    dst[r][c] = Float.NaN;
-                    dst[r][c + 1] = Float.NaN;
-                } else {
-                    expandWithVoid(src.getGrid(), dst, c, r, true);
-                }
-            } else {
-                dst[r][c] = vEven;
-                dst[r][c + 1] = vOdd;
-            }
+            levels[i - 1] = LaplacianPyramid.expand(gaussianPyramid[i],
+                    gaussianPyramid[i - 1], true);
         }
 
     }
 
-    private static void expandBorderRows(float[][] src, GeoGrid dstGeoGrid) {
-
-        final int cols = dstGeoGrid.getCols();
-        final int rows = dstGeoGrid.getRows();
-        final float[][] dstGrid = dstGeoGrid.getGrid();
-
-        // top row
-        for (int c = 0; c < cols; c++) {
-            float v0 = src[0][c];
-            float v1 = v0;
-            float v2 = src[1][c];
-            float vEven = 2.f * (wc * (v0 + v2) + wa * v1);
-            float vOdd = 2.f * wb * (v1 + v2);
-            if (Float.isNaN(vEven) || Float.isNaN(vOdd)) {
-                if (Float.isNaN(vEven) && Float.isNaN(vOdd)) {
-                    dstGrid[0][c] = Float.NaN;
-                    dstGrid[1][c] = Float.NaN;
-                } else {
-                    expandWithVoid(dstGeoGrid.getGrid(), dstGrid, c, 0, false);
-                }
-            } else {
-                dstGrid[0][c] = vEven;
-                dstGrid[1][c] = vOdd;
-            }
-
-        }
-
-        // bottom row
-        for (int c = 0; c < cols; c++) {
-            float v0 = src[rows / 2 - 2][c];
-            float v1 = src[rows / 2 - 1][c];
-            float v2 = v1;
-            float vEven = 2.f * (wc * (v0 + v2) + wa * v1);
-            float vOdd = 2.f * wb * (v1 + v2);
-            if (Float.isNaN(vEven) || Float.isNaN(vOdd)) {
-                if (Float.isNaN(vEven) && Float.isNaN(vOdd)) {
-                    dstGrid[rows - 2][c] = Float.NaN;
-                    dstGrid[rows - 1][c] = Float.NaN;
-                } else {
-                    expandWithVoid(dstGeoGrid.getGrid(), dstGrid, c, rows - 2, false);
-                }
-            } else {
-                dstGrid[rows - 2][c] = vEven;
-                dstGrid[rows - 1][c] = vOdd;
-            }
-        }
-    }
-    private static float[][] tempGrid = null;
-
     /**
      * Expand the size of a grid by a factor 2.
      * @param geoGrid The grid to expand.
      * @return
      */
     public static GeoGrid expand(GeoGrid geoGrid, int maxCols, int maxRows) {
+        return LaplacianPyramid.expand(geoGrid, maxCols, maxRows, null, false);
+    }
+
+    /**
+     * Expand the size of a grid by a factor 2 and add or subtract a grid.
+     * @param geoGrid The grid to expand.
+     * @param addend The grid to add. Its size limits the size of the 
+     * expanded grid.
+     * @param subtract If true, the expanded grid is subtracted from addend,
+     * otherwise the two grids are added.
+     * @return A new grid.
+     */
+    private static GeoGrid expand(GeoGrid geoGrid, GeoGrid addend, boolean subtract) {
+        if (addend.getCols() > geoGrid.getCols() * 2
+                || addend.getRows() > geoGrid.getRows() * 2
+                || addend.getCellSize() != geoGrid.getCellSize() / 2
+                || addend.getWest() != geoGrid.getWest()
+                || addend.getNorth() != geoGrid.getNorth()) {
+            throw new IllegalArgumentException("grids of different size");
+        }
+        return LaplacianPyramid.expand(geoGrid, addend.getCols(), addend.getRows(),
+                addend, subtract);
+    }
+
+    private static GeoGrid expand(final GeoGrid geoGrid, int maxCols, int maxRows,
+            final GeoGrid addend, final boolean subtract) {
 
         final int cols = geoGrid.getCols();
         final int rows = geoGrid.getRows();
@@ -154,81 +82,175 @@ public class LaplacianPyramid {
         final int newCols = Math.min(maxCols, cols * 2);
         final int newRows = Math.min(maxRows, rows * 2);
 
-        GeoGrid expandedGrid = new GeoGrid(newCols, newRows, geoGrid.getCellSize() / 2);
+        final GeoGrid expandedGrid = new GeoGrid(newCols, newRows, geoGrid.getCellSize() / 2);
         expandedGrid.setWest(geoGrid.getWest());
         expandedGrid.setNorth(geoGrid.getNorth());
 
-        // tempGrid holds an intermediate grid that is expanded horizontally, 
-        // but not vertically.
-        if (tempGrid == null || tempGrid.length < rows) {
-            tempGrid = new float[rows][cols * 2];
+        // distribute bands of rows among threads
+        int nThreads = Math.max(1, Math.min(Runtime.getRuntime().availableProcessors(),
+                newRows / MIN_ROWS_PER_THREAD));
+        ArrayList<Thread> threads = new ArrayList<Thread>(nThreads);
+        int rowChunk = (newRows / nThreads) + 1;
+        for (int i = 0; i < nThreads; i++) {
+            final int startRow = i * rowChunk;
+            final int endRow = Math.min(newRows, startRow + rowChunk);
+            Thread t = new Thread() {
+
+                @Override
+                public void run() {
+                    expandRows(geoGrid.getGrid(), expandedGrid.getGrid(),
+                            addend == null ? null : addend.getGrid(), subtract,
+                            startRow, endRow);
+                }
+            };
+            threads.add(t);
+            t.start();
         }
+        LaplacianPyramid.join(threads);
 
-        LaplacianPyramid.expandBorderColumns(geoGrid, tempGrid);
-        for (int r = 0; r < rows; r++) {
-            final float[] tempGridRow = tempGrid[r];
-            for (int c = 1; c < cols - 1; c++) {
-                final float v0 = geoGrid.getValue(c - 1, r);
-                final float v1 = geoGrid.getValue(c, r);
-                final float v2 = geoGrid.getValue(c + 1, r);
+        return expandedGrid;
+    }
+
+    private static void join(ArrayList<Thread> threads) {
+        for (Thread t : threads) {
+            try {
+                t.join();
+            } catch (InterruptedException ex) {
+                Logger.getLogger(LaplacianPyramid.class.getName()).log(Level.SEVERE, null, ex);
+            }
+        }
+    }
+
+    /**
+     * Computes a band of rows of an expanded grid. Each row of the source grid
+     * is first expanded horizontally. The expanded rows are then combined
+     * vertically. Horizontally expanded rows are kept in a ring buffer, as
+     * neighboring rows of the expanded grid share source rows.<br>
+     * Border cells use the border value of the source grid for the missing
+     * neighbor. If the expanded grid has an odd number of rows, its last row
+     * is computed like the last row of a grid with an even number of rows
+     * shifted up by one row.
+     */
+    private static void expandRows(float[][] src, float[][] dst, float[][] addend,
+            boolean subtract, int startRow, int endRow) {
+
+        final int rows = src.length;
+        final int newRows = dst.length;
+        final int newCols = dst[0].length;
+        final float[][] expandedRows = new float[4][newCols];
+        final int[] expandedRowIDs = {-1, -1, -1, -1};
+        final int h = newRows / 2;
+
+        for (int row = startRow; row < endRow; row++) {
+            final int r0, r1, r2;
+            final boolean odd;
+            if (row < 2) {
+                // top border
+                r0 = 0;
+                r1 = 0;
+                r2 = 1;
+                odd = row == 1;
+            } else if (row / 2 <= rows - 2) {
+                r0 = row / 2 - 1;
+                r1 = row / 2;
+                r2 = row / 2 + 1;
+                odd = row % 2 == 1;
+            } else {
+                // bottom border
+                r0 = Math.max(0, h - 2);
+                r1 = Math.max(0, h - 1);
+                r2 = r1;
+                odd = row == newRows - 1;
+            }
+
+            final float[] t0 = expandedRow(src, r0, expandedRows, expandedRowIDs);
+            final float[] t1 = expandedRow(src, r1, expandedRows, expandedRowIDs);
+            final float[] t2 = expandedRow(src, r2, expandedRows, expandedRowIDs);
+            final float[] dstRow = dst[row];
+            for (int c = 0; c < newCols; c++) {
+                final float v0 = t0[c];
+                final float v1 = t1[c];
+                final float v2 = t2[c];
                 final float vEven = 2.f * (wc * (v0 + v2) + wa * v1);
                 final float vOdd = 2.f * wb * (v1 + v2);
+                final float v;
                 if (Float.isNaN(vEven) || Float.isNaN(vOdd)) {
                     if (Float.isNaN(vEven) && Float.isNaN(vOdd)) {
-                        tempGridRow[c * 2] = Float.NaN;
-                        tempGridRow[c * 2 + 1] = Float.NaN;
+                        v = Float.NaN;
                     } else {
-                        expandWithVoid(geoGrid.getGrid(), tempGrid, c, r, true);
+                        v = expandWithVoid(v0, v1, v2, odd);
                     }
                 } else {
-                    tempGridRow[c * 2] = vEven;
-                    tempGridRow[c * 2 + 1] = vOdd;
+                    v = odd ? vOdd : vEven;
                 }
+                dstRow[c] = v;
             }
-        }
-
-        LaplacianPyramid.expandBorderRows(tempGrid, expandedGrid);
-        for (int r = 1; r < rows - 1; r++) {
-            for (int c = 0; c < newCols; c++) {
 
-                final float v0 = tempGrid[r - 1][c]; //tempGrid[(r - 1) * cols * 2 + c];
-                final float v1 = tempGrid[r][c];
-                final float v2 = tempGrid[r + 1][c];
-                final float vEven = 2.f * (wc * (v0 + v2) + wa * v1);
-                final float vOdd = 2.f * wb * (v1 + v2);
-                if (Float.isNaN(vEven) || Float.isNaN(vOdd)) {
-                    if (Float.isNaN(vEven) && Float.isNaN(vOdd)) {
-                        expandedGrid.setValue(Float.NaN, c, 2 * r);
-                        expandedGrid.setValue(Float.NaN, c, 2 * r + 1);
-                    } else {
-                        expandWithVoid(tempGrid, expandedGrid.getGrid(), c / 2, r, false);
+            if (addend != null) {
+                final float[] addendRow = addend[row];
+                if (subtract) {
+                    for (int c = 0; c < newCols; c++) {
+                        dstRow[c] = addendRow[c] - dstRow[c];
                     }
                 } else {
-                    expandedGrid.setValue(vEven, c, 2 * r);
-                    expandedGrid.setValue(vOdd, c, 2 * r + 1);
+                    for (int c = 0; c < newCols; c++) {
+                        dstRow[c] += addendRow[c];
+                    }
                 }
             }
         }
-
-        return expandedGrid;
     }
 
-    private static void expandWithVoid(float[][] srcGrid,
-            float[][] expandedGrid,
-            int c,
-            int r,
-            boolean horizontal) {
-
-        final float v0, v1, v2;
-        if (horizontal) {
-            v0 = srcGrid[r][c - 1];
-            v1 = srcGrid[r][c];
-            v2 = srcGrid[r][c + 1];
-        } else {
-            v0 = srcGrid[r - 1][c];
-            v1 = srcGrid[r][c];
-            v2 = srcGrid[r + 1][c];
+    /**
+     * Returns a row of the source grid that is expanded horizontally. Uses a
+     * ring buffer to avoid expanding rows repeatedly.
+     */
+    private static float[] expandedRow(float[][] src, int row,
+            float[][] expandedRows, int[] expandedRowIDs) {
+
+        final int slot = row % expandedRows.length;
+        final float[] dst = expandedRows[slot];
+        if (expandedRowIDs[slot] == row) {
+            return dst;
         }
+        expandedRowIDs[slot] = row;
+
+        final float[] srcRow = src[row];
+        final int cols = srcRow.length;
+        final int newCols = dst.length;
+        for (int c = 0; c * 2 < newCols; c++) {
+            // the left and right border columns use the border value twice
+            final float v0 = srcRow[c == 0 ? 0 : c - 1];
+            final float v1 = srcRow[c];
+            final float v2 = srcRow[c == cols - 1 ? c : c + 1];
+            final float vEven = 2.f * (wc * (v0 + v2) + wa * v1);
+            final float vOdd = 2.f * wb * (v1 + v2);
+            float e = vEven;
+            float o = vOdd;
+            if (Float.isNaN(vEven) || Float.isNaN(vOdd)) {
+                if (Float.isNaN(vEven) && Float.isNaN(vOdd)) {
+                    e = Float.NaN;
+                    o = Float.NaN;
+                } else {
+                    e = expandWithVoid(v0, v1, v2, false);
+                    o = expandWithVoid(v0, v1, v2, true);
+                }
+            }
+            dst[c * 2] = e;
+            if (c * 2 + 1 < newCols) {
+                dst[c * 2 + 1] = o;
+            }
+        }
+        return dst;
+    }
+
+    /**
+     * Expands three values when some of them are void. The weights of the
+     * remaining values are scaled to sum to the total weight.
+     * @param odd If true, the value between v1 and v2 is returned, otherwise
+     * the value at the position of v1.
+     */
+    private static float expandWithVoid(float v0, float v1, float v2, boolean odd) {
 
         float vEven = 0f;
         float vOdd = 0f;
@@ -252,23 +274,18 @@ public class LaplacianPyramid {
             totOddW += wb;
         }
 
-        if (totEvenW == 0) {
-            vEven = Float.NaN;
-        }
-        if (totOddW == 0) {
-            vOdd = Float.NaN;
-        }
-        final float scaleEven = (wc * 2 + wa) / totEvenW;
-        final float scaleOdd = wb * 2 / totOddW;
-
-        vEven *= 2f * scaleEven;
-        vOdd *= 2f * scaleOdd;
-        if (horizontal) {
-            expandedGrid[r][c * 2] = vEven;
-            expandedGrid[r][c * 2 + 1] = vOdd;
+        if (odd) {
+            if (totOddW == 0) {
+                return Float.NaN;
+            }
+            final float scaleOdd = wb * 2 / totOddW;
+            return vOdd * (2f * scaleOdd);
         } else {
-            expandedGrid[r * 2][c] = vEven;
-            expandedGrid[r * 2 + 1][c] = vOdd;
+            if (totEvenW == 0) {
+                return Float.NaN;
+            }
+            final float scaleEven = (wc * 2 + wa) / totEvenW;
+            return vEven * (2f * scaleEven);
         }
     }
 
@@ -525,9 +542,7 @@ public class LaplacianPyramid {
 
         // expand the sum and and add the next larger grids
         for (int i = this.levels.length - 2; i >= 0; i--) {
-            GeoGrid grid = this.levels[i];
-            sum = LaplacianPyramid.expand(sum, grid.getCols(), grid.getRows());
-            LaplacianPyramid.sumGrids(sum, grid, null, 1, 0, 0, 1, 0, 0, 0, 0, null, i);
+            sum = LaplacianPyramid.expand(sum, this.levels[i], false);
         }
         return sum;
 
@@ -595,41 +610,88 @@ public class LaplacianPyramid {
     }
 
     /**
-     * Merge this Laplacian pyramid with another one, based on a mask.
+     * Merge this Laplacian pyramid with another one, based on a mask. The
+     * mask of each level samples every second cell of the mask of the
+     * previous level. Cells of the mask with a value of 1 along edges
+     * towards 0 receive a weight of 0.5. The weights are computed while 
+     * merging, without creating halved or marked grids.
      * @param pyramid
      * @param mask
      */
     public void merge(LaplacianPyramid pyramid, GeoGrid mask) {
 
+        final float[][] maskGrid = mask.getGrid();
+        int maskCols = mask.getCols();
+        int maskRows = mask.getRows();
         for (int i = 0; i < this.levels.length; i++) {
-
-            GeoGrid smoothMask = GridEdgeMarker.markEdges(mask);
-            GeoGrid grid1 = this.levels[i];
-            GeoGrid grid2 = pyramid.getLevels()[i];
-            final int cols = grid1.getCols();
-            final int rows = grid1.getRows();
-            for (int r = 0; r < rows; r++) {
-                for (int c = 0; c < cols; c++) {
-                    float w = smoothMask.getValue(c, r);
-                    float v = grid1.getValue(c, r) * w + grid2.getValue(c, r) * (1f - w);
-                    grid1.setValue(v, c, r);
-                }
-            }
-
-            /*try {
-            System.out.println("Mask: " + i + " " + mask.toString() + "\n");
-            GeoImage maskImg = (GeoImage) new GridToImageOperator().operate(smoothMask);
-            ImageIO.write(maskImg.getBufferedImage(), "png", new File("/Volumes/Macintosh HD/Users/jenny/Documents/Java/GridMerger/data/mask" + i + ".png"));
-            } catch (IOException ex) {
-            Logger.getLogger(LaplacianPyramid.class.getName()).log(Level.SEVERE, null, ex);
+            final float[][] grid1 = this.levels[i].getGrid();
+            final float[][] grid2 = pyramid.getLevels()[i].getGrid();
+            final int rows = this.levels[i].getRows();
+            final int step = 1 << i;
+            final int levelMaskCols = maskCols;
+            final int levelMaskRows = maskRows;
+
+            int nThreads = Math.max(1, Math.min(Runtime.getRuntime().availableProcessors(),
+                    rows / MIN_ROWS_PER_THREAD));
+            ArrayList<Thread> threads = new ArrayList<Thread>(nThreads);
+            int rowChunk = (rows / nThreads) + 1;
+            for (int t = 0; t < nThreads; t++) {
+                final int startRow = t * rowChunk;
+                final int endRow = Math.min(rows, startRow + rowChunk);
+                Thread thread = new Thread() {
+
+                    @Override
+                    public void run() {
+                        mergeRows(grid1, grid2, maskGrid, step,
+                                levelMaskCols, levelMaskRows, startRow, endRow);
+                    }
+                };
+                threads.add(thread);
+                thread.start();
             }
-             */
+            LaplacianPyramid.join(threads);
 
-            mask = HalveGrid.halve(mask);
+            maskCols /= 2;
+            maskRows /= 2;
         }
 
     }
 
+    /**
+     * Merges a band of rows of two grids.
+     * @param step The distance between two cells of the mask of this level in
+     * the mask of the first level.
+     * @param maskCols The number of columns of the mask of this level.
+     * @param maskRows The number of rows of the mask of this level.
+     */
+    private static void mergeRows(float[][] grid1, float[][] grid2,
+            float[][] mask, int step, int maskCols, int maskRows,
+            int startRow, int endRow) {
+
+        for (int r = startRow; r < endRow; r++) {
+            final float[] row1 = grid1[r];
+            final float[] row2 = grid2[r];
+            final boolean interiorRow = r > 0 && r < maskRows - 1;
+            for (int c = 0; c < row1.length; c++) {
+                float w = 0;
+                if (interiorRow && c > 0 && c < maskCols - 1) {
+                    final float[] maskRow = mask[r * step];
+                    if (maskRow[c * step] == 1f) {
+                        if (maskRow[(c - 1) * step] == 0
+                                || maskRow[(c + 1) * step] == 0
+                                || mask[(r - 1) * step][c * step] == 0
+                                || mask[(r + 1) * step][c * step] == 0) {
+                            w = 0.5f;
+                        } else {
+                            w = 1f;
+                        }
+                    }
+                }
+                row1[c] = row1[c] * w + row2[c] * (1f - w);
+            }
+        }
+    }
+
     public GeoGrid[] getLevels() {
         return levels;
     }
@@ -0,0 +1,279 @@
+/*
+ * SlidingRankFilter.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+package ika.geo.grid;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.logging.Level;
+import java.util.logging.Logger;
+
+/**
+ * Rank-order filters with a square moving window. The values of a band of
+ * rows are replaced by their ranks, and the ranks of the cells in the window
+ * are counted in a binary indexed tree. The window moves in a serpentine
+ * through the band, so that each step adds and removes one row or column of
+ * the window. The k-th smallest value or the rank of the central cell are
+ * found in logarithmic time. A step therefore costs O(filterSize log n)
+ * instead of O(filterSize^2) for copying and sorting the window.<br>
+ * The grid is mirrored at its border. Bands of rows are filtered in
+ * parallel.
+ */
+final class SlidingRankFilter {
+
+    /**
+     * Binary indexed tree counting the ranks of the values in the window. The
+     * first element is not used.
+     */
+    private int[] tree;
+
+    /**
+     * Number of distinct values in the band.
+     */
+    private int nbrValues;
+
+    /**
+     * The distinct values of the band in ascending order.
+     */
+    private float[] values;
+
+    private SlidingRankFilter() {
+    }
+
+    /**
+     * Stores the k-th smallest value of the window around each cell.
+     * @param src The source grid.
+     * @param dst The destination grid of the same size as src.
+     * @param filterSize The odd size of the window.
+     * @param k The rank of the value, starting with 0.
+     */
+    static void kthSmallest(float[][] src, float[][] dst, int filterSize, int k) {
+        run(src, dst, filterSize, k);
+    }
+
+    /**
+     * Stores the fraction of the values in the window around each cell that
+     * are smaller than the value of the cell.
+     * @param src The source grid.
+     * @param dst The destination grid of the same size as src.
+     * @param filterSize The odd size of the window.
+     */
+    static void relativeRank(float[][] src, float[][] dst, int filterSize) {
+        run(src, dst, filterSize, -1);
+    }
+
+    private static void run(float[][] src, float[][] dst, int filterSize, int k) {
+        final int rows = src.length;
+        if (rows == 0 || src[0].length == 0) {
+            return;
+        }
+        int nThreads = Runtime.getRuntime().availableProcessors();
+        ArrayList<FilterThread> threads = new ArrayList<FilterThread>(nThreads);
+        int rowChunk = (rows / nThreads) + 1;
+        for (int i = 0; i < nThreads; i++) {
+            int startRow = i * rowChunk;
+            int endRow = Math.min(rows, startRow + rowChunk);
+            if (startRow >= endRow) {
+                break;
+            }
+            FilterThread t = new FilterThread(src, dst, filterSize, k,
+                    startRow, endRow);
+            threads.add(t);
+            t.start();
+        }
+
+        for (Thread t : threads) {
+            try {
+                t.join();
+            } catch (InterruptedException ex) {
+                Logger.getLogger(SlidingRankFilter.class.getName()).log(Level.SEVERE, null, ex);
+            }
+        }
+    }
+
+    /**
+     * Mirrors an index at the border of the grid.
+     */
+    private static int mirror(int i, int n) {
+        i = i < 0 ? -i : (i >= n ? 2 * n - 2 - i : i);
+        return Math.max(0, Math.min(n - 1, i));
+    }
+
+    /**
+     * Filters a band of rows. If k is negative, the relative rank of the
+     * central cell is computed, otherwise the k-th smallest value.
+     */
+    private void filterBand(float[][] src, float[][] dst, int filterSize,
+            int k, int startRow, int endRow) {
+
+        final int rows = src.length;
+        final int cols = src[0].length;
+        final int h = filterSize / 2;
+
+        // source rows touched by the windows of this band
+        final int firstRow = Math.max(0, startRow - h);
+        final int lastRow = Math.min(rows - 1, endRow - 1 + h);
+
+        // indices of mirrored rows and columns
+        final int[] rowIdx = new int[endRow - startRow + 2 * h];
+        for (int i = 0; i < rowIdx.length; i++) {
+            rowIdx[i] = mirror(startRow - h + i, rows) - firstRow;
+        }
+        final int[] colIdx = new int[cols + 2 * h];
+        for (int i = 0; i < colIdx.length; i++) {
+            colIdx[i] = mirror(i - h, cols);
+        }
+
+        // replace values by their ranks among the distinct values of the band
+        final int nbrRows = lastRow - firstRow + 1;
+        values = new float[nbrRows * cols];
+        for (int r = 0; r < nbrRows; r++) {
+            final float[] srcRow = src[firstRow + r];
+            for (int c = 0; c < cols; c++) {
+                // -0 and +0 are the same value
+                values[r * cols + c] = srcRow[c] == 0f ? 0f : srcRow[c];
+            }
+        }
+        Arrays.sort(values);
+        nbrValues = 1;
+        for (int i = 1; i < values.length; i++) {
+            if (Float.compare(values[i], values[nbrValues - 1]) != 0) {
+                values[nbrValues++] = values[i];
+            }
+        }
+        final int[][] ranks = new int[nbrRows][cols];
+        for (int r = 0; r < nbrRows; r++) {
+            final float[] srcRow = src[firstRow + r];
+            for (int c = 0; c < cols; c++) {
+                final float v = srcRow[c] == 0f ? 0f : srcRow[c];
+                ranks[r][c] = Arrays.binarySearch(values, 0, nbrValues, v);
+            }
+        }
+        tree = new int[nbrValues + 1];
+
+        final float scale = 1f / (filterSize * filterSize - 1);
+        final int w = 2 * h;
+
+        // fill the first window
+        for (int i = 0; i <= w; i++) {
+            final int[] rankRow = ranks[rowIdx[i]];
+            for (int j = 0; j <= w; j++) {
+                add(rankRow[colIdx[j]], 1);
+            }
+        }
+
+        int col = 0;
+        for (int row = startRow; row < endRow; row++) {
+            final int ri = row - startRow;
+            final float[] dstRow = dst[row];
+
+            // move the window down by one row
+            if (ri > 0) {
+                final int[] oldRow = ranks[rowIdx[ri - 1]];
+                final int[] newRow = ranks[rowIdx[ri + w]];
+                for (int j = 0; j <= w; j++) {
+                    final int c = colIdx[col + j];
+                    add(oldRow[c], -1);
+                    add(newRow[c], 1);
+                }
+            }
+            final int[] centerRow = ranks[rowIdx[ri + h]];
+
+            // move along the row, alternating the direction
+            final boolean leftToRight = ri % 2 == 0;
+            for (;;) {
+                if (k < 0) {
+                    // nothing is smaller than NaN
+                    final int rank = centerRow[col];
+                    dstRow[col] = Float.isNaN(values[rank])
+                            ? 0 : countSmaller(rank) * scale;
+                } else {
+                    dstRow[col] = values[findKth(k)];
+                }
+                if (leftToRight) {
+                    if (col == cols - 1) {
+                        break;
+                    }
+                    for (int i = 0; i <= w; i++) {
+                        final int[] rankRow = ranks[rowIdx[ri + i]];
+                        add(rankRow[colIdx[col]], -1);
+                        add(rankRow[colIdx[col + w + 1]], 1);
+                    }
+                    ++col;
+                } else {
+                    if (col == 0) {
+                        break;
+                    }
+                    for (int i = 0; i <= w; i++) {
+                        final int[] rankRow = ranks[rowIdx[ri + i]];
+                        add(rankRow[colIdx[col + w]], -1);
+                        add(rankRow[colIdx[col - 1]], 1);
+                    }
+                    --col;
+                }
+            }
+        }
+    }
+
+    private void add(int rank, int delta) {
+        for (int i = rank + 1; i <= nbrValues; i += i & -i) {
+            tree[i] += delta;
+        }
+    }
+
+    /**
+     * Returns the number of values in the window with a rank smaller than
+     * the passed rank.
+     */
+    private int countSmaller(int rank) {
+        int n = 0;
+        for (int i = rank; i > 0; i -= i & -i) {
+            n += tree[i];
+        }
+        return n;
+    }
+
+    /**
+     * Returns the rank of the k-th smallest value in the window.
+     */
+    private int findKth(int k) {
+        int pos = 0;
+        for (int step = Integer.highestOneBit(nbrValues); step > 0; step >>= 1) {
+            final int next = pos + step;
+            if (next <= nbrValues && tree[next] <= k) {
+                pos = next;
+                k -= tree[next];
+            }
+        }
+        return pos;
+    }
+
+    private static class FilterThread extends Thread {
+
+        private final float[][] src;
+        private final float[][] dst;
+        private final int filterSize;
+        private final int k;
+        private final int startRow;
+        private final int endRow;
+
+        public FilterThread(float[][] src, float[][] dst, int filterSize, int k,
+                int startRow, int endRow) {
+            this.src = src;
+            this.dst = dst;
+            this.filterSize = filterSize;
+            this.k = k;
+            this.startRow = startRow;
+            this.endRow = endRow;
+        }
+
+        @Override
+        public void run() {
+            new SlidingRankFilter().filterBand(src, dst, filterSize, k,
+                    startRow, endRow);
+        }
+    }
+}
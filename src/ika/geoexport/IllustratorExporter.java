@@ -13,7 +13,6 @@ import ika.gui.PageFormat;
 import java.io.*;
 import java.awt.geom.*;
 import java.awt.*;
-import java.text.DecimalFormat;
 import java.util.*;
 
 /**
@@ -22,11 +21,20 @@ import java.util.*;
  */
 public class IllustratorExporter extends VectorGraphicsExporter {
 
+    /**
+     * Line separator used by PrintWriter.println.
+     */
+    private static final String LINE_SEPARATOR = System.getProperty("line.separator");
+
     /* to keep track of current drawing settings. */
     private Color currentFillColor;
     private Color currentStrokeColor;
     private float currentStrokeWidth;
-    private DecimalFormat coordinateFormat;
+
+    /**
+     * The destination while exporting.
+     */
+    private PrintWriter outputWriter;
     /**
      * Count the number of layers created.
      */
@@ -36,10 +44,6 @@ public class IllustratorExporter extends VectorGraphicsExporter {
      * Creates a new instance of IllustratorExporter.
      */
     public IllustratorExporter() {
-        coordinateFormat = new DecimalFormat();
-        coordinateFormat.setGroupingUsed(false);
-        coordinateFormat.getDecimalFormatSymbols().setDecimalSeparator('.');
-        coordinateFormat.setDecimalSeparatorAlwaysShown(false);
     }
 
     public String getFileFormatName() {
@@ -58,6 +62,7 @@ public class IllustratorExporter extends VectorGraphicsExporter {
         this.currentFillColor = null;
         this.currentStrokeColor = null;
         this.currentStrokeWidth = 0;
+        this.outputWriter = writer;
 
 // HEADER
         // start the header
@@ -124,6 +129,7 @@ public class IllustratorExporter extends VectorGraphicsExporter {
         writer.println("%%EOF");
 
         writer.flush();
+        this.outputWriter = null;
     }
 
     /**
@@ -177,7 +183,9 @@ public class IllustratorExporter extends VectorGraphicsExporter {
                     usingNonGeoSetLayer = true;
                 }
 
-                if (obj instanceof GeoPath) {
+                if (!hasFiniteAnchor(obj)) {
+                    // skip points and texts without a valid position
+                } else if (obj instanceof GeoPath) {
                     writeGeoPath((GeoPath) obj, writer);
                 } else if (obj instanceof GeoPoint) {
                     writeGeoPoint((GeoPoint) obj, writer);
@@ -222,32 +230,60 @@ public class IllustratorExporter extends VectorGraphicsExporter {
         writer.println("%AI5_EndLayer--");
     }
 
-    /** Write a GeoSet and all its children.
+    /** Write a GeoSet and all its children. The geometry of paths and points
+     * is converted in parallel.
      */
     private void writeGeoSet(GeoSet geoSet, PrintWriter writer) {
+        try {
+            this.writeChildren(geoSet);
+        } catch (IOException exc) {
+            // PrintWriter does not throw IOExceptions
+            throw new IllegalStateException(exc);
+        }
+    }
 
-        final int nbrObj = geoSet.getNumberOfChildren();
-        for (int i = 0; i < nbrObj; i++) {
-            GeoObject obj = geoSet.getGeoObject(i);
-
-            // only write visible elements
-            if (obj.isVisible() == false) {
-                continue;
+    /**
+     * Converts the geometry of GeoPaths and GeoPoints, including painting
+     * operators, but without painting attributes.
+     */
+    @Override
+    protected String geometryToString(GeoObject obj) {
+        if (obj instanceof GeoPath) {
+            GeoPath geoPath = (GeoPath) obj;
+            if (geoPath.getDrawingInstructionCount() == 0) {
+                return null;
             }
+            return this.pathToString(geoPath.getIterator(), geoPath.isCompound(),
+                    geoPath.getVectorSymbol());
+        } else if (obj instanceof GeoPoint) {
+            GeoPoint geoPoint = (GeoPoint) obj;
+            PointSymbol pointSymbol = geoPoint.getPointSymbol();
+            GeoPath geoPath = pointSymbol.getPointSymbol(this.getDisplayMapScale(),
+                    geoPoint.getX(), geoPoint.getY());
+            return this.pathToString(geoPath.getIterator(), geoPath.isCompound(),
+                    pointSymbol);
+        }
+        return null;
+    }
 
-            if (obj instanceof GeoSet) {
-                writeGeoSet((GeoSet) obj, writer);
-            } else if (obj instanceof GeoPath) {
-                writeGeoPath((GeoPath) obj, writer);
-            } else if (obj instanceof GeoPoint) {
-                writeGeoPoint((GeoPoint) obj, writer);
-            } else if (obj instanceof GeoText) {
-                writeGeoText((GeoText) obj, writer);
-            } else if (obj instanceof GeoImage) {
-                writeGeoImage((GeoImage) obj, writer);
+    @Override
+    protected void writeConverted(GeoObject obj, String geometry) {
+        PrintWriter writer = this.outputWriter;
+        if (obj instanceof GeoPath) {
+            if (geometry != null) {
+                this.writePaintingAttributes(((GeoPath) obj).getVectorSymbol(), writer);
+                writer.print(geometry);
+                this.writeName(obj, writer);
             }
+        } else if (obj instanceof GeoPoint) {
+            this.writePaintingAttributes(((GeoPoint) obj).getPointSymbol(), writer);
+            writer.print(geometry);
+            this.writeName(obj, writer);
+        } else if (obj instanceof GeoText) {
+            writeGeoText((GeoText) obj, writer);
+        } else if (obj instanceof GeoImage) {
+            writeGeoImage((GeoImage) obj, writer);
         }
-
     }
 
     /**
@@ -546,7 +582,24 @@ public class IllustratorExporter extends VectorGraphicsExporter {
             VectorSymbol vectorSymbol,
             PrintWriter writer) {
 
+        // write colors and stroke width if necessary.
+        this.writePaintingAttributes(vectorSymbol, writer);
+        writer.print(this.pathToString(pi, compound, vectorSymbol));
+    }
+
+    /** Converts a path iterator to a string with path and painting 
+     * operators. Painting attributes are not included. This does not change
+     * the state of this exporter.
+     * @param pi The GeoPathIterator to convert.
+     * @param compound True if the path consists of multiple compound paths.
+     * @param vectorSymbol The VectorSymbol specifying the appearance of pi.
+     */
+    private String pathToString(GeoPathIterator pi,
+            boolean compound,
+            VectorSymbol vectorSymbol) {
+
         final int UNDEF_SEG_TYPE = -999;
+        StringBuilder writer = new StringBuilder();
 
         // remember the last written segment type and the point position.
         int lastSegmentType = UNDEF_SEG_TYPE;
@@ -554,16 +607,46 @@ public class IllustratorExporter extends VectorGraphicsExporter {
         double lastMoveToY = 0;
         double lastEndX = 0;
         double lastEndY = 0;
-        // write colors and stroke width if necessary.
-        this.writePaintingAttributes(vectorSymbol, writer);
 
         if (compound) {
-            writer.print("*u\n");
+            writer.append("*u\n");
         }
 
+        // after a skipped segment with non-finite coordinates, the pen is
+        // lifted and the current subpath is broken
+        boolean penLifted = true;
+        boolean brokenSubpath = false;
+
         // write geometry
         do {
             final int segmentType = pi.getInstruction();
+            if (!isFiniteSegment(pi)) {
+                penLifted = true;
+                brokenSubpath = true;
+                continue;
+            }
+            if (segmentType == GeoPathModel.CLOSE) {
+                if (penLifted || brokenSubpath) {
+                    continue;
+                }
+            } else if (segmentType == GeoPathModel.MOVETO) {
+                penLifted = false;
+                brokenSubpath = false;
+            } else if (penLifted) {
+                // paint the previous partial path and restart the subpath
+                // at the end of this segment
+                if (lastSegmentType != GeoPathModel.CLOSE
+                        && lastSegmentType != GeoPathModel.MOVETO
+                        && lastSegmentType != UNDEF_SEG_TYPE) {
+                    this.writeFillStroke(vectorSymbol, false, writer);
+                }
+                lastMoveToX = lastEndX = getSegmentEndX(pi);
+                lastMoveToY = lastEndY = getSegmentEndY(pi);
+                this.writeCoordinate(lastMoveToX, lastMoveToY, "m", writer);
+                lastSegmentType = GeoPathModel.MOVETO;
+                penLifted = false;
+                continue;
+            }
             switch (segmentType) {
                 case GeoPathModel.CLOSE:
                     if (lastSegmentType == GeoPathModel.CLOSE
@@ -621,13 +704,15 @@ public class IllustratorExporter extends VectorGraphicsExporter {
         } while (pi.next());
 
         if (lastSegmentType != GeoPathModel.CLOSE
-                && lastSegmentType != GeoPathModel.MOVETO) {
+                && lastSegmentType != GeoPathModel.MOVETO
+                && lastSegmentType != UNDEF_SEG_TYPE) {
             this.writeFillStroke(vectorSymbol, false, writer);
         }
         // close the compound path
         if (compound) {
-            writer.print("*U\n");
+            writer.append("*U\n");
         }
+        return writer.toString();
     }
 
     /**
@@ -682,28 +767,35 @@ public class IllustratorExporter extends VectorGraphicsExporter {
      * Transforms a pair of coordinate to sheet coordinates, and writes them
      * using the specified operator.
      */
-    private void writeCoordinate(double x, double y, String operator, PrintWriter writer) {
+    private void writeCoordinate(double x, double y, String operator, StringBuilder writer) {
         writeCoordinate(x, y, writer);
-        writer.println(operator);
+        writer.append(operator);
+        writer.append(LINE_SEPARATOR);
     }
 
     /**
      * Transforms a pair of coordinate to sheet coordinates, and writes them.
      */
-    private void writeCoordinate(double x, double y, PrintWriter writer) {
-        // apply offset and scale
-        x = xToPageRoundedPx(x);
-        y = yToPageRoundedPx(y);
+    private void writeCoordinate(double x, double y, StringBuilder writer) {
+        // apply offset and scale, and round
+        appendRounded(writer, xToPagePx(x));
+        writer.append(' ');
+        appendRounded(writer, yToPagePx(y));
+        writer.append(' ');
+    }
 
-        writer.print(coordinateFormat.format(x));
-        writer.print(" ");
-        writer.print(coordinateFormat.format(y));
-        writer.print(" ");
+    /**
+     * Transforms a pair of coordinate to sheet coordinates, and writes them.
+     */
+    private void writeCoordinate(double x, double y, PrintWriter writer) {
+        StringBuilder str = new StringBuilder();
+        writeCoordinate(x, y, str);
+        writer.print(str);
     }
 
     /** Writes commands to stroke and / or fill the last geometry.
      */
-    private void writeFillStroke(VectorSymbol symbol, boolean close, PrintWriter writer) {
+    private void writeFillStroke(VectorSymbol symbol, boolean close, StringBuilder writer) {
         if (symbol == null) {
             return;
         }
@@ -723,7 +815,8 @@ public class IllustratorExporter extends VectorGraphicsExporter {
             paintingOperator = close ? "n" : "N";
         }
 
-        writer.println(paintingOperator);
+        writer.append(paintingOperator);
+        writer.append(LINE_SEPARATOR);
     }
 
     /**
@@ -9,15 +9,17 @@ package ika.geoexport;
 import com.lowagie.text.Document;
 import com.lowagie.text.DocumentException;
 import com.lowagie.text.pdf.PdfContentByte;
+import com.lowagie.text.pdf.PdfTemplate;
 import com.lowagie.text.pdf.PdfWriter;
 import ika.geo.*;
 import java.awt.*;
-import java.awt.geom.*;
 import java.io.IOException;
 import java.io.OutputStream;
 
 /**
- *
+ * Exporter for the PDF file format. Each top-level GeoSet is drawn to a
+ * separate template that is written to the output stream as soon as it is
+ * complete. The geometry of paths is converted to PDF operators in parallel.
  * @author jenny
  */
 public class PDFExporter extends VectorGraphicsExporter {
@@ -27,6 +29,11 @@ public class PDFExporter extends VectorGraphicsExporter {
     private Color currentStrokeColor;
     private float currentStrokeWidth;
 
+    /**
+     * The content that is currently written to.
+     */
+    private PdfContentByte currentContent;
+
     /** Creates a new instance of PDFExporter */
     public PDFExporter() {
     }
@@ -92,12 +99,13 @@ public class PDFExporter extends VectorGraphicsExporter {
             PdfContentByte cb = writer.getDirectContent();
 
             // write the GeoObjects
-            writeGeoSet(geoSet, cb);
+            writeTopLevelGeoSet(geoSet, writer, cb, w, h);
 
         } catch (DocumentException de) {
             System.err.println(de.getMessage());
             throw new IOException(de.getMessage());
         } finally {
+            currentContent = null;
             // close the document
             if (document != null) {
                 document.close();
@@ -105,9 +113,13 @@ public class PDFExporter extends VectorGraphicsExporter {
         }
     }
 
-    /** Write a GeoSet and all its children.
+    /**
+     * Writes the children of the top-level GeoSet. GeoSets are drawn to
+     * templates that are released to the output stream immediately, which 
+     * avoids accumulating the content of the whole page in memory.
      */
-    private void writeGeoSet(GeoSet geoSet, PdfContentByte cb) {
+    private void writeTopLevelGeoSet(GeoSet geoSet, PdfWriter writer,
+            PdfContentByte cb, float w, float h) throws IOException {
 
         final int nbrObj = geoSet.getNumberOfChildren();
         for (int i = 0; i < nbrObj; i++) {
@@ -119,16 +131,53 @@ public class PDFExporter extends VectorGraphicsExporter {
             }
 
             if (obj instanceof GeoSet) {
-                writeGeoSet((GeoSet) obj, cb);
-            } else if (obj instanceof GeoPath) {
-                writeGeoPath((GeoPath) obj, cb);
-            } else if (obj instanceof GeoPoint) {
-                writeGeoPoint((GeoPoint) obj, cb);
-            } else if (obj instanceof GeoText) {
-                writeGeoText((GeoText) obj, cb);
-            } else if (obj instanceof GeoImage) {
-                writeGeoImage((GeoImage) obj, cb);
+                // a template starts with the default graphics state
+                PdfTemplate template = cb.createTemplate(w, h);
+                currentFillColor = null;
+                currentContent = template;
+                writeChildren((GeoSet) obj);
+                cb.addTemplate(template, 0, 0);
+                writer.releaseTemplate(template);
+                currentFillColor = null;
+            } else {
+                currentContent = cb;
+                writeConverted(obj, geometryToString(obj));
+            }
+        }
+    }
+
+    /**
+     * Converts the geometry of GeoPaths and GeoPoints to PDF path 
+     * construction and painting operators.
+     */
+    @Override
+    protected String geometryToString(GeoObject obj) {
+        if (obj instanceof GeoPath) {
+            GeoPath geoPath = (GeoPath) obj;
+            if (geoPath.getDrawingInstructionCount() == 0) {
+                return null;
             }
+            return pathToString(geoPath.getIterator(), geoPath.getVectorSymbol());
+        } else if (obj instanceof GeoPoint) {
+            GeoPoint geoPoint = (GeoPoint) obj;
+            PointSymbol pointSymbol = geoPoint.getPointSymbol();
+            GeoPath geoPath = pointSymbol.getPointSymbol(getDisplayMapScale(),
+                    geoPoint.getX(), geoPoint.getY());
+            return pathToString(geoPath.getIterator(), pointSymbol);
+        }
+        return null;
+    }
+
+    @Override
+    protected void writeConverted(GeoObject obj, String geometry) {
+        if (obj instanceof GeoPath) {
+            writePath(geometry, ((GeoPath) obj).getVectorSymbol(), currentContent);
+        } else if (obj instanceof GeoPoint) {
+            writePath(geometry, ((GeoPoint) obj).getPointSymbol(), currentContent);
+        } else if (obj instanceof GeoText) {
+            writeGeoText((GeoText) obj, currentContent);
+        } else if (obj instanceof GeoImage) {
+            writeGeoImage((GeoImage) obj, currentContent);
         }
     }
 
@@ -288,86 +337,123 @@ public class PDFExporter extends VectorGraphicsExporter {
          **/
     }
 
-    /**
-     * Write a GeoPoint.
+    /** Write a path converted by pathToString.
      */
-    private void writeGeoPoint(GeoPoint geoPoint, PdfContentByte cb) {
-        PointSymbol pointSymbol = geoPoint.getPointSymbol();
-        GeoPath geoPath = pointSymbol.getPointSymbol(getDisplayMapScale(),
-                geoPoint.getX(), geoPoint.getY());
-        GeoPathIterator pi = geoPath.getIterator();
-        writePathIterator(pi, pointSymbol, cb);
-    }
-
-    /** Write a GeoPath.
-     */
-    private void writeGeoPath(GeoPath geoPath, PdfContentByte cb) {
-        GeoPathIterator pi = geoPath.getIterator();
-        writePathIterator(pi, geoPath.getVectorSymbol(), cb);
+    private void writePath(String geometry, VectorSymbol vectorSymbol,
+            PdfContentByte cb) {
+        if (geometry == null) {
+            return;
+        }
+        // write colors and stroke width if necessary.
+        writePaintingAttributes(vectorSymbol, cb);
+        cb.setLiteral(geometry);
     }
 
-    /** Write a path describing a graphic objects of straight lines,
-     * Bezier curves, potentially with holes and islands.
-     * @param iterator The path iterator to write.
+    /** Converts a path describing a graphic objects of straight lines,
+     * Bezier curves, potentially with holes and islands to PDF operators. 
+     * This does not change the state of this exporter.
+     * @param iterator The path iterator to convert.
      * @param vectorSymbol The VectorSymbol specifying the appearance of pi.
      */
-    private void writePathIterator(GeoPathIterator iterator,
-            VectorSymbol vectorSymbol, PdfContentByte cb) {
+    private String pathToString(GeoPathIterator iterator,
+            VectorSymbol vectorSymbol) {
 
-        // write colors and stroke width if necessary.
-        writePaintingAttributes(vectorSymbol, cb);
+        StringBuilder str = new StringBuilder();
 
-        // write the path
-        // remember the last written segment type and the point position.
+        // remember the last written segment type.
         int lastSegmentType = GeoPathModel.NONE;
+        
+        // after a skipped segment with non-finite coordinates, the pen is
+        // lifted and the current subpath is broken
+        boolean penLifted = true;
+        boolean brokenSubpath = false;
         do {
             final int type = iterator.getInstruction();
+            if (!isFiniteSegment(iterator)) {
+                penLifted = true;
+                brokenSubpath = true;
+                continue;
+            }
+            if (type == GeoPathModel.CLOSE) {
+                if (penLifted || brokenSubpath) {
+                    continue;
+                }
+            } else if (type == GeoPathModel.MOVETO) {
+                penLifted = false;
+                brokenSubpath = false;
+            } else if (penLifted) {
+                // paint the previous partial path and restart the subpath 
+                // at the end of this segment
+                if (lastSegmentType != GeoPathModel.CLOSE
+                        && lastSegmentType != GeoPathModel.MOVETO
+                        && lastSegmentType != GeoPathModel.NONE) {
+                    appendFillStroke(vectorSymbol, str);
+                }
+                appendPoint(getSegmentEndX(iterator), getSegmentEndY(iterator), str);
+                str.append("m\n");
+                lastSegmentType = GeoPathModel.MOVETO;
+                penLifted = false;
+                continue;
+            }
             switch (type) {
                 case GeoPathModel.CLOSE:
-                    cb.closePath();
-                    writeFillStroke(vectorSymbol, true, cb); // !!! ??? needed?
+                    str.append("h\n");
+                    appendFillStroke(vectorSymbol, str);
                     break;
 
                 case GeoPathModel.MOVETO:
-                    writeFillStroke(vectorSymbol, false, cb);// !!! ??? needed?
+                    // paint previous partial path
+                    if (lastSegmentType != GeoPathModel.CLOSE
+                            && lastSegmentType != GeoPathModel.MOVETO
+                            && lastSegmentType != GeoPathModel.NONE) {
+                        appendFillStroke(vectorSymbol, str);
+                    }
                     // start defintion of new path
-                    cb.moveTo((float) xToPagePx(iterator.getX()),
-                            (float) yToPagePx(iterator.getY()));
+                    appendPoint(iterator.getX(), iterator.getY(), str);
+                    str.append("m\n");
                     break;
 
                 case GeoPathModel.LINETO:
-                    cb.lineTo((float) xToPagePx(iterator.getX()),
-                            (float) yToPagePx(iterator.getY()));
+                    appendPoint(iterator.getX(), iterator.getY(), str);
+                    str.append("l\n");
                     break;
 
                 case GeoPathModel.QUADCURVETO:
-                    cb.curveTo((float) xToPagePx(iterator.getX()),
-                            (float) yToPagePx(iterator.getY()),
-                            (float) xToPagePx(iterator.getX2()),
-                            (float) yToPagePx(iterator.getY2()));
+                    appendPoint(iterator.getX(), iterator.getY(), str);
+                    appendPoint(iterator.getX2(), iterator.getY2(), str);
+                    str.append("v\n");
                     break;
 
                 case GeoPathModel.CURVETO:
-                    cb.curveTo((float) xToPagePx(iterator.getX()),
-                            (float) yToPagePx(iterator.getY()),
-                            (float) xToPagePx(iterator.getX2()),
-                            (float) yToPagePx(iterator.getY2()),
-                            (float) xToPagePx(iterator.getX3()),
-                            (float) yToPagePx(iterator.getY3()));
+                    appendPoint(iterator.getX(), iterator.getY(), str);
+                    appendPoint(iterator.getX2(), iterator.getY2(), str);
+                    appendPoint(iterator.getX3(), iterator.getY3(), str);
+                    str.append("c\n");
                     break;
             }
             lastSegmentType = type;
         } while (iterator.next());
 
-        if (lastSegmentType != PathIterator.SEG_CLOSE
-                && lastSegmentType != PathIterator.SEG_MOVETO) {
-            writeFillStroke(vectorSymbol, false, cb);
+        if (lastSegmentType != GeoPathModel.CLOSE
+                && lastSegmentType != GeoPathModel.MOVETO
+                && lastSegmentType != GeoPathModel.NONE) {
+            appendFillStroke(vectorSymbol, str);
         }
+        return str.toString();
     }
 
-    /** Writes commands to stroke and / or fill the last geometry.
+    /** Appends a point transformed to page coordinates.
      */
-    private void writeFillStroke(VectorSymbol symbol, boolean close, PdfContentByte cb) {
+    private void appendPoint(double x, double y, StringBuilder str) {
+        appendRounded(str, xToPagePx(x));
+        str.append(' ');
+        appendRounded(str, yToPagePx(y));
+        str.append(' ');
+    }
+
+    /** Appends the operator to stroke and / or fill the last geometry.
+     */
+    private void appendFillStroke(VectorSymbol symbol, StringBuilder str) {
         if (symbol == null) {
             return;
         }
@@ -376,13 +462,15 @@ public class PDFExporter extends VectorGraphicsExporter {
         final boolean stroke = symbol.isStroked();
 
         if (fill && stroke) {
-            cb.fillStroke();
+            str.append("B\n");
         } else if (fill) {
-            cb.fill();
+            str.append("f\n");
         } else if (stroke) {
-            cb.stroke();
-        } else // nothing: invisible element
-            ;
+            str.append("S\n");
+        } else {
+            // invisible element: end the path without painting
+            str.append("n\n");
+        }
     }
 
     /**
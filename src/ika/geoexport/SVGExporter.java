@@ -5,14 +5,12 @@ import ika.utils.*;
 import java.awt.*;
 import java.awt.geom.*;
 import java.io.*;
-import javax.xml.parsers.*;
-import javax.xml.transform.*;
-import javax.xml.transform.dom.*;
-import javax.xml.transform.stream.*;
-import org.w3c.dom.*;
 
 /**
- * Exporter for the SVG file format.
+ * Exporter for the SVG file format. The SVG document is streamed to the
+ * output stream while the GeoSet tree is traversed; no DOM is built in memory.
+ * Consecutive paths with identical symbolization share the style attributes
+ * of an enclosing g element.
  */
 public class SVGExporter extends VectorGraphicsExporter {
 
@@ -30,6 +28,27 @@ public class SVGExporter extends VectorGraphicsExporter {
     protected static String XLINKNAMESPACE = "http://www.w3.org/1999/xlink";
     protected static String XMLEVENTSNAMESPACE = "http://www.w3.org/2001/xml-events";
 
+    /**
+     * Number of spaces to indent nested elements.
+     */
+    private static final int INDENTATION = 2;
+
+    /**
+     * The destination while exporting.
+     */
+    private Writer writer;
+
+    /**
+     * The depth of the currently written element in the tree.
+     */
+    private int depth;
+
+    /**
+     * The style attributes of the currently open g element shared by
+     * consecutive paths, or null if no such element is open.
+     */
+    private String currentStyle;
+
 //    private static String svgIdentifier = "-//W3C//DTD SVG 1.0//EN";
 //    private static String svgDTD = "http://www.w3.org/TR/2001/REC-SVG-20010904/DTD/svg10.dtd";
     public SVGExporter() {
@@ -43,19 +62,6 @@ public class SVGExporter extends VectorGraphicsExporter {
         return "svg";
     }
 
-    /**
-     * Give derived classes an option to provide own Document.
-     *
-     * @return
-     */
-    protected Document createDocument() throws ParserConfigurationException {
-        // create a document
-        DocumentBuilderFactory factory = DocumentBuilderFactory.newInstance();
-        DocumentBuilder builder = factory.newDocumentBuilder();
-        return builder.newDocument();
-
-    }
-
     /**
      * Exports a GeoSet to a new SVG file.
      *
@@ -67,324 +73,339 @@ public class SVGExporter extends VectorGraphicsExporter {
     protected void write(GeoSet geoSet, OutputStream outputStream)
             throws IOException {
         try {
-            Document document = createDocument();
+            this.writer = new BufferedWriter(
+                    new OutputStreamWriter(outputStream, "utf-8"), 64 * 1024);
+            this.depth = 0;
+            this.currentStyle = null;
+
+            // don't add doctype to SVG files. see http://jwatt.org/svg/authoring/
+            writer.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
 
             // construct the SVG root element
-            Element svgRootElement = createSVGRootElement(geoSet, document);
-            document.appendChild(svgRootElement);
+            writeSVGRootElementStart();
 
             // add content to SVG root element
-            addSVGContent(geoSet, document, svgRootElement);
-
-            // Prepare the output file
-            OutputStreamWriter outputStreamWriter =
-                    new OutputStreamWriter(outputStream, "utf-8");
-            StreamResult result = new StreamResult(outputStreamWriter);
-
-            // Write the DOM document to the file
-            /*
-             There is a bug in Java 1.5: XML output is not indented.
-             To work around this bug:
-             http://bugs.sun.com/bugdatabase/view_bug.do?bug_id=6296446
-             (1)set the indent-number in the transformerfactory
-             TransformerFactory tf = new TransformerFactory.newInstance();
-             tf.setAttribute("indent-number", new Integer(2));
-             (2)enable the indent in the transformer
-             Transformer t = tf.newTransformer();
-             t.setOutputProperty(OutputKeys.INDENT, "yes");
-             (3)wrap the otuputstream with a writer (or bufferedwriter)
-             t.transform(new DOMSource(doc),
-             new StreamResult(new OutputStreamWriter(out, "utf-8"));
-             You must do (3) to workaround a "buggy" behavior of the
-             xml handling code.
-             */
-
-            TransformerFactory tf = TransformerFactory.newInstance();
-            tf.setAttribute("indent-number", new Integer(2));
-            Transformer xformer = tf.newTransformer();
-            xformer.setOutputProperty(OutputKeys.INDENT, "yes");
-            Source source = new DOMSource(document);
-            xformer.transform(source, result);
-
-            // don't add doctype to SVG files. see http://jwatt.org/svg/authoring/
-            /*
-             xformer.setOutputProperty(OutputKeys.DOCTYPE_PUBLIC, svgIdentifier);
-             xformer.setOutputProperty(OutputKeys.DOCTYPE_SYSTEM, svgDTD);
-             */
-
-            outputStreamWriter.flush();
+            addSVGContent(geoSet);
 
+            writer.write("</svg>\n");
+            writer.flush();
+        } catch (IOException e) {
+            throw e;
         } catch (Exception e) {
             String msg = e.getMessage() != null ? e.getMessage() : e.getClass().toString();
             throw new IOException("Export to SVG not possible. " + msg);
+        } finally {
+            this.writer = null;
         }
     }
 
     /**
-     * Creates the top level SVG element.
+     * Writes the start tag of the top level SVG element.
      */
-    protected Element createSVGRootElement(GeoSet geoSet, Document document) {
-        // create the main svg element
-        Element svg = (Element) document.createElementNS(SVGNAMESPACE, "svg");
+    protected void writeSVGRootElementStart() throws IOException {
+
+        final double wWC = pageFormat.getPageWidthWorldCoordinates();
+        final double hWC = pageFormat.getPageHeightWorldCoordinates();
+        final double w = dimToPageRoundedPx((float) wWC);
+        final double h = dimToPageRoundedPx((float) hWC);
 
         // specify a namespace prefix on the 'svg' element, which means that
         // SVG is the default namespace for all elements within the scope of
         // the svg element with the xmlns attribute:
         // See http://www.w3.org/TR/SVG11/struct.html#SVGElement
         // and http://jwatt.org/svg/authoring/
-        svg.setAttribute("xmlns", SVGNAMESPACE);
-        svg.setAttribute("xmlns:xlink", XLINKNAMESPACE);
-        svg.setAttribute("xmlns:ev", XMLEVENTSNAMESPACE);
-        svg.setAttribute("version", "1.0");
-        svg.setAttribute("preserveAspectRatio", "xMinYMin");
-
-        final double wWC = pageFormat.getPageWidthWorldCoordinates();
-        final double hWC = pageFormat.getPageHeightWorldCoordinates();
-        final double w = dimToPageRoundedPx((float) wWC);
-        final double h = dimToPageRoundedPx((float) hWC);
-        svg.setAttribute("width", Double.toString(w));
-        svg.setAttribute("height", Double.toString(h));
+        StringBuilder str = new StringBuilder();
+        str.append("<svg");
+        appendAttribute(str, "xmlns", SVGNAMESPACE);
+        appendAttribute(str, "xmlns:xlink", XLINKNAMESPACE);
+        appendAttribute(str, "xmlns:ev", XMLEVENTSNAMESPACE);
+        appendAttribute(str, "version", "1.0");
+        appendAttribute(str, "preserveAspectRatio", "xMinYMin");
+        appendAttribute(str, "width", Double.toString(w));
+        appendAttribute(str, "height", Double.toString(h));
 
         // Define the viewBox.
-        String viewBoxStr = "0 0 " + w + " " + h;
-        svg.setAttribute("viewBox", viewBoxStr);
+        appendAttribute(str, "viewBox", "0 0 " + w + " " + h);
+        str.append(">\n");
+        writer.write(str.toString());
+        ++depth;
+    }
+
+    protected void addSVGContent(GeoSet geoSet) throws IOException {
 
-        return svg;
+        // add a description element
+        appendDescription();
+
+        // convert GeoSet to SVG
+        writeGeoSet(geoSet);
     }
 
     /**
-     * The default implementation simply creates a g element. Derived classes
-     * may overwrite this.
+     * Writes a GeoSet as a g element.
+     *
+     * @param geoSet The GeoSet to write.
      */
-    protected Element createSVGGroupElement(GeoSet geoSet, Document document) {
+    protected void writeGeoSet(GeoSet geoSet) throws IOException {
+
         // don't write invisible or empty GeoSets
         if (!geoSet.hasVisibleGeoObjects()) {
-            return null;
+            return;
         }
 
-        return document.createElementNS(SVGNAMESPACE, "g");
-    }
-
-    protected void finish(GeoSet geoSet, Document doc,
-            Element element) {
-    }
-
-    protected void finish(GeoPath geoPath, Document doc,
-            Element element) {
-    }
+        closeStyleGroup();
+        writeIndentation();
+        writer.write("<g>\n");
+        ++depth;
 
-    protected void finish(GeoPoint geoPoint, Document doc,
-            Element element) {
-    }
+        writeChildren(geoSet);
 
-    protected void finish(GeoText geoText, Document doc,
-            Element element) {
+        closeStyleGroup();
+        --depth;
+        writeIndentation();
+        writer.write("</g>\n");
     }
 
-    protected void addSVGContent(GeoSet geoSet, Document document, Element svgRootElement) throws IOException {
-
-        // add a description element
-        appendDescription(svgRootElement, document);
-
-        // convert GeoSet to SVG DOM
-        writeGeoSet(geoSet, svgRootElement, document);
+    @Override
+    protected void writeChildGeoSet(GeoSet geoSet) throws IOException {
+        writeGeoSet(geoSet);
     }
 
-    protected void writeGeoObject(GeoObject obj, Element parent, Document doc) throws IOException {
+    /**
+     * Converts the geometry of GeoPaths and GeoPoints to the content of the d
+     * attribute of a path element.
+     */
+    @Override
+    protected String geometryToString(GeoObject obj) {
         if (obj instanceof GeoPath) {
-            writeGeoPath((GeoPath) obj, parent, doc);
-        } else if (obj instanceof GeoImage) {
-            writeGeoImage((GeoImage) obj, parent, doc);
+            GeoPath geoPath = (GeoPath) obj;
+            if (geoPath.getDrawingInstructionCount() == 0) {
+                return null;
+            }
+            return convertPathIteratorToSVG(geoPath.getIterator());
         } else if (obj instanceof GeoPoint) {
-            writeGeoPoint((GeoPoint) obj, parent, doc);
-        } else if (obj instanceof GeoText) {
-            writeGeoText((GeoText) obj, parent, doc);
+            // Unfortunately Illustrator CS does not support SVG symbols correctly.
+            // Therefore don't write SVG symbols, but convert GeoPoints to
+            // normal graphics.
+            GeoPoint geoPoint = (GeoPoint) obj;
+            PointSymbol pointSymbol = geoPoint.getPointSymbol();
+            GeoPath geoPath = pointSymbol.getPointSymbol(getDisplayMapScale(),
+                    geoPoint.getX(), geoPoint.getY());
+            return convertPathIteratorToSVG(geoPath.getIterator());
         }
+        return null;
     }
 
-    /**
-     * Converts a GeoSet to a SVG DOM.
-     *
-     * @param geoSet The GeoSet to convert.
-     * @param parent The parent element that will contain the passed GeoSet.
-     * @param document The DOM.
-     */
-    protected void writeGeoSet(GeoSet geoSet, Element parent, Document document) throws IOException {
-
-        Element g = createSVGGroupElement(geoSet, document);
-        if (g == null) {
-            return;
-        }
-        parent.appendChild(g);
-
-        final int nbrObj = geoSet.getNumberOfChildren();
-        for (int i = 0; i < nbrObj; i++) {
-            GeoObject obj = geoSet.getGeoObject(i);
-
-            // only write visible elements
-            if (obj.isVisible() == false) {
-                continue;
-            }
-
-            if (obj instanceof GeoSet) {
-                writeGeoSet((GeoSet) obj, g, document);
-            } else {
-                writeGeoObject(obj, g, document);
+    @Override
+    protected void writeConverted(GeoObject obj, String geometry)
+            throws IOException {
+        if (obj instanceof GeoPath) {
+            if (geometry != null) {
+                writePath(geometry, ((GeoPath) obj).getVectorSymbol());
             }
+        } else if (obj instanceof GeoImage) {
+            writeGeoImage((GeoImage) obj);
+        } else if (obj instanceof GeoPoint) {
+            writePath(geometry, ((GeoPoint) obj).getPointSymbol());
+        } else if (obj instanceof GeoText) {
+            writeGeoText((GeoText) obj);
         }
-
-        finish(geoSet, document, g);
     }
 
-    protected Element geoTextToSVG(GeoText geoText, Document document) {
+    protected void writeGeoText(GeoText geoText) throws IOException {
         FontSymbol symbol = geoText.getFontSymbol();
 
         final double x = xToPageRoundedPx((float) geoText.getVisualX(1. / getDisplayMapScale()));
         final double y = yToPageRoundedPx((float) geoText.getVisualY(1. / getDisplayMapScale()));
 
-        Element text = document.createElementNS(SVGNAMESPACE, "text");
-        text.setAttribute("x", Double.toString(x));
-        text.setAttribute("y", Double.toString(y));
+        StringBuilder text = new StringBuilder();
+        text.append("<text");
+        appendAttribute(text, "x", Double.toString(x));
+        appendAttribute(text, "y", Double.toString(y));
         if (useCSSStyles) {
-            text.setAttribute("style", symbolToCSS(symbol));
+            appendAttribute(text, "style", symbolToCSS(symbol));
         } else {
             Font font = symbol.getFont();
-            text.setAttribute("font-size", Integer.toString(symbol.getSize()));
-            text.setAttribute("font-family", font.getFamily());
-            text.setAttribute("fill", "black");
+            appendAttribute(text, "font-size", Integer.toString(symbol.getSize()));
+            appendAttribute(text, "font-family", font.getFamily());
+            appendAttribute(text, "fill", "black");
 
             switch (font.getStyle()) {
                 case Font.PLAIN:
-                    text.setAttribute("font-style", "normal");
+                    appendAttribute(text, "font-style", "normal");
                     break;
                 case Font.BOLD:
-                    text.setAttribute("font-weight", "bold");
+                    appendAttribute(text, "font-weight", "bold");
                     break;
                 case Font.ITALIC:
-                    text.setAttribute("font-style", "italic");
+                    appendAttribute(text, "font-style", "italic");
                     break;
             }
 
             if (symbol.isCenterHor()) {
-                text.setAttribute("text-anchor", "middle");
+                appendAttribute(text, "text-anchor", "middle");
             } else {
-                text.setAttribute("text-anchor", "start");
+                appendAttribute(text, "text-anchor", "start");
             }
 
             if (symbol.isCenterVer()) {
-                text.setAttribute("baseline-shift", "50%");
+                appendAttribute(text, "baseline-shift", "50%");
             }
         }
 
-        text.setAttribute("id", Long.toString(geoText.getID()));
-        Node textNode = document.createTextNode(geoText.getText());
-        text.appendChild(textNode);
-        return text;
-    }
+        appendAttribute(text, "id", Long.toString(geoText.getID()));
+        text.append('>');
+        appendEscaped(text, geoText.getText());
+        text.append("</text>\n");
 
-    protected void writeGeoText(GeoText geoText, Element parent, Document document) throws IOException {
-        Element el = geoTextToSVG(geoText, document);
-        parent.appendChild(el);
-        finish(geoText, document, el);
+        closeStyleGroup();
+        writeIndentation();
+        writer.write(text.toString());
     }
 
-    protected void writeGeoImage(GeoImage geoImage, Element parent, Document document) throws IOException {
+    protected void writeGeoImage(GeoImage geoImage) throws IOException {
         Rectangle2D bounds = geoImage.getBounds2D(GeoObject.UNDEFINED_SCALE);
         String xStr = Double.toString(xToPageRoundedPx((float) bounds.getMinX()));
         String yStr = Double.toString(yToPageRoundedPx((float) bounds.getMaxY()));
         String wStr = Double.toString(dimToPageRoundedPx((float) bounds.getWidth()));
         String hStr = Double.toString(dimToPageRoundedPx((float) bounds.getHeight()));
 
-        Element image = (Element) document.createElementNS(SVGNAMESPACE, "image");
-        image.setAttribute("x", xStr);
-        image.setAttribute("y", yStr);
-        image.setAttribute("width", wStr);
-        image.setAttribute("height", hStr);
-        image.setAttribute("xlink:href", geoImage.getURL().toExternalForm());
-        parent.appendChild(image);
+        closeStyleGroup();
+
+        StringBuilder image = new StringBuilder();
+        image.append("<image");
+        appendAttribute(image, "x", xStr);
+        appendAttribute(image, "y", yStr);
+        appendAttribute(image, "width", wStr);
+        appendAttribute(image, "height", hStr);
+        appendAttribute(image, "xlink:href", geoImage.getURL().toExternalForm());
+        image.append("/>\n");
+        writeIndentation();
+        writer.write(image.toString());
 
         // add rectangle of the size of the image
-        Element rect = (Element) document.createElementNS(SVGNAMESPACE, "rect");
-        rect.setAttribute("x", xStr);
-        rect.setAttribute("y", yStr);
-        rect.setAttribute("width", wStr);
-        rect.setAttribute("height", hStr);
-        rect.setAttribute("fill", "none");
-        rect.setAttribute("stroke", "blue");
-        rect.setAttribute("stroke-width", "1");
-        parent.appendChild(rect);
+        StringBuilder rect = new StringBuilder();
+        rect.append("<rect");
+        appendAttribute(rect, "x", xStr);
+        appendAttribute(rect, "y", yStr);
+        appendAttribute(rect, "width", wStr);
+        appendAttribute(rect, "height", hStr);
+        appendAttribute(rect, "fill", "none");
+        appendAttribute(rect, "stroke", "blue");
+        appendAttribute(rect, "stroke-width", "1");
+        rect.append("/>\n");
+        writeIndentation();
+        writer.write(rect.toString());
     }
 
-    protected void writeGeoPoint(GeoPoint geoPoint, Element parent, Document document) throws IOException {
-
-        // Unfortunately Illustrator CS does not support SVG symbols correctly.
-        // Therefore don't write SVG symbols, but convert GeoPoints to
-        // normal graphics.
-        PointSymbol pointSymbol = geoPoint.getPointSymbol();
-        GeoPath geoPath = pointSymbol.getPointSymbol(getDisplayMapScale(),
-                geoPoint.getX(), geoPoint.getY());
-        GeoPathIterator pi = geoPath.getIterator();
-        Element pathElement = writePathIterator(pi, pointSymbol, document);
-        parent.appendChild(pathElement);
-        finish(geoPoint, document, pathElement);
+    /**
+     * Writes a path element. The style attributes are written to an
+     * enclosing g element, which is shared with following paths with the
+     * same style.
+     *
+     * @param svgPath The content of the d attribute.
+     * @param vectorSymbol The symbol of the path.
+     */
+    protected void writePath(String svgPath, VectorSymbol vectorSymbol)
+            throws IOException {
+        String style = vectorSymbolToAttributes(vectorSymbol);
+        if (!style.equals(currentStyle)) {
+            closeStyleGroup();
+            if (style.length() > 0) {
+                writeIndentation();
+                writer.write("<g");
+                writer.write(style);
+                writer.write(">\n");
+                ++depth;
+                currentStyle = style;
+            }
+        }
+        writeIndentation();
+        writer.write("<path d=\"");
+        writer.write(svgPath);
+        writer.write("\"/>\n");
     }
 
     /**
-     * Converts a GeoPath to a SVG path.
-     *
-     * @param geoPath The GeoPath to convert.
-     * @param parent The parent element that will contain the passed GeoSet.
-     * @param document The DOM.
+     * Closes the g element shared by paths with identical style.
      */
-    protected void writeGeoPath(GeoPath geoPath, Element parent, Document document) throws IOException {
-        GeoPathIterator pi = geoPath.getIterator();
-        Element pathElement = writePathIterator(pi, geoPath.getVectorSymbol(), document);
-        parent.appendChild(pathElement);
-        finish(geoPath, document, pathElement);
+    private void closeStyleGroup() throws IOException {
+        if (currentStyle != null) {
+            currentStyle = null;
+            --depth;
+            writeIndentation();
+            writer.write("</g>\n");
+        }
     }
 
-    protected void writeVectorSymbol(Element svgElement, VectorSymbol vectorSymbol) {
-        if (vectorSymbol != null && svgElement != null) {
+    /**
+     * Converts a VectorSymbol to SVG attributes.
+     *
+     * @param vectorSymbol The symbol to convert.
+     * @return A string with the attributes, each preceded by a space. Empty
+     * if vectorSymbol is null.
+     */
+    protected String vectorSymbolToAttributes(VectorSymbol vectorSymbol) {
+        StringBuilder str = new StringBuilder();
+        if (vectorSymbol != null) {
             if (useCSSStyles) {
-                svgElement.setAttribute("style", symbolToCSS(vectorSymbol));
+                appendAttribute(str, "style", symbolToCSS(vectorSymbol));
             } else {
                 String strokeColor = vectorSymbol.isStroked()
                         ? ColorUtils.colorToCSSString(vectorSymbol.getStrokeColor())
                         : "none";
-                svgElement.setAttribute("stroke", strokeColor);
+                appendAttribute(str, "stroke", strokeColor);
 
                 String fillColor = vectorSymbol.isFilled()
                         ? ColorUtils.colorToCSSString(vectorSymbol.getFillColor())
                         : "none";
-                svgElement.setAttribute("fill", fillColor);
+                appendAttribute(str, "fill", fillColor);
 
                 if (vectorSymbol.isFillTransparent()) {
                     float alpha = Math.round(vectorSymbol.getFillTransparency() / 255f * 100) / 100f;
-                    svgElement.setAttribute("fill-opacity", Float.toString(alpha));
+                    appendAttribute(str, "fill-opacity", Float.toString(alpha));
                 }
                 double strokeWidth = vectorSymbol.getScaledStrokeWidth(getDisplayMapScale());
                 if (strokeWidth <= 0) {
                     strokeWidth = 1;
                 }
-                svgElement.setAttribute("stroke-width", Double.toString(strokeWidth));
+                appendAttribute(str, "stroke-width", Double.toString(strokeWidth));
             }
         }
-    }
-
-    protected Element writePathIterator(GeoPathIterator pi, VectorSymbol vectorSymbol,
-            Document document) {
-        String svgPath = convertPathIteratorToSVG(pi);
-        Element pathElement = (Element) document.createElementNS(SVGNAMESPACE, "path");
-        writeVectorSymbol(pathElement, vectorSymbol);
-        pathElement.setAttribute("d", svgPath);
-        return pathElement;
+        return str.toString();
     }
 
     private String convertPathIteratorToSVG(GeoPathIterator iterator) {
-       
+
         StringBuilder str = new StringBuilder();
+        
+        // after a skipped segment with non-finite coordinates, the pen is
+        // lifted and the current subpath is broken
+        boolean penLifted = true;
+        boolean brokenSubpath = false;
         do {
             final int instruction = iterator.getInstruction();
+            if (!isFiniteSegment(iterator)) {
+                penLifted = true;
+                brokenSubpath = true;
+                continue;
+            }
+            if (instruction == GeoPathModel.CLOSE) {
+                if (penLifted || brokenSubpath) {
+                    continue;
+                }
+            } else if (instruction == GeoPathModel.MOVETO) {
+                penLifted = false;
+                brokenSubpath = false;
+            } else if (penLifted) {
+                // restart the subpath at the end of this segment
+                if (!writeCompactPath && str.length() > 0) {
+                    str.append(" ");
+                }
+                str.append("M");
+                appendPoint(str, getSegmentEndX(iterator), getSegmentEndY(iterator));
+                penLifted = false;
+                continue;
+            }
             switch (instruction) {
                 case GeoPathModel.CLOSE:
                     if (!writeCompactPath) {
@@ -398,9 +419,7 @@ public class SVGExporter extends VectorGraphicsExporter {
                         str.append(" ");
                     }
                     str.append("M");
-                    str.append(xToPageRoundedPx(iterator.getX()));
-                    str.append(" ");
-                    str.append(yToPageRoundedPx(iterator.getY()));
+                    appendPoint(str, iterator.getX(), iterator.getY());
                     break;
 
                 case GeoPathModel.LINETO:
@@ -408,9 +427,7 @@ public class SVGExporter extends VectorGraphicsExporter {
                         str.append(" ");
                     }
                     str.append("L");
-                    str.append(xToPageRoundedPx(iterator.getX()));
-                    str.append(" ");
-                    str.append(yToPageRoundedPx(iterator.getY()));
+                    appendPoint(str, iterator.getX(), iterator.getY());
                     break;
 
                 case GeoPathModel.QUADCURVETO:
@@ -418,13 +435,9 @@ public class SVGExporter extends VectorGraphicsExporter {
                         str.append(" ");
                     }
                     str.append("Q");
-                    str.append(xToPageRoundedPx(iterator.getX()));
+                    appendPoint(str, iterator.getX(), iterator.getY());
                     str.append(" ");
-                    str.append(yToPageRoundedPx(iterator.getY()));
-                    str.append(" ");
-                    str.append(xToPageRoundedPx(iterator.getX2()));
-                    str.append(" ");
-                    str.append(yToPageRoundedPx(iterator.getY2()));
+                    appendPoint(str, iterator.getX2(), iterator.getY2());
                     break;
 
                 case GeoPathModel.CURVETO:
@@ -432,17 +445,11 @@ public class SVGExporter extends VectorGraphicsExporter {
                         str.append(" ");
                     }
                     str.append("C");
-                    str.append(xToPageRoundedPx(iterator.getX()));
-                    str.append(" ");
-                    str.append(yToPageRoundedPx(iterator.getY()));
-                    str.append(" ");
-                    str.append(xToPageRoundedPx(iterator.getX2()));
+                    appendPoint(str, iterator.getX(), iterator.getY());
                     str.append(" ");
-                    str.append(yToPageRoundedPx(iterator.getY2()));
+                    appendPoint(str, iterator.getX2(), iterator.getY2());
                     str.append(" ");
-                    str.append(xToPageRoundedPx(iterator.getX3()));
-                    str.append(" ");
-                    str.append(yToPageRoundedPx(iterator.getY3()));
+                    appendPoint(str, iterator.getX3(), iterator.getY3());
                     break;
             }
         } while (iterator.next());
@@ -450,6 +457,15 @@ public class SVGExporter extends VectorGraphicsExporter {
         return str.toString();
     }
 
+    /**
+     * Appends a point transformed to page pixels and rounded.
+     */
+    private void appendPoint(StringBuilder str, double x, double y) {
+        appendRounded(str, xToPagePx(x));
+        str.append(" ");
+        appendRounded(str, yToPagePx(y));
+    }
+
     /**
      * Converts a VectorSymbol to a CSS style.
      *
@@ -541,7 +557,7 @@ public class SVGExporter extends VectorGraphicsExporter {
         return str.toString();
     }
 
-    protected void appendDescription(Element svgRootElement, Document document) {
+    protected void appendDescription() throws IOException {
 
         StringBuilder str = new StringBuilder();
         String userName = getDocumentAuthor();
@@ -560,19 +576,67 @@ public class SVGExporter extends VectorGraphicsExporter {
         str.append("Date:");
         str.append(java.util.Calendar.getInstance().getTime());
 
-        // create a description element
-        Element desc = (Element) document.createElementNS(SVGNAMESPACE, "desc");
-        desc.appendChild(document.createTextNode(str.toString()));
+        // write a description element
+        StringBuilder desc = new StringBuilder("<desc>");
+        appendEscaped(desc, str.toString());
+        desc.append("</desc>\n");
+        writeIndentation();
+        writer.write(desc.toString());
+    }
+
+    protected void appendTitle(String title) throws IOException {
+        StringBuilder el = new StringBuilder("<title>");
+        appendEscaped(el, title);
+        el.append("</title>\n");
+        writeIndentation();
+        writer.write(el.toString());
+    }
+
+    private void writeIndentation() throws IOException {
+        for (int i = depth * INDENTATION; i > 0; i--) {
+            writer.write(' ');
+        }
+    }
 
-        // append description element
-        svgRootElement.appendChild(desc);
+    /**
+     * Appends an attribute preceded by a space.
+     */
+    private static void appendAttribute(StringBuilder str, String name,
+            String value) {
+        str.append(' ');
+        str.append(name);
+        str.append("=\"");
+        appendEscaped(str, value);
+        str.append('"');
     }
-    
-    protected void appendTitle(String title, Element svgRootElement) {
-        Document doc = svgRootElement.getOwnerDocument();
-        Element el = (Element) (doc.createElementNS(SVGNAMESPACE, "title"));
-        el.appendChild(doc.createTextNode(title));
-        svgRootElement.appendChild(el);
+
+    /**
+     * Appends text with XML markup characters replaced by entities.
+     */
+    private static void appendEscaped(StringBuilder str, String text) {
+        if (text == null) {
+            return;
+        }
+        final int n = text.length();
+        for (int i = 0; i < n; i++) {
+            final char c = text.charAt(i);
+            switch (c) {
+                case '&':
+                    str.append("&amp;");
+                    break;
+                case '<':
+                    str.append("&lt;");
+                    break;
+                case '>':
+                    str.append("&gt;");
+                    break;
+                case '"':
+                    str.append("&quot;");
+                    break;
+                default:
+                    str.append(c);
+            }
+        }
     }
 
     public boolean isUseCSSStyles() {
@@ -582,4 +646,4 @@ public class SVGExporter extends VectorGraphicsExporter {
     public void setUseCSSStyles(boolean useCSSStyles) {
         this.useCSSStyles = useCSSStyles;
     }
-}
\ No newline at end of file
+}
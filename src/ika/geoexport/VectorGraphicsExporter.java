@@ -8,14 +8,22 @@
 package ika.geoexport;
 
 import ika.geo.GeoObject;
+import ika.geo.GeoPathIterator;
+import ika.geo.GeoPathModel;
+import ika.geo.GeoPoint;
 import ika.geo.GeoSet;
+import ika.geo.GeoText;
 import ika.gui.PageFormat;
 import java.awt.geom.Rectangle2D;
 import java.io.IOException;
 import java.io.OutputStream;
 
 /**
- *
+ * Base class for exporters writing vector graphics. Derived classes can
+ * stream the GeoSet tree with writeChildren(): the geometry of consecutive
+ * non-GeoSet objects is converted to strings by multiple threads in batches
+ * of limited size, and then written in the original order. The memory used
+ * for the export is therefore independent of the number of features.
  * @author Bernhard Jenny, Institute of Cartography, ETH Zurich.
  */
 public abstract class VectorGraphicsExporter extends GeoSetExporter {
@@ -24,6 +32,17 @@ public abstract class VectorGraphicsExporter extends GeoSetExporter {
     private static final int NBR_AFTER_COMA_DECIMALS = 2;
     private static final double AFTER_COMA_ROUNDER = Math.pow(10, NBR_AFTER_COMA_DECIMALS);
     
+    /**
+     * Maximum number of objects whose geometry is converted at once. This
+     * limits the memory used by converted geometry.
+     */
+    private static final int CONVERSION_BATCH_SIZE = 2048;
+    
+    /**
+     * Minimum number of objects converted by a single thread.
+     */
+    private static final int MIN_OBJECTS_PER_THREAD = 64;
+    
     protected PageFormat pageFormat = null;
     
     /** Creates a new instance of VectorGraphicsExporter */
@@ -162,6 +181,281 @@ public abstract class VectorGraphicsExporter extends GeoSetExporter {
         return round(dimToPagePx(d));
     }
     
+    /**
+     * Converts the geometry of a GeoObject to a string in the format of the
+     * exporter. This method is called concurrently by multiple threads and
+     * must therefore not change the state of the exporter. Derived classes
+     * using writeChildren() override this method.
+     * @param obj The object to convert. This is never a GeoSet.
+     * @return The converted geometry, or null if the object is not converted
+     * in advance.
+     */
+    protected String geometryToString(GeoObject obj) {
+        return null;
+    }
+    
+    /**
+     * Writes an object and its geometry that was converted by 
+     * geometryToString(). Derived classes using writeChildren() override this
+     * method. Objects are passed in the order of the GeoSet tree.
+     * @param obj The object to write. This is never a GeoSet.
+     * @param geometry The string returned by geometryToString, possibly null.
+     */
+    protected void writeConverted(GeoObject obj, String geometry)
+    throws IOException {
+    }
+    
+    /**
+     * Writes a GeoSet found by writeChildren(). The default implementation
+     * writes the children of the GeoSet. Derived classes can override this
+     * to write the start and end of a group.
+     * @param geoSet The visible GeoSet to write.
+     */
+    protected void writeChildGeoSet(GeoSet geoSet) throws IOException {
+        this.writeChildren(geoSet);
+    }
+    
+    /**
+     * Writes the visible children of a GeoSet. GeoSets are passed to 
+     * writeChildGeoSet(). The geometry of consecutive other objects is 
+     * converted in batches by geometryToString() and passed to 
+     * writeConverted().
+     * @param geoSet The GeoSet with the children to write.
+     */
+    protected void writeChildren(GeoSet geoSet) throws IOException {
+        final int nbrObj = geoSet.getNumberOfChildren();
+        GeoObject[] batch = new GeoObject[Math.min(nbrObj, CONVERSION_BATCH_SIZE)];
+        int batchSize = 0;
+        for (int i = 0; i < nbrObj; i++) {
+            GeoObject obj = geoSet.getGeoObject(i);
+            
+            // only write visible elements with a valid position
+            if (obj.isVisible() == false || !hasFiniteAnchor(obj)) {
+                continue;
+            }
+            
+            if (obj instanceof GeoSet) {
+                this.writeBatch(batch, batchSize);
+                batchSize = 0;
+                this.writeChildGeoSet((GeoSet) obj);
+            } else {
+                batch[batchSize++] = obj;
+                if (batchSize == batch.length) {
+                    this.writeBatch(batch, batchSize);
+                    batchSize = 0;
+                }
+            }
+        }
+        this.writeBatch(batch, batchSize);
+    }
+    
+    private void writeBatch(GeoObject[] batch, int batchSize) throws IOException {
+        String[] geometry = this.convertGeometry(batch, batchSize);
+        for (int i = 0; i < batchSize; i++) {
+            this.writeConverted(batch[i], geometry[i]);
+            batch[i] = null;
+            geometry[i] = null;
+        }
+    }
+    
+    /**
+     * Converts the geometry of objects with geometryToString() using 
+     * multiple threads.
+     * @param objects The objects to convert.
+     * @param count The number of objects in objects to convert.
+     * @return The converted geometry for each object.
+     */
+    protected String[] convertGeometry(final GeoObject[] objects, int count) {
+        final String[] geometry = new String[count];
+        final int nThreads = Math.min(Runtime.getRuntime().availableProcessors(),
+                count / MIN_OBJECTS_PER_THREAD);
+        if (nThreads <= 1) {
+            for (int i = 0; i < count; i++) {
+                geometry[i] = this.geometryToString(objects[i]);
+            }
+            return geometry;
+        }
+        
+        ConverterThread[] threads = new ConverterThread[nThreads];
+        final int chunkSize = count / nThreads + 1;
+        for (int i = 0; i < nThreads; i++) {
+            final int first = i * chunkSize;
+            final int last = Math.min(first + chunkSize, count);
+            threads[i] = new ConverterThread(objects, geometry, first, last);
+            threads[i].start();
+        }
+        for (int i = 0; i < nThreads; i++) {
+            try {
+                threads[i].join();
+            } catch (InterruptedException ex) {
+                Thread.currentThread().interrupt();
+                throw new IllegalStateException("Export interrupted.");
+            }
+        }
+        
+        // pass exceptions on to the calling thread
+        for (int i = 0; i < nThreads; i++) {
+            if (threads[i].exception != null) {
+                throw threads[i].exception;
+            }
+        }
+        return geometry;
+    }
+    
+    /**
+     * Converts the geometry of a range of objects.
+     */
+    private class ConverterThread extends Thread {
+        
+        private final GeoObject[] objects;
+        private final String[] geometry;
+        private final int first;
+        private final int last;
+        private RuntimeException exception;
+        
+        ConverterThread(GeoObject[] objects, String[] geometry,
+                int first, int last) {
+            this.objects = objects;
+            this.geometry = geometry;
+            this.first = first;
+            this.last = last;
+        }
+        
+        @Override
+        public void run() {
+            try {
+                for (int i = first; i < last; i++) {
+                    geometry[i] = geometryToString(objects[i]);
+                }
+            } catch (RuntimeException exc) {
+                this.exception = exc;
+            }
+        }
+    }
+    
+    /**
+     * Appends a number rounded to the precision of exported coordinates.
+     * The number is written without exponent and without trailing zeros.
+     * This is considerably faster than converting rounded doubles to strings.
+     * Segments with non-finite coordinates must be skipped with
+     * isFiniteSegment() before their coordinates are appended.
+     * @param sb The destination.
+     * @param d The number to append. Must be finite.
+     */
+    protected static void appendRounded(StringBuilder sb, double d) {
+        if (!isFinite(d)) {
+            throw new IllegalArgumentException("coordinate is not finite: " + d);
+        }
+        final double scaled = d * AFTER_COMA_ROUNDER;
+        if (Math.abs(scaled) >= Long.MAX_VALUE / 10) {
+            double rounded = Math.rint(scaled) / AFTER_COMA_ROUNDER;
+            sb.append(java.math.BigDecimal.valueOf(rounded).toPlainString());
+            return;
+        }
+        long l = Math.round(scaled);
+        if (l < 0) {
+            sb.append('-');
+            l = -l;
+        }
+        final long div = (long) AFTER_COMA_ROUNDER;
+        sb.append(l / div);
+        long frac = l % div;
+        if (frac != 0) {
+            sb.append('.');
+            long digitDiv = div / 10;
+            while (frac != 0) {
+                sb.append((char) ('0' + frac / digitDiv));
+                frac %= digitDiv;
+                digitDiv /= 10;
+            }
+        }
+    }
+    
+    /**
+     * Returns whether all points of the current segment of a path iterator
+     * have finite coordinates. Segments with NaN or infinite coordinates are
+     * skipped when exporting. The pen is then lifted: the subpath restarts
+     * with a moveto to the end point of the next finite segment, and a
+     * close instruction of the broken subpath is skipped.
+     * @param iterator The path iterator.
+     * @return False if any coordinate of the current segment is NaN or
+     * infinite.
+     */
+    protected static boolean isFiniteSegment(GeoPathIterator iterator) {
+        switch (iterator.getInstruction()) {
+            case GeoPathModel.CURVETO:
+                if (!isFinite(iterator.getX3()) || !isFinite(iterator.getY3())) {
+                    return false;
+                }
+            // fall through
+            case GeoPathModel.QUADCURVETO:
+                if (!isFinite(iterator.getX2()) || !isFinite(iterator.getY2())) {
+                    return false;
+                }
+            // fall through
+            case GeoPathModel.MOVETO:
+            case GeoPathModel.LINETO:
+                return isFinite(iterator.getX()) && isFinite(iterator.getY());
+            default:
+                return true;
+        }
+    }
+
+    /**
+     * Returns the horizontal coordinate of the end point of the current
+     * segment of a path iterator. The current instruction must not be a
+     * close instruction.
+     */
+    protected static double getSegmentEndX(GeoPathIterator iterator) {
+        switch (iterator.getInstruction()) {
+            case GeoPathModel.CURVETO:
+                return iterator.getX3();
+            case GeoPathModel.QUADCURVETO:
+                return iterator.getX2();
+            default:
+                return iterator.getX();
+        }
+    }
+
+    /**
+     * Returns the vertical coordinate of the end point of the current
+     * segment of a path iterator. The current instruction must not be a
+     * close instruction.
+     */
+    protected static double getSegmentEndY(GeoPathIterator iterator) {
+        switch (iterator.getInstruction()) {
+            case GeoPathModel.CURVETO:
+                return iterator.getY3();
+            case GeoPathModel.QUADCURVETO:
+                return iterator.getY2();
+            default:
+                return iterator.getY();
+        }
+    }
+
+    /**
+     * Returns whether the position of a GeoPoint or a GeoText is finite.
+     * Points and texts at NaN or infinite positions are not exported.
+     * @param obj The object to test.
+     * @return False for a GeoPoint or GeoText with a NaN or infinite
+     * coordinate, true otherwise.
+     */
+    protected static boolean hasFiniteAnchor(GeoObject obj) {
+        if (obj instanceof GeoPoint) {
+            GeoPoint geoPoint = (GeoPoint) obj;
+            return isFinite(geoPoint.getX()) && isFinite(geoPoint.getY());
+        }
+        if (obj instanceof GeoText) {
+            GeoText geoText = (GeoText) obj;
+            return isFinite(geoText.getX()) && isFinite(geoText.getY());
+        }
+        return true;
+    }
+
+    private static boolean isFinite(double d) {
+        return !Double.isNaN(d) && !Double.isInfinite(d);
+    }
+
     private double round(double d){
         return Math.round(AFTER_COMA_ROUNDER * d) / AFTER_COMA_ROUNDER;
     }
@@ -0,0 +1,525 @@
+/*
+ * CompiledPaths.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+
+package ika.geoimport;
+
+import ika.geo.GeoObject;
+import ika.geo.GeoPath;
+import ika.geo.GeoPathIterator;
+import ika.geo.GeoPathModel;
+import ika.geo.GeoSet;
+import ika.geo.VectorSymbol;
+import ika.utils.URLUtils;
+import java.io.BufferedOutputStream;
+import java.io.DataOutputStream;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.util.ArrayList;
+import java.util.HashMap;
+
+/**
+ * Straight line paths in a compact binary format that can be read without
+ * parsing. The bundled coastlines are converted to this format when the
+ * application is built, see main().<br>
+ * Coordinates are stored as integer multiples of COORDINATE_UNIT. Each point
+ * has a significance: the tolerance of the Douglas-Peucker line simplification
+ * at which the point would be removed. A simplified version of the paths for
+ * any tolerance is therefore obtained by skipping points with a significance
+ * not larger than the tolerance. The first point of each line and the point
+ * of a ring that is farthest from its first point are never removed.<br>
+ * Data read with load() is kept in memory and shared; it must not be changed.
+ * <br>
+ * File format, big-endian:<br>
+ * int MAGIC, int VERSION, byte polygon (1 or 0), int paths count,
+ * int lines count, int points count, long[paths count] path IDs,
+ * int[paths count + 1] first line of each path,
+ * int[lines count + 1] first point of each line,
+ * int[points count * 2] x and y coordinates,
+ * float[points count] significance.
+ */
+public final class CompiledPaths {
+
+    public static final int MAGIC = 0x494B4150; // "IKAP"
+
+    public static final int VERSION = 1;
+
+    /**
+     * Coordinates are stored as multiples of this unit.
+     */
+    public static final double COORDINATE_UNIT = 1e-7;
+
+    /**
+     * File extension of compiled paths.
+     */
+    public static final String FILE_EXTENSION = "paths";
+
+    /**
+     * Data loaded by load(), shared by all callers.
+     */
+    private static final HashMap<String, CompiledPaths> cache =
+            new HashMap<String, CompiledPaths>();
+
+    /**
+     * True if lines are closed polygon rings.
+     */
+    private final boolean polygon;
+
+    private final long[] pathIDs;
+
+    /**
+     * The first line of each path, with an additional entry for the end.
+     */
+    private final int[] pathFirstLines;
+
+    /**
+     * The first point of each line, with an additional entry for the end.
+     */
+    private final int[] lineFirstPoints;
+
+    /**
+     * x and y coordinates in COORDINATE_UNIT.
+     */
+    private final int[] xy;
+
+    /**
+     * The significance of each point.
+     */
+    private final float[] significance;
+
+    /**
+     * GeoSet with all points, created by getGeoSet() and copied for each
+     * caller.
+     */
+    private GeoSet geoSet;
+
+    private CompiledPaths(boolean polygon, long[] pathIDs, int[] pathFirstLines,
+            int[] lineFirstPoints, int[] xy, float[] significance) {
+        this.polygon = polygon;
+        this.pathIDs = pathIDs;
+        this.pathFirstLines = pathFirstLines;
+        this.lineFirstPoints = lineFirstPoints;
+        this.xy = xy;
+        this.significance = significance;
+    }
+
+    /**
+     * Returns compiled paths. The data at a URL are only read once, and the
+     * returned object is shared by all callers.
+     * @param url The URL of the compiled paths.
+     */
+    public static CompiledPaths load(java.net.URL url) throws IOException {
+        final String key = url.toExternalForm();
+        synchronized (cache) {
+            CompiledPaths paths = cache.get(key);
+            if (paths == null) {
+                paths = read(URLUtils.loadBufferFromURL(url));
+                cache.put(key, paths);
+            }
+            return paths;
+        }
+    }
+
+    /**
+     * Returns true if a buffer starts with the identifier of compiled paths.
+     */
+    private static boolean isCompiledPaths(ByteBuffer buffer) {
+        return buffer.limit() >= 8 && buffer.getInt(0) == MAGIC;
+    }
+
+    private static CompiledPaths read(ByteBuffer buffer) throws IOException {
+        try {
+            if (!isCompiledPaths(buffer) || buffer.getInt(4) != VERSION) {
+                throw new IOException("Not a supported compiled paths file.");
+            }
+            buffer.position(8);
+            final boolean polygon = buffer.get() != 0;
+            final int pathsCount = buffer.getInt();
+            final int linesCount = buffer.getInt();
+            final int pointsCount = buffer.getInt();
+
+            long[] pathIDs = new long[pathsCount];
+            buffer.asLongBuffer().get(pathIDs);
+            buffer.position(buffer.position() + pathsCount * 8);
+            int[] pathFirstLines = new int[pathsCount + 1];
+            buffer.asIntBuffer().get(pathFirstLines);
+            buffer.position(buffer.position() + (pathsCount + 1) * 4);
+            int[] lineFirstPoints = new int[linesCount + 1];
+            buffer.asIntBuffer().get(lineFirstPoints);
+            buffer.position(buffer.position() + (linesCount + 1) * 4);
+            int[] xy = new int[pointsCount * 2];
+            buffer.asIntBuffer().get(xy);
+            buffer.position(buffer.position() + pointsCount * 8);
+            float[] significance = new float[pointsCount];
+            buffer.asFloatBuffer().get(significance);
+            return new CompiledPaths(polygon, pathIDs, pathFirstLines,
+                    lineFirstPoints, xy, significance);
+        } catch (RuntimeException exc) {
+            // buffer underflow or negative counts
+            throw new IOException("Compiled paths file is corrupt.");
+        }
+    }
+
+    /**
+     * Writes the data.
+     * @param out The destination.
+     */
+    public void write(java.io.OutputStream out) throws IOException {
+        DataOutputStream dos = new DataOutputStream(new BufferedOutputStream(out));
+        dos.writeInt(MAGIC);
+        dos.writeInt(VERSION);
+        dos.writeByte(this.polygon ? 1 : 0);
+        dos.writeInt(this.pathIDs.length);
+        dos.writeInt(this.lineFirstPoints.length - 1);
+        dos.writeInt(this.significance.length);
+        for (long id : this.pathIDs) {
+            dos.writeLong(id);
+        }
+        for (int i : this.pathFirstLines) {
+            dos.writeInt(i);
+        }
+        for (int i : this.lineFirstPoints) {
+            dos.writeInt(i);
+        }
+        for (int i : this.xy) {
+            dos.writeInt(i);
+        }
+        for (float s : this.significance) {
+            dos.writeFloat(s);
+        }
+        dos.flush();
+    }
+
+    /**
+     * Converts the GeoPaths of a GeoSet. Only straight lines are supported.
+     * @param geoSet The GeoPaths to convert. Nested GeoSets are included.
+     * @return The converted paths.
+     */
+    public static CompiledPaths compile(GeoSet geoSet) {
+        ArrayList<GeoPath> geoPaths = new ArrayList<GeoPath>();
+        collectGeoPaths(geoSet, geoPaths);
+
+        long[] pathIDs = new long[geoPaths.size()];
+        int[] pathFirstLines = new int[geoPaths.size() + 1];
+        IntList lineFirstPoints = new IntList();
+        IntList xy = new IntList();
+        boolean polygon = false;
+        for (int p = 0; p < geoPaths.size(); p++) {
+            GeoPath geoPath = geoPaths.get(p);
+            pathIDs[p] = geoPath.getID();
+            pathFirstLines[p] = lineFirstPoints.size;
+            GeoPathIterator it = geoPath.getIterator();
+            if (it.getInstruction() == GeoPathModel.NONE) {
+                continue;
+            }
+            do {
+                switch (it.getInstruction()) {
+                    case GeoPathModel.MOVETO:
+                        lineFirstPoints.add(xy.size / 2);
+                        // fall through
+                    case GeoPathModel.LINETO:
+                        xy.add(toUnits(it.getX()));
+                        xy.add(toUnits(it.getY()));
+                        break;
+                    case GeoPathModel.CLOSE:
+                        polygon = true;
+                        break;
+                    default:
+                        throw new IllegalArgumentException("curves are not supported");
+                }
+            } while (it.next());
+        }
+        pathFirstLines[geoPaths.size()] = lineFirstPoints.size;
+        lineFirstPoints.add(xy.size / 2);
+
+        int[] lines = lineFirstPoints.toArray();
+        int[] coords = xy.toArray();
+        float[] significance = new float[coords.length / 2];
+        for (int l = 0; l < lines.length - 1; l++) {
+            computeSignificance(coords, lines[l], lines[l + 1], polygon, significance);
+        }
+        return new CompiledPaths(polygon, pathIDs, pathFirstLines, lines,
+                coords, significance);
+    }
+
+    private static void collectGeoPaths(GeoSet geoSet, ArrayList<GeoPath> geoPaths) {
+        final int n = geoSet.getNumberOfChildren();
+        for (int i = 0; i < n; i++) {
+            GeoObject geoObject = geoSet.getGeoObject(i);
+            if (geoObject instanceof GeoPath) {
+                geoPaths.add((GeoPath) geoObject);
+            } else if (geoObject instanceof GeoSet) {
+                collectGeoPaths((GeoSet) geoObject, geoPaths);
+            }
+        }
+    }
+
+    private static int toUnits(double c) {
+        return (int) Math.round(c / COORDINATE_UNIT);
+    }
+
+    /**
+     * Computes the Douglas-Peucker significance of the points of a line. The
+     * significance of a point is its distance to the line connecting the
+     * end points of the interval in which it was selected, but not larger
+     * than the significance of these end points. The simplification with a
+     * tolerance therefore keeps all points with a larger significance.
+     * @param xy Coordinates of all lines.
+     * @param first The first point of the line.
+     * @param end The point after the last point of the line.
+     * @param ring True if the line is closed.
+     * @param significance Receives the significance.
+     */
+    private static void computeSignificance(int[] xy, int first, int end,
+            boolean ring, float[] significance) {
+
+        final int n = end - first;
+        if (n <= 0) {
+            return;
+        }
+        significance[first] = Float.POSITIVE_INFINITY;
+        if (n == 1) {
+            return;
+        }
+
+        // a ring is split at the point farthest from its first point
+        int last = end - 1;
+        if (ring) {
+            double maxD = -1;
+            for (int i = first + 1; i < end; i++) {
+                final double dx = xy[i * 2] - xy[first * 2];
+                final double dy = xy[i * 2 + 1] - xy[first * 2 + 1];
+                final double d = dx * dx + dy * dy;
+                if (d > maxD) {
+                    maxD = d;
+                    last = i;
+                }
+            }
+        }
+        significance[last] = Float.POSITIVE_INFINITY;
+
+        // intervals to split: start point, end point (possibly wrapping
+        // to the first point of a ring) and the significance of the end points
+        IntList stack = new IntList();
+        stack.add(first);
+        stack.add(last);
+        if (ring) {
+            stack.add(last);
+            stack.add(end); // stands for the first point
+        }
+        ArrayList<Float> limits = new ArrayList<Float>();
+        limits.add(Float.POSITIVE_INFINITY);
+        if (ring) {
+            limits.add(Float.POSITIVE_INFINITY);
+        }
+        while (stack.size > 0) {
+            final int b = stack.data[--stack.size];
+            final int a = stack.data[--stack.size];
+            final float limit = limits.remove(limits.size() - 1);
+            if (b - a < 2) {
+                continue;
+            }
+            final int bi = b == end ? first : b;
+            final double ax = xy[a * 2] * COORDINATE_UNIT;
+            final double ay = xy[a * 2 + 1] * COORDINATE_UNIT;
+            final double bx = xy[bi * 2] * COORDINATE_UNIT;
+            final double by = xy[bi * 2 + 1] * COORDINATE_UNIT;
+            double maxD = -1;
+            int maxI = a + 1;
+            for (int i = a + 1; i < b; i++) {
+                final double d = segmentDistance(ax, ay, bx, by,
+                        xy[i * 2] * COORDINATE_UNIT, xy[i * 2 + 1] * COORDINATE_UNIT);
+                if (d > maxD) {
+                    maxD = d;
+                    maxI = i;
+                }
+            }
+            final float s = Math.min(limit, (float) maxD);
+            significance[maxI] = s;
+            stack.add(a);
+            stack.add(maxI);
+            limits.add(s);
+            stack.add(maxI);
+            stack.add(b);
+            limits.add(s);
+        }
+    }
+
+    /**
+     * Distance between a point and a line segment.
+     */
+    private static double segmentDistance(double ax, double ay, double bx,
+            double by, double px, double py) {
+        final double dx = bx - ax;
+        final double dy = by - ay;
+        final double l2 = dx * dx + dy * dy;
+        double t = l2 == 0 ? 0 : ((px - ax) * dx + (py - ay) * dy) / l2;
+        t = Math.max(0, Math.min(1, t));
+        return Math.hypot(px - ax - t * dx, py - ay - t * dy);
+    }
+
+    /**
+     * Returns the number of points.
+     */
+    public int getPointsCount() {
+        return this.significance.length;
+    }
+
+    /**
+     * Returns the number of points kept when simplifying with a tolerance.
+     * @param tolerance The simplification tolerance. 0 keeps all points.
+     */
+    public int getPointsCount(double tolerance) {
+        int n = 0;
+        for (float s : this.significance) {
+            if (tolerance <= 0 || s > tolerance) {
+                ++n;
+            }
+        }
+        return n;
+    }
+
+    /**
+     * Returns a GeoSet with one GeoPath for each path and all points. The
+     * GeoSet is created once; each call returns a copy that shares the
+     * coordinates with the other copies until they are changed.
+     */
+    public synchronized GeoSet getGeoSet() {
+        if (this.geoSet == null) {
+            this.geoSet = this.toGeoSet(0);
+        }
+        return this.geoSet.clone();
+    }
+
+    /**
+     * Creates a GeoSet with one GeoPath for each path.
+     * @param tolerance The simplification tolerance. Points with a
+     * significance not larger than the tolerance are removed. Lines and rings
+     * with too few remaining points are removed. 0 keeps all points.
+     * @return A new GeoSet.
+     */
+    public GeoSet toGeoSet(double tolerance) {
+        GeoSet geoSet = new GeoSet();
+        geoSet.setSpatialIndexEnabled(true);
+        final int minPoints = this.polygon ? 3 : 2;
+        for (int p = 0; p < this.pathIDs.length; p++) {
+            final int firstLine = this.pathFirstLines[p];
+            final int endLine = this.pathFirstLines[p + 1];
+
+            // count the points to allocate the arrays once
+            int pointsCount = 0;
+            for (int i = this.lineFirstPoints[firstLine]; i < this.lineFirstPoints[endLine]; i++) {
+                if (tolerance <= 0 || this.significance[i] > tolerance) {
+                    ++pointsCount;
+                }
+            }
+            double[] pathXY = new double[pointsCount * 2];
+            int[] firstPoints = new int[endLine - firstLine];
+            int linesCount = 0;
+            int n = 0;
+            for (int l = firstLine; l < endLine; l++) {
+                final int lineStart = n;
+                for (int i = this.lineFirstPoints[l]; i < this.lineFirstPoints[l + 1]; i++) {
+                    if (tolerance <= 0 || this.significance[i] > tolerance) {
+                        pathXY[n * 2] = this.xy[i * 2] * COORDINATE_UNIT;
+                        pathXY[n * 2 + 1] = this.xy[i * 2 + 1] * COORDINATE_UNIT;
+                        ++n;
+                    }
+                }
+                if (n - lineStart < minPoints) {
+                    n = lineStart;
+                } else {
+                    firstPoints[linesCount++] = lineStart;
+                }
+            }
+            if (linesCount == 0) {
+                continue;
+            }
+            if (n != pointsCount) {
+                double[] compactXY = new double[n * 2];
+                System.arraycopy(pathXY, 0, compactXY, 0, n * 2);
+                pathXY = compactXY;
+            }
+            if (linesCount != firstPoints.length) {
+                int[] compactFirstPoints = new int[linesCount];
+                System.arraycopy(firstPoints, 0, compactFirstPoints, 0, linesCount);
+                firstPoints = compactFirstPoints;
+            }
+
+            GeoPathModel pathModel = new GeoPathModel();
+            pathModel.setStraightLines(pathXY, firstPoints, this.polygon);
+            GeoPath geoPath = new GeoPath();
+            geoPath.setPathModel(pathModel);
+            geoPath.setID(this.pathIDs[p]);
+            geoSet.add(geoPath);
+        }
+
+        VectorSymbol symbol = new VectorSymbol();
+        symbol.setScaleInvariant(true);
+        symbol.setStrokeWidth(1);
+        if (this.polygon) {
+            symbol.setFilled(true);
+            symbol.setFillColor(java.awt.Color.WHITE);
+        }
+        geoSet.setVectorSymbol(symbol);
+        return geoSet;
+    }
+
+    /**
+     * A growable array of integers.
+     */
+    private static final class IntList {
+
+        private int[] data = new int[1024];
+        private int size = 0;
+
+        void add(int i) {
+            if (this.size == this.data.length) {
+                int[] newData = new int[this.size * 2];
+                System.arraycopy(this.data, 0, newData, 0, this.size);
+                this.data = newData;
+            }
+            this.data[this.size++] = i;
+        }
+
+        int[] toArray() {
+            int[] a = new int[this.size];
+            System.arraycopy(this.data, 0, a, 0, this.size);
+            return a;
+        }
+    }
+
+    /**
+     * Converts data to compiled paths. Used by the build to convert the
+     * bundled coastlines.
+     * @param args The path of the data to convert and the path of the
+     * compiled paths file to write.
+     */
+    public static void main(String[] args) throws IOException {
+        if (args.length != 2) {
+            System.err.println("Usage: CompiledPaths input output." + FILE_EXTENSION);
+            System.exit(1);
+        }
+        GeoImporter importer = GeoImporter.findGeoImporter(args[0]);
+        if (importer == null) {
+            throw new IOException("Cannot import " + args[0]);
+        }
+        GeoObject geoObject = importer.read(args[0]);
+        if (!(geoObject instanceof GeoSet)) {
+            throw new IOException("No paths in " + args[0]);
+        }
+        CompiledPaths paths = compile((GeoSet) geoObject);
+        FileOutputStream out = new FileOutputStream(args[1]);
+        try {
+            paths.write(out);
+        } finally {
+            out.close();
+        }
+        System.out.println("Compiled " + paths.pathIDs.length + " paths with "
+                + paths.getPointsCount() + " points to " + args[1]);
+    }
+}
@@ -0,0 +1,41 @@
+/*
+ * CompiledPathsImporter.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+
+package ika.geoimport;
+
+import ika.geo.GeoObject;
+import ika.geo.GeoSet;
+import java.io.IOException;
+
+/**
+ * An importer for paths in the binary format of CompiledPaths. The data of a
+ * URL are only read once and then shared; each import returns new GeoPaths
+ * sharing their coordinates with all other imports of the same URL.
+ */
+public class CompiledPathsImporter extends GeoImporter {
+
+    public CompiledPathsImporter() {
+    }
+
+    protected java.net.URL findDataURL(java.net.URL url) {
+        if (url == null) {
+            return null;
+        }
+        String lowerCaseFilePath = url.getPath().toLowerCase();
+        return lowerCaseFilePath.endsWith("." + CompiledPaths.FILE_EXTENSION) ? url : null;
+    }
+
+    protected GeoObject importData(java.net.URL url) throws IOException {
+        GeoSet geoSet = CompiledPaths.load(url).getGeoSet();
+        geoSet.setName(ika.utils.FileUtils.getFileNameWithoutExtension(url.getPath()));
+        return geoSet;
+    }
+
+    public String getImporterName() {
+        return "Compiled Paths Importer";
+    }
+}
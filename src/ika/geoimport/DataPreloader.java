@@ -0,0 +1,106 @@
+/*
+ * DataPreloader.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+
+package ika.geoimport;
+
+import ika.geo.GeoObject;
+import ika.table.TableLink;
+
+/**
+ * Imports data in a background thread and later passes the imported data to
+ * a DataReceiver in the thread calling deliver(). This allows for reading
+ * data while other initialization work is done, and for adding the data to
+ * a map in the Event Dispatching Thread.
+ */
+public class DataPreloader extends Thread {
+
+    private final java.net.URL url;
+
+    /**
+     * The imported data, a GeoObject or a TableLink.
+     */
+    private GeoObject geoObject;
+    private TableLink tableLink;
+
+    /**
+     * The exception thrown when importing the data.
+     */
+    private Exception exception;
+
+    /**
+     * Creates a new DataPreloader. Call start() to start importing.
+     * @param url The URL of the data.
+     */
+    public DataPreloader(java.net.URL url) {
+        super("DataPreloader");
+        this.url = url;
+        this.setDaemon(true);
+        this.setPriority(Thread.NORM_PRIORITY - 1);
+    }
+
+    public java.net.URL getURL() {
+        return url;
+    }
+
+    @Override
+    public void run() {
+        final long t = ika.utils.Instrumentation.start();
+        try {
+            GeoImporter importer = GeoImporter.findGeoImporter(this.url);
+            if (importer == null) {
+                throw new java.io.IOException("no importer for " + this.url);
+            }
+            importer.read(this.url, new RecordingDataReceiver(),
+                    GeoImporter.SAME_THREAD);
+        } catch (Exception exc) {
+            this.exception = exc;
+        }
+        ika.utils.Instrumentation.stop("DataPreloader", t);
+    }
+
+    /**
+     * Waits until the data is imported and passes it to a DataReceiver.
+     * @param dataReceiver The receiver of the imported data.
+     */
+    public void deliver(DataReceiver dataReceiver) throws InterruptedException {
+        this.join();
+        if (this.exception != null) {
+            dataReceiver.error(this.exception, this.url);
+        } else if (this.tableLink != null) {
+            dataReceiver.add(this.tableLink);
+        } else if (this.geoObject != null) {
+            dataReceiver.add(this.geoObject);
+        }
+    }
+
+    /**
+     * Stores the data passed by the importer.
+     */
+    private class RecordingDataReceiver extends DataReceiver {
+
+        @Override
+        protected ika.geo.GeoSet getDestinationGeoSet() {
+            return null;
+        }
+
+        @Override
+        public void add(GeoObject geoObject) {
+            DataPreloader.this.geoObject = geoObject;
+        }
+
+        @Override
+        public boolean add(TableLink tableLink) {
+            DataPreloader.this.tableLink = tableLink;
+            return true;
+        }
+
+        @Override
+        public void error(Exception exc, java.net.URL url) {
+            DataPreloader.this.exception = exc;
+        }
+    }
+}
@@ -7,12 +7,16 @@
 package ika.geoimport;
 
 import ika.geo.*;
-import ika.utils.MixedEndianDataInputStream;
+import ika.utils.URLUtils;
 import java.io.*;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.ArrayList;
 
 /**
  * An importer for ESRI shape files. This importer only reads geometry from
- * .shp files.
+ * .shp files. The .shp file is memory-mapped, and the record offsets in the
+ * .shx file are used to decode records in parallel.
  * @author Bernhard Jenny, Institute of Cartography, ETH Zurich.
  */
 public class ShapeGeometryImporter extends GeoImporter {
@@ -36,6 +40,18 @@ public class ShapeGeometryImporter extends GeoImporter {
      * ESRI shapefile magic code at the beginning of the .shp file.
      */
     private static final int FILE_CODE = 9994;
+    /**
+     * Length of the header of shp and shx files in bytes.
+     */
+    private static final int HEADER_LENGTH = 100;
+    /**
+     * Length of the record header (number and content length) in bytes.
+     */
+    private static final int RECORD_HEADER_LENGTH = 8;
+    /**
+     * Do not start more threads than needed for small files.
+     */
+    private static final int MIN_RECORDS_PER_THREAD = 256;
 
     /**
      * Creates a new instance of ShapeGeometryImporter
@@ -94,334 +110,369 @@ public class ShapeGeometryImporter extends GeoImporter {
         return bis;
     }
 
+    /**
+     * Returns the content of the .shp file. Files are memory-mapped, other
+     * resources are read into memory.
+     * @param url The URL of the .shp file.
+     * @return A buffer with the content of the file, positioned at 0.
+     */
+    protected ByteBuffer findDataBuffer(java.net.URL url) throws IOException {
+        if (URLUtils.urlToFile(url) == null) {
+            return URLUtils.loadBufferFromStream(this.findInputStream(url));
+        }
+        return URLUtils.loadBufferFromURL(url);
+    }
+
     protected GeoObject importData(java.net.URL url) throws IOException {
-        MixedEndianDataInputStream is = null;
-        try {
-            url = this.findDataURL(url);
-            if (url == null) {
-                return null;
-            }
+        url = this.findDataURL(url);
+        if (url == null) {
+            return null;
+        }
 
-            GeoSet geoSet = this.createGeoSet();
-            geoSet.setName(ika.utils.FileUtils.getFileNameWithoutExtension(url.getPath()));
+        GeoSet geoSet = this.createGeoSet();
+        geoSet.setName(ika.utils.FileUtils.getFileNameWithoutExtension(url.getPath()));
+        // Shape files often contain thousands of records
+        geoSet.setSpatialIndexEnabled(true);
 
-            BufferedInputStream bis = this.findInputStream(url);
-            is = new MixedEndianDataInputStream(bis);
+        ByteBuffer buffer = this.findDataBuffer(url).order(ByteOrder.LITTLE_ENDIAN);
+        if (buffer.limit() < HEADER_LENGTH) {
+            throw new IOException("File is not an ESRI Shape file.");
+        }
 
-            // magic code is 9994
-            int fileCode = is.readInt();
-            if (fileCode != FILE_CODE) {
-                throw new IOException("File is not an ESRI Shape file. "
-                        + "Found file code: " + fileCode);
-            }
+        // magic code is 9994
+        int fileCode = bigEndianInt(buffer, 0);
+        if (fileCode != FILE_CODE) {
+            throw new IOException("File is not an ESRI Shape file. "
+                    + "Found file code: " + fileCode);
+        }
 
-            is.skipBytes(5 * 4);
-            int fileLength = is.readInt() * 2;
-
-            // read version and shape type
-            int version = is.readLittleEndianInt();
-            int shapeType = is.readLittleEndianInt();
-
-            // skip bounding box and four double values
-            is.skipBytes(8 * 8);
-
-            // Read all features stored in records. The shp file does not contain
-            // the number of records present in the file. The shx file can be 
-            // used to extract this information.
-            // If the shx file cannot be found, -1 is returned.
-            final int recordCount = this.readRecordCountFromSHXFile(url);
-            final int[] recOffsets = readSHXFile(url);
-            
-            // Read until as many records as specified in the shx file are 
-            // imported or until the end of file is reached and an EOFException
-            // is thrown.
-            int currentRecord = 0;
-            int currentPos = 100;
+        // read shape type
+        int shapeType = buffer.getInt(32);
+
+        // The shp file does not contain the number of records present in the
+        // file. Use the record offsets of the shx file for random access to
+        // the records. If the shx file cannot be found, the records are
+        // located by scanning the shp file.
+        int[] recOffsets = readSHXFile(url);
+        if (recOffsets == null) {
+            recOffsets = scanRecordOffsets(buffer);
+        }
+
+        // decode records in parallel chunks
+        final int recordCount = recOffsets.length;
+        Object[] records = new Object[recordCount];
+        int nThreads = Math.max(1, Math.min(Runtime.getRuntime().availableProcessors(),
+                recordCount / MIN_RECORDS_PER_THREAD));
+        ArrayList<RecordDecoderThread> threads = new ArrayList<RecordDecoderThread>(nThreads);
+        int recordChunk = (recordCount / nThreads) + 1;
+        for (int i = 0; i < nThreads; i++) {
+            int startRecord = i * recordChunk;
+            int endRecord = Math.min(recordCount, startRecord + recordChunk);
+            RecordDecoderThread t = new RecordDecoderThread(buffer, recOffsets,
+                    records, startRecord, endRecord);
+            threads.add(t);
+            t.start();
+        }
+        for (RecordDecoderThread t : threads) {
             try {
-                while (true) {
-                    
-                    // move to beginning of record
-                    is.skipBytes(recOffsets[currentRecord] - currentPos);
-                    currentPos = recOffsets[currentRecord];
-                    currentPos += readRecord(is, geoSet);
-                    
-                    if (progressIndicator != null) {
-                        final int percentage = (currentRecord + 1) * 100 / recordCount;
-                        if (!progressIndicator.progress(percentage)) {
-                            return null;
-                        }
-                    }
-                    if (++currentRecord == recordCount) {
-                        break;
-                    }
-                }
-            } catch (EOFException e) {
-                // EOFException indicates that all records have been read.
+                t.join();
+            } catch (InterruptedException ex) {
+                throw new IOException("Shape file import interrupted.");
             }
-
-            // setup the symbol
-            VectorSymbol symbol = new VectorSymbol();
-            symbol.setScaleInvariant(true);
-            symbol.setStrokeWidth(1);
-            if (shapeType == POLYGON || shapeType == POLYGONZ || shapeType == POLYGONM) {
-                symbol.setFilled(true);
-                symbol.setFillColor(java.awt.Color.WHITE);
+            if (t.exception != null) {
+                throw t.exception;
             }
-            geoSet.setVectorSymbol(symbol);
+        }
 
-            return geoSet;
+        // add the decoded records in the order of the file
+        for (int i = 0; i < recordCount; i++) {
+            if (records[i] instanceof GeoObject) {
+                geoSet.add((GeoObject) records[i]);
+            } else if (records[i] instanceof GeoObject[]) {
+                GeoObject[] geoObjects = (GeoObject[]) records[i];
+                for (int j = 0; j < geoObjects.length; j++) {
+                    geoSet.add(geoObjects[j]);
+                }
+            }
+            records[i] = null;
 
-        } finally {
-            if (is != null) {
-                is.close();
+            if (progressIndicator != null) {
+                final int percentage = (i + 1) * 100 / recordCount;
+                if (!progressIndicator.progress(percentage)) {
+                    return null;
+                }
             }
         }
+
+        // setup the symbol
+        VectorSymbol symbol = new VectorSymbol();
+        symbol.setScaleInvariant(true);
+        symbol.setStrokeWidth(1);
+        if (shapeType == POLYGON || shapeType == POLYGONZ || shapeType == POLYGONM) {
+            symbol.setFilled(true);
+            symbol.setFillColor(java.awt.Color.WHITE);
+        }
+        geoSet.setVectorSymbol(symbol);
+
+        return geoSet;
     }
 
     public String getImporterName() {
         return "Shape Importer";
     }
 
-    private int readRecord(MixedEndianDataInputStream is,
-            GeoSet geoSet)
-            throws IOException {
+    /**
+     * Reads a big-endian integer at an absolute position of a little-endian
+     * buffer.
+     */
+    private static int bigEndianInt(ByteBuffer buffer, int pos) {
+        return Integer.reverseBytes(buffer.getInt(pos));
+    }
 
-        final int recordNumber = is.readInt();
-        final int contentLength = is.readInt() * 2;
-        // content is at least one int (i.e. the ShapeType)
-        if (contentLength < 4) {
-            throw new EOFException("Negative record length");
+    /**
+     * Locates records by jumping from record header to record header. Used
+     * when no shx file is available.
+     * @param buffer The content of the shp file.
+     * @return The offsets of all complete records in bytes.
+     */
+    private static int[] scanRecordOffsets(ByteBuffer buffer) {
+        final int limit = buffer.limit();
+        int[] offsets = new int[1024];
+        int recordCount = 0;
+        int pos = HEADER_LENGTH;
+        while (pos + RECORD_HEADER_LENGTH <= limit) {
+            final int contentLength = bigEndianInt(buffer, pos + 4) * 2;
+            if (contentLength < 4 || pos + RECORD_HEADER_LENGTH + contentLength > limit) {
+                break;
+            }
+            if (recordCount == offsets.length) {
+                int[] newOffsets = new int[recordCount * 2];
+                System.arraycopy(offsets, 0, newOffsets, 0, recordCount);
+                offsets = newOffsets;
+            }
+            offsets[recordCount++] = pos;
+            pos += RECORD_HEADER_LENGTH + contentLength;
         }
+        int[] recOffsets = new int[recordCount];
+        System.arraycopy(offsets, 0, recOffsets, 0, recordCount);
+        return recOffsets;
+    }
 
-        final int shapeType = is.readLittleEndianInt();
-        int recordBytesRead = 8 + 4; // header is 8 bytes, shapeType is 4 bytes
+    /**
+     * Decodes a chunk of records. Each thread uses its own view on the shared
+     * buffer.
+     */
+    private class RecordDecoderThread extends Thread {
+
+        private final ByteBuffer buffer;
+        private final int[] recOffsets;
+        private final Object[] records;
+        private final int startRecord;
+        private final int endRecord;
+        private IOException exception;
+
+        public RecordDecoderThread(ByteBuffer buffer, int[] recOffsets,
+                Object[] records, int startRecord, int endRecord) {
+            // the byte order of a duplicate is reset to big-endian
+            this.buffer = buffer.duplicate().order(ByteOrder.LITTLE_ENDIAN);
+            this.recOffsets = recOffsets;
+            this.records = records;
+            this.startRecord = startRecord;
+            this.endRecord = endRecord;
+        }
 
-        switch (shapeType) {
-            case NULLSHAPE:
-                break;
-            case POINT:
-            case POINTZ:
-            case POINTM:
-                recordBytesRead += readPoint(is, geoSet, recordNumber);
-                break;
-            case MULTIPOINT:
-            case MULTIPOINTZ:
-            case MULTIPOINTM:
-                recordBytesRead += readMultipoint(is, geoSet, recordNumber);
-                break;
-            case POLYLINE:
-            case POLYLINEZ:
-            case POLYLINEM:
-                recordBytesRead += readPolyline(is, geoSet, recordNumber);
-                break;
-            case POLYGON:
-            case POLYGONZ:
-            case POLYGONM:
-                recordBytesRead += readPolygon(is, geoSet, recordNumber);
-                break;
-            case MULTIPATCH:
-                throw new IOException("Multipatch Shape files are not supported.");
-            default:
-                throw new IOException("Shapefile contains unsupported "
-                        + "geometry type: " + shapeType);
+        @Override
+        public void run() {
+            try {
+                for (int i = startRecord; i < endRecord; i++) {
+                    records[i] = readRecord(buffer, recOffsets[i]);
+                }
+            } catch (IOException exc) {
+                this.exception = exc;
+            }
         }
+    }
+
+    /**
+     * Decodes a single record.
+     * @param buffer The content of the shp file in little-endian byte order.
+     * @param pos The offset of the record in bytes.
+     * @return A GeoObject, an array of GeoObjects, or null if the record is
+     * empty, incomplete, or outside of the area of interest.
+     */
+    private Object readRecord(ByteBuffer buffer, int pos) throws IOException {
 
-        return recordBytesRead;
+        if (pos < HEADER_LENGTH || pos + RECORD_HEADER_LENGTH + 4 > buffer.limit()) {
+            return null;
+        }
+        final int recordNumber = bigEndianInt(buffer, pos);
+        final int contentLength = bigEndianInt(buffer, pos + 4) * 2;
+        // content is at least one int (i.e. the ShapeType)
+        final int contentPos = pos + RECORD_HEADER_LENGTH;
+        if (contentLength < 4 || contentPos + contentLength > buffer.limit()) {
+            return null;
+        }
+
+        final int shapeType = buffer.getInt(contentPos);
+        try {
+            switch (shapeType) {
+                case NULLSHAPE:
+                    return null;
+                case POINT:
+                case POINTZ:
+                case POINTM:
+                    return readPoint(buffer, contentPos + 4, recordNumber);
+                case MULTIPOINT:
+                case MULTIPOINTZ:
+                case MULTIPOINTM:
+                    return readMultipoint(buffer, contentPos + 4, recordNumber);
+                case POLYLINE:
+                case POLYLINEZ:
+                case POLYLINEM:
+                    return readPolyline(buffer, contentPos + 4, recordNumber, false);
+                case POLYGON:
+                case POLYGONZ:
+                case POLYGONM:
+                    return readPolyline(buffer, contentPos + 4, recordNumber, true);
+                case MULTIPATCH:
+                    throw new IOException("Multipatch Shape files are not supported.");
+                default:
+                    throw new IOException("Shapefile contains unsupported "
+                            + "geometry type: " + shapeType);
+            }
+        } catch (RuntimeException exc) {
+            // invalid offsets or counts: the record is corrupt
+            return null;
+        }
     }
 
-    private int readPoint(MixedEndianDataInputStream is, GeoSet geoSet, int recordID)
-            throws IOException {
+    private GeoPoint readPoint(ByteBuffer buffer, int pos, int recordID) {
 
-        final double x = is.readLittleEndianDouble();
-        final double y = is.readLittleEndianDouble();
+        final double x = buffer.getDouble(pos);
+        final double y = buffer.getDouble(pos + 8);
         GeoPoint geoPoint = new GeoPoint(x, y);
-        geoSet.add(geoPoint);
-        geoSet.setID(recordID);
-        return 2 * 8;
+        geoPoint.setID(recordID);
+        return geoPoint;
 
     }
 
-    private int readMultipoint(MixedEndianDataInputStream is, GeoSet geoSet, int recordID)
-            throws IOException {
+    private GeoObject[] readMultipoint(ByteBuffer buffer, int pos, int recordID) {
 
-        is.skipBytes(4 * 8); // skip bounding box
-        final int numPoints = is.readLittleEndianInt();
+        pos += 4 * 8; // skip bounding box
+        final int numPoints = buffer.getInt(pos);
+        pos += 4;
+        GeoObject[] points = new GeoObject[numPoints];
         for (int ptID = 0; ptID < numPoints; ptID++) {
-            readPoint(is, geoSet, recordID);
+            points[ptID] = readPoint(buffer, pos + ptID * 2 * 8, recordID);
         }
-        return 4 * 8 + 4 + numPoints * 2 * 8;
+        return points;
 
     }
 
-    private int readPolyline(MixedEndianDataInputStream is, GeoSet geoSet,
-            int recordID) throws IOException {
+    /**
+     * Reads a polyline or a polygon record into a single GeoPath. The points
+     * are read with a single bulk transfer into the coordinate array of the
+     * GeoPath. Parts with too few points are removed, and for polygons the
+     * last point of each ring, which repeats the first point, is replaced by
+     * a close instruction.
+     */
+    private GeoPath readPolyline(ByteBuffer buffer, int pos, int recordID,
+            boolean polygon) {
 
-        is.skipBytes(4 * 8); // skip bounding box
-        final int numParts = is.readLittleEndianInt();
-        final int numPoints = is.readLittleEndianInt();
+        pos += 4 * 8; // skip bounding box
+        final int numParts = buffer.getInt(pos);
+        final int numPoints = buffer.getInt(pos + 4);
+        pos += 8;
 
         // read indices into point array
         int[] pointIds = new int[numParts];
         for (int partID = 0; partID < numParts; partID++) {
-            pointIds[partID] = is.readLittleEndianInt();
+            pointIds[partID] = buffer.getInt(pos + partID * 4);
         }
+        pos += numParts * 4;
 
         // read point array
-        double[] x = new double[numPoints];
-        double[] y = new double[numPoints];
-        for (int ptID = 0; ptID < numPoints; ptID++) {
-            x[ptID] = is.readLittleEndianDouble();
-            y[ptID] = is.readLittleEndianDouble();
-        }
-
-        // construct one GeoPath
-        GeoPath geoPath = this.createGeoPath();
-        geoPath.setID(recordID);
-
+        double[] xy = new double[numPoints * 2];
+        buffer.position(pos);
+        buffer.asDoubleBuffer().get(xy);
+
+        // find the parts to keep and remove points that are not needed
+        final int minPoints = polygon ? 3 : 2;
+        int[] firstPoints = new int[numParts];
+        int partsCount = 0;
+        int pointsCount = 0;
         for (int partID = 0; partID < numParts; partID++) {
+            final int firstPtID = Math.max(0, pointIds[partID]);
+            int endPtID = partID + 1 < numParts ? pointIds[partID + 1] : numPoints;
+            endPtID = Math.min(endPtID, numPoints);
+
+            // the last point of a ring repeats the first point
+            if (polygon && endPtID - firstPtID > 1
+                    && xy[firstPtID * 2] == xy[endPtID * 2 - 2]
+                    && xy[firstPtID * 2 + 1] == xy[endPtID * 2 - 1]) {
+                --endPtID;
+            }
 
-            int firstPtID = pointIds[partID];
-            int lastPtID = partID + 1 < numParts ? pointIds[partID + 1] : numPoints;
-
-            // part must have at least two points
-            if ((lastPtID - firstPtID) < 2) {
+            // part must have at least minPoints points
+            final int partPoints = endPtID - firstPtID;
+            if (partPoints < minPoints) {
                 continue;
             }
 
-            geoPath.moveTo(x[firstPtID], y[firstPtID]);
-            for (int ptID = firstPtID + 1; ptID < lastPtID; ptID++) {
-                geoPath.lineTo(x[ptID], y[ptID]);
+            if (firstPtID != pointsCount) {
+                System.arraycopy(xy, firstPtID * 2, xy, pointsCount * 2, partPoints * 2);
             }
+            firstPoints[partsCount++] = pointsCount;
+            pointsCount += partPoints;
         }
-
-        geoSet.add(geoPath);
-
-        return 4 * 8 + 4 + 4 + numParts * 4 + numPoints * 2 * 8;
-    }
-
-    private int readPolygon(MixedEndianDataInputStream is, GeoSet geoSet,
-            int recordID) throws IOException {
-
-        is.skipBytes(4 * 8); // skip bounding box
-
-        final int numParts = is.readLittleEndianInt();
-        final int numPoints = is.readLittleEndianInt();
-
-        // read indices into point array
-        int[] pointIds = new int[numParts];
-        for (int partID = 0; partID < numParts; partID++) {
-            pointIds[partID] = is.readLittleEndianInt();
+        if (pointsCount != numPoints) {
+            double[] compactXY = new double[pointsCount * 2];
+            System.arraycopy(xy, 0, compactXY, 0, pointsCount * 2);
+            xy = compactXY;
         }
-
-        // read point array
-        double[] x = new double[numPoints];
-        double[] y = new double[numPoints];
-        for (int ptID = 0; ptID < numPoints; ptID++) {
-            x[ptID] = is.readLittleEndianDouble();
-            y[ptID] = is.readLittleEndianDouble();
+        if (partsCount != numParts) {
+            int[] compactFirstPoints = new int[partsCount];
+            System.arraycopy(firstPoints, 0, compactFirstPoints, 0, partsCount);
+            firstPoints = compactFirstPoints;
         }
 
         // construct one GeoPath
+        GeoPathModel pathModel = new GeoPathModel();
+        pathModel.setStraightLines(xy, firstPoints, polygon);
         GeoPath geoPath = this.createGeoPath();
+        geoPath.setPathModel(pathModel);
         geoPath.setID(recordID);
-
-        // add sections
-        for (int partID = 0; partID < numParts; partID++) {
-            int firstPtID = pointIds[partID];
-            int lastPtID = partID + 1 < numParts ? pointIds[partID + 1] : numPoints - 1;
-
-            // part must have at least two points
-            if ((lastPtID - firstPtID) < 2) {
-                continue;
-            }
-
-            geoPath.moveTo(x[firstPtID], y[firstPtID]);
-            for (int ptID = firstPtID + 1; ptID < lastPtID; ptID++) {
-                geoPath.lineTo(x[ptID], y[ptID]);
-            }
-
-            // close polygon when there are more than 2 points
-            if (geoPath.getDrawingInstructionCount() > 2) {
-                geoPath.closePath();
-            }
-        }
-
-        geoSet.add(geoPath);
-        return 4 * 8 + 4 + 4 + numParts * 4 + numPoints * 2 * 8;
+        return geoPath;
     }
 
     /**
-     * Reads the number of records from the shx file.
+     * Reads the record offsets from the shx file.
      * @param shapeURL The URL of the data shape file.
-     * @return The number of records or -1 if the shx file cannot be found.
+     * @return The offsets of the records in bytes, or null if the shx file
+     * cannot be found or read.
      */
-    private int readRecordCountFromSHXFile(java.net.URL shapeURL) {
-
-        MixedEndianDataInputStream is = null;
-        try {
-            java.net.URL shxURL = findSHXURL(shapeURL);
-            if (shxURL == null) {
-                return -1;
-            }
-            BufferedInputStream bis = new BufferedInputStream(shxURL.openStream());
-            is = new MixedEndianDataInputStream(bis);
-            is.skipBytes(24);
-            final int fileLength = is.readInt() * 2;
-            final int recordsCount = (fileLength - 100) / 8;
-            return recordsCount;
-        } catch (java.io.IOException e) {
-            return -1;
-        } finally {
-            if (is != null) {
-                try {
-                    is.close();
-                } catch (java.io.IOException e) {
-                }
-            }
-        }
-
-    }
-
     private int[] readSHXFile(java.net.URL shapeURL) {
 
-        MixedEndianDataInputStream is = null;
         try {
             java.net.URL shxURL = findSHXURL(shapeURL);
             if (shxURL == null) {
                 return null;
             }
-            BufferedInputStream bis = new BufferedInputStream(shxURL.openStream());
-            is = new MixedEndianDataInputStream(bis);
-            is.skipBytes(24);
-            final int fileLength = is.readInt() * 2;
-            final int recordsCount = (fileLength - 100) / 8;
-            int[] offsets = new int[recordsCount];
-            is.skipBytes(72);
+            ByteBuffer shx = URLUtils.loadBufferFromURL(shxURL);
+            if (shx.limit() < HEADER_LENGTH) {
+                return null;
+            }
+            final int fileLength = Math.min(bigEndianInt(shx, 24) * 2, shx.limit());
+            final int recordsCount = Math.max(0, (fileLength - HEADER_LENGTH) / 8);
             int[] recOffsets = new int[recordsCount];
-            
             for (int i = 0; i < recordsCount; i++) {
-                recOffsets[i] = is.readInt() * 2;
-                // skip length
-                is.readInt();
-                
-                /*
-                System.out.println("Shape " + i);
-                System.out.println("Offset: " + is.readInt() * 2);
-                System.out.println("Content Length: " + is.readInt() * 2);
-                */
+                // offset is followed by content length
+                recOffsets[i] = bigEndianInt(shx, HEADER_LENGTH + i * 8) * 2;
             }
-
             return recOffsets;
         } catch (java.io.IOException e) {
             return null;
-        } finally {
-            if (is != null) {
-                try {
-                    is.close();
-                } catch (java.io.IOException e) {
-                }
-            }
         }
 
     }
-}
\ No newline at end of file
+}
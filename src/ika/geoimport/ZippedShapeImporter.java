@@ -9,6 +9,7 @@ package ika.geoimport;
 
 import java.io.BufferedInputStream;
 import java.io.IOException;
+import java.nio.ByteBuffer;
 import java.util.zip.GZIPInputStream;
 
 /**
@@ -30,4 +31,12 @@ public class ZippedShapeImporter extends ShapeImporter {
         BufferedInputStream bis = new BufferedInputStream( new GZIPInputStream(url.openStream()));
         return bis;
     }
+    
+    /**
+     * Zipped files cannot be memory-mapped, the unzipped content is read into
+     * memory instead.
+     */
+    protected ByteBuffer findDataBuffer(java.net.URL url) throws IOException {
+        return ika.utils.URLUtils.loadBufferFromStream(this.findInputStream(url));
+    }
 }
@@ -335,36 +335,43 @@ public final class DistortionProfilesManager
         GeoSet geoSet = new GeoSet();
         GeoPath areaProfile = new GeoPath();
         GeoPath angleProfile = new GeoPath();
-        ProjectionFactors projFactors = new ProjectionFactors();
 
-        if (vertical) {
-            // vertical profiles
-            for (int lat = -90; lat < 90; lat += LAT_INCREMENT) {
-                try {
-                    projFactors.compute(projection, profileLon * MapMath.DTR, lat * MapMath.DTR, DH);
-                    if (projFactors.s <= MAX_AREA && projFactors.s > 0) {
-                        areaProfile.moveOrLineTo(projFactors.s * AREA_SCALE, lat);
-                    }
-                    if (projFactors.omega <= MAX_ANGLE && projFactors.omega >= 0) {
-                        angleProfile.moveOrLineTo(projFactors.omega * MapMath.RTD, lat);
-                    }
-                } catch (Exception exc) {
-                    //
+        // the positions of the samples along the profile in degrees
+        final int n = vertical
+                ? (180 + LAT_INCREMENT - 1) / LAT_INCREMENT
+                : 360 / LON_INCREMENT + 1;
+        final double[] lon = new double[n];
+        final double[] lat = new double[n];
+        for (int i = 0; i < n; i++) {
+            lon[i] = vertical ? profileLon : -180 + i * LON_INCREMENT;
+            lat[i] = vertical ? -90 + i * LAT_INCREMENT : profileLat;
+        }
+        final double[] lam = new double[n];
+        final double[] phi = new double[n];
+        for (int i = 0; i < n; i++) {
+            lam[i] = lon[i] * MapMath.DTR;
+            phi[i] = lat[i] * MapMath.DTR;
+        }
+        BulkProjectionFactors projFactors 
+                = BulkProjectionFactors.compute(projection, lam, phi, DH);
+
+        // points that cannot be projected have NaN factors and are skipped
+        for (int i = 0; i < n; i++) {
+            final double s = projFactors.s[i];
+            final double omega = projFactors.omega[i];
+            if (vertical) {
+                if (s <= MAX_AREA && s > 0) {
+                    areaProfile.moveOrLineTo(s * AREA_SCALE, lat[i]);
                 }
-            }
-        } else {
-            // horizontal profiles
-            for (int lon = -180; lon <= 180; lon += LON_INCREMENT) {
-                try {
-                    projFactors.compute(projection, lon * MapMath.DTR, profileLat * MapMath.DTR, DH);
-                    if (projFactors.s <= MAX_AREA && projFactors.s > 0) {
-                        areaProfile.moveOrLineTo(lon, projFactors.s * AREA_SCALE);
-                    }
-                    if (projFactors.omega <= MAX_ANGLE && projFactors.omega >= 0) {
-                        angleProfile.moveOrLineTo(lon, projFactors.omega * MapMath.RTD);
-                    }
-                } catch (Exception exc) {
-                    //
+                if (omega <= MAX_ANGLE && omega >= 0) {
+                    angleProfile.moveOrLineTo(omega * MapMath.RTD, lat[i]);
+                }
+            } else {
+                if (s <= MAX_AREA && s > 0) {
+                    areaProfile.moveOrLineTo(lon[i], s * AREA_SCALE);
+                }
+                if (omega <= MAX_ANGLE && omega >= 0) {
+                    angleProfile.moveOrLineTo(lon[i], omega * MapMath.RTD);
                 }
             }
         }
@@ -49,6 +49,13 @@ public class FlexProjectorWindow extends MainWindow
 
     private ProjectionBrewerPanel projectionBrewerPanel;
 
+    /**
+     * Intercept mouse and key events while editing is blocked.
+     */
+    private Component editingBlocker;
+    private KeyEventDispatcher editingKeyBlocker;
+    private Component glassPaneBeforeBlocking;
+
     /**
      * Creates new form FlexProjectorWindow
      */
@@ -290,11 +297,13 @@ public class FlexProjectorWindow extends MainWindow
         // pass map to panel for undo/redo support
         this.projectionBrewerPanel.setMap(this.mapComponent);
 
-        // load default coastline data
-        Properties props = PropertiesLoader.loadProperties("ika.app.Application.properties");
-        String mapData = props.getProperty("MapData");
-        java.net.URL url = FlexProjectorWindow.class.getResource(mapData);
-        importData(url, true);
+        // load default coastline data. Data that is loaded in the background
+        // since startup is added when ready; until then editing is blocked.
+        java.net.URL url = ika.app.Startup.getDefaultMapDataURL();
+        ika.geoimport.DataPreloader preloader = ika.app.Startup.takePreloadedData(url);
+        if (preloader == null) {
+            importData(url, true, null);
+        }
 
         // initialize the undo/redo manager with the current map content.
         this.mapComponent.resetUndo();
@@ -317,12 +326,131 @@ public class FlexProjectorWindow extends MainWindow
         new ika.proj.TableFiller(distortionTable, flexProjectorModel).execute();
 
         projectionBrewerPanel.writeDisplayGUI();
+
+        if (preloader != null) {
+            this.addPreloadedData(preloader, url);
+        } else {
+            this.windowReady();
+        }
         return true;
 
     }
 
+    /**
+     * Shows the window without waiting for the data loaded at startup. The
+     * data is added in the Event Dispatching Thread when it is ready. Editing
+     * is blocked until then, and the undo history and the clean state of the
+     * document are initialized after the data is added.
+     */
+    private void addPreloadedData(final ika.geoimport.DataPreloader preloader,
+            final java.net.URL url) {
+
+        this.setEditingBlocked(true);
+        Thread thread = new Thread("Wait for preloaded data") {
+
+            @Override
+            public void run() {
+                try {
+                    preloader.join();
+                } catch (InterruptedException exc) {
+                    // deliver() waits again in the Event Dispatching Thread
+                }
+                SwingUtilities.invokeLater(new Runnable() {
+
+                    @Override
+                    public void run() {
+                        importData(url, true, preloader);
+                        mapComponent.resetUndo();
+                        setDocumentClean();
+                        setEditingBlocked(false);
+                        windowReady();
+                    }
+                });
+            }
+        };
+        thread.setDaemon(true);
+        thread.start();
+    }
+
+    /**
+     * Tells Startup that the window can be used, after the events painting
+     * the window are processed.
+     */
+    private void windowReady() {
+        SwingUtilities.invokeLater(new Runnable() {
+
+            @Override
+            public void run() {
+                ika.app.Startup.windowReady();
+            }
+        });
+    }
+
+    /**
+     * Blocks or unblocks user input while the data loaded at startup is
+     * added. Mouse events are intercepted by a glass pane showing a wait
+     * cursor, key events for this window are discarded, and the menus are
+     * disabled.
+     * @param blocked True to block, false to unblock.
+     */
+    private void setEditingBlocked(boolean blocked) {
+        if (blocked == (this.editingBlocker != null)) {
+            return;
+        }
+        JMenuBar menuBar = this.getJMenuBar();
+        if (menuBar != null) {
+            for (int i = 0; i < menuBar.getMenuCount(); i++) {
+                JMenu menu = menuBar.getMenu(i);
+                if (menu != null) {
+                    menu.setEnabled(!blocked);
+                }
+            }
+        }
+        KeyboardFocusManager kfm = KeyboardFocusManager.getCurrentKeyboardFocusManager();
+        if (blocked) {
+            JPanel blocker = new JPanel();
+            blocker.setOpaque(false);
+            MouseAdapter mouseBlocker = new MouseAdapter() {
+            };
+            blocker.addMouseListener(mouseBlocker);
+            blocker.addMouseMotionListener(mouseBlocker);
+            blocker.addMouseWheelListener(mouseBlocker);
+            blocker.setCursor(Cursor.getPredefinedCursor(Cursor.WAIT_CURSOR));
+            this.glassPaneBeforeBlocking = this.getGlassPane();
+            this.setGlassPane(blocker);
+            blocker.setVisible(true);
+            this.editingBlocker = blocker;
+
+            this.editingKeyBlocker = new KeyEventDispatcher() {
+
+                @Override
+                public boolean dispatchKeyEvent(KeyEvent e) {
+                    return SwingUtilities.getWindowAncestor(e.getComponent())
+                            == FlexProjectorWindow.this
+                            || e.getComponent() == FlexProjectorWindow.this;
+                }
+            };
+            kfm.addKeyEventDispatcher(this.editingKeyBlocker);
+        } else {
+            kfm.removeKeyEventDispatcher(this.editingKeyBlocker);
+            this.editingKeyBlocker = null;
+            this.editingBlocker.setVisible(false);
+            this.setGlassPane(this.glassPaneBeforeBlocking);
+            this.glassPaneBeforeBlocking = null;
+            this.editingBlocker = null;
+            this.updateAllMenus();
+        }
+    }
+
+    /**
+     * Imports data and adds it to the map.
+     * @param url The URL of the data.
+     * @param replacePreviousData If true, the current data is removed.
+     * @param preloader Passes data imported in the background if not null.
+     */
     private void importData(final java.net.URL url,
-            final boolean replacePreviousData) {
+            final boolean replacePreviousData,
+            ika.geoimport.DataPreloader preloader) {
 
         MapDataReceiver receiver = new MapDataReceiver(mapComponent) {
             @Override
@@ -343,7 +471,8 @@ public class FlexProjectorWindow extends MainWindow
                 if (added) {
                     FlexProjectorModel model
                             = (FlexProjectorModel) mapComponent.getGeoSet();
-                    model.designProjectionChanged(model.getDesignProjection());
+                    // construct the map synchronously before showAll()
+                    model.mapChanged();
                     mapComponent.showAll();
                 }
             }
@@ -364,6 +493,12 @@ public class FlexProjectorWindow extends MainWindow
         };
 
         try {
+            // use the data if it has been loaded in the background at startup
+            if (preloader != null) {
+                preloader.deliver(receiver);
+                return;
+            }
+            
             GeoImporter importer = GeoImporter.findGeoImporter(url);
             // importer.setProgressIndicator(new SwingProgressIndicator(this, "Load Data", null, true));
             importer.read(url, receiver, GeoImporter.SAME_THREAD); // FIXME NEW_THREAD);
@@ -1812,7 +1947,7 @@ minimizeMenuItem.addActionListener(new java.awt.event.ActionListener() {
         // load the data
         try {
             String url = (String) urls.get(names.indexOf(name));
-            this.importData(new java.net.URL(url), replaceCurrentData);
+            this.importData(new java.net.URL(url), replaceCurrentData, null);
         } catch (MalformedURLException e) {
             e.printStackTrace();
             ika.utils.ErrorDialog.showErrorDialog("Could not find the data on www.flexprojector.com.", e);
@@ -2067,7 +2202,13 @@ minimizeMenuItem.addActionListener(new java.awt.event.ActionListener() {
         }
 
         // put the selected GeoObjects onto the clipboard
-        GeoTransferable.storeInSystemClipboard(copyGeoSet);
+        try {
+            GeoTransferable.storeInSystemClipboard(copyGeoSet);
+        } catch (java.io.IOException exc) {
+            exc.printStackTrace();
+            ika.utils.ErrorDialog.showErrorDialog("Could not cut the selection.", exc);
+            return;
+        }
 
         // delete the selected GeoObjects
         this.mapComponent.removeSelectedGeoObjects();
@@ -2086,7 +2227,13 @@ minimizeMenuItem.addActionListener(new java.awt.event.ActionListener() {
         copyGeoSet = (GeoSet) copyGeoSet.getGeoObject(0);
 
         // put the selected objects onto the clipboard
-        GeoTransferable.storeInSystemClipboard(copyGeoSet);
+        try {
+            GeoTransferable.storeInSystemClipboard(copyGeoSet);
+        } catch (java.io.IOException exc) {
+            exc.printStackTrace();
+            ika.utils.ErrorDialog.showErrorDialog("Could not copy the selection.", exc);
+            return;
+        }
 
         // update the "Paste" command in the edit menu
         this.updateEditMenu();
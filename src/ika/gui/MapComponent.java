@@ -705,6 +705,34 @@ public class MapComponent extends javax.swing.JComponent
 
     }
 
+    /**
+     * Draws the timings recorded by Instrumentation in the upper left corner.
+     * @param g2d The destination to draw to.
+     */
+    private void paintInstrumentation(Graphics2D g2d) {
+
+        java.util.List<String> lines = Instrumentation.getSummary();
+        if (lines.isEmpty()) {
+            return;
+        }
+        g2d.setFont(new Font("Monospaced", Font.PLAIN, 11));
+        final FontMetrics fm = g2d.getFontMetrics();
+        int width = 0;
+        for (String line : lines) {
+            width = Math.max(width, fm.stringWidth(line));
+        }
+        final int lineHeight = fm.getHeight();
+        final Insets insets = getInsets();
+        final int x = insets.left + 5;
+        final int y = insets.top + 5;
+        g2d.setColor(new Color(255, 255, 255, 200));
+        g2d.fillRect(x, y, width + 10, lines.size() * lineHeight + 10);
+        g2d.setColor(Color.BLACK);
+        for (int i = 0; i < lines.size(); i++) {
+            g2d.drawString(lines.get(i), x + 5, y + 5 + fm.getAscent() + i * lineHeight);
+        }
+    }
+
     /**
      * Override paintComponent of JComponent for custom drawing.
      * @param g The destination to draw to.
@@ -712,6 +740,7 @@ public class MapComponent extends javax.swing.JComponent
     @Override
     protected void paintComponent(Graphics g) {
 
+        final long paintStart = Instrumentation.start();
 
         //ika.utils.NanoTimer timer = new ika.utils.NanoTimer();
         // final long startTime = timer.nanoTime();
@@ -789,12 +818,19 @@ public class MapComponent extends javax.swing.JComponent
                 paintInfoString(g2d);
             }
 
+            // draw the timing overlay
+            if (Instrumentation.isEnabled()) {
+                g2d.setTransform(origTransform);
+                paintInstrumentation(g2d);
+            }
+
             g2d.dispose(); //release the copy's resources. Recomended by Sun tutorial.
         } catch (Throwable exc) {
             String msg = "An error occured while rendering the map.";
             String title = "Rendering Error";
             ika.utils.ErrorDialog.showErrorDialog(msg, title, exc, this);
         }
+        Instrumentation.stop("MapComponent.paint", paintStart);
         /*
         System.out.println ("Time for Drawing Map: "
         + (timer.nanoTime() - startTime) / 1000 / 1000
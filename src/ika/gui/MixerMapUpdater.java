@@ -0,0 +1,133 @@
+/*
+ * MixerMapUpdater.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+
+package ika.gui;
+
+import com.jhlabs.map.proj.Projection;
+import ika.geo.FlexProjectorModel;
+import ika.geo.GeoPath;
+import ika.geo.GeoPathDecimator;
+import ika.geo.GeoProjector;
+import ika.geo.GeoSet;
+import ika.geo.VectorSymbol;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import javax.swing.SwingUtilities;
+
+/**
+ * Computes the content of a small mixer map in a separate thread. A coarse
+ * version with reduced coastlines is displayed first, followed by the full
+ * version. Each call to update() makes all earlier requests obsolete: they are
+ * not started, or their results are discarded. Only the finished GeoSets are
+ * added to the map in the Event Dispatching Thread.
+ */
+public class MixerMapUpdater {
+
+    /**
+     * Only every COARSE_STEP-th point of the coastlines is projected for the
+     * coarse map.
+     */
+    private static final int COARSE_STEP = 8;
+
+    private final MapComponent mapComponent;
+
+    /**
+     * Executes requests sequentially in a single thread.
+     */
+    private final ExecutorService executor = Executors.newSingleThreadExecutor();
+
+    /**
+     * Identifies the most recent request. Incremented in the Event
+     * Dispatching Thread and read by the worker thread.
+     */
+    private volatile long currentRequest = 0;
+
+    public MixerMapUpdater(MapComponent mapComponent) {
+        this.mapComponent = mapComponent;
+    }
+
+    /**
+     * Starts computing the map content. Must be called in the Event
+     * Dispatching Thread.
+     * @param projection The projection of the map. A copy is used, so the
+     * projection can be changed after this call.
+     * @param model The model with the data to project.
+     * @param color The color of the map.
+     */
+    public void update(Projection projection, FlexProjectorModel model,
+            java.awt.Color color) {
+
+        final long request = ++this.currentRequest;
+        final Projection proj = (Projection) projection.clone();
+        final FlexProjectorModel flexModel = model;
+        final GeoSet data = model.getUnprojectedData().clone();
+        final VectorSymbol symbol = new VectorSymbol(null, color, 1);
+        symbol.setScaleInvariant(true);
+
+        this.executor.execute(new Runnable() {
+
+            @Override
+            public void run() {
+                try {
+                    if (request != currentRequest) {
+                        return;
+                    }
+                    GeoSet graticule = flexModel.constructGraticule(proj);
+                    GeoPath outline = FlexProjectorModel.constructOutline(proj);
+
+                    // the map takes ownership of published GeoObjects
+                    GeoSet fullGraticule = graticule.clone();
+                    GeoPath fullOutline = outline.clone();
+
+                    GeoSet coarse = GeoPathDecimator.decimate(data, COARSE_STEP);
+                    new GeoProjector(proj).project(coarse);
+                    publish(request, coarse, graticule, outline, symbol);
+
+                    if (request != currentRequest) {
+                        return;
+                    }
+                    new GeoProjector(proj).project(data);
+                    publish(request, data, fullGraticule, fullOutline, symbol);
+                } catch (RuntimeException exc) {
+                    exc.printStackTrace();
+                }
+            }
+        });
+    }
+
+    /**
+     * Adds the map content in the Event Dispatching Thread, unless a newer
+     * request has been made.
+     */
+    private void publish(final long request, final GeoSet coastLines,
+            final GeoSet graticule, final GeoPath outline,
+            final VectorSymbol symbol) {
+
+        SwingUtilities.invokeLater(new Runnable() {
+
+            @Override
+            public void run() {
+                if (request != currentRequest) {
+                    return;
+                }
+                coastLines.setVectorSymbol(symbol);
+                graticule.setVectorSymbol(symbol);
+                outline.setVectorSymbol(symbol);
+
+                coastLines.setSelectable(false);
+                graticule.setSelectable(false);
+                outline.setSelectable(false);
+
+                mapComponent.removeAllGeoObjects();
+                mapComponent.addGeoObject(coastLines, false);
+                mapComponent.addGeoObject(graticule, false);
+                mapComponent.addGeoObject(outline, false);
+                mapComponent.showAll();
+            }
+        });
+    }
+}
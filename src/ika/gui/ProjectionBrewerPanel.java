@@ -11,15 +11,14 @@ import com.jhlabs.map.proj.Projection;
 import com.jhlabs.map.proj.ProjectionFactory;
 import ika.geo.FlexProjectorModel;
 import ika.geo.FlexProjectorModel.DisplayModel;
-import ika.geo.GeoPath;
 import ika.geo.GeoSet;
 import ika.geo.MapEventTrigger;
-import ika.geo.VectorSymbol;
 import ika.proj.AbstractMixerProjection;
 import ika.proj.DesignProjection;
 import ika.proj.FlexMixProjection;
 import ika.proj.FlexProjection;
 import ika.proj.FlexProjectionModel;
+import ika.proj.FlexProjectionOptimizer;
 import ika.proj.LatitudeMixerProjection;
 import ika.proj.MeanProjection;
 import ika.proj.ProjectionDistortionParameters;
@@ -43,6 +42,7 @@ import java.util.Hashtable;
 import java.util.List;
 import java.util.Properties;
 import java.util.concurrent.*;
+import java.util.concurrent.atomic.AtomicReference;
 import javax.swing.*;
 import javax.swing.event.ChangeEvent;
 import javax.swing.event.ChangeListener;
@@ -94,6 +94,11 @@ public class ProjectionBrewerPanel extends javax.swing.JPanel {
      * guaranteed to be executed sequentially.
      */
     private final ExecutorService asynchTableUpdater = Executors.newSingleThreadExecutor();
+    /**
+     * Compute the content of the two small mixer maps in separate threads.
+     */
+    private MixerMapUpdater mixerMapUpdater1;
+    private MixerMapUpdater mixerMapUpdater2;
     /**
      * listeners that are informed whenever the design projection changes.
      */
@@ -308,28 +313,20 @@ public class ProjectionBrewerPanel extends javax.swing.JPanel {
         projection.setProjectionLongitude(lon0);
         projection.initialize();
 
-        // get the projected map data
-        VectorSymbol symbol = new VectorSymbol(null,
-                FlexProjectorPreferencesPanel.getFlexColor(), 1);
-        symbol.setScaleInvariant(true);
-        GeoSet coastLines = model.constructProjectedCoastlines(projection);
-        GeoSet graticule = model.constructGraticule(projection);
-        GeoPath outline = FlexProjectorModel.constructOutline(projection);
-
-        mixerMapComponent.removeAllGeoObjects();
-
-        coastLines.setVectorSymbol(symbol);
-        graticule.setVectorSymbol(symbol);
-        outline.setVectorSymbol(symbol);
-
-        coastLines.setSelectable(false);
-        graticule.setSelectable(false);
-        outline.setSelectable(false);
-
-        mixerMapComponent.addGeoObject(coastLines, false);
-        mixerMapComponent.addGeoObject(graticule, false);
-        mixerMapComponent.addGeoObject(outline, false);
-        mixerMapComponent.showAll();
+        // project the map data in a separate thread
+        MixerMapUpdater updater;
+        if (mixerMapComponent == mixerMap1) {
+            if (mixerMapUpdater1 == null) {
+                mixerMapUpdater1 = new MixerMapUpdater(mixerMap1);
+            }
+            updater = mixerMapUpdater1;
+        } else {
+            if (mixerMapUpdater2 == null) {
+                mixerMapUpdater2 = new MixerMapUpdater(mixerMap2);
+            }
+            updater = mixerMapUpdater2;
+        }
+        updater.update(projection, model, FlexProjectorPreferencesPanel.getFlexColor());
     }
 
     private boolean scalesDiffer(double scale1, double scale2) {
@@ -812,13 +809,15 @@ public class ProjectionBrewerPanel extends javax.swing.JPanel {
             updatingGUI = false;
         }
 
-        // when the user releases the mouse, the values are copied from the
-        // GUI to the flex model.
-        if (!slider.getValueIsAdjusting()) {
-            for (int j = 0; j < xNumbers.length; j++) {
-                flexModel.setX(j, ((Number) xNumbers[j].getValue()).doubleValue());
-            }
+        // copy the values from the GUI to the flex model
+        for (int j = 0; j < xNumbers.length; j++) {
+            flexModel.setX(j, ((Number) xNumbers[j].getValue()).doubleValue());
+        }
 
+        // only show a quick preview until the user releases the mouse
+        if (slider.getValueIsAdjusting()) {
+            model.mapChangedInteractive();
+        } else {
             updateDistortionIndicesAndInformListeners();
             mapComponent.addUndo("Change of Parallels Length");
             showDesignProjection();
@@ -883,14 +882,15 @@ public class ProjectionBrewerPanel extends javax.swing.JPanel {
         }
 
 
-        if (!slider.getValueIsAdjusting()) {
-
-            // when the user releases the mouse, the values are copied from the
-            // GUI to the flexModel.
-            for (int j = 1; j < yNumbers.length; j++) {
-                flexModel.setY(j, ((Number) yNumbers[j].getValue()).doubleValue());
+        // copy the values from the GUI to the flex model
+        for (int j = 1; j < yNumbers.length; j++) {
+            flexModel.setY(j, ((Number) yNumbers[j].getValue()).doubleValue());
+        }
 
-            }
+        // only show a quick preview until the user releases the mouse
+        if (slider.getValueIsAdjusting()) {
+            model.mapChangedInteractive();
+        } else {
 
             // a hack to keep the aspect ratio constant
             if (KEEP_ASPECT_CONSTANT_HACK) {
@@ -952,12 +952,15 @@ public class ProjectionBrewerPanel extends javax.swing.JPanel {
             updatingGUI = false;
         }
 
-        if (!slider.getValueIsAdjusting()) {
-            // when the user releases the mouse, the values are copied from the
-            // GUI to the flexModel.
-            for (int j = 0; j < bNumbers.length; j++) {
-                flexModel.setBending(j, ((Number) bNumbers[j].getValue()).doubleValue());
-            }
+        // copy the values from the GUI to the flex model
+        for (int j = 0; j < bNumbers.length; j++) {
+            flexModel.setBending(j, ((Number) bNumbers[j].getValue()).doubleValue());
+        }
+
+        // only show a quick preview until the user releases the mouse
+        if (slider.getValueIsAdjusting()) {
+            model.mapChangedInteractive();
+        } else {
             updateDistortionIndicesAndInformListeners();
             mapComponent.addUndo("Change of Bending");
             showDesignProjection();
@@ -1002,12 +1005,15 @@ public class ProjectionBrewerPanel extends javax.swing.JPanel {
             updatingGUI = false;
         }
 
-        if (!slider.getValueIsAdjusting()) {
-            // when the user releases the mouse, the values are copied from the
-            // GUI to the flexModel.
-            for (int j = 0; j < xDistNumbers.length - 1; j++) {
-                flexModel.setXDist(j, ((Number) xDistNumbers[j].getValue()).doubleValue());
-            }
+        // copy the values from the GUI to the flex model
+        for (int j = 0; j < xDistNumbers.length - 1; j++) {
+            flexModel.setXDist(j, ((Number) xDistNumbers[j].getValue()).doubleValue());
+        }
+
+        // only show a quick preview until the user releases the mouse
+        if (slider.getValueIsAdjusting()) {
+            model.mapChangedInteractive();
+        } else {
             updateDistortionIndicesAndInformListeners();
             mapComponent.addUndo("Change of Meridians Distribution");
             showDesignProjection();
@@ -1126,6 +1132,7 @@ public class ProjectionBrewerPanel extends javax.swing.JPanel {
         jSeparator1 = new JPopupMenu.Separator();
         polesAndEquatorMenuItem = new javax.swing.JMenuItem();
         eliminateShapeDistortionAtOriginMenuItem = new javax.swing.JMenuItem();
+        optimizeDistortionMenuItem = new javax.swing.JMenuItem();
         jSeparator2 = new JPopupMenu.Separator();
         bendingMenu = new javax.swing.JMenu();
         cubicBendingRadioButtonMenuItem = new javax.swing.JRadioButtonMenuItem();
@@ -1459,6 +1466,14 @@ public class ProjectionBrewerPanel extends javax.swing.JPanel {
             }
         });
         optionsPopupMenu.add(eliminateShapeDistortionAtOriginMenuItem);
+
+        optimizeDistortionMenuItem.setText("Optimize Distortion");
+        optimizeDistortionMenuItem.addActionListener(new java.awt.event.ActionListener() {
+            public void actionPerformed(java.awt.event.ActionEvent evt) {
+                optimizeDistortionMenuItemActionPerformed(evt);
+            }
+        });
+        optionsPopupMenu.add(optimizeDistortionMenuItem);
         optionsPopupMenu.add(jSeparator2);
 
         bendingMenu.setText("Parallels Bending");
@@ -3897,6 +3912,138 @@ public class ProjectionBrewerPanel extends javax.swing.JPanel {
 
 }//GEN-LAST:event_eliminateShapeDistortionAtOriginMenuItemActionPerformed
 
+    private void optimizeDistortionMenuItemActionPerformed(java.awt.event.ActionEvent evt) {//GEN-FIRST:event_optimizeDistortionMenuItemActionPerformed
+        if (updatingGUI) {
+            return;
+        }
+        showDesignProjection();
+        optimizeDistortion();
+    }//GEN-LAST:event_optimizeDistortionMenuItemActionPerformed
+
+    /**
+     * Asks for the weights of the distortion indices and optimizes the curves
+     * of the flex projection in a background thread. Improved curves are
+     * shown while the optimization is running.
+     */
+    private void optimizeDistortion() {
+
+        JSpinner danSpinner = new JSpinner(new SpinnerNumberModel(1d, 0d, 10d, 0.1));
+        JSpinner darSpinner = new JSpinner(new SpinnerNumberModel(1d, 0d, 10d, 0.1));
+        JSpinner dabSpinner = new JSpinner(new SpinnerNumberModel(0d, 0d, 10d, 0.1));
+        JSpinner qSpinner = new JSpinner(new SpinnerNumberModel(0d, 0d, 10d, 0.1));
+        JPanel weightsPanel = new JPanel(new GridLayout(0, 2, 10, 5));
+        weightsPanel.add(new JLabel("Angular Distortion Dan"));
+        weightsPanel.add(danSpinner);
+        weightsPanel.add(new JLabel("Areal Distortion Dar"));
+        weightsPanel.add(darSpinner);
+        weightsPanel.add(new JLabel("Scale Distortion Dab"));
+        weightsPanel.add(dabSpinner);
+        weightsPanel.add(new JLabel("Acceptance Q"));
+        weightsPanel.add(qSpinner);
+        JCheckBox continentalCheckBox = new JCheckBox("Distortion of Continental Areas");
+        JCheckBox bendingCheckBox = new JCheckBox("Adjust Bending of Parallels");
+        JCheckBox meridiansCheckBox = new JCheckBox("Adjust Distribution of Meridians");
+        JPanel panel = new JPanel();
+        panel.setLayout(new BoxLayout(panel, BoxLayout.Y_AXIS));
+        panel.add(new JLabel("<html>Weights of the distortion indices:</html>"));
+        panel.add(Box.createVerticalStrut(5));
+        weightsPanel.setAlignmentX(Component.LEFT_ALIGNMENT);
+        panel.add(weightsPanel);
+        panel.add(Box.createVerticalStrut(10));
+        panel.add(continentalCheckBox);
+        panel.add(bendingCheckBox);
+        panel.add(meridiansCheckBox);
+
+        int res = JOptionPane.showOptionDialog(GUIUtil.getOwnerFrame(this),
+                panel,
+                "Optimize Distortion",
+                JOptionPane.OK_CANCEL_OPTION,
+                JOptionPane.PLAIN_MESSAGE,
+                null,
+                new String[]{"Optimize", "Cancel"},
+                "Optimize");
+        if (res != 0) {
+            return;
+        }
+
+        final FlexProjectionOptimizer optimizer = new FlexProjectionOptimizer(
+                model.getFlexProjectionModel(), model.getDisplayModel().qModel);
+        optimizer.setWeights(((Number) danSpinner.getValue()).doubleValue(),
+                ((Number) darSpinner.getValue()).doubleValue(),
+                ((Number) dabSpinner.getValue()).doubleValue(),
+                ((Number) qSpinner.getValue()).doubleValue());
+        optimizer.setContinental(continentalCheckBox.isSelected());
+        optimizer.setOptimizedCurves(true, true, bendingCheckBox.isSelected(),
+                meridiansCheckBox.isSelected(), true);
+
+        // show improved models in the event dispatching thread. Models that
+        // are found while the map is being updated are replaced by newer ones.
+        final AtomicReference<FlexProjectionModel> pendingModel
+                = new AtomicReference<FlexProjectionModel>();
+        final Runnable showPendingModel = new Runnable() {
+            @Override
+            public void run() {
+                FlexProjectionModel m = pendingModel.getAndSet(null);
+                if (m != null) {
+                    applyOptimizedModel(m);
+                }
+            }
+        };
+        optimizer.setListener(new FlexProjectionOptimizer.OptimizerListener() {
+            @Override
+            public void bestModelChanged(FlexProjectionModel m, double objective) {
+                if (pendingModel.getAndSet(m) == null) {
+                    SwingUtilities.invokeLater(showPendingModel);
+                }
+            }
+        });
+
+        // canceling keeps the best model found so far
+        SwingWorkerWithProgressIndicator<FlexProjectionModel> worker
+                = new SwingWorkerWithProgressIndicator<FlexProjectionModel>(
+                GUIUtil.getOwnerFrame(this), "Optimize Distortion",
+                "<html><small>Searching for smaller distortion</small></html>", true) {
+
+            @Override
+            protected FlexProjectionModel doInBackground() throws Exception {
+                try {
+                    start();
+                    return optimizer.optimize();
+                } finally {
+                    completeProgress();
+                }
+            }
+
+            @Override
+            protected void done() {
+                pendingModel.set(null);
+                try {
+                    applyOptimizedModel(get());
+                    mapComponent.addUndo("Optimize Distortion");
+                } catch (Exception exc) {
+                    ErrorDialog.showErrorDialog("The distortion could not be optimized.", exc);
+                }
+            }
+        };
+        optimizer.setProgressIndicator(worker);
+        worker.execute();
+    }
+
+    /**
+     * Replaces the curves, the proportions and the scale of the flex
+     * projection, and updates the GUI and the map.
+     */
+    private void applyOptimizedModel(FlexProjectionModel m) {
+        FlexProjectionModel flexModel = model.getFlexProjectionModel();
+        flexModel.setKnots(m.getX(), m.getY(), m.getB(), m.getXDist());
+        flexModel.setScaleY(m.getScaleY());
+        flexModel.setScale(m.getScale());
+        writeFlexSliderGUI();
+        writeVerticalScaleGUI();
+        writeInternalScaleGUI();
+        updateDistortionIndicesAndInformListeners();
+    }
+
     private void scaleRadioButtonActionPerformed(java.awt.event.ActionEvent evt) {//GEN-FIRST:event_scaleRadioButtonActionPerformed
         if (updatingGUI) {
             return;
@@ -4149,9 +4296,12 @@ public class ProjectionBrewerPanel extends javax.swing.JPanel {
             return;
         }
 
-        if (liveUpdate || ((JSlider) (evt.getSource())).getValueIsAdjusting() == false) {
-            double w = meanSlider.getValue() / 100D;
-            model.getMeanProjection().setWeight(w);
+        double w = meanSlider.getValue() / 100D;
+        model.getMeanProjection().setWeight(w);
+        if (!liveUpdate && ((JSlider) (evt.getSource())).getValueIsAdjusting()) {
+            // only show a quick preview until the user releases the mouse
+            model.mapChangedInteractive();
+        } else {
             updateDistortionIndicesAndInformListeners();
             mapComponent.addUndo("Mixer Weight");
             showDesignProjection();
@@ -4626,6 +4776,7 @@ public class ProjectionBrewerPanel extends javax.swing.JPanel {
     private javax.swing.JPanel mixerProjection1Panel;
     private javax.swing.JPanel mixerProjection2Panel;
     private javax.swing.JMenuItem normalizeMenuItem;
+    private javax.swing.JMenuItem optimizeDistortionMenuItem;
     private javax.swing.JPopupMenu optionsPopupMenu;
     private javax.swing.JToggleButton peakCurveToggleButton;
     private javax.swing.JCheckBox poleDirectionCheckBox;
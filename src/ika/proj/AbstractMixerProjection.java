@@ -3,6 +3,7 @@ package ika.proj;
 import com.jhlabs.map.proj.MillerCylindrical1Projection;
 import com.jhlabs.map.proj.MollweideProjection;
 import com.jhlabs.map.proj.Projection;
+import java.awt.geom.Point2D;
 
 /**
  *
@@ -13,6 +14,48 @@ public abstract class AbstractMixerProjection extends DesignProjection {
     protected Projection p1 = new MollweideProjection();
     protected Projection p2 = new MillerCylindrical1Projection();
 
+    /**
+     * Inverse projection for mixed projections with straight parallels.
+     * Built when first needed, and discarded when the mix changes.
+     */
+    private volatile ParallelsInverse parallelsInverse;
+
+    @Override
+    public Object clone() {
+        AbstractMixerProjection clone = (AbstractMixerProjection) super.clone();
+        clone.parallelsInverse = null;
+        return clone;
+    }
+
+    /**
+     * Call this each time a parameter changes that influences the forward
+     * projection.
+     */
+    protected void invalidateInverse() {
+        this.parallelsInverse = null;
+    }
+
+    /**
+     * Inverse projection with straight parallels. The inverse is found with
+     * a few forward projections along a parallel, instead of a generic
+     * two-dimensional search.
+     * @param x The x coordinate.
+     * @param y The y coordinate.
+     * @param lp Receives the longitude and latitude in radians.
+     * @return True if the point was inverted, false if parallels are not
+     * straight or the point cannot be inverted this way.
+     */
+    protected boolean parallelsInverse(double x, double y, Point2D.Double lp) {
+        if (!this.parallelsAreParallel()) {
+            return false;
+        }
+        ParallelsInverse inv = this.parallelsInverse;
+        if (inv == null) {
+            inv = this.parallelsInverse = new ParallelsInverse(this);
+        }
+        return inv.inverse(x, y, lp);
+    }
+
     public Projection getProjection1() {
         return p1;
     }
@@ -22,6 +65,7 @@ public abstract class AbstractMixerProjection extends DesignProjection {
             throw new IllegalArgumentException("cannot mix projection " + p);
         }
         this.p1 = p;
+        this.invalidateInverse();
     }
 
     public Projection getProjection2() {
@@ -33,6 +77,7 @@ public abstract class AbstractMixerProjection extends DesignProjection {
             throw new IllegalArgumentException("cannot mix projection " + p);
         }
         this.p2 = p;
+        this.invalidateInverse();
     }
 
     public boolean canMix(Projection p) {
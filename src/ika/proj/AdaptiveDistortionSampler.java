@@ -0,0 +1,333 @@
+/*
+ * AdaptiveDistortionSampler.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+
+package ika.proj;
+
+import com.jhlabs.map.MapMath;
+import com.jhlabs.map.proj.Projection;
+import java.util.ArrayList;
+import java.util.List;
+
+/**
+ * Fills grids with areal and angular distortion values for contouring
+ * isolines, without computing the distortion for every cell.<br>
+ * The grids are regular 1-degree grids covering the whole sphere. The
+ * projection must be centered on the Greenwich meridian, so that the
+ * distortion is symmetric relative to it: only the eastern half of the grids
+ * is sampled, and the western half is mirrored.<br>
+ * Distortion is first computed at the corners of coarse blocks of
+ * COARSE_STEP by COARSE_STEP cells. Each block is refined like a quadtree by
+ * also computing the distortion at its center. A block is split into four
+ * blocks if any of these values is undefined, if the value at the center
+ * deviates from the bilinear interpolation of the corners by more than a
+ * fraction of the isolines interval, or if an isoline level lies between
+ * the values. Blocks that need no refinement are filled by bilinear
+ * interpolation. Isolines are therefore always traced through computed
+ * values, while smooth areas without isolines are interpolated. The
+ * computations of each level of the quadtree are done in bulk by
+ * BulkProjectionFactors.
+ */
+public final class AdaptiveDistortionSampler {
+
+    /**
+     * The size of the coarse blocks in cells.
+     */
+    private static final int COARSE_STEP = 8;
+
+    /**
+     * Maximum deviation of the interpolated value from the computed value at
+     * the center of a block, relative to the isolines interval.
+     */
+    private static final double MAX_INTERPOLATION_ERROR = 0.1;
+
+    /**
+     * Increment for computing derivatives in radians.
+     */
+    private static final double DH = 1e-5;
+
+    private final Projection projection;
+
+    /**
+     * Distortion values of the eastern half of the grids, including the
+     * central meridian and the 180th meridian.
+     */
+    private final double[][] area;
+    private final double[][] angle;
+
+    /**
+     * True for values that are computed. Values that are not computed are
+     * interpolated.
+     */
+    private final boolean[][] computed;
+
+    /**
+     * Points that are computed by the next call to computeRequested().
+     */
+    private int[] requestedCols = new int[256];
+    private int[] requestedRows = new int[256];
+    private int requestedCount = 0;
+    private final boolean[][] requested;
+
+    /**
+     * The intervals between isolines, or NaN if no isolines are shown.
+     */
+    private final double areaInterval;
+    private final double angleInterval;
+
+    /**
+     * The number of computed points.
+     */
+    private int computedCount = 0;
+
+    private AdaptiveDistortionSampler(Projection projection, int rows, int cols,
+            double areaInterval, double angleInterval) {
+        this.projection = projection;
+        this.area = new double[rows][cols];
+        this.angle = new double[rows][cols];
+        this.computed = new boolean[rows][cols];
+        this.requested = new boolean[rows][cols];
+        this.areaInterval = areaInterval;
+        this.angleInterval = angleInterval;
+    }
+
+    /**
+     * Fills two grids with distortion values. The cell in row r and column c
+     * is centered on longitude -cols / 2 + c and latitude rows / 2 - r in
+     * degrees. Cells that cannot be projected are NaN.
+     * @param projection The projection with a central meridian of 0.
+     * @param areaGrid Receives the areal scale factors.
+     * @param angleGrid Receives the maximum angular distortion in degrees.
+     * @param areaInterval The interval between isolines of areal distortion,
+     * or NaN if these isolines are not needed.
+     * @param angleInterval The interval between isolines of angular
+     * distortion, or NaN if these isolines are not needed.
+     * @return The number of grid cells for which the distortion is computed.
+     */
+    public static int fill(Projection projection,
+            float[][] areaGrid, float[][] angleGrid,
+            double areaInterval, double angleInterval) {
+
+        final int rows = areaGrid.length;
+        final int fullCols = areaGrid[0].length;
+        final int centerCol = fullCols / 2;
+        AdaptiveDistortionSampler sampler = new AdaptiveDistortionSampler(
+                projection, rows, centerCol + 1, areaInterval, angleInterval);
+        sampler.sample();
+
+        // copy the eastern half and mirror it to the western half
+        for (int r = 0; r < rows; r++) {
+            final float[] areaRow = areaGrid[r];
+            final float[] angleRow = angleGrid[r];
+            for (int c = 0; c < fullCols; c++) {
+                final int halfCol = Math.abs(c - centerCol);
+                areaRow[c] = (float) sampler.area[r][halfCol];
+                angleRow[c] = (float) sampler.angle[r][halfCol];
+            }
+        }
+        return sampler.computedCount;
+    }
+
+    /**
+     * Computes and interpolates all values of the eastern half.
+     */
+    private void sample() {
+
+        final int rows = this.area.length;
+        final int cols = this.area[0].length;
+
+        // the coarse blocks. A block is stored as {col0, row0, col1, row1},
+        // with inclusive corners.
+        List<int[]> blocks = new ArrayList<int[]>();
+        for (int r0 = 0; r0 < rows - 1; r0 += COARSE_STEP) {
+            final int r1 = Math.min(rows - 1, r0 + COARSE_STEP);
+            for (int c0 = 0; c0 < cols - 1; c0 += COARSE_STEP) {
+                final int c1 = Math.min(cols - 1, c0 + COARSE_STEP);
+                blocks.add(new int[]{c0, r0, c1, r1});
+            }
+        }
+
+        // refine the blocks level by level
+        List<int[]> interpolatedBlocks = new ArrayList<int[]>();
+        while (!blocks.isEmpty()) {
+            for (int[] b : blocks) {
+                this.request(b[0], b[1]);
+                this.request(b[2], b[1]);
+                this.request(b[0], b[3]);
+                this.request(b[2], b[3]);
+                if (!isSmallest(b)) {
+                    this.request((b[0] + b[2]) / 2, (b[1] + b[3]) / 2);
+                }
+            }
+            this.computeRequested();
+
+            List<int[]> refinedBlocks = new ArrayList<int[]>();
+            for (int[] b : blocks) {
+                if (isSmallest(b)) {
+                    continue;
+                }
+                if (this.needsRefinement(b)) {
+                    split(b, refinedBlocks);
+                } else {
+                    interpolatedBlocks.add(b);
+                }
+            }
+            blocks = refinedBlocks;
+        }
+
+        for (int[] b : interpolatedBlocks) {
+            this.interpolate(b);
+        }
+    }
+
+    /**
+     * Returns true if all values of a block are at its corners.
+     */
+    private static boolean isSmallest(int[] b) {
+        return b[2] - b[0] <= 1 && b[3] - b[1] <= 1;
+    }
+
+    /**
+     * Splits a block in two or four blocks sharing their borders.
+     */
+    private static void split(int[] b, List<int[]> blocks) {
+        final int cm = (b[0] + b[2]) / 2;
+        final int rm = (b[1] + b[3]) / 2;
+        final int[] colBounds = b[2] - b[0] > 1
+                ? new int[]{b[0], cm, b[2]} : new int[]{b[0], b[2]};
+        final int[] rowBounds = b[3] - b[1] > 1
+                ? new int[]{b[1], rm, b[3]} : new int[]{b[1], b[3]};
+        for (int i = 0; i < rowBounds.length - 1; i++) {
+            for (int j = 0; j < colBounds.length - 1; j++) {
+                blocks.add(new int[]{colBounds[j], rowBounds[i],
+                            colBounds[j + 1], rowBounds[i + 1]});
+            }
+        }
+    }
+
+    /**
+     * Adds a point to the points computed by the next call to
+     * computeRequested(), unless it is computed already.
+     */
+    private void request(int col, int row) {
+        if (this.computed[row][col] || this.requested[row][col]) {
+            return;
+        }
+        if (this.requestedCount == this.requestedCols.length) {
+            int[] newCols = new int[this.requestedCount * 2];
+            int[] newRows = new int[this.requestedCount * 2];
+            System.arraycopy(this.requestedCols, 0, newCols, 0, this.requestedCount);
+            System.arraycopy(this.requestedRows, 0, newRows, 0, this.requestedCount);
+            this.requestedCols = newCols;
+            this.requestedRows = newRows;
+        }
+        this.requestedCols[this.requestedCount] = col;
+        this.requestedRows[this.requestedCount] = row;
+        this.requestedCount++;
+        this.requested[row][col] = true;
+    }
+
+    /**
+     * Computes the distortion for all requested points.
+     */
+    private void computeRequested() {
+        final int n = this.requestedCount;
+        if (n == 0) {
+            return;
+        }
+        final int northLat = this.area.length / 2;
+        double[] lam = new double[n];
+        double[] phi = new double[n];
+        for (int i = 0; i < n; i++) {
+            lam[i] = this.requestedCols[i] * MapMath.DTR;
+            phi[i] = (northLat - this.requestedRows[i]) * MapMath.DTR;
+        }
+        BulkProjectionFactors f = BulkProjectionFactors.compute(this.projection,
+                lam, phi, DH);
+        for (int i = 0; i < n; i++) {
+            final int col = this.requestedCols[i];
+            final int row = this.requestedRows[i];
+            this.area[row][col] = f.s[i];
+            this.angle[row][col] = f.omega[i] * MapMath.RTD;
+            this.computed[row][col] = true;
+            this.requested[row][col] = false;
+        }
+        this.computedCount += n;
+        this.requestedCount = 0;
+    }
+
+    /**
+     * Returns true if the corners and the center of a block require a finer
+     * sampling of the block.
+     */
+    private boolean needsRefinement(int[] b) {
+        return needsRefinement(b, this.area, this.areaInterval)
+                || needsRefinement(b, this.angle, this.angleInterval);
+    }
+
+    private static boolean needsRefinement(int[] b, double[][] values,
+            double interval) {
+
+        final int c0 = b[0], r0 = b[1], c1 = b[2], r1 = b[3];
+        final int cm = (c0 + c1) / 2;
+        final int rm = (r0 + r1) / 2;
+        final double v00 = values[r0][c0];
+        final double v10 = values[r0][c1];
+        final double v01 = values[r1][c0];
+        final double v11 = values[r1][c1];
+        final double vm = values[rm][cm];
+        if (Double.isNaN(v00) || Double.isNaN(v10) || Double.isNaN(v01)
+                || Double.isNaN(v11) || Double.isNaN(vm)) {
+            return true;
+        }
+        if (Double.isNaN(interval) || interval <= 0) {
+            return false;
+        }
+
+        // an isoline level lies between the values
+        final double min = Math.min(Math.min(Math.min(v00, v10), Math.min(v01, v11)), vm);
+        final double max = Math.max(Math.max(Math.max(v00, v10), Math.max(v01, v11)), vm);
+        if (Math.ceil(min / interval) <= Math.floor(max / interval)) {
+            return true;
+        }
+
+        // the interpolated value at the center deviates from the computed value
+        final double interpolated = bilinear(v00, v10, v01, v11,
+                fraction(cm, c0, c1), fraction(rm, r0, r1));
+        return Math.abs(interpolated - vm) > MAX_INTERPOLATION_ERROR * interval;
+    }
+
+    private static double fraction(int i, int i0, int i1) {
+        return i1 == i0 ? 0 : (double) (i - i0) / (i1 - i0);
+    }
+
+    private static double bilinear(double v00, double v10, double v01,
+            double v11, double tx, double ty) {
+        final double top = v00 + (v10 - v00) * tx;
+        final double bottom = v01 + (v11 - v01) * tx;
+        return top + (bottom - top) * ty;
+    }
+
+    /**
+     * Interpolates the values of a block that are not computed.
+     */
+    private void interpolate(int[] b) {
+        final int c0 = b[0], r0 = b[1], c1 = b[2], r1 = b[3];
+        for (int r = r0; r <= r1; r++) {
+            final double ty = fraction(r, r0, r1);
+            for (int c = c0; c <= c1; c++) {
+                if (this.computed[r][c]) {
+                    continue;
+                }
+                final double tx = fraction(c, c0, c1);
+                this.area[r][c] = bilinear(this.area[r0][c0], this.area[r0][c1],
+                        this.area[r1][c0], this.area[r1][c1], tx, ty);
+                this.angle[r][c] = bilinear(this.angle[r0][c0], this.angle[r0][c1],
+                        this.angle[r1][c0], this.angle[r1][c1], tx, ty);
+            }
+        }
+    }
+}
@@ -0,0 +1,294 @@
+/*
+ * BulkProjectionFactors.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+
+package ika.proj;
+
+import com.jhlabs.map.MapMath;
+import com.jhlabs.map.proj.Projection;
+import java.awt.geom.Point2D;
+
+/**
+ * Distortion factors for arrays of points. This computes the same values as
+ * ProjectionFactors, but stores them in one array per factor, and does not
+ * create or modify an object for each point. The four points of the finite
+ * difference stencil of a point are projected in sequence into one reused
+ * point. Large arrays are distributed among as many threads as processors
+ * are available, each thread projecting with its own clone of the projection.
+ * <br>
+ * The factors of points that cannot be projected are NaN.
+ */
+public final class BulkProjectionFactors {
+
+    /**
+     * Minimum number of points computed by a thread.
+     */
+    private static final int MIN_POINTS_PER_THREAD = 1024;
+
+    /**
+     * meridinal scale
+     */
+    public final double[] h;
+
+    /**
+     * parallel scale
+     */
+    public final double[] k;
+
+    /**
+     * areal scale factor
+     */
+    public final double[] s;
+
+    /**
+     * angular distortion
+     */
+    public final double[] omega;
+
+    /**
+     * max scale error
+     */
+    public final double[] a;
+
+    /**
+     * min scale error
+     */
+    public final double[] b;
+
+    /**
+     * Creates arrays for a number of points.
+     * @param n The number of points.
+     */
+    public BulkProjectionFactors(int n) {
+        this.h = new double[n];
+        this.k = new double[n];
+        this.s = new double[n];
+        this.omega = new double[n];
+        this.a = new double[n];
+        this.b = new double[n];
+    }
+
+    /**
+     * Returns the number of points.
+     */
+    public int size() {
+        return this.s.length;
+    }
+
+    /**
+     * Computes the factors for arrays of points.
+     * @param projection The projection to use. It is not changed.
+     * @param lam The longitudes in radians.
+     * @param phi The latitudes in radians.
+     * @param dh Delta for computing derivatives.
+     * @return The factors.
+     */
+    public static BulkProjectionFactors compute(Projection projection,
+            double[] lam, double[] phi, double dh) {
+        BulkProjectionFactors f = new BulkProjectionFactors(lam.length);
+        f.compute(projection, lam, phi, dh);
+        return f;
+    }
+
+    /**
+     * Computes the factors for arrays of points with as many threads as
+     * processors are available.
+     * @param projection The projection to use. It is not changed.
+     * @param lam The longitudes in radians, one for each point.
+     * @param phi The latitudes in radians, one for each point.
+     * @param dh Delta for computing derivatives.
+     */
+    public void compute(Projection projection, double[] lam, double[] phi,
+            double dh) {
+
+        final int n = this.size();
+        if (lam.length != n || phi.length != n) {
+            throw new IllegalArgumentException();
+        }
+        final int cpus = Runtime.getRuntime().availableProcessors();
+        final int nThreads = Math.max(1, Math.min(cpus, n / MIN_POINTS_PER_THREAD));
+        if (nThreads == 1) {
+            this.compute(projection, lam, phi, dh, 0, n);
+            return;
+        }
+
+        final int chunk = (n / nThreads) + 1;
+        FactorsThread[] threads = new FactorsThread[nThreads];
+        for (int i = 1; i < nThreads; i++) {
+            final int start = i * chunk;
+            final int end = Math.min(n, start + chunk);
+            threads[i] = new FactorsThread((Projection) projection.clone(),
+                    lam, phi, dh, start, end);
+            threads[i].start();
+        }
+
+        // the first chunk is computed by the current thread
+        this.compute(projection, lam, phi, dh, 0, Math.min(n, chunk));
+        for (int i = 1; i < nThreads; i++) {
+            try {
+                threads[i].join();
+            } catch (InterruptedException ex) {
+                throw new IllegalStateException(ex);
+            }
+        }
+    }
+
+    /**
+     * Computes the factors for a range of points in the current thread.
+     * @param projection The projection to use. It is not changed.
+     * @param lam The longitudes in radians, one for each point.
+     * @param phi The latitudes in radians, one for each point.
+     * @param dh Delta for computing derivatives.
+     * @param start The first point.
+     * @param end The point after the last point.
+     */
+    public void compute(Projection projection, double[] lam, double[] phi,
+            double dh, int start, int end) {
+
+        final Point2D.Double pt = new Point2D.Double();
+        final double lon0 = projection.getProjectionLongitude();
+        for (int i = start; i < end; i++) {
+            boolean valid;
+            try {
+                valid = this.computePoint(projection, lon0, lam[i], phi[i], dh, pt, i);
+            } catch (RuntimeException exc) {
+                valid = false;
+            }
+            if (!valid) {
+                this.h[i] = this.k[i] = this.s[i] = Double.NaN;
+                this.omega[i] = this.a[i] = this.b[i] = Double.NaN;
+            }
+        }
+    }
+
+    /**
+     * Computes the factors of one point as ProjectionFactors and
+     * ProjectionDerivatives do.
+     * @return False if the point cannot be projected.
+     */
+    private boolean computePoint(Projection projection, double lon0,
+            double lam, double phi, double dh, Point2D.Double pt, int i) {
+
+        // check for latitude or longitude over-range
+        final double EPS = 1.0e-12;
+        final double t0 = Math.abs(phi) - MapMath.HALFPI;
+        if (t0 > EPS || Math.abs(lam) > 10.) {
+            return false;
+        }
+        if (Math.abs(t0) <= EPS) {
+            phi = phi < 0. ? -MapMath.HALFPI : MapMath.HALFPI;
+        }
+        lam = MapMath.normalizeLongitude(lam - lon0);
+
+        // derivatives with a central difference stencil
+        double l = lam;
+        double p = phi;
+        if (l + dh > Math.PI) {
+            l = Math.PI - dh;
+        } else if (l - dh < -Math.PI) {
+            l = -Math.PI + dh;
+        }
+        if (p + dh > MapMath.HALFPI) {
+            p = MapMath.HALFPI - dh;
+        } else if (p - dh < -MapMath.HALFPI) {
+            p = -MapMath.HALFPI + dh;
+        }
+        l += dh;
+        p += dh;
+        if (Math.abs(p) > MapMath.HALFPI) {
+            return false;
+        }
+        double d = dh + dh;
+        projection.project(l, p, pt);
+        if (Double.isNaN(pt.x)) {
+            return false;
+        }
+        double x_l = pt.x;
+        double y_p = pt.y;
+        double x_p = -pt.x;
+        double y_l = -pt.y;
+        p -= d;
+        if (Math.abs(p) > MapMath.HALFPI) {
+            return false;
+        }
+        projection.project(l, p, pt);
+        if (Double.isNaN(pt.x)) {
+            return false;
+        }
+        x_l += pt.x;
+        y_p -= pt.y;
+        x_p += pt.x;
+        y_l -= pt.y;
+        l -= d;
+        projection.project(l, p, pt);
+        if (Double.isNaN(pt.x)) {
+            return false;
+        }
+        x_l -= pt.x;
+        y_p -= pt.y;
+        x_p += pt.x;
+        y_l += pt.y;
+        p += d;
+        projection.project(l, p, pt);
+        if (Double.isNaN(pt.x)) {
+            return false;
+        }
+        x_l -= pt.x;
+        y_p += pt.y;
+        x_p -= pt.x;
+        y_l += pt.y;
+        d += d;
+        x_l /= d;
+        y_p /= d;
+        x_p /= d;
+        y_l /= d;
+
+        // scale factors
+        final double cosphi = Math.cos(phi);
+        final double hi = Math.hypot(x_p, y_p);
+        final double ki = Math.hypot(x_l, y_l) / cosphi;
+        final double si = (y_p * x_l - x_p * y_l) / cosphi;
+        double t = ki * ki + hi * hi;
+        double ai = Math.sqrt(t + 2. * si);
+        t = (t = t - 2. * si) <= 0. ? 0. : Math.sqrt(t);
+        final double bi = 0.5 * (ai - t);
+        ai = 0.5 * (ai + t);
+
+        this.h[i] = hi;
+        this.k[i] = ki;
+        this.s[i] = si;
+        this.a[i] = ai;
+        this.b[i] = bi;
+        this.omega[i] = 2. * Math.asin((ai - bi) / (ai + bi));
+        return true;
+    }
+
+    private class FactorsThread extends Thread {
+
+        private final Projection projection;
+        private final double[] lam;
+        private final double[] phi;
+        private final double dh;
+        private final int start;
+        private final int end;
+
+        public FactorsThread(Projection projection, double[] lam, double[] phi,
+                double dh, int start, int end) {
+            this.projection = projection;
+            this.lam = lam;
+            this.phi = phi;
+            this.dh = dh;
+            this.start = start;
+            this.end = end;
+        }
+
+        @Override
+        public void run() {
+            compute(this.projection, this.lam, this.phi, this.dh,
+                    this.start, this.end);
+        }
+    }
+}
@@ -0,0 +1,269 @@
+/*
+ * BulkTissotIndicatrices.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+
+package ika.proj;
+
+import com.jhlabs.map.proj.Projection;
+import ika.geo.GeoPath;
+import ika.geo.GeoPathModel;
+import java.awt.geom.Point2D;
+
+/**
+ * Constructs Tissot's indicatrices for arrays of points. A small circle around
+ * a point on the sphere is projected to an ellipse that is defined by the
+ * local Jacobian of the projection. Instead of projecting every point of the
+ * circle, the center and two points on the circle are projected, which gives
+ * the two conjugate semi-diameters of the ellipse. The outline of the ellipse
+ * is then computed from these semi-diameters. For the tiny circles used for
+ * indicatrices, the result is identical to projecting the circle point by
+ * point.<br>
+ * Large arrays are distributed among as many threads as processors are
+ * available, each thread projecting with its own clone of the projection. All
+ * ellipses are returned in a single GeoPath with one closed sub-path per
+ * ellipse.
+ */
+public final class BulkTissotIndicatrices {
+
+    /**
+     * Minimum number of indicatrices computed by a thread.
+     */
+    private static final int MIN_POINTS_PER_THREAD = 256;
+
+    /**
+     * The projected centers.
+     */
+    private final double[] cx;
+    private final double[] cy;
+
+    /**
+     * The projected semi-diameters. u is the projection of the radius pointing
+     * east, v the projection of the radius pointing north.
+     */
+    private final double[] ux;
+    private final double[] uy;
+    private final double[] vx;
+    private final double[] vy;
+
+    private BulkTissotIndicatrices(int n) {
+        this.cx = new double[n];
+        this.cy = new double[n];
+        this.ux = new double[n];
+        this.uy = new double[n];
+        this.vx = new double[n];
+        this.vy = new double[n];
+    }
+
+    /**
+     * Constructs indicatrices.
+     * @param projection The projection to use. It is not changed.
+     * @param lam The longitudes of the centers in radians.
+     * @param phi The latitudes of the centers in radians.
+     * @param radius The radius of the circles on the unary sphere.
+     * @param pointsCount The number of points of each ellipse.
+     * @param scale Scale factor to convert from the unary sphere to earth
+     * coordinates.
+     * @param indicatrixScale Scale factor to enlarge the ellipses relative to
+     * their centers.
+     * @return A GeoPath with a closed sub-path for each ellipse, or null if no
+     * ellipse can be constructed.
+     */
+    public static GeoPath construct(Projection projection,
+            double[] lam, double[] phi, double radius, int pointsCount,
+            double scale, double indicatrixScale) {
+
+        if (lam.length != phi.length) {
+            throw new IllegalArgumentException();
+        }
+        BulkTissotIndicatrices t = new BulkTissotIndicatrices(lam.length);
+        t.compute(projection, lam, phi, radius);
+        return t.toGeoPath(pointsCount, scale, indicatrixScale);
+    }
+
+    /**
+     * Computes centers and semi-diameters with as many threads as processors
+     * are available.
+     */
+    private void compute(Projection projection, double[] lam, double[] phi,
+            double radius) {
+
+        final int n = lam.length;
+        final int cpus = Runtime.getRuntime().availableProcessors();
+        final int nThreads = Math.max(1, Math.min(cpus, n / MIN_POINTS_PER_THREAD));
+        if (nThreads == 1) {
+            this.compute(projection, lam, phi, radius, 0, n);
+            return;
+        }
+
+        final int chunk = (n / nThreads) + 1;
+        IndicatrixThread[] threads = new IndicatrixThread[nThreads];
+        for (int i = 1; i < nThreads; i++) {
+            final int start = i * chunk;
+            final int end = Math.min(n, start + chunk);
+            threads[i] = new IndicatrixThread((Projection) projection.clone(),
+                    lam, phi, radius, start, end);
+            threads[i].start();
+        }
+
+        // the first chunk is computed by the current thread
+        this.compute(projection, lam, phi, radius, 0, Math.min(n, chunk));
+        for (int i = 1; i < nThreads; i++) {
+            try {
+                threads[i].join();
+            } catch (InterruptedException ex) {
+                throw new IllegalStateException(ex);
+            }
+        }
+    }
+
+    /**
+     * Computes centers and semi-diameters for a range of points in the
+     * current thread. The values of points that cannot be projected are NaN.
+     */
+    private void compute(Projection projection, double[] lam, double[] phi,
+            double radius, int start, int end) {
+
+        final Point2D.Double pt = new Point2D.Double();
+        for (int i = start; i < end; i++) {
+            boolean valid;
+            try {
+                valid = this.computePoint(projection, lam[i], phi[i], radius, pt, i);
+            } catch (RuntimeException exc) {
+                valid = false;
+            }
+            if (!valid) {
+                this.cx[i] = this.cy[i] = Double.NaN;
+            }
+        }
+    }
+
+    /**
+     * Projects the center and two points on the circle around lam/phi.
+     * @return False if a point cannot be projected.
+     */
+    private boolean computePoint(Projection projection, double lam, double phi,
+            double radius, Point2D.Double pt, int i) {
+
+        projection.project(lam, phi, pt);
+        final double x0 = pt.x;
+        final double y0 = pt.y;
+        if (!isFinite(x0) || !isFinite(y0)) {
+            return false;
+        }
+
+        // the point east of the center. Use the point west of the center on
+        // the eastern border of the graticule, and invert the semi-diameter.
+        final double dlam = radius / Math.cos(phi);
+        final double dir = lam + dlam > Math.PI ? -1 : 1;
+        projection.project(lam + dir * dlam, phi, pt);
+        final double x1 = pt.x;
+        final double y1 = pt.y;
+        if (!isFinite(x1) || !isFinite(y1)) {
+            return false;
+        }
+
+        // the point north of the center
+        projection.project(lam, phi + radius, pt);
+        final double x2 = pt.x;
+        final double y2 = pt.y;
+        if (!isFinite(x2) || !isFinite(y2)) {
+            return false;
+        }
+
+        this.cx[i] = x0;
+        this.cy[i] = y0;
+        this.ux[i] = dir * (x1 - x0);
+        this.uy[i] = dir * (y1 - y0);
+        this.vx[i] = x2 - x0;
+        this.vy[i] = y2 - y0;
+        return true;
+    }
+
+    private static boolean isFinite(double d) {
+        return !Double.isNaN(d) && !Double.isInfinite(d);
+    }
+
+    /**
+     * Constructs the outlines of all ellipses.
+     */
+    private GeoPath toGeoPath(int pointsCount, double scale,
+            double indicatrixScale) {
+
+        final int n = this.cx.length;
+        int validCount = 0;
+        for (int i = 0; i < n; i++) {
+            if (!Double.isNaN(this.cx[i])) {
+                ++validCount;
+            }
+        }
+        if (validCount == 0) {
+            return null;
+        }
+
+        // the same sines and cosines for all ellipses
+        final double angleIncrement = Math.PI * 2. / pointsCount;
+        double[] cos = new double[pointsCount];
+        double[] sin = new double[pointsCount];
+        for (int j = 0; j < pointsCount; j++) {
+            cos[j] = Math.cos(j * angleIncrement);
+            sin[j] = Math.sin(j * angleIncrement);
+        }
+
+        double[] xy = new double[validCount * pointsCount * 2];
+        int[] firstPoints = new int[validCount];
+        final double s = scale * indicatrixScale;
+        int ellipseID = 0;
+        int c = 0;
+        for (int i = 0; i < n; i++) {
+            if (Double.isNaN(this.cx[i])) {
+                continue;
+            }
+            final double x0 = scale * this.cx[i];
+            final double y0 = scale * this.cy[i];
+            final double ax = s * this.ux[i];
+            final double ay = s * this.uy[i];
+            final double bx = s * this.vx[i];
+            final double by = s * this.vy[i];
+            firstPoints[ellipseID++] = c / 2;
+            for (int j = 0; j < pointsCount; j++) {
+                xy[c++] = x0 + cos[j] * ax + sin[j] * bx;
+                xy[c++] = y0 + cos[j] * ay + sin[j] * by;
+            }
+        }
+
+        GeoPathModel pathModel = new GeoPathModel();
+        pathModel.setStraightLines(xy, firstPoints, true);
+        GeoPath geoPath = new GeoPath();
+        geoPath.setPathModel(pathModel);
+        return geoPath;
+    }
+
+    private class IndicatrixThread extends Thread {
+
+        private final Projection projection;
+        private final double[] lam;
+        private final double[] phi;
+        private final double radius;
+        private final int start;
+        private final int end;
+
+        public IndicatrixThread(Projection projection, double[] lam,
+                double[] phi, double radius, int start, int end) {
+            this.projection = projection;
+            this.lam = lam;
+            this.phi = phi;
+            this.radius = radius;
+            this.start = start;
+            this.end = end;
+        }
+
+        @Override
+        public void run() {
+            compute(this.projection, this.lam, this.phi, this.radius,
+                    this.start, this.end);
+        }
+    }
+}
@@ -36,6 +36,8 @@ public abstract class DesignProjection extends Projection implements Serializabl
      * Faster methods could be used here (Newton-Raphson does not work,
      * however, because the first or second derivative of the
      * total areal distortion function behaves badly).
+     * The areal scale factors are computed once for a scale of 1, and the
+     * total areal distortion for other scales is computed from these factors.
      */
     public void computeAreaDistortionMinimizingScale() {
 
@@ -48,14 +50,16 @@ public abstract class DesignProjection extends Projection implements Serializabl
         // work with a clone to make sure nothing is changed
         DesignProjection projClone = (DesignProjection) this.clone();
         projClone.setProjectionLongitude(0);
+        projClone.setScale(1);
         projClone.initialize();
+        final double[] arealScaleFactors =
+                ProjectionDistortionParameters.computeArealScaleFactors(projClone);
 
         do {
-            projClone.setScale(s - 1e-6);
-            final double d1 = ProjectionDistortionParameters.getDarIndex(projClone);
-
-            projClone.setScale(s + 1e-6);
-            final double d2 = ProjectionDistortionParameters.getDarIndex(projClone);
+            final double d1 = ProjectionDistortionParameters.getDarIndex(
+                    arealScaleFactors, s - 1e-6);
+            final double d2 = ProjectionDistortionParameters.getDarIndex(
+                    arealScaleFactors, s + 1e-6);
             if (d1 < d2) {
                 s2 = s; // change upper boundary
             } else {
@@ -99,8 +103,10 @@ public abstract class DesignProjection extends Projection implements Serializabl
     /**
      * Adjusts the scale factor of this projection such that the areal scale
      * factor equals 1 at the position lam / phi. In other words, the scale factor
-     * is adjusted, such that there is no areal distortion at lam / phi. This
-     * uses an iterative procedure that may take some time.
+     * is adjusted, such that there is no areal distortion at lam / phi. The
+     * areal scale factor d is computed once for a scale of 1; as it grows with
+     * the square of the scale, the new scale is 1 / sqrt(d), clamped to the
+     * range [0.1, 1.9]. The scale is not changed if d cannot be computed.
      * @param lam The longitude at which areal distortion will be eliminated. In radians.
      * @param phi The latitude at which areal distortion will be eliminated. In radians.
      */
@@ -111,29 +117,15 @@ public abstract class DesignProjection extends Projection implements Serializabl
 
         try {
 
-            final double EPS = 1e-5; // iterate until the fourth digit after the coma is stable.
-            double s1 = 0.1; // lower boundary of possible scale values.
-            double s2 = 1.9; // upper boundary of possible scale values.
-            double s = (s1 + s2) / 2; // the new scale
-            double diff; // difference between the previous and the new scale.
-            int iterationCounter = 0;
-            do {
-                final double d = localArealDist(s, lam, phi);
-                if (d > 1) {
-                    s2 = s;
-                } // change upper boundary
-                else {
-                    s1 = s;
-                } // adjust lower boundary
-                double s_ = (s1 + s2) / 2;
-                diff = Math.abs(s - s_);
-                s = s_;
-                iterationCounter++;
-                if (iterationCounter > 1000) {
-                    break;
-                }
-            } while (diff > EPS);
-
+            // The areal scale factor grows with the square of the scale of
+            // the projection. Compute it once for a scale of 1.
+            final double s1 = 0.1; // lower boundary of possible scale values.
+            final double s2 = 1.9; // upper boundary of possible scale values.
+            final double d = localArealDist(1, lam, phi);
+            if (!(d > 0)) {
+                throw new IllegalStateException();
+            }
+            final double s = Math.max(s1, Math.min(s2, 1. / Math.sqrt(d)));
             setScale(s);
 
         } catch (Throwable t) {
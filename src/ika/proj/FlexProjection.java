@@ -16,6 +16,12 @@ public class FlexProjection extends DesignProjection implements SerializableProj
     private static final int NODES = 18;
     private static final double EPS = 1e-8;
     private static final double RAD15 = Math.toRadians(15);
+    private static final double LAT_INC_INV = 1. / Math.toRadians(5);
+    /**
+     * Tolerance in projected coordinates for Newton iterations of the inverse.
+     */
+    private static final double INVERSE_TOL = 1e-10;
+    private static final int MAX_NEWTON_ITERATIONS = 20;
     private FlexProjectionModel model = null;
 
     /**
@@ -129,6 +135,11 @@ public class FlexProjection extends DesignProjection implements SerializableProj
         // first approximation
         fp.projectInverseRobinson(x, y, lp);
 
+        // Newton iterations if parallels are straight
+        if (!fp.model.isAdjustingBending() && fp.projectInverseNewton(x, y, lp)) {
+            return lp;
+        }
+
         // binary search approximation
         fp.binarySearchInverse(x, y, lp.x, lp.y, lp);
 
@@ -214,6 +225,68 @@ public class FlexProjection extends DesignProjection implements SerializableProj
      *
      * }
      */
+    /**
+     * Refines an approximate inverse with Newton iterations. Parallels must
+     * not be bent. The y coordinate then only depends on the latitude, and
+     * the x coordinate only depends on the longitude along a parallel. The
+     * latitude and the longitude are therefore found one after the other,
+     * using the first derivatives of the spline curves.
+     * @param x The x coordinate.
+     * @param y The y coordinate.
+     * @param lp The approximate longitude and latitude in radians. Receives
+     * the refined values if the iterations converge.
+     * @return True if the iterations converged, false otherwise.
+     */
+    private boolean projectInverseNewton(double x, double y, Point2D.Double lp) {
+
+        if (Double.isNaN(lp.x) || Double.isNaN(lp.y)) {
+            return false;
+        }
+        final double scale = model.getScale();
+
+        // latitude: y = scale * scaleY * PI * dist(lat)
+        final double yScale = scale * model.getScaleY() * Math.PI;
+        final double absY = Math.abs(y);
+        double lat = Math.abs(lp.y);
+        for (int i = 0;; i++) {
+            final double f = yScale * model.getLatitudeScaleFactor(lat) - absY;
+            if (Math.abs(f) <= INVERSE_TOL) {
+                break;
+            }
+            final double der = yScale * LAT_INC_INV
+                    * model.getLatitudeScaleFactorFirstDerivative(lat);
+            if (i == MAX_NEWTON_ITERATIONS || der == 0) {
+                return false;
+            }
+            lat = Math.max(0, Math.min(MapMath.HALFPI, lat - f / der));
+        }
+
+        // longitude: x = scale * length(lat) * (lon + xDist(lon) * 15deg)
+        // the derivative of xDist(lon) * 15deg with respect to lon is the
+        // derivative of the spline, as the spline has a knot every 15 degrees
+        final double xScale = scale * model.getLongitudeScaleFactor(lat);
+        double lon = lp.x;
+        for (int i = 0;; i++) {
+            final double meridianShift = Math.signum(lon) * model.getXDistFactor(lon) * RAD15;
+            final double f = xScale * (lon + meridianShift) - x;
+            if (Math.abs(f) <= INVERSE_TOL) {
+                break;
+            }
+            final double der = xScale * (1 + model.getXDistFactorFirstDerivative(lon));
+            if (i == MAX_NEWTON_ITERATIONS || der == 0) {
+                return false;
+            }
+            lon -= f / der;
+            if (!(Math.abs(lon) <= Math.PI)) {
+                return false;
+            }
+        }
+
+        lp.x = lon;
+        lp.y = y < 0. ? -lat : lat;
+        return true;
+    }
+
     // inversion without bending or meridians distribution
     public Point2D.Double projectInverseRobinson(double x, double y, Point2D.Double lp) {
 
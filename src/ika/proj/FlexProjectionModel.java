@@ -75,6 +75,12 @@ public final class FlexProjectionModel implements Cloneable {
     public static final double MIN_BENDING = -MAX_BENDING;
     public static final double MAX_MERIDIANS_DIST = 1d;
     public static final double MIN_MERIDIANS_DIST = -MAX_MERIDIANS_DIST;
+    /**
+     * The default maximum error of spline values interpolated in lookup
+     * tables. Spline values are relative to the size of the graticule, and
+     * 1e-7 corresponds to less than a meter on the Earth.
+     */
+    public static final double DEFAULT_LOOKUP_TABLE_TOLERANCE = 1e-7;
     private int curveShape = CUBIC_CURVE;
     /**
      * Global scale factor applied to the graticule.
@@ -119,6 +125,7 @@ public final class FlexProjectionModel implements Cloneable {
     /** Creates a new instance of FlexProjectionModel */
     public FlexProjectionModel() {
         this.updateSplineTables();
+        this.setLookupTableTolerance(DEFAULT_LOOKUP_TABLE_TOLERANCE);
     }
 
     /**
@@ -276,6 +283,29 @@ public final class FlexProjectionModel implements Cloneable {
 
     }
 
+    /**
+     * Returns the maximum error of spline values interpolated in lookup tables.
+     * @return The tolerance, or 0 if splines are evaluated exactly.
+     */
+    public double getLookupTableTolerance() {
+        return this.lengthSpline.getLookupTableTolerance();
+    }
+
+    /**
+     * Sets the maximum error of spline values interpolated in lookup tables.
+     * The lookup tables are rebuilt each time a spline changes, which makes
+     * the scale, bend and distribution factors considerably cheaper to
+     * evaluate. Derivatives are always evaluated exactly.
+     * @param tolerance The tolerance relative to the size of the graticule,
+     * or 0 to evaluate the splines exactly.
+     */
+    public void setLookupTableTolerance(double tolerance) {
+        this.lengthSpline.setLookupTableTolerance(tolerance);
+        this.distSpline.setLookupTableTolerance(tolerance);
+        this.bendSpline.setLookupTableTolerance(tolerance);
+        this.xDistSpline.setLookupTableTolerance(tolerance);
+    }
+
     /**
      * Returns the scale factor for the longitude computed with a cubic spline
      * interpolation.
@@ -432,6 +462,51 @@ public final class FlexProjectionModel implements Cloneable {
         this.xDistSpline.setKnot(id, xd);
     }
 
+    /**
+     * Replaces the knots of all curves. The spline coefficients of each curve
+     * are computed once. Values are constrained as by setX, setY, setBending
+     * and setXDist, and the distances of parallels are made increasing.
+     * @param x The length of parallels or null to keep the current values.
+     * @param y The distance of parallels or null to keep the current values.
+     * @param b The bending of parallels or null to keep the current values.
+     * @param xDist The distribution of meridians or null to keep the current
+     * values.
+     */
+    public void setKnots(double[] x, double[] y, double[] b, double[] xDist) {
+        if (x != null) {
+            double[] v = new double[x.length];
+            for (int i = 0; i < v.length; i++) {
+                v[i] = Math.min(Math.max(x[i], 0d), 1d);
+            }
+            this.lengthSpline.setKnots(v);
+        }
+        if (y != null) {
+            double[] v = new double[y.length];
+            for (int i = 0; i < v.length; i++) {
+                v[i] = Math.min(Math.max(y[i], 0d), 1d);
+                if (i > 0 && v[i] < v[i - 1]) {
+                    v[i] = v[i - 1];
+                }
+            }
+            this.distSpline.setKnots(v);
+        }
+        if (b != null) {
+            double[] v = new double[b.length];
+            for (int i = 0; i < v.length; i++) {
+                v[i] = Math.min(Math.max(b[i], MIN_BENDING), MAX_BENDING);
+            }
+            this.bendSpline.setKnots(v);
+        }
+        if (xDist != null) {
+            double[] v = new double[xDist.length];
+            for (int i = 0; i < v.length; i++) {
+                v[i] = Math.min(Math.max(xDist[i], MIN_MERIDIANS_DIST),
+                        MAX_MERIDIANS_DIST);
+            }
+            this.xDistSpline.setKnots(v);
+        }
+    }
+
     public void resetMeridiansDistribution() {
         for (int i = 0; i < xDistSpline.getKnotsCount(); i++) {
             xDistSpline.setKnot(i, 0d);
@@ -754,34 +829,22 @@ public final class FlexProjectionModel implements Cloneable {
     public void mixCurves(FlexProjectionModel flexProjectionModel,
             double lengthW, double distanceW, double bendingW, double meridiansW) {
 
-        for (int i = 0; i < this.lengthSpline.getKnotsCount(); i++) {
-            final double k1 = this.lengthSpline.getKnot(i);
-            final double k2 = flexProjectionModel.lengthSpline.getKnot(i);
-            final double knot = (1d - lengthW) * k1 + lengthW * k2;
-            this.lengthSpline.setKnot(i, knot);
-        }
+        // set all knots of a spline at once to only compute the spline
+        // coefficients and lookup table once
+        mixSpline(this.lengthSpline, flexProjectionModel.lengthSpline, lengthW);
+        mixSpline(this.distSpline, flexProjectionModel.distSpline, distanceW);
+        mixSpline(this.bendSpline, flexProjectionModel.bendSpline, bendingW);
+        mixSpline(this.xDistSpline, flexProjectionModel.xDistSpline, meridiansW);
 
-        for (int i = 0; i < this.distSpline.getKnotsCount(); i++) {
-            final double k1 = this.distSpline.getKnot(i);
-            final double k2 = flexProjectionModel.distSpline.getKnot(i);
-            final double knot = (1d - distanceW) * k1 + distanceW * k2;
-            this.distSpline.setKnot(i, knot);
-        }
-
-        for (int i = 0; i < this.bendSpline.getKnotsCount(); i++) {
-            final double k1 = this.bendSpline.getKnot(i);
-            final double k2 = flexProjectionModel.bendSpline.getKnot(i);
-            final double knot = (1d - bendingW) * k1 + bendingW * k2;
-            this.bendSpline.setKnot(i, knot);
-        }
+        this.updateSplineTables();
+    }
 
-        for (int i = 0; i < this.xDistSpline.getKnotsCount(); i++) {
-            final double k1 = this.xDistSpline.getKnot(i);
-            final double k2 = flexProjectionModel.xDistSpline.getKnot(i);
-            final double knot = (1d - meridiansW) * k1 + meridiansW * k2;
-            this.xDistSpline.setKnot(i, knot);
+    private static void mixSpline(CubicSpline spline1, CubicSpline spline2,
+            double w) {
+        final double[] knots = spline1.getKnotsClone();
+        for (int i = 0; i < knots.length; i++) {
+            knots[i] = (1d - w) * knots[i] + w * spline2.getKnot(i);
         }
-        
-        this.updateSplineTables();
+        spline1.setKnots(knots);
     }
 }
@@ -0,0 +1,900 @@
+/*
+ * FlexProjectionOptimizer.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+
+package ika.proj;
+
+import ika.gui.FlexProjectorPreferencesPanel;
+import ika.gui.ProgressIndicator;
+import java.util.Arrays;
+import java.util.Random;
+
+/**
+ * Searches the curves of a FlexProjectionModel that minimize a weighted
+ * combination of the distortion indices by Canters and Decleir and of the
+ * acceptance index Q.<br>
+ * The search is a differential evolution: a population of candidate models
+ * is improved generation by generation, and the candidates of a generation
+ * are evaluated in parallel. Flex projections are symmetric about the equator
+ * and the central meridian, so distortion is only computed at the sample
+ * points of the indices in one quadrant. The scale of a candidate is the
+ * scale that minimizes the objective. It is found with the scale factors
+ * computed once for the candidate, as scaling a projection scales the Tissot
+ * indicatrices, but does not require projecting again.<br>
+ * The distance of parallels is kept increasing, candidates with folds are
+ * rejected, and rough curves are penalized. The indices are relative to the
+ * indices of the initial model, such that their weights are comparable. Q is
+ * approximated with the sample points of the other indices.
+ */
+public class FlexProjectionOptimizer {
+
+    /**
+     * A listener that is informed when a better model is found.
+     */
+    public interface OptimizerListener {
+
+        /**
+         * Called by the optimizing thread when a better model is found.
+         * @param model A normalized copy of the best model.
+         * @param objective The objective of the model.
+         */
+        public void bestModelChanged(FlexProjectionModel model, double objective);
+    }
+
+    /**
+     * Differential weight scaling the difference between two candidates.
+     */
+    private static final double DIFFERENTIAL_WEIGHT = 0.6;
+
+    /**
+     * Probability of taking a parameter from the mutated candidate.
+     */
+    private static final double CROSSOVER_PROBABILITY = 0.9;
+
+    /**
+     * Standard deviation of the random changes to the initial model that
+     * create the initial population.
+     */
+    private static final double INITIAL_SPREAD = 0.02;
+
+    private static final int MIN_POPULATION = 16;
+
+    private static final int MAX_POPULATION = 64;
+
+    /**
+     * The range of the vertical scale.
+     */
+    private static final double MIN_SCALE_Y = 0.1;
+
+    private static final double MAX_SCALE_Y = 2;
+
+    /**
+     * The optimal scale is searched within this factor of the scale that
+     * equalizes the logarithmic mean of the areal scale factors.
+     */
+    private static final double SCALE_SEARCH_RANGE = Math.log(1.5);
+
+    private static final int SCALE_SEARCH_ITERATIONS = 24;
+
+    /**
+     * Longitude and latitude of the sample points in the upper right quadrant.
+     */
+    private final double[] lam;
+
+    private final double[] phi;
+
+    /**
+     * The area of the sphere represented by each sample point, including the
+     * three mirrored sample points in the other quadrants.
+     */
+    private final double[] area;
+
+    /**
+     * The continental area represented by each sample point and the three
+     * mirrored sample points.
+     */
+    private final double[] continentalArea;
+
+    /**
+     * The initial model, normalized.
+     */
+    private final FlexProjectionModel startModel;
+
+    /**
+     * The parameters for computing Q. Can be null.
+     */
+    private final QModel qModel;
+
+    private final boolean qRelativeTo1;
+
+    private double danWeight = 1;
+
+    private double darWeight = 1;
+
+    private double dabWeight = 0;
+
+    private double qWeight = 0;
+
+    /**
+     * If true, the indices by Canters and Decleir are computed for
+     * continental areas.
+     */
+    private boolean continental = false;
+
+    /**
+     * Weight of the sum of squared second differences of the knots.
+     */
+    private double smoothnessWeight = 10;
+
+    private boolean optimizeLength = true;
+
+    private boolean optimizeDistance = true;
+
+    private boolean optimizeBending = false;
+
+    private boolean optimizeMeridians = false;
+
+    private boolean optimizeProportions = true;
+
+    private int maxGenerations = 200;
+
+    /**
+     * The number of candidates in the population. If 0, the size depends on
+     * the number of optimized parameters.
+     */
+    private int populationSize = 0;
+
+    private long seed = 0;
+
+    /**
+     * The indices of the initial model. The indices of candidates are divided
+     * by these values.
+     */
+    private double refDan;
+
+    private double refDar;
+
+    private double refDab;
+
+    /**
+     * True if the references are valid for the current settings.
+     */
+    private boolean prepared = false;
+
+    /**
+     * Number of optimized parameters.
+     */
+    private int dimension;
+
+    private OptimizerListener listener;
+
+    private ProgressIndicator progressIndicator;
+
+    private volatile boolean cancelled = false;
+
+    private FlexProjectionModel bestModel;
+
+    private double bestObjective = Double.NaN;
+
+    /**
+     * Creates a new optimizer.
+     * @param model The initial model. It is not changed.
+     * @param qModel The parameters for computing Q. Can be null if Q is not
+     * used.
+     */
+    public FlexProjectionOptimizer(FlexProjectionModel model, QModel qModel) {
+        this.startModel = model.clone();
+        this.startModel.normalize();
+        this.qModel = qModel == null ? null : new QModel(qModel);
+        this.qRelativeTo1 = FlexProjectorPreferencesPanel.isAreaAcceptanceRelativeTo1();
+
+        final double d_rad = Math.toRadians(ProjectionDistortionParameters.INDEX_SAMPLING_DIST_DEG);
+        final int nh = (int) Math.round(180. / ProjectionDistortionParameters.INDEX_SAMPLING_DIST_DEG);
+        final int nv = (int) Math.round(90. / ProjectionDistortionParameters.INDEX_SAMPLING_DIST_DEG);
+        final int n = nh * nv;
+        this.lam = new double[n];
+        this.phi = new double[n];
+        this.area = new double[n];
+        this.continentalArea = new double[n];
+        int i = 0;
+        for (int v = 0; v < nv; v++) {
+            final double patchArea = Math.cos((v + 0.5) * d_rad) * d_rad * d_rad;
+            for (int h = 0; h < nh; h++) {
+                this.lam[i] = (h + 0.5) * d_rad;
+                this.phi[i] = (v + 0.5) * d_rad;
+                this.area[i] = 4 * patchArea;
+                int land = 0;
+                land += ProjectionDistortionParameters.isContinental(h, v) ? 1 : 0;
+                land += ProjectionDistortionParameters.isContinental(-h - 1, v) ? 1 : 0;
+                land += ProjectionDistortionParameters.isContinental(h, -v - 1) ? 1 : 0;
+                land += ProjectionDistortionParameters.isContinental(-h - 1, -v - 1) ? 1 : 0;
+                this.continentalArea[i] = land * patchArea;
+                ++i;
+            }
+        }
+    }
+
+    /**
+     * Runs the optimization. This can take a while and should not be called
+     * in the event dispatching thread.
+     * @return The best model found, normalized.
+     */
+    public FlexProjectionModel optimize() {
+
+        this.cancelled = false;
+        final int nThreads = Runtime.getRuntime().availableProcessors();
+        Evaluator[] evaluators = new Evaluator[nThreads];
+        for (int i = 0; i < nThreads; i++) {
+            evaluators[i] = new Evaluator();
+        }
+        this.prepare(evaluators[0]);
+
+        final double[] start = this.encode(this.startModel);
+        if (this.dimension == 0) {
+            this.bestModel = this.startModel.clone();
+            this.bestObjective = evaluators[0].evaluate(start);
+            return this.bestModel.clone();
+        }
+
+        final int np = this.populationSize > 0 ? Math.max(4, this.populationSize)
+                : Math.max(MIN_POPULATION, Math.min(MAX_POPULATION, 2 * this.dimension));
+        Random random = new Random(this.seed);
+
+        // initial population of random variations of the initial model
+        double[][] population = new double[np][];
+        double[] objectives = new double[np];
+        double[] scales = new double[np];
+        population[0] = start;
+        for (int i = 1; i < np; i++) {
+            population[i] = start.clone();
+            for (int d = 0; d < this.dimension; d++) {
+                population[i][d] += INITIAL_SPREAD * random.nextGaussian();
+            }
+            this.repair(population[i]);
+        }
+        evaluate(evaluators, population, objectives, scales);
+        int best = 0;
+        for (int i = 1; i < np; i++) {
+            if (objectives[i] < objectives[best]) {
+                best = i;
+            }
+        }
+        this.bestChanged(population[best], scales[best], objectives[best]);
+
+        double[][] trials = new double[np][this.dimension];
+        double[] trialObjectives = new double[np];
+        double[] trialScales = new double[np];
+        for (int generation = 0; generation < this.maxGenerations; generation++) {
+            if (this.cancelled || (this.progressIndicator != null
+                    && !this.progressIndicator.progress(generation * 100 / this.maxGenerations))) {
+                break;
+            }
+
+            // mutate and cross each candidate with three other candidates
+            for (int i = 0; i < np; i++) {
+                int r1, r2, r3;
+                do {
+                    r1 = random.nextInt(np);
+                } while (r1 == i);
+                do {
+                    r2 = random.nextInt(np);
+                } while (r2 == i || r2 == r1);
+                do {
+                    r3 = random.nextInt(np);
+                } while (r3 == i || r3 == r1 || r3 == r2);
+                final double[] x = population[i];
+                final double[] trial = trials[i];
+                final int forced = random.nextInt(this.dimension);
+                for (int d = 0; d < this.dimension; d++) {
+                    if (d == forced || random.nextDouble() < CROSSOVER_PROBABILITY) {
+                        trial[d] = population[r1][d] + DIFFERENTIAL_WEIGHT
+                                * (population[r2][d] - population[r3][d]);
+                    } else {
+                        trial[d] = x[d];
+                    }
+                }
+                this.repair(trial);
+            }
+            evaluate(evaluators, trials, trialObjectives, trialScales);
+
+            // keep trials that are not worse
+            final double previousBest = objectives[best];
+            for (int i = 0; i < np; i++) {
+                if (trialObjectives[i] <= objectives[i]) {
+                    final double[] tmp = population[i];
+                    population[i] = trials[i];
+                    trials[i] = tmp;
+                    objectives[i] = trialObjectives[i];
+                    scales[i] = trialScales[i];
+                    if (objectives[i] < objectives[best]) {
+                        best = i;
+                    }
+                }
+            }
+            final boolean improved = objectives[best] < previousBest;
+            if (improved) {
+                this.bestChanged(population[best], scales[best], objectives[best]);
+            }
+        }
+
+        return this.bestModel.clone();
+    }
+
+    /**
+     * Stops a running optimization. optimize() returns the best model found
+     * so far.
+     */
+    public void cancel() {
+        this.cancelled = true;
+    }
+
+    /**
+     * Computes the objective for a model. Only the optimized curves are taken
+     * from the model, the other curves are taken from the initial model. The
+     * objective is computed for the optimal scale, not the scale of the model.
+     * @return The objective or Double.POSITIVE_INFINITY if the model has folds.
+     */
+    public double computeObjective(FlexProjectionModel model) {
+        Evaluator evaluator = new Evaluator();
+        this.prepare(evaluator);
+        FlexProjectionModel m = model.clone();
+        m.normalize();
+        return evaluator.evaluate(this.encode(m));
+    }
+
+    /**
+     * Counts the optimized parameters and computes the indices of the initial
+     * model.
+     */
+    private void prepare(Evaluator evaluator) {
+        if (this.prepared) {
+            return;
+        }
+        this.dimension = this.encode(this.startModel).length;
+        this.refDan = this.refDar = this.refDab = 1;
+        final double[] start = this.encode(this.startModel);
+        if (evaluator.evaluate(start) < Double.POSITIVE_INFINITY) {
+            this.refDan = evaluator.dan > 1e-9 ? evaluator.dan : 1;
+            this.refDar = evaluator.dar > 1e-9 ? evaluator.dar : 1;
+            this.refDab = evaluator.dab > 1e-9 ? evaluator.dab : 1;
+        }
+        this.prepared = true;
+    }
+
+    /**
+     * Distributes the evaluation of candidates among the evaluators. The
+     * first chunk of candidates is evaluated by the current thread.
+     */
+    private static void evaluate(Evaluator[] evaluators, double[][] candidates,
+            double[] objectives, double[] scales) {
+
+        final int nThreads = Math.min(evaluators.length, candidates.length);
+        final int chunk = (candidates.length / nThreads) + 1;
+        EvaluationThread[] threads = new EvaluationThread[nThreads];
+        for (int i = 0; i < nThreads; i++) {
+            final int start = i * chunk;
+            final int end = Math.min(candidates.length, start + chunk);
+            threads[i] = new EvaluationThread(evaluators[i], candidates,
+                    objectives, scales, start, end);
+            if (i > 0) {
+                threads[i].start();
+            }
+        }
+        threads[0].run();
+        for (int i = 1; i < nThreads; i++) {
+            try {
+                threads[i].join();
+            } catch (InterruptedException ex) {
+                throw new IllegalStateException(ex);
+            }
+        }
+        for (int i = 0; i < nThreads; i++) {
+            if (threads[i].exception != null) {
+                throw threads[i].exception;
+            }
+        }
+    }
+
+    private void bestChanged(double[] v, double scale, double objective) {
+        FlexProjectionModel m = this.startModel.clone();
+        this.decode(v, m);
+        m.setScale(m.getScale() * scale);
+        m.normalize();
+        this.bestModel = m;
+        this.bestObjective = objective;
+        if (this.listener != null) {
+            this.listener.bestModelChanged(m.clone(), objective);
+        }
+    }
+
+    /**
+     * Returns the optimized parameters of a model.
+     */
+    private double[] encode(FlexProjectionModel m) {
+        final double[] x = m.getX();
+        final double[] y = m.getY();
+        final double[] b = m.getB();
+        final double[] xDist = m.getXDist();
+        double[] v = new double[x.length + y.length + b.length + xDist.length + 1];
+        int n = 0;
+        if (this.optimizeLength) {
+            System.arraycopy(x, 0, v, n, x.length);
+            n += x.length;
+        }
+        if (this.optimizeDistance) {
+            // the equator and the poles are fixed
+            System.arraycopy(y, 1, v, n, y.length - 2);
+            n += y.length - 2;
+        }
+        if (this.optimizeBending) {
+            System.arraycopy(b, 0, v, n, b.length);
+            n += b.length;
+        }
+        if (this.optimizeMeridians) {
+            // the central meridian and the outer meridians are fixed
+            System.arraycopy(xDist, 1, v, n, xDist.length - 2);
+            n += xDist.length - 2;
+        }
+        if (this.optimizeProportions) {
+            v[n++] = m.getScaleY();
+        }
+        return Arrays.copyOf(v, n);
+    }
+
+    /**
+     * Replaces the curves of a model by the optimized parameters. Curves that
+     * are not optimized are taken from the initial model.
+     */
+    private void decode(double[] v, FlexProjectionModel m) {
+        double[] x = null;
+        double[] y = null;
+        double[] b = null;
+        double[] xDist = null;
+        int n = 0;
+        if (this.optimizeLength) {
+            x = this.startModel.getX();
+            System.arraycopy(v, n, x, 0, x.length);
+            n += x.length;
+        }
+        if (this.optimizeDistance) {
+            y = this.startModel.getY();
+            System.arraycopy(v, n, y, 1, y.length - 2);
+            n += y.length - 2;
+        }
+        if (this.optimizeBending) {
+            b = this.startModel.getB();
+            System.arraycopy(v, n, b, 0, b.length);
+            n += b.length;
+        }
+        if (this.optimizeMeridians) {
+            xDist = this.startModel.getXDist();
+            System.arraycopy(v, n, xDist, 1, xDist.length - 2);
+            n += xDist.length - 2;
+        }
+        m.setKnots(x, y, b, xDist);
+        if (this.optimizeProportions) {
+            m.setScaleY(v[n]);
+        }
+    }
+
+    /**
+     * Constrains parameters to their valid ranges and sorts the distances of
+     * parallels.
+     */
+    private void repair(double[] v) {
+        int n = 0;
+        if (this.optimizeLength) {
+            final int nKnots = this.startModel.getX().length;
+            for (int i = n; i < n + nKnots; i++) {
+                v[i] = Math.min(Math.max(v[i], 0d), 1d);
+            }
+            n += nKnots;
+        }
+        if (this.optimizeDistance) {
+            final int nKnots = this.startModel.getY().length - 2;
+            for (int i = n; i < n + nKnots; i++) {
+                v[i] = Math.min(Math.max(v[i], 0d), 1d);
+            }
+            Arrays.sort(v, n, n + nKnots);
+            n += nKnots;
+        }
+        if (this.optimizeBending) {
+            final int nKnots = this.startModel.getB().length;
+            for (int i = n; i < n + nKnots; i++) {
+                v[i] = Math.min(Math.max(v[i], FlexProjectionModel.MIN_BENDING),
+                        FlexProjectionModel.MAX_BENDING);
+            }
+            n += nKnots;
+        }
+        if (this.optimizeMeridians) {
+            final int nKnots = this.startModel.getXDist().length - 2;
+            for (int i = n; i < n + nKnots; i++) {
+                v[i] = Math.min(Math.max(v[i], FlexProjectionModel.MIN_MERIDIANS_DIST),
+                        FlexProjectionModel.MAX_MERIDIANS_DIST);
+            }
+            n += nKnots;
+        }
+        if (this.optimizeProportions) {
+            v[n] = Math.min(Math.max(v[n], MIN_SCALE_Y), MAX_SCALE_Y);
+        }
+    }
+
+    /**
+     * Returns the sum of squared second differences of the knots.
+     */
+    private static double roughness(double[] knots) {
+        double r = 0;
+        for (int i = 1; i < knots.length - 1; i++) {
+            final double d = knots[i - 1] - 2 * knots[i] + knots[i + 1];
+            r += d * d;
+        }
+        return r;
+    }
+
+    /**
+     * Computes the objective of candidates. Each evaluator has its own model
+     * and can be used by one thread.
+     */
+    private final class Evaluator {
+
+        private final FlexProjectionModel model;
+
+        private final FlexProjection projection = new FlexProjection();
+
+        private final BulkProjectionFactors factors;
+
+        /**
+         * Areal scale factor, Tissot semi-axes and angular distortion at each
+         * sample point for the scale of the initial model. These are the
+         * arrays of factors.
+         */
+        private final double[] s;
+
+        private final double[] a;
+
+        private final double[] b;
+
+        private final double[] omega;
+
+        /**
+         * Weights of the sample points for Dan, Dar and Dab.
+         */
+        private final double[] weights;
+
+        private final double weightsSum;
+
+        /**
+         * Whether the angular and the areal distortion are acceptable for Q
+         * when the acceptable areal distortion is independent of the scale.
+         */
+        private final boolean[] angleAccepted;
+
+        private final boolean[] areaAccepted;
+
+        /**
+         * The indices of the last evaluated candidate.
+         */
+        double dan;
+
+        double dar;
+
+        double dab;
+
+        double q;
+
+        /**
+         * The optimal scale of the last evaluated candidate relative to the
+         * scale of the initial model.
+         */
+        double scale;
+
+        Evaluator() {
+            this.model = startModel.clone();
+            this.projection.setModel(this.model);
+            this.projection.initialize();
+            final int n = lam.length;
+            this.factors = new BulkProjectionFactors(n);
+            this.s = this.factors.s;
+            this.a = this.factors.a;
+            this.b = this.factors.b;
+            this.omega = this.factors.omega;
+            this.angleAccepted = new boolean[n];
+            this.areaAccepted = new boolean[n];
+            this.weights = continental ? continentalArea : area;
+            double sum = 0;
+            for (int i = 0; i < n; i++) {
+                sum += this.weights[i];
+            }
+            this.weightsSum = sum;
+        }
+
+        /**
+         * Computes the objective of a candidate.
+         * @return The objective or Double.POSITIVE_INFINITY if the candidate
+         * has folds.
+         */
+        double evaluate(double[] v) {
+            decode(v, this.model);
+
+            double omegaSum = 0;
+            double lnSum = 0;
+            double areaSum = 0;
+            double minS = Double.MAX_VALUE;
+            this.factors.compute(this.projection, lam, phi,
+                    ProjectionDistortionParameters.DERIVATIVE_INC_RAD, 0, lam.length);
+            for (int i = 0; i < lam.length; i++) {
+                final double si = this.s[i];
+                if (!(si > 0) || Double.isInfinite(si)) {
+                    return Double.POSITIVE_INFINITY;
+                }
+                omegaSum += this.weights[i] * this.omega[i];
+                lnSum += area[i] * Math.log(si);
+                areaSum += area[i];
+                minS = Math.min(minS, si);
+            }
+            this.dan = Math.toDegrees(omegaSum / this.weightsSum);
+
+            // acceptance that does not depend on the scale
+            if (qModel != null) {
+                final double maxArea = qModel.getQMaxAreaScale();
+                final double maxAngle = qModel.getQMaxAngle();
+                for (int i = 0; i < lam.length; i++) {
+                    this.angleAccepted[i] = this.omega[i] <= maxAngle;
+                    this.areaAccepted[i] = this.s[i] <= maxArea * minS;
+                }
+            }
+
+            double penalty = 0;
+            if (optimizeLength) {
+                penalty += roughness(this.model.getX());
+            }
+            if (optimizeDistance) {
+                penalty += roughness(this.model.getY());
+            }
+            if (optimizeBending) {
+                penalty += roughness(this.model.getB());
+            }
+            if (optimizeMeridians) {
+                penalty += roughness(this.model.getXDist());
+            }
+            penalty *= smoothnessWeight;
+
+            // golden section search for the optimal scale, starting with the
+            // scale that equalizes the logarithmic mean of the areal factors
+            final double t0 = -0.5 * lnSum / areaSum;
+            if (darWeight == 0 && dabWeight == 0 && qWeight == 0) {
+                this.scale = Math.exp(t0);
+                return this.objective(this.scale) + penalty;
+            }
+            final double g = (Math.sqrt(5) - 1) / 2;
+            double lo = t0 - SCALE_SEARCH_RANGE;
+            double hi = t0 + SCALE_SEARCH_RANGE;
+            double t1 = hi - g * (hi - lo);
+            double t2 = lo + g * (hi - lo);
+            double f1 = this.objective(Math.exp(t1));
+            double f2 = this.objective(Math.exp(t2));
+            for (int i = 0; i < SCALE_SEARCH_ITERATIONS; i++) {
+                if (f1 <= f2) {
+                    hi = t2;
+                    t2 = t1;
+                    f2 = f1;
+                    t1 = hi - g * (hi - lo);
+                    f1 = this.objective(Math.exp(t1));
+                } else {
+                    lo = t1;
+                    t1 = t2;
+                    f1 = f2;
+                    t2 = lo + g * (hi - lo);
+                    f2 = this.objective(Math.exp(t2));
+                }
+            }
+            this.scale = Math.exp((lo + hi) / 2);
+            return this.objective(this.scale) + penalty;
+        }
+
+        /**
+         * Computes Dar, Dab and Q for a scale from the cached scale factors and
+         * returns the weighted sum of the indices.
+         */
+        private double objective(double scale) {
+            final double scale2 = scale * scale;
+            double darSum = 0;
+            double dabSum = 0;
+            for (int i = 0; i < lam.length; i++) {
+                final double w = this.weights[i];
+                final double axb = this.s[i] * scale2;
+                darSum += ((axb < 1. ? 1. / axb : axb) - 1.) * w;
+                final double as = this.a[i] * scale;
+                final double bs = this.b[i] * scale;
+                final double a_b = (as < 1. ? 1. / as : as) + (bs < 1. ? 1. / bs : bs);
+                dabSum += (a_b * 0.5 - 1.) * w;
+            }
+            this.dar = darSum / this.weightsSum;
+            this.dab = dabSum / this.weightsSum;
+            this.q = this.acceptance(scale2);
+
+            double obj = danWeight * this.dan / refDan
+                    + darWeight * this.dar / refDar
+                    + dabWeight * this.dab / refDab;
+            if (qModel != null) {
+                obj += qWeight * (1. - this.q / 100.);
+            }
+            return obj;
+        }
+
+        /**
+         * Computes the acceptance index Q in percent.
+         */
+        private double acceptance(double scale2) {
+            if (qModel == null) {
+                return Double.NaN;
+            }
+            double maxArea = qModel.getQMaxAreaScale();
+            if (qModel.getQMaxAngle() == 0 && maxArea == 1) {
+                // conformal and equal-area are not possible
+                return 0;
+            }
+            if (maxArea < 1d) {
+                maxArea = 1d / maxArea;
+            }
+            final double minArea = 1d / maxArea;
+            double acceptableArea = 0;
+            double totalArea = 0;
+            for (int i = 0; i < lam.length; i++) {
+                totalArea += area[i];
+                if (!this.angleAccepted[i]) {
+                    continue;
+                }
+                final boolean accept;
+                if (qRelativeTo1) {
+                    final double axb = this.s[i] * scale2;
+                    accept = axb <= maxArea && axb >= minArea;
+                } else {
+                    accept = this.areaAccepted[i];
+                }
+                if (accept) {
+                    acceptableArea += area[i];
+                }
+            }
+            return acceptableArea / totalArea * 100.;
+        }
+    }
+
+    private static class EvaluationThread extends Thread {
+
+        private final Evaluator evaluator;
+        private final double[][] candidates;
+        private final double[] objectives;
+        private final double[] scales;
+        private final int start;
+        private final int end;
+        private RuntimeException exception;
+
+        public EvaluationThread(Evaluator evaluator, double[][] candidates,
+                double[] objectives, double[] scales, int start, int end) {
+            this.evaluator = evaluator;
+            this.candidates = candidates;
+            this.objectives = objectives;
+            this.scales = scales;
+            this.start = start;
+            this.end = end;
+        }
+
+        @Override
+        public void run() {
+            try {
+                for (int i = this.start; i < this.end; i++) {
+                    this.objectives[i] = this.evaluator.evaluate(this.candidates[i]);
+                    this.scales[i] = this.evaluator.scale;
+                }
+            } catch (RuntimeException exc) {
+                this.exception = exc;
+            }
+        }
+    }
+
+    /**
+     * Sets the weights of the indices. The indices by Canters and Decleir are
+     * relative to the indices of the initial model.
+     * @param dan Weight of the angular distortion index.
+     * @param dar Weight of the areal distortion index.
+     * @param dab Weight of the overall scale distortion index.
+     * @param q Weight of the share of the sphere with unacceptable distortion.
+     */
+    public void setWeights(double dan, double dar, double dab, double q) {
+        this.danWeight = dan;
+        this.darWeight = dar;
+        this.dabWeight = dab;
+        this.qWeight = q;
+        this.prepared = false;
+    }
+
+    public boolean isContinental() {
+        return continental;
+    }
+
+    /**
+     * Sets whether the indices by Canters and Decleir are computed for
+     * continental areas only.
+     */
+    public void setContinental(boolean continental) {
+        this.continental = continental;
+        this.prepared = false;
+    }
+
+    public double getSmoothnessWeight() {
+        return smoothnessWeight;
+    }
+
+    public void setSmoothnessWeight(double smoothnessWeight) {
+        this.smoothnessWeight = smoothnessWeight;
+        this.prepared = false;
+    }
+
+    /**
+     * Sets the curves that are optimized.
+     * @param length The length of parallels.
+     * @param distance The distance of parallels from the equator.
+     * @param bending The bending of parallels.
+     * @param meridians The distribution of meridians.
+     * @param proportions The height-to-width proportions.
+     */
+    public void setOptimizedCurves(boolean length, boolean distance,
+            boolean bending, boolean meridians, boolean proportions) {
+        this.optimizeLength = length;
+        this.optimizeDistance = distance;
+        this.optimizeBending = bending;
+        this.optimizeMeridians = meridians;
+        this.optimizeProportions = proportions;
+        this.prepared = false;
+    }
+
+    public int getMaxGenerations() {
+        return maxGenerations;
+    }
+
+    public void setMaxGenerations(int maxGenerations) {
+        this.maxGenerations = Math.max(1, maxGenerations);
+    }
+
+    public int getPopulationSize() {
+        return populationSize;
+    }
+
+    /**
+     * Sets the number of candidates in the population. If 0, the size
+     * depends on the number of optimized parameters.
+     */
+    public void setPopulationSize(int populationSize) {
+        this.populationSize = populationSize;
+    }
+
+    public void setSeed(long seed) {
+        this.seed = seed;
+    }
+
+    public void setListener(OptimizerListener listener) {
+        this.listener = listener;
+    }
+
+    /**
+     * Sets a progress indicator. The optimization stops when it is aborted.
+     */
+    public void setProgressIndicator(ProgressIndicator progressIndicator) {
+        this.progressIndicator = progressIndicator;
+    }
+
+    /**
+     * Returns the best model found by the last optimization.
+     */
+    public FlexProjectionModel getBestModel() {
+        return bestModel == null ? null : bestModel.clone();
+    }
+
+    public double getBestObjective() {
+        return bestObjective;
+    }
+}
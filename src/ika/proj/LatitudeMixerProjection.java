@@ -70,6 +70,7 @@ public class LatitudeMixerProjection extends AbstractMixerProjection {
         super.initialize();
         p1.initialize();
         p2.initialize();
+        invalidateInverse();
     }
 
     @Override
@@ -159,6 +160,11 @@ public class LatitudeMixerProjection extends AbstractMixerProjection {
     @Override
     public Point2D.Double projectInverse(double x, double y, Point2D.Double out) {
 
+        if (parallelsInverse(x, y, out)) {
+            return out;
+        }
+
+        // generic search if parallels are not straight or the fast inverse fails
         try {
             if (p1.hasInverse()) {
                 p1.projectInverse(x, y, out);
@@ -195,6 +201,7 @@ public class LatitudeMixerProjection extends AbstractMixerProjection {
         this.latitude = latitude;
         updateAutomaticPoleScale();
         updatePoleOffset();
+        invalidateInverse();
     }
 
     /**
@@ -209,6 +216,7 @@ public class LatitudeMixerProjection extends AbstractMixerProjection {
      */
     public void setTolerance(double tolerance) {
         this.tolerance = tolerance;
+        invalidateInverse();
     }
 
     @Override
@@ -237,6 +245,7 @@ public class LatitudeMixerProjection extends AbstractMixerProjection {
     public void setPoleScale(double poleScale) {
         this.poleScale = poleScale;
         updatePoleOffset();
+        invalidateInverse();
     }
 
     /**
@@ -253,6 +262,7 @@ public class LatitudeMixerProjection extends AbstractMixerProjection {
     @Override
     public void setScale(double scale) {
         this.scale = scale;
+        invalidateInverse();
     }
 
     /**
@@ -268,6 +278,7 @@ public class LatitudeMixerProjection extends AbstractMixerProjection {
     public void setAutomaticScale(boolean automaticScale) {
         this.automaticPoleScale = automaticScale;
         updateAutomaticPoleScale();
+        invalidateInverse();
     }
 
     @Override
@@ -278,6 +289,7 @@ public class LatitudeMixerProjection extends AbstractMixerProjection {
     @Override
     public void setVerticalScale(double vScale) {
         this.vScale = vScale;
+        invalidateInverse();
     }
 
     @Override
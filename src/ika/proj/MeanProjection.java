@@ -61,6 +61,11 @@ public class MeanProjection extends AbstractMixerProjection {
     @Override
     public Point2D.Double projectInverse(double x, double y, Point2D.Double out) {
 
+        if (parallelsInverse(x, y, out)) {
+            return out;
+        }
+
+        // generic search if parallels are not straight or the fast inverse fails
         try {
             if (p1.hasInverse()) {
                 p1.projectInverse(x, y, out);
@@ -95,6 +100,7 @@ public class MeanProjection extends AbstractMixerProjection {
      */
     public void setWeight(double weight) {
         this.weight = weight;
+        invalidateInverse();
     }
 
     @Override
@@ -116,6 +122,7 @@ public class MeanProjection extends AbstractMixerProjection {
     @Override
     public void setScale(double scale) {
         this.scale = scale;
+        invalidateInverse();
     }
 
     @Override
@@ -126,6 +133,7 @@ public class MeanProjection extends AbstractMixerProjection {
     @Override
     public void setVerticalScale(double vScale) {
         this.vScale = vScale;
+        invalidateInverse();
     }
 
     @Override
@@ -194,5 +202,6 @@ public class MeanProjection extends AbstractMixerProjection {
         tokenizer.nextToken();
         String proj2Name = tokenizer.nextToken();
         p2 = ProjectionFactory.getNamedPROJ4Projection(proj2Name);
+        invalidateInverse();
     }
 }
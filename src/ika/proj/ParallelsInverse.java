@@ -0,0 +1,189 @@
+/*
+ * ParallelsInverse.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+
+package ika.proj;
+
+import com.jhlabs.map.MapMath;
+import com.jhlabs.map.proj.Projection;
+import java.awt.geom.Point2D;
+
+/**
+ * Inverse projection for projections with straight horizontal parallels,
+ * where the y coordinate only depends on the latitude. The latitude is
+ * found in a table of y coordinates sampled along the central meridian and
+ * refined with a bracketed regula falsi. The longitude is then found with
+ * a bracketed regula falsi along the parallel, which converges after one
+ * step if x is linear in longitude. Both need only a few forward
+ * projections, whereas a generic two-dimensional search needs many.<br>
+ * The table is built when the object is created, and must be discarded when
+ * the projection changes.
+ */
+final class ParallelsInverse {
+
+    /**
+     * Number of latitudes in the table, one every half degree.
+     */
+    private static final int TABLE_SIZE = 361;
+
+    /**
+     * Maximum difference between the forward projection of the inverted
+     * point and the point to invert.
+     */
+    private static final double TOL = 1e-10;
+
+    private static final int MAX_ITERATIONS = 50;
+
+    private final Projection projection;
+
+    /**
+     * Latitudes in radians from -PI/2 to +PI/2.
+     */
+    private final double[] lats;
+
+    /**
+     * y coordinates of the latitudes along the central meridian. Null if
+     * the y coordinates do not increase with latitude.
+     */
+    private final double[] ys;
+
+    /**
+     * Builds the table for a projection. The projection must not change
+     * afterwards.
+     * @param projection A projection with straight horizontal parallels.
+     */
+    ParallelsInverse(Projection projection) {
+        this.projection = projection;
+        this.lats = new double[TABLE_SIZE];
+        double[] y = new double[TABLE_SIZE];
+        Point2D.Double pt = new Point2D.Double();
+        for (int i = 0; i < TABLE_SIZE; i++) {
+            this.lats[i] = -MapMath.HALFPI + Math.PI * i / (TABLE_SIZE - 1);
+            try {
+                projection.project(0, this.lats[i], pt);
+            } catch (RuntimeException exc) {
+                y = null;
+                break;
+            }
+            y[i] = pt.y;
+            if (Double.isNaN(pt.y) || (i > 0 && !(y[i] > y[i - 1]))) {
+                y = null;
+                break;
+            }
+        }
+        this.ys = y;
+    }
+
+    /**
+     * Inverse projection of a point.
+     * @param x The x coordinate.
+     * @param y The y coordinate.
+     * @param lp Receives the longitude and latitude in radians. Also used for
+     * intermediate results if the inversion fails.
+     * @return True if the point was inverted, false if it is outside of the
+     * graticule or an iteration did not converge.
+     */
+    boolean inverse(double x, double y, Point2D.Double lp) {
+        if (this.ys == null || !(y >= this.ys[0] && y <= this.ys[TABLE_SIZE - 1])) {
+            return false;
+        }
+
+        try {
+            // latitude: find the table interval and refine along the central meridian
+            int lo = 0;
+            int hi = TABLE_SIZE - 1;
+            while (hi - lo > 1) {
+                final int mid = (lo + hi) >>> 1;
+                if (this.ys[mid] > y) {
+                    hi = mid;
+                } else {
+                    lo = mid;
+                }
+            }
+            final double lat = this.solve(this.lats[lo], this.ys[lo] - y,
+                    this.lats[hi], this.ys[hi] - y, y, 0, true, lp);
+            if (Double.isNaN(lat)) {
+                return false;
+            }
+
+            // longitude: x between the central meridian and the outer meridian
+            this.projection.project(0, lat, lp);
+            final double x0 = lp.x;
+            final double lonEdge = x >= x0 ? Math.PI : -Math.PI;
+            this.projection.project(lonEdge, lat, lp);
+            final double xEdge = lp.x;
+            if (x >= x0 ? x > xEdge : x < xEdge) {
+                return false;
+            }
+            final double lon = this.solve(0, x0 - x, lonEdge, xEdge - x, x,
+                    lat, false, lp);
+            if (Double.isNaN(lon)) {
+                return false;
+            }
+
+            // verify with the forward projection
+            this.projection.project(lon, lat, lp);
+            if (!(Math.abs(lp.x - x) <= TOL && Math.abs(lp.y - y) <= TOL)) {
+                return false;
+            }
+            lp.x = lon;
+            lp.y = lat;
+            return true;
+        } catch (RuntimeException exc) {
+            return false;
+        }
+    }
+
+    /**
+     * Finds a root of the difference between a forward projected coordinate
+     * and a target coordinate in a bracket with the Illinois variant of the
+     * regula falsi.
+     * @param a Start of the bracket.
+     * @param fa Difference at a.
+     * @param b End of the bracket.
+     * @param fb Difference at b, with a sign opposite to fa.
+     * @param target The coordinate to find.
+     * @param fixed The fixed longitude or latitude.
+     * @param latitude True if a latitude is searched for a fixed longitude,
+     * false if a longitude is searched for a fixed latitude.
+     * @param pt Point for intermediate results.
+     * @return The root or NaN if the iteration does not converge.
+     */
+    private double solve(double a, double fa, double b, double fb,
+            double target, double fixed, boolean latitude, Point2D.Double pt) {
+
+        if (fa == 0) {
+            return a;
+        }
+        if (fb == 0) {
+            return b;
+        }
+        for (int i = 0; i < MAX_ITERATIONS; i++) {
+            final double c = b - fb * (b - a) / (fb - fa);
+            if (latitude) {
+                this.projection.project(fixed, c, pt);
+            } else {
+                this.projection.project(c, fixed, pt);
+            }
+            final double fc = (latitude ? pt.y : pt.x) - target;
+            if (Double.isNaN(fc)) {
+                return Double.NaN;
+            }
+            if (Math.abs(fc) <= TOL * 0.5 || Math.abs(b - a) < 1e-14) {
+                return c;
+            }
+            if (fc * fb < 0) {
+                a = b;
+                fa = fb;
+            } else {
+                fa *= 0.5;
+            }
+            b = c;
+            fb = fc;
+        }
+        return Double.NaN;
+    }
+}
@@ -9,16 +9,19 @@ package ika.proj;
 
 import com.jhlabs.map.MapMath;
 import com.jhlabs.map.proj.Projection;
+import com.jhlabs.map.proj.ProjectionException;
 import ika.geo.FlexProjectorModel;
 import ika.geo.GeoImage;
 import ika.geo.GeoObject;
 import ika.geo.GeoPath;
 import ika.gui.FlexProjectorPreferencesPanel;
+import ika.utils.Instrumentation;
 import ika.utils.PropertiesLoader;
 import java.awt.Color;
 import java.awt.geom.Point2D;
 import java.awt.geom.Rectangle2D;
 import java.awt.image.BufferedImage;
+import java.awt.image.WritableRaster;
 import java.util.Properties;
 
 /**
@@ -42,12 +45,12 @@ public class ProjectionDistortionParameters {
      * The default value is 2.5 degree, which is the value used by Canters and
      * Decleir.
      */
-    private static final double INDEX_SAMPLING_DIST_DEG = 2.5;
+    static final double INDEX_SAMPLING_DIST_DEG = 2.5;
     
     /**
      * Increment for computing local first derivative. In radians.
      */
-    private static final double DERIVATIVE_INC_RAD = 1e-5;
+    static final double DERIVATIVE_INC_RAD = 1e-5;
     
     /**
      * Continental areas are depicted in the mask image with this color.
@@ -55,27 +58,60 @@ public class ProjectionDistortionParameters {
     private static final java.awt.Color continentalColor = java.awt.Color.WHITE;
     
     /**
-     * Mask for terrestrial areas stored in a black-and-white image.
+     * Holds the mask for terrestrial areas stored in a black-and-white image.
+     * The image is loaded when first used.
      */
-    private static final java.awt.image.BufferedImage CONTINENTAL_MASK;
+    private static final class ContinentalMask {
+
+        private static final java.awt.image.BufferedImage IMAGE = load();
+
+        private static java.awt.image.BufferedImage load() {
+            try {
+                Properties props =
+                        PropertiesLoader.loadProperties("ika.app.Application.properties");
+                String mapData = props.getProperty("EarthMask");
+                java.net.URL url = ProjectionDistortionParameters.class.getResource(mapData);
+                return javax.imageio.ImageIO.read(url);
+            } catch (Exception exc) {
+                exc.printStackTrace();
+                return null;
+            }
+        }
 
-    // load the continental image mask
-    static {
-        java.awt.image.BufferedImage img;
-        try {
-            // load continental mask
-            Properties props =
-                    PropertiesLoader.loadProperties("ika.app.Application.properties");
-            String mapData = props.getProperty("EarthMask");
-            java.net.URL url = ProjectionDistortionParameters.class.getResource(mapData);
-            img = javax.imageio.ImageIO.read(url);
-        } catch (Exception exc) {
-            exc.printStackTrace();
-            img = null;
+        /**
+         * Returns the mask, or null if it could not be loaded.
+         */
+        static java.awt.image.BufferedImage get() {
+            return IMAGE;
         }
-        CONTINENTAL_MASK = img;
+    }
+
+    /**
+     * Loads the mask for terrestrial areas if it has not been loaded before.
+     * Can be called from any thread to load the mask before it is needed.
+     */
+    public static void preloadContinentalMask() {
+        ContinentalMask.get();
     }
     
+    /**
+     * Returns whether a sample point of the indices defined by Canters and
+     * Decleir is on land.
+     * @param h The column of the sample point, centered on the longitude
+     * (h + 0.5) * INDEX_SAMPLING_DIST_DEG.
+     * @param v The row of the sample point, centered on the latitude
+     * (v + 0.5) * INDEX_SAMPLING_DIST_DEG.
+     */
+    static boolean isContinental(int h, int v) {
+        final java.awt.image.BufferedImage mask = ContinentalMask.get();
+        if (mask == null) {
+            return false;
+        }
+        final int nh = (int) Math.round(180. / INDEX_SAMPLING_DIST_DEG);
+        final int nv = (int) Math.round(90. / INDEX_SAMPLING_DIST_DEG);
+        return mask.getRGB(h + nh, v + nv) == continentalColor.getRGB();
+    }
+
     /**
      * The mean angular deformation index.
      */
@@ -160,6 +196,13 @@ public class ProjectionDistortionParameters {
      */
     private double qMinArea; 
     
+    /**
+     * An index over qAreaGridQuadrant and qAngleGridQuadrant for quickly
+     * computing the Q index for new acceptance limits. Replaced by
+     * initAcceptanceDegreeGrids() when the projection changes.
+     */
+    private volatile QAcceptanceIndex qAcceptanceIndex;
+    
     /**
      * A grid in the projected coordinate space (not the geographic space, as 
      * qAreaGridQuadrant or qAngleGridQuadrant).
@@ -196,16 +239,24 @@ public class ProjectionDistortionParameters {
     public final void computeDistortionIndices(QModel qModel) {
         
         // update Q grids in spherical coordinates
+        long t = Instrumentation.start();
         this.initAcceptanceDegreeGrids();
+        Instrumentation.stop("distortion.acceptanceDegreeGrids", t);
         
         // update the Q index based on the Q grids in spherical coordinates
+        t = Instrumentation.start();
         this.computeAcceptanceIndex(qModel);
+        Instrumentation.stop("distortion.acceptanceIndex", t);
         
         // update Q grid in projected coordinates
+        t = Instrumentation.start();
         this.initQProjectedGrid();
+        Instrumentation.stop("distortion.qProjectedGrid", t);
         
         // update indices by Canters & Decleir
+        t = Instrumentation.start();
         this.computeCantersDecleirIndices();
+        Instrumentation.stop("distortion.cantersDecleirIndices", t);
         
     }
 
@@ -235,6 +286,7 @@ public class ProjectionDistortionParameters {
             normalAspectProj.initialize();
                     
             final int continentARGB = continentalColor.getRGB();
+            final java.awt.image.BufferedImage mask = ContinentalMask.get();
             
             final double d_rad = Math.toRadians(INDEX_SAMPLING_DIST_DEG);
             int nh = (int)Math.round(180. / INDEX_SAMPLING_DIST_DEG);
@@ -247,31 +299,36 @@ public class ProjectionDistortionParameters {
             Darc = 0;
             Dabc = 0;
             double continentalArea = 0;
-            ProjectionFactors f = new ProjectionFactors();
+            BulkProjectionFactors f = BulkProjectionFactors.compute(normalAspectProj,
+                    sampleLongitudes(), sampleLatitudes(), DERIVATIVE_INC_RAD);
             
+            int i = 0;
             for (int v = -nv; v < nv; v++) {
                 final double phi = (v + 0.5) * d_rad;
                 
                 // area of infinitesimal patch on sphere
                 final double patchArea = Math.cos(phi) * d_rad * d_rad;
                 
-                for (int h = -nh; h < nh; h++) {
+                for (int h = -nh; h < nh; h++, i++) {
                     
-                    final double lam = (h + 0.5) * d_rad;
-                    f.compute(normalAspectProj, lam, phi, DERIVATIVE_INC_RAD);
+                    if (Double.isNaN(f.s[i])) {
+                        throw new ProjectionException();
+                    }
                     
-                    final double an = f.omega * patchArea;
+                    final double an = f.omega[i] * patchArea;
                     Dan += an;
                     
-                    final double axb = f.a * f.b;
+                    final double fa = f.a[i];
+                    final double fb = f.b[i];
+                    final double axb = fa * fb;
                     final double ar = ((axb < 1. ? 1./axb : axb) - 1.) * patchArea;
                     Dar += ar;
                     
-                    final double a_b = (f.a < 1. ? 1./f.a : f.a) + (f.b < 1. ? 1./f.b : f.b);
+                    final double a_b = (fa < 1. ? 1./fa : fa) + (fb < 1. ? 1./fb : fb);
                     final double ab = (a_b * 0.5 - 1.) * patchArea;
                     Dab += ab;
                     
-                    if (CONTINENTAL_MASK.getRGB(h+nh, v+nv) == continentARGB) {
+                    if (mask.getRGB(h+nh, v+nv) == continentARGB) {
                         Danc += an;
                         Darc += ar;
                         Dabc += ab;
@@ -300,25 +357,35 @@ public class ProjectionDistortionParameters {
      * Computes Dar distortion indices as defined by Canters and Decleir
      */
     public static double getDarIndex(Projection normalProjection) {
+        return getDarIndex(computeArealScaleFactors(normalProjection), 1);
+    }
+
+    /**
+     * Computes the Dar distortion index for a projection that is scaled by a
+     * constant factor. Scaling a projection by s scales all areal scale
+     * factors by s * s, so the index can be computed for any scale from areal
+     * scale factors computed once.
+     * @param arealScaleFactors Areal scale factors computed by
+     * computeArealScaleFactors().
+     * @param scale The factor that scales the projection.
+     */
+    public static double getDarIndex(double[] arealScaleFactors, double scale) {
 
         final double d_rad = Math.toRadians(INDEX_SAMPLING_DIST_DEG);
         final int nh = (int) Math.round(180. / INDEX_SAMPLING_DIST_DEG);
         final int nv = (int) Math.round(90. / INDEX_SAMPLING_DIST_DEG);
+        final double scale2 = scale * scale;
 
-
-        ProjectionDerivatives der = new ProjectionDerivatives();
         double Dar = 0;
+        int i = 0;
         for (int v = -nv; v < nv; v++) {
             final double phi = (v + 0.5) * d_rad;
-            final double cosphi_inv = 1. / Math.cos(phi);
 
             // area of infinitesimal patch on sphere
             final double patchArea = Math.cos(phi) * d_rad * d_rad;
 
             for (int h = -nh; h < nh; h++) {
-                final double lam = (h + 0.5) * d_rad;
-                der.compute(normalProjection, lam, phi, DERIVATIVE_INC_RAD);
-                final double axb = (der.y_p * der.x_l - der.x_p * der.y_l) * cosphi_inv;
+                final double axb = arealScaleFactors[i++] * scale2;
                 final double ar = ((axb < 1. ? 1. / axb : axb) - 1.) * patchArea;
                 Dar += ar;
             }
@@ -328,6 +395,60 @@ public class ProjectionDistortionParameters {
 
     }
 
+    /**
+     * Computes the areal scale factors at the sample points of the Dar
+     * distortion index.
+     * @return The areal scale factors, row by row from south to north.
+     */
+    public static double[] computeArealScaleFactors(Projection normalProjection) {
+
+        BulkProjectionFactors f = BulkProjectionFactors.compute(normalProjection,
+                sampleLongitudes(), sampleLatitudes(), DERIVATIVE_INC_RAD);
+        for (int i = 0; i < f.s.length; i++) {
+            if (Double.isNaN(f.s[i])) {
+                throw new ProjectionException();
+            }
+        }
+        return f.s;
+
+    }
+
+    /**
+     * Returns the longitudes of the sample points of the indices defined by
+     * Canters and Decleir, row by row from south to north.
+     */
+    private static double[] sampleLongitudes() {
+        final double d_rad = Math.toRadians(INDEX_SAMPLING_DIST_DEG);
+        final int nh = (int) Math.round(180. / INDEX_SAMPLING_DIST_DEG);
+        final int nv = (int) Math.round(90. / INDEX_SAMPLING_DIST_DEG);
+        double[] lam = new double[4 * nh * nv];
+        int i = 0;
+        for (int v = -nv; v < nv; v++) {
+            for (int h = -nh; h < nh; h++) {
+                lam[i++] = (h + 0.5) * d_rad;
+            }
+        }
+        return lam;
+    }
+
+    /**
+     * Returns the latitudes of the sample points of the indices defined by
+     * Canters and Decleir, row by row from south to north.
+     */
+    private static double[] sampleLatitudes() {
+        final double d_rad = Math.toRadians(INDEX_SAMPLING_DIST_DEG);
+        final int nh = (int) Math.round(180. / INDEX_SAMPLING_DIST_DEG);
+        final int nv = (int) Math.round(90. / INDEX_SAMPLING_DIST_DEG);
+        double[] phi = new double[4 * nh * nv];
+        int i = 0;
+        for (int v = -nv; v < nv; v++) {
+            for (int h = -nh; h < nh; h++) {
+                phi[i++] = (v + 0.5) * d_rad;
+            }
+        }
+        return phi;
+    }
+
     /**
      * Q acceptance index according to R. Capek or A acceptance index according
      * to Jenny.
@@ -341,26 +462,48 @@ public class ProjectionDistortionParameters {
             return;
         }
         
+        final QAcceptanceIndex index = this.qAcceptanceIndex;
+        if (index == null) {
+            this.Q = Double.NaN;
+            return;
+        }
+        
         final boolean qRelativeTo1 
                 = FlexProjectorPreferencesPanel.isAreaAcceptanceRelativeTo1();
-            
-        double acceptableArea = 0;
-
-        // loop over rows of grids for topleft quadrant
-        for (int row = 0; row < Q_GRID_ROWS; row++) {
-            
-            // area of infinitesimal patch on sphere
-            final double phi = Math.PI / 2. - (row + 0.5) * Q_CELLSIZE_RAD;
-            final double patchArea = Math.cos(phi) * Q_CELLSIZE_RAD * Q_CELLSIZE_RAD;
-
-            // loop over colums of grid for topleft quadrant
-            for (int col = 0; col < Q_GRID_COLUMNS; col++) {
-                if (isDistortionAcceptable(row, col, qModel, qRelativeTo1)) {
-                    acceptableArea += patchArea * 4.; // * 4 for 4 quadrants
-                }
+        
+        // convert the tests of isDistortionAcceptable() to ranges of 
+        // acceptable distortion values
+        double maxAngleDist = qModel.getQMaxAngle();
+        double maxAreaDist = qModel.getQMaxAreaScale();
+        if (maxAngleDist == 0 && maxAreaDist == 1) {
+            this.Q = 0; // conformal and equal-area are not possible
+            return;
+        }
+        double minAreaDist = Double.NEGATIVE_INFINITY;
+        if (qRelativeTo1) {
+            if (maxAreaDist < 1d) {
+                maxAreaDist = 1d / maxAreaDist;
             }
+            minAreaDist = 1d / maxAreaDist;
+        } else {
+            maxAreaDist *= this.qMinArea;
+        }
+        
+        // conformal projections only test areal distortion, equal-area 
+        // projections only test angular distortion
+        boolean testAngle = true;
+        boolean testArea = true;
+        if (maxAngleDist < 0.00001 && this.projection.isConformal()) {
+            testAngle = false;
+        } else if (this.projection.isEqualArea()) {
+            testArea = false;
         }
         
+        // the index stores the area of the patches in the top-left quadrant
+        final double acceptableArea = 4. // * 4 for 4 quadrants
+                * index.sum(maxAngleDist, minAreaDist, maxAreaDist,
+                testAngle, testArea);
+        
         // divide by area of sphere with radius 1 and convert to percentage
         final double sphereArea = 4. * Math.PI;
         
@@ -387,36 +530,54 @@ public class ProjectionDistortionParameters {
         normalAspectProj.setProjectionLongitude(0);
         normalAspectProj.initialize();
             
-        ProjectionFactors f = new ProjectionFactors();
         this.qMinArea = Double.MAX_VALUE;
         final boolean equalArea = normalAspectProj.isEqualArea();
         final boolean conformal = normalAspectProj.isConformal();
         
-        for (int row = 0; row < Q_GRID_ROWS; row++) {
-            final double phi = Math.PI / 2. - (row + 0.5) * Q_CELLSIZE_RAD;
-            for (int col = 0; col < Q_GRID_COLUMNS; col++) {
-                try {
-                    final double lam = (col + 0.5) * Q_CELLSIZE_RAD;
-                    f.compute(normalAspectProj, lam, phi, DERIVATIVE_INC_RAD);
-                    
-                    // area distortion
-                    qAreaGridQuadrant[row][col] = equalArea ? 1. : f.s;
-                    if (f.s < qMinArea) {
-                        this.qMinArea = f.s;
-                    }
-                    
-                    // angular distortion
-                    qAngleGridQuadrant[row][col] = conformal ? 0. : f.omega;
-                } catch (Exception exc) {
+        final int n = Q_GRID_ROWS * Q_GRID_COLUMNS;
+        double[] lam = new double[n];
+        double[] phi = new double[n];
+        for (int row = 0, i = 0; row < Q_GRID_ROWS; row++) {
+            for (int col = 0; col < Q_GRID_COLUMNS; col++, i++) {
+                phi[i] = Math.PI / 2. - (row + 0.5) * Q_CELLSIZE_RAD;
+                lam[i] = (col + 0.5) * Q_CELLSIZE_RAD;
+            }
+        }
+        BulkProjectionFactors f = BulkProjectionFactors.compute(normalAspectProj,
+                lam, phi, DERIVATIVE_INC_RAD);
+        
+        for (int row = 0, i = 0; row < Q_GRID_ROWS; row++) {
+            for (int col = 0; col < Q_GRID_COLUMNS; col++, i++) {
+                final double s = f.s[i];
+                if (Double.isNaN(s)) {
                     qAreaGridQuadrant[row][col] = Double.NaN;
                     qAngleGridQuadrant[row][col] = Double.NaN;
+                    continue;
                 }
+                
+                // area distortion
+                qAreaGridQuadrant[row][col] = equalArea ? 1. : s;
+                if (s < qMinArea) {
+                    this.qMinArea = s;
+                }
+                
+                // angular distortion
+                qAngleGridQuadrant[row][col] = conformal ? 0. : f.omega[i];
             }
         }
         
         if (equalArea) {
             qMinArea = 1.;
         }
+        
+        // area of infinitesimal patch on sphere for each row
+        double[] patchAreas = new double[Q_GRID_ROWS];
+        for (int row = 0; row < Q_GRID_ROWS; row++) {
+            final double phiRow = Math.PI / 2. - (row + 0.5) * Q_CELLSIZE_RAD;
+            patchAreas[row] = Math.cos(phiRow) * Q_CELLSIZE_RAD * Q_CELLSIZE_RAD;
+        }
+        this.qAcceptanceIndex = new QAcceptanceIndex(qAreaGridQuadrant,
+                qAngleGridQuadrant, patchAreas);
     }
 
     /**
@@ -506,44 +667,46 @@ public class ProjectionDistortionParameters {
         // transparent white for rejected areas.
         int rejectColor = new Color(1f, 1f, 1f, 0f).getRGB();
         
-        BufferedImage img = new BufferedImage(cols * 2, rows * 2, 
-                BufferedImage.TYPE_INT_ARGB);
-                           
+        // the color of each cell of qAreaGridQuadrant and qAngleGridQuadrant.
+        // Compute acceptance of areal distortion for visualization always
+        // relative to 1 to compare the visualization with an equal-area
+        // projection.
+        int[] cellColors = new int[Q_GRID_ROWS * Q_GRID_COLUMNS];
+        for (int accRow = 0, i = 0; accRow < Q_GRID_ROWS; accRow++) {
+            for (int accCol = 0; accCol < Q_GRID_COLUMNS; accCol++, i++) {
+                boolean accept = isDistortionAcceptable(accRow, accCol, qModel, true);
+                cellColors[i] = accept ? acceptColor : rejectColor;
+            }
+        }
+        
+        // write the image row by row. Each row is mirrored horizontally and
+        // vertically.
+        final int width = cols * 2;
+        BufferedImage img = new BufferedImage(width, rows * 2, BufferedImage.TYPE_INT_ARGB);
+        WritableRaster raster = img.getRaster();
+        int[] rowPixels = new int[width];
         for (int r = 0; r < rows; r++) {
+            
+            // top-right quadrant
             for (int c = 0; c < cols; c++) {
                 final int cellID = (int)acceptanceIndexGrid.getValue(c, r);
                 
                 // outside of graticule
                 if (cellID < 0) {
-                    img.setRGB(cols + c, r, rejectColor);
-                    // top-left quadrant
-                    img.setRGB(cols - c - 1, r, rejectColor);
-                    // bottom-left quadrant
-                    img.setRGB(cols - c - 1, 2 * rows - r - 1, rejectColor);
-                    // bottom-right quadrant
-                    img.setRGB(cols + c, 2 * rows - r - 1, rejectColor);
-
-                    continue;
+                    rowPixels[cols + c] = rejectColor;
+                } else {
+                    rowPixels[cols + c] = cellColors[cellID];
                 }
-                
-                final int accCol = cellID % 180;
-                final int accRow = cellID / 180;
-                
-                // compute acceptance of areal distortion for visualization 
-                // always relative to 1 to compare the visualization with an
-                // equal-area projection
-                boolean accept = isDistortionAcceptable(accRow, accCol, qModel, true);
-                final int color = accept ? acceptColor : rejectColor;
-                
-                // top-righ quadrant
-                img.setRGB(cols + c, r, color);
-                // top-left quadrant
-                img.setRGB(cols - c - 1, r, color);
-                // bottom-left quadrant
-                img.setRGB(cols - c - 1, 2 * rows - r - 1, color);
-                // bottom-right quadrant
-                img.setRGB(cols + c, 2 * rows - r - 1, color);
             }
+            
+            // top-left quadrant
+            for (int c = 0; c < cols; c++) {
+                rowPixels[cols - c - 1] = rowPixels[cols + c];
+            }
+            
+            // top and bottom half
+            raster.setDataElements(0, r, width, 1, rowPixels);
+            raster.setDataElements(0, 2 * rows - r - 1, width, 1, rowPixels);
         }
         
         double cellSize = this.acceptanceIndexGrid.getCellSize();
@@ -93,7 +93,16 @@ public class ProjectionsManager {
     private ProjectionsManager() {
     }
     
-    private static void loadProjections(){
+    /**
+     * Loads the list of projections and the selection stored in the
+     * preferences, if this has not been done before. Can be called from any
+     * thread; other threads wait until the list is loaded.
+     */
+    public static void preloadProjections() {
+        ProjectionsManager.loadProjections();
+    }
+    
+    private static synchronized void loadProjections(){
         if (ProjectionsManager.list != null)
             return;
         ProjectionsManager.loadProjectionsFromFile();
@@ -0,0 +1,220 @@
+/*
+ * QAcceptanceIndex.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+
+package ika.proj;
+
+import java.util.Arrays;
+import java.util.Comparator;
+
+/**
+ * An index over the areal and angular distortion values of the cells of a
+ * grid, which quickly sums the weights of all cells with distortion values
+ * within a range. This is used to compute the acceptance index Q for new
+ * acceptance limits without testing every cell of the grid.<br>
+ * The cells are sorted by angular distortion and split into blocks of
+ * BLOCK_SIZE cells. Within each block, the cells are also sorted by areal
+ * distortion, and the weights are accumulated in this order. The cells with
+ * acceptable angular distortion are a prefix of the sorted cells: full blocks
+ * are summed with two binary searches each, and the remaining cells of the
+ * last partial block are tested one by one.<br>
+ * Cells where both distortion values are undefined are not stored. A cell
+ * with one undefined value is stored with NaN for this value, which is sorted
+ * after all other values. Such a cell is only accepted if the undefined value
+ * is not tested. The index is not changed after construction and can be
+ * shared between threads.
+ */
+final class QAcceptanceIndex {
+
+    /**
+     * The number of cells in a block.
+     */
+    private static final int BLOCK_SIZE = 128;
+
+    /**
+     * The angular distortion of all cells in increasing order.
+     */
+    private final double[] angles;
+
+    /**
+     * The areal distortion and the weight of the cells in the order of angles.
+     */
+    private final double[] areasByAngle;
+    private final double[] weightsByAngle;
+
+    /**
+     * The areal distortion of the cells, sorted in increasing order within
+     * each block.
+     */
+    private final double[] blockAreas;
+
+    /**
+     * The sum of the weights from the first cell of a block to a cell, in
+     * the order of blockAreas.
+     */
+    private final double[] blockWeights;
+
+    /**
+     * Creates a new index.
+     * @param areaGrid The areal distortion of each cell, organized in rows.
+     * @param angleGrid The angular distortion of each cell, organized in rows.
+     * @param rowWeights The weight of each cell in a row.
+     */
+    QAcceptanceIndex(double[][] areaGrid, double[][] angleGrid,
+            double[] rowWeights) {
+
+        // collect the cells with at least one valid distortion value
+        int n = 0;
+        for (int row = 0; row < areaGrid.length; row++) {
+            for (int col = 0; col < areaGrid[row].length; col++) {
+                if (!Double.isNaN(areaGrid[row][col])
+                        || !Double.isNaN(angleGrid[row][col])) {
+                    ++n;
+                }
+            }
+        }
+        final double[] area = new double[n];
+        final double[] angle = new double[n];
+        final double[] weight = new double[n];
+        int i = 0;
+        for (int row = 0; row < areaGrid.length; row++) {
+            for (int col = 0; col < areaGrid[row].length; col++) {
+                if (!Double.isNaN(areaGrid[row][col])
+                        || !Double.isNaN(angleGrid[row][col])) {
+                    area[i] = areaGrid[row][col];
+                    angle[i] = angleGrid[row][col];
+                    weight[i] = rowWeights[row];
+                    ++i;
+                }
+            }
+        }
+
+        // sort the cells by angular distortion
+        Integer[] order = sortedOrder(angle, 0, n);
+        this.angles = new double[n];
+        this.areasByAngle = new double[n];
+        this.weightsByAngle = new double[n];
+        for (i = 0; i < n; i++) {
+            final int id = order[i];
+            this.angles[i] = angle[id];
+            this.areasByAngle[i] = area[id];
+            this.weightsByAngle[i] = weight[id];
+        }
+
+        // sort the cells of each block by areal distortion and accumulate
+        // the weights
+        this.blockAreas = new double[n];
+        this.blockWeights = new double[n];
+        for (int start = 0; start < n; start += BLOCK_SIZE) {
+            final int end = Math.min(n, start + BLOCK_SIZE);
+            Integer[] blockOrder = sortedOrder(this.areasByAngle, start, end);
+            double sum = 0;
+            for (i = start; i < end; i++) {
+                final int id = blockOrder[i - start];
+                sum += this.weightsByAngle[id];
+                this.blockAreas[i] = this.areasByAngle[id];
+                this.blockWeights[i] = sum;
+            }
+        }
+    }
+
+    /**
+     * Returns the indices start..end-1 sorted by their values.
+     */
+    private static Integer[] sortedOrder(final double[] values, int start,
+            int end) {
+        Integer[] order = new Integer[end - start];
+        for (int i = start; i < end; i++) {
+            order[i - start] = i;
+        }
+        Arrays.sort(order, new Comparator<Integer>() {
+
+            @Override
+            public int compare(Integer i1, Integer i2) {
+                return Double.compare(values[i1], values[i2]);
+            }
+        });
+        return order;
+    }
+
+    /**
+     * Returns the sum of the weights of all cells with
+     * angle &lt;= maxAngle and minArea &lt;= area &lt;= maxArea. A cell with
+     * an undefined value is not accepted, unless this value is not tested.
+     * @param maxAngle The maximum angular distortion. Can be infinite.
+     * @param minArea The minimum areal distortion. Can be infinite.
+     * @param maxArea The maximum areal distortion. Can be infinite.
+     * @param testAngle If false, the angular distortion is not tested and
+     * maxAngle is ignored.
+     * @param testArea If false, the areal distortion is not tested and
+     * minArea and maxArea are ignored.
+     */
+    double sum(double maxAngle, double minArea, double maxArea,
+            boolean testAngle, boolean testArea) {
+
+        // the cells 0..k-1 have acceptable angular distortion. Cells with
+        // undefined angular distortion are sorted last and are not included.
+        final int n = this.angles.length;
+        final int k = testAngle ? upperBound(this.angles, 0, n, maxAngle) : n;
+
+        double sum = 0;
+        int start = 0;
+        for (; start + BLOCK_SIZE <= k; start += BLOCK_SIZE) {
+            final int end = start + BLOCK_SIZE;
+            if (!testArea) {
+                sum += this.blockWeights[end - 1];
+                continue;
+            }
+            final int lo = lowerBound(this.blockAreas, start, end, minArea);
+            final int hi = upperBound(this.blockAreas, start, end, maxArea);
+            if (hi > lo) {
+                sum += this.blockWeights[hi - 1];
+                if (lo > start) {
+                    sum -= this.blockWeights[lo - 1];
+                }
+            }
+        }
+
+        // the remaining cells of the last partial block
+        for (int i = start; i < k; i++) {
+            final double area = this.areasByAngle[i];
+            if (!testArea || (area >= minArea && area <= maxArea)) {
+                sum += this.weightsByAngle[i];
+            }
+        }
+        return sum;
+    }
+
+    /**
+     * Returns the first index in start..end-1 with a value &gt;= v, or end.
+     */
+    private static int lowerBound(double[] a, int start, int end, double v) {
+        while (start < end) {
+            final int mid = (start + end) >>> 1;
+            if (a[mid] < v) {
+                start = mid + 1;
+            } else {
+                end = mid;
+            }
+        }
+        return start;
+    }
+
+    /**
+     * Returns the first index in start..end-1 with a value &gt; v, or end.
+     */
+    private static int upperBound(double[] a, int start, int end, double v) {
+        while (start < end) {
+            final int mid = (start + end) >>> 1;
+            if (a[mid] <= v) {
+                start = mid + 1;
+            } else {
+                end = mid;
+            }
+        }
+        return start;
+    }
+}
@@ -0,0 +1,556 @@
+/*
+ * DBFColumnarTable.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+
+package ika.table;
+
+import java.io.*;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.Vector;
+
+/**
+ * A read-mostly Table backed by the raw records of a DBF file. Columns are
+ * decoded on first access into primitive arrays: numeric columns are stored
+ * as double[], character columns as int[] codes into a dictionary of
+ * distinct strings. Columns that are never displayed or symbolized are
+ * never decoded. The raw buffer is released once all columns are decoded.<br>
+ * Cells can be changed with setValueAt, but rows and columns cannot be added
+ * or removed.
+ */
+public class DBFColumnarTable extends Table {
+
+    /**
+     * Default value for numbers that cannot be read.
+     */
+    private static final double DEFAULT_NUMBER = 0;
+
+    /**
+     * Charset used to store raw bytes losslessly in dictionary keys.
+     */
+    private static final String RAW_CHARSET = "ISO-8859-1";
+
+    /**
+     * Powers of ten that are exactly representable as doubles.
+     */
+    private static final double[] POWERS_OF_TEN = new double[23];
+
+    static {
+        POWERS_OF_TEN[0] = 1;
+        for (int i = 1; i < POWERS_OF_TEN.length; i++) {
+            POWERS_OF_TEN[i] = POWERS_OF_TEN[i - 1] * 10;
+        }
+    }
+
+    /**
+     * The records of the DBF file. Null once all columns have been decoded.
+     */
+    private transient ByteBuffer buffer;
+
+    private final int headerSize;
+
+    private final int recordSize;
+
+    private final int nbrRecords;
+
+    /**
+     * DBF field type for each column, e.g. 'C' or 'N'.
+     */
+    private final int[] fieldTypes;
+
+    /**
+     * Offset of each field relative to the start of a record.
+     */
+    private final int[] fieldOffsets;
+
+    private final int[] fieldLengths;
+
+    /**
+     * Decoded columns. An entry is null until the column is first accessed.
+     */
+    private final Column[] columns;
+
+    private int nbrDecodedColumns = 0;
+
+    /**
+     * Set at the end of the constructor. While columns are added by the
+     * constructor, the superclass must see an empty table.
+     */
+    private boolean initialized = false;
+
+    /**
+     * Creates a new table.
+     * @param buffer The content of the DBF file.
+     * @param headerSize The offset of the first record in buffer.
+     * @param recordSize The size of a record including the deletion flag.
+     * @param nbrRecords The number of records.
+     * @param fieldNames The names of the fields.
+     * @param fieldTypes The DBF types of the fields.
+     * @param fieldLengths The lengths of the fields in bytes.
+     * @param charsetName The name of the character set of character fields.
+     */
+    public DBFColumnarTable(ByteBuffer buffer, int headerSize, int recordSize,
+            int nbrRecords, String[] fieldNames, int[] fieldTypes,
+            int[] fieldLengths, String charsetName) {
+
+        super(charsetName);
+        this.buffer = buffer.duplicate().order(ByteOrder.LITTLE_ENDIAN);
+        this.headerSize = headerSize;
+        this.recordSize = recordSize;
+        this.nbrRecords = nbrRecords;
+        this.fieldTypes = (int[]) fieldTypes.clone();
+        this.fieldLengths = (int[]) fieldLengths.clone();
+        this.fieldOffsets = new int[fieldTypes.length];
+        this.columns = new Column[fieldTypes.length];
+
+        // the first byte of each record is the deletion flag
+        int offset = 1;
+        for (int i = 0; i < fieldTypes.length; i++) {
+            this.fieldOffsets[i] = offset;
+            offset += fieldLengths[i];
+            this.addColumn(fieldNames[i]);
+        }
+        this.initialized = true;
+    }
+
+    /**
+     * Decodes all columns before the table is serialized, as the raw buffer
+     * cannot be serialized.
+     */
+    private void writeObject(ObjectOutputStream outputStream) throws IOException {
+        for (int c = 0; c < this.columns.length; c++) {
+            this.getColumnData(c);
+        }
+        outputStream.defaultWriteObject();
+    }
+
+    @Override
+    public int getRowCount() {
+        return this.initialized ? this.nbrRecords : super.getRowCount();
+    }
+
+    @Override
+    public Object getValueAt(int row, int column) {
+        return this.getColumnData(column).getValue(row);
+    }
+
+    @Override
+    public void setValueAt(Object value, int row, int column) {
+        this.getColumnData(column).setValue(value, row);
+        this.fireTableCellUpdated(row, column);
+    }
+
+    @Override
+    public Class getColumnClass(int columnIndex) {
+        Column col = this.getColumnData(columnIndex);
+        if (col.objects != null) {
+            return super.getColumnClass(columnIndex);
+        }
+        return col.numbers != null ? Double.class : String.class;
+    }
+
+    @Override
+    public double[] getMinMax(int colID, boolean absolute, boolean notZero) {
+        Column col = this.getColumnData(colID);
+        if (col.numbers == null) {
+            return super.getMinMax(colID, absolute, notZero);
+        }
+        double min = Double.MAX_VALUE;
+        double max = -Double.MAX_VALUE;
+        final double[] numbers = col.numbers;
+        for (int i = 0; i < numbers.length; i++) {
+            double d = numbers[i];
+            if (absolute)
+                d = Math.abs(d);
+            if (d == 0. && notZero)
+                continue;
+            if (d < min)
+                min = d;
+            if (d > max)
+                max = d;
+        }
+        return new double[]{min, max};
+    }
+
+    /**
+     * Changes the character encoding of all strings. Only the dictionaries of
+     * distinct strings are decoded again.
+     */
+    @Override
+    public void changeEncoding(String charsetName)
+            throws UnsupportedEncodingException {
+
+        // test whether the character set is supported before changing anything
+        new String(new byte[0], charsetName);
+
+        for (int c = 0; c < this.columns.length; c++) {
+            Column col = this.getColumnData(c);
+            if (col.objects != null) {
+                // the column has been edited, fall back to the slow version
+                final String oldCharsetName = this.getEncodingName() == null
+                        ? System.getProperty("file.encoding")
+                        : this.getEncodingName();
+                for (int r = 0; r < this.nbrRecords; r++) {
+                    if (col.objects[r] instanceof String) {
+                        byte[] bytes = ((String) col.objects[r]).getBytes(oldCharsetName);
+                        col.objects[r] = new String(bytes, charsetName);
+                    }
+                }
+            } else if (col.codes != null && col.charsetEncoded) {
+                col.decodeDictionary(charsetName);
+            }
+        }
+        this.setEncodingName(charsetName);
+        this.fireTableDataChanged();
+    }
+
+    /**
+     * Returns the decoded data of a column, decoding it if necessary.
+     */
+    private synchronized Column getColumnData(int column) {
+        Column col = this.columns[column];
+        if (col == null) {
+            col = this.decodeColumn(column);
+            this.columns[column] = col;
+            if (++this.nbrDecodedColumns == this.columns.length) {
+                // release the file mapping
+                this.buffer = null;
+            }
+        }
+        return col;
+    }
+
+    private Column decodeColumn(int column) {
+        final int length = this.fieldLengths[column];
+        final int fieldOffset = this.headerSize + this.fieldOffsets[column];
+        final ByteBuffer buf = this.buffer.duplicate().order(ByteOrder.LITTLE_ENDIAN);
+        Column col = new Column();
+
+        switch (this.fieldTypes[column]) {
+            case 'F':   // floating number
+            case 'N': { // number
+                byte[] data = new byte[length];
+                col.numbers = new double[this.nbrRecords];
+                for (int r = 0; r < this.nbrRecords; r++) {
+                    this.readField(buf, r, fieldOffset, data);
+                    col.numbers[r] = parseNumber(data);
+                }
+                break;
+            }
+
+            case '8':
+            case 'O':   // little endian 8 byte double
+                col.numbers = new double[this.nbrRecords];
+                for (int r = 0; r < this.nbrRecords; r++) {
+                    int pos = fieldOffset + r * this.recordSize;
+                    col.numbers[r] = buf.getDouble(pos);
+                }
+                break;
+
+            case '4':
+            case 'I':   // little endian 4 byte integer
+                col.numbers = new double[this.nbrRecords];
+                for (int r = 0; r < this.nbrRecords; r++) {
+                    int pos = fieldOffset + r * this.recordSize;
+                    col.numbers[r] = buf.getInt(pos);
+                }
+                break;
+
+            case '2':   // little endian 2 byte integer
+                col.numbers = new double[this.nbrRecords];
+                for (int r = 0; r < this.nbrRecords; r++) {
+                    int pos = fieldOffset + r * this.recordSize;
+                    col.numbers[r] = buf.getShort(pos);
+                }
+                break;
+
+            case 'C':   // character string
+                this.decodeStrings(buf, col, fieldOffset, length, true);
+                col.decodeDictionary(this.getEncodingName());
+                break;
+
+            default:
+                // store the raw bytes as String
+                this.decodeStrings(buf, col, fieldOffset, length, false);
+                col.decodeDictionary(null);
+        }
+        return col;
+    }
+
+    /**
+     * Fills the codes and raw dictionary of a string column.
+     * @param charsetEncoded If true, the string ends at the first 0x00 byte
+     * and is decoded with the character set of this table.
+     */
+    private void decodeStrings(ByteBuffer buf, Column col, int fieldOffset, int length,
+            boolean charsetEncoded) {
+
+        byte[] data = new byte[length];
+        HashMap dictionary = new HashMap();
+        col.codes = new int[this.nbrRecords];
+        col.rawStrings = new ArrayList();
+        col.charsetEncoded = charsetEncoded;
+        for (int r = 0; r < this.nbrRecords; r++) {
+            this.readField(buf, r, fieldOffset, data);
+            int n = length;
+            if (charsetEncoded) {
+                for (n = 0; n < length && data[n] != 0; n++) {
+                }
+            }
+            String key;
+            try {
+                key = new String(data, 0, n, RAW_CHARSET);
+            } catch (UnsupportedEncodingException exc) {
+                // every Java platform supports ISO-8859-1
+                throw new IllegalStateException(exc);
+            }
+            Integer code = (Integer) dictionary.get(key);
+            if (code == null) {
+                code = new Integer(col.rawStrings.size());
+                dictionary.put(key, code);
+                col.rawStrings.add(key);
+            }
+            col.codes[r] = code.intValue();
+        }
+    }
+
+    /**
+     * Copies a field of a record into data.
+     */
+    private void readField(ByteBuffer buf, int row, int fieldOffset, byte[] data) {
+        buf.position(fieldOffset + row * this.recordSize);
+        buf.get(data, 0, data.length);
+    }
+
+    /**
+     * Converts an ASCII number to a double. Simple decimal numbers are
+     * converted without creating Strings. The result is identical to
+     * Double.parseDouble.
+     */
+    private static double parseNumber(byte[] data) {
+        int i = 0;
+        final int n = data.length;
+        while (i < n && data[i] == ' ') {
+            i++;
+        }
+        boolean negative = false;
+        if (i < n && (data[i] == '-' || data[i] == '+')) {
+            negative = data[i] == '-';
+            i++;
+        }
+        long mantissa = 0;
+        int nbrDigits = 0;
+        int nbrDecimals = 0;
+        boolean decimalPoint = false;
+        boolean hasDigits = false;
+        for (; i < n; i++) {
+            final byte b = data[i];
+            if (b >= '0' && b <= '9') {
+                hasDigits = true;
+                // leading zeros do not count as significant digits
+                if (mantissa != 0 || b != '0') {
+                    nbrDigits++;
+                }
+                mantissa = mantissa * 10 + (b - '0');
+                if (decimalPoint) {
+                    nbrDecimals++;
+                }
+            } else if (b == '.' && !decimalPoint) {
+                decimalPoint = true;
+            } else {
+                break;
+            }
+        }
+        while (i < n && (data[i] == ' ' || data[i] == 0)) {
+            i++;
+        }
+
+        // Both the mantissa and the power of ten are exact doubles if there
+        // are at most 15 significant digits, and the division is correctly
+        // rounded. Fall back to the standard parser in all other cases.
+        if (hasDigits && i == n && nbrDigits <= 15
+                && nbrDecimals < POWERS_OF_TEN.length) {
+            double d = mantissa / POWERS_OF_TEN[nbrDecimals];
+            return negative ? -d : d;
+        }
+        try {
+            return Double.parseDouble(new String(data, RAW_CHARSET).trim());
+        } catch (Exception exc) {
+            return DEFAULT_NUMBER;
+        }
+    }
+
+    @Override
+    public void insertRow(int row, Vector rowData) {
+        this.ensureNotInitialized();
+        super.insertRow(row, rowData);
+    }
+
+    @Override
+    public void removeRow(int row) {
+        this.ensureNotInitialized();
+        super.removeRow(row);
+    }
+
+    @Override
+    public void moveRow(int start, int end, int to) {
+        this.ensureNotInitialized();
+        super.moveRow(start, end, to);
+    }
+
+    @Override
+    public void setNumRows(int rowCount) {
+        this.ensureNotInitialized();
+        super.setNumRows(rowCount);
+    }
+
+    @Override
+    public void addColumn(Object columnName, Vector columnData) {
+        this.ensureNotInitialized();
+        super.addColumn(columnName, columnData);
+    }
+
+    @Override
+    public void setColumnIdentifiers(Vector columnIdentifiers) {
+        this.ensureNotInitialized();
+        super.setColumnIdentifiers(columnIdentifiers);
+    }
+
+    @Override
+    public void setColumnCount(int columnCount) {
+        this.ensureNotInitialized();
+        super.setColumnCount(columnCount);
+    }
+
+    @Override
+    public void setDataVector(Vector dataVector, Vector columnIdentifiers) {
+        this.ensureNotInitialized();
+        super.setDataVector(dataVector, columnIdentifiers);
+    }
+
+    private void ensureNotInitialized() {
+        if (this.initialized) {
+            throw new UnsupportedOperationException(
+                    "Rows and columns of a DBF table cannot be changed.");
+        }
+    }
+
+    /**
+     * The decoded values of a column. Exactly one of numbers, codes or
+     * objects is not null.
+     */
+    private static final class Column implements Serializable {
+
+        /**
+         * Values of numeric columns.
+         */
+        private double[] numbers;
+
+        /**
+         * Index into strings for each row of string columns.
+         */
+        private int[] codes;
+
+        /**
+         * Distinct raw strings, each char holding one byte of the source.
+         */
+        private ArrayList rawStrings;
+
+        /**
+         * Distinct decoded strings, in the same order as rawStrings.
+         */
+        private ArrayList strings;
+
+        /**
+         * True if the strings are decoded with the character set of the
+         * table, false if the platform default is used.
+         */
+        private boolean charsetEncoded;
+
+        /**
+         * Values of columns that were edited with values that do not fit
+         * the numbers or codes arrays.
+         */
+        private Object[] objects;
+
+        private Object getValue(int row) {
+            if (this.objects != null) {
+                return this.objects[row];
+            }
+            if (this.numbers != null) {
+                return new Double(this.numbers[row]);
+            }
+            return this.strings.get(this.codes[row]);
+        }
+
+        private void setValue(Object value, int row) {
+            if (this.objects == null) {
+                if (this.numbers != null && value instanceof Number) {
+                    this.numbers[row] = ((Number) value).doubleValue();
+                    return;
+                }
+                if (this.codes != null && value instanceof String) {
+                    // raw bytes are unknown for new values; the string is
+                    // stored in both dictionaries
+                    this.codes[row] = this.strings.size();
+                    this.strings.add(value);
+                    this.rawStrings.add(null);
+                    return;
+                }
+                this.toObjects();
+            }
+            this.objects[row] = value;
+        }
+
+        private void toObjects() {
+            final int n = this.numbers != null
+                    ? this.numbers.length : this.codes.length;
+            this.objects = new Object[n];
+            for (int r = 0; r < n; r++) {
+                this.objects[r] = this.getValue(r);
+            }
+            this.numbers = null;
+            this.codes = null;
+            this.rawStrings = null;
+            this.strings = null;
+        }
+
+        /**
+         * Decodes the raw dictionary.
+         * @param charsetName The character set, or null for the platform
+         * default character set.
+         */
+        private void decodeDictionary(String charsetName) {
+            final int n = this.rawStrings.size();
+            ArrayList decoded = new ArrayList(n);
+            for (int i = 0; i < n; i++) {
+                String raw = (String) this.rawStrings.get(i);
+                if (raw == null) {
+                    // a string set with setValue
+                    decoded.add(this.strings.get(i));
+                    continue;
+                }
+                byte[] bytes;
+                try {
+                    bytes = raw.getBytes(RAW_CHARSET);
+                } catch (UnsupportedEncodingException exc) {
+                    throw new IllegalStateException(exc);
+                }
+                String str;
+                if (charsetName == null) {
+                    str = new String(bytes);
+                } else {
+                    str = ika.utils.StringUtils.bytesToString(
+                            bytes, bytes.length, charsetName).trim();
+                }
+                decoded.add(str);
+            }
+            this.strings = decoded;
+        }
+    }
+}
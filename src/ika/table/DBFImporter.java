@@ -10,10 +10,11 @@
 package ika.table;
 
 import java.io.*;
-import java.net.URLConnection;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 import java.util.Vector;
 import ika.utils.MathUtils;
-import ika.utils.LittleEndianInputStream;
+import ika.utils.URLUtils;
 
 /**
  * An importer for DBF data base files.
@@ -30,41 +31,34 @@ public class DBFImporter extends TableImporter {
     
     private String charsetName;
 
-    /**
-     * Default value for numbers that cannot be read.
-     */
-    private Double DEFAULT_NUMBER = new Double(0);
-    
     /** Creates a new instance of DBFImporter */
     public DBFImporter() {
     }
     
+    /**
+     * Reads the header and the field descriptors of a DBF file. The records
+     * are not decoded here; the returned table decodes a column when it is
+     * first accessed.
+     */
     public Table read(java.net.URL url) throws IOException {
-        LittleEndianInputStream is = null;
         if (url == null)
             return null;
         
+        this.fields.clear();
+        ByteBuffer buffer = URLUtils.loadBufferFromURL(url);
+        buffer.order(ByteOrder.LITTLE_ENDIAN);
+        
         try {
-            // read all data into a data buffer.
-            is = new LittleEndianInputStream(new BufferedInputStream(url.openStream()));
-            
-            URLConnection urlConnection = url.openConnection();
-            final long fileLength = urlConnection.getContentLength();
-            
-            
-            int fileCode = MathUtils.unsignedByteToInt(is.readByte());
-            int year = MathUtils.unsignedByteToInt(is.readByte());
-            int month = MathUtils.unsignedByteToInt(is.readByte());
-            int day = MathUtils.unsignedByteToInt(is.readByte());
-            long nbrRecords = is.readInt();// & 0xffffffffL;// unsigned int
-            int headerSize = is.readShort();
-            int recordSize = is.readShort();
-            is.readShort();  // overread reserved value
-            is.readByte(); // transaction byte
-            int encrypted = is.readUnsignedByte(); // encription byte
-            is.skipBytes(13);
-            int codepage = is.readUnsignedByte();
-            is.skipBytes(2);
+            int fileCode = MathUtils.unsignedByteToInt(buffer.get(0));
+            int year = MathUtils.unsignedByteToInt(buffer.get(1));
+            int month = MathUtils.unsignedByteToInt(buffer.get(2));
+            int day = MathUtils.unsignedByteToInt(buffer.get(3));
+            int nbrRecords = buffer.getInt(4);
+            int headerSize = buffer.getShort(8) & 0xffff;
+            int recordSize = buffer.getShort(10) & 0xffff;
+            // 12-13 reserved value, 14 transaction byte
+            int encrypted = MathUtils.unsignedByteToInt(buffer.get(15));
+            int codepage = MathUtils.unsignedByteToInt(buffer.get(29));
             
             // map the codepage to a string. Based on:
             // http://www.clicketyclick.dk/databases/xbase/format/dbf.html#DBF_STRUCT
@@ -152,172 +146,81 @@ public class DBFImporter extends TableImporter {
                 throw new IOException("Encrypted DBF not supported.");
             
             int nFields = (headerSize - 32) / 32;
-            this.readFieldDescriptors(is, nFields);
+            this.readFieldDescriptors(buffer, nFields);
             
-            // create an new table
-            String name = ika.utils.FileUtils.getFileNameWithoutExtension(url.getPath());
-            Table table = this.initTable(name);
-            
-            // read the records and fill the table
-            for (int i = 0; i < nbrRecords; i++) {
-                this.printInfo("Reading Record " + i);
-                this.readRecord(is, recordSize, table);
+            // the fields and the deletion flag must fit in a record
+            int fieldsLength = 1;
+            for (int i = 0; i < this.fields.size(); i++) {
+                fieldsLength += ((DBFField)this.fields.get(i)).length;
             }
+            if (fieldsLength > recordSize)
+                throw new IOException("DBF file is corrupt.");
             
+            // ignore records missing at the end of truncated files
+            int available = (buffer.limit() - headerSize) / recordSize;
+            nbrRecords = Math.max(0, Math.min(nbrRecords, available));
+            
+            // create an new table
+            String name = ika.utils.FileUtils.getFileNameWithoutExtension(url.getPath());
+            Table table = this.initTable(buffer, headerSize, recordSize, nbrRecords);
+            table.setName(name);
             return table;
-        } finally {
-            if (is != null)
-                is.close();
+        } catch (IndexOutOfBoundsException exc) {
+            throw new IOException("DBF file is corrupt.");
         }
     }
     
-    private void readFieldDescriptors(LittleEndianInputStream is, int nFields) 
+    private void readFieldDescriptors(ByteBuffer buffer, int nFields) 
     throws IOException {
         
         // read description of each field
         byte[] asciiFieldName = new byte[11];
         for (int i = 0; i < nFields; i++) {
+            final int pos = 32 + i * 32;
             DBFField field = new DBFField();
-            is.read(asciiFieldName);
+            buffer.position(pos);
+            buffer.get(asciiFieldName);
             field.name = ika.utils.StringUtils.bytesToString(
                     asciiFieldName, asciiFieldName.length, this.charsetName);
-            field.type = is.readUnsignedByte();
-            field.address = is.readInt();
-            field.length = is.readUnsignedByte();
-            field.decimalCount = is.readUnsignedByte();
-            is.readShort();// overread reserved value
-            field.workAreaID = is.readUnsignedByte();
-            field.multiUserDBase = is.readShort();
-            field.setFields = is.readUnsignedByte();
-            is.skipBytes(7); // overread 7 reserved bytes
-            field.fieldInMDXIndex = is.readUnsignedByte();
+            field.type = MathUtils.unsignedByteToInt(buffer.get(pos + 11));
+            field.address = buffer.getInt(pos + 12);
+            field.length = MathUtils.unsignedByteToInt(buffer.get(pos + 16));
+            field.decimalCount = MathUtils.unsignedByteToInt(buffer.get(pos + 17));
+            // 18-19 reserved value
+            field.workAreaID = MathUtils.unsignedByteToInt(buffer.get(pos + 20));
+            field.multiUserDBase = buffer.getShort(pos + 21);
+            field.setFields = MathUtils.unsignedByteToInt(buffer.get(pos + 23));
+            // 24-30 reserved bytes
+            field.fieldInMDXIndex = MathUtils.unsignedByteToInt(buffer.get(pos + 31));
             
             this.fields.add(field);
             
             this.printInfo("\n" + field.toString());
         }
         
-        // overread the Header Record Terminator, which should be 0x0D
-        byte terminator = is.readByte();
+        // the Header Record Terminator should be 0x0D
+        byte terminator = buffer.get(32 + nFields * 32);
         if (terminator != 0x0D) {
             throw new IOException("DBF file is corrupt.");
         }
         
     }
     
-    private void readRecord(LittleEndianInputStream is, int recordSize, 
-            Table table) throws IOException {
-        
-        int deletedFlag = is.readUnsignedByte();
-        byte[] data = new byte[recordSize];
-        
-        Vector rowData = new Vector();
+    private Table initTable(ByteBuffer buffer, int headerSize, int recordSize,
+            int nbrRecords) {
         
-        java.util.Iterator iterator = this.fields.iterator();
-        while (iterator.hasNext()) {
-            DBFField field = (DBFField)iterator.next();
-            is.read(data, 0, field.length);
-            
-            switch (field.type) {
-                case 'C':   // character string
-                    String string = ika.utils.StringUtils.bytesToString(
-                            data, field.length, this.charsetName);
-                    rowData.add(string.trim());
-                    break;
-                
-                 case 'F':  // floating number
-                    try {
-                        rowData.add(new Double(new String(data, 0, field.length)));
-                    } catch (NumberFormatException exc) {
-                        rowData.add(this.DEFAULT_NUMBER);
-                    }
-                    break;
-                
-                case 'N':   // number
-                    try {
-                        rowData.add(new Double(new String(data, 0, field.length)));
-                    } catch (NumberFormatException exc) {
-                        rowData.add(this.DEFAULT_NUMBER);
-                    }
-                    break;
-                
-                case '8':
-                case 'O':
-                    // little endian 8 byte double. Not tested !!! ???
-                    long byte1 = data[0];
-                    long byte2 = data[1];
-                    long byte3 = data[2];
-                    long byte4 = data[3];
-                    long byte5 = data[4];
-                    long byte6 = data[5];
-                    long byte7 = data[6];
-                    long byte8 = data[7];
-                    long l = (byte8 << 56) + (byte7 << 48) + (byte6 << 40) + (byte5 << 32) +
-                            (byte4 << 24) + (byte3 << 16) + (byte2 << 8) + byte1;
-                    rowData.add(new Double(Double.longBitsToDouble(l)));
-                    break;
-                    
-                case '4':
-                case 'I':
-                    // little endian 4 byte integer. Not tested !!! ???
-                    int i = (data[3] << 24) + (data[2] << 16) + (data[1] << 8) + data[0];
-                    rowData.add(new Double(i));
-                    break;
-                
-                case '2':
-                    // little endian 2 byte integer. Not tested !!! ???
-                    rowData.add(new Double((data[1] << 8) + data[0]));
-                    break;
-                    
-                /*    
-                case 'D':   // date
-                    System.out.println ("Date objects in DBF files not tested.");   // !!! ???
-                    
-                    // Date in format YYYYMMDD.
-                    if (field.length != 8)
-                        throw new Exception("Date object has non-standard length in DBF file.");
-                    int year = Integer.parseInt(new String(data, 0, 4));
-                    int month = Integer.parseInt(new String(data, 4, 2));
-                    int day = Integer.parseInt(new String(data, 6, 2));
-                    Date date = new Date(year, month, day);
-                    rowData.add(date.toString());
-                    break;
-                    
-                case 'L':   // logical
-                    //  ?	 Not initialised (default)	 
-                    //  Y,y	 Yes
-                    //  N,n	 No
-                    //  F,f	 False
-                    //  T,t	 True
-                    final byte b = data[0];
-                    if (b == 'Y' || b == 'y' || b == 'T' || b == 't')
-                        rowData.add("True");
-                    else if (b == 'N' || b == 'n' || b == 'F' || b == 'f')
-                        rowData.add("False");
-                    else
-                        rowData.add("?");
-                    break;
-                 */
-                default:
-                    // add the raw bytes as String
-                    rowData.add(new String(data, 0, field.length));;
-                    
-            }
-        }
-        table.addRow(rowData);
-    }
-    
-    private Table initTable(String name) {
-        Table table = new Table(this.charsetName);
-        table.setName(name);
-        
-        java.util.Iterator iterator = this.fields.iterator();
-        while (iterator.hasNext()) {
-            DBFField field = (DBFField)iterator.next();
-            table.addColumn(field.name);
+        final int nFields = this.fields.size();
+        String[] names = new String[nFields];
+        int[] types = new int[nFields];
+        int[] lengths = new int[nFields];
+        for (int i = 0; i < nFields; i++) {
+            DBFField field = (DBFField)this.fields.get(i);
+            names[i] = field.name;
+            types[i] = field.type;
+            lengths[i] = field.length;
         }
-        
-        return table;
+        return new DBFColumnarTable(buffer, headerSize, recordSize, nbrRecords,
+                names, types, lengths, this.charsetName);
     }
     
     private class DBFField {
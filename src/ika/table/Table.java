@@ -258,6 +258,14 @@ public class Table extends DefaultTableModel
         return this.sourceCharsetName;
     }
     
+    /**
+     * Stores the name of the character set used to encode the source data.
+     * Strings stored in this table are not changed.
+     */
+    protected void setEncodingName(String charsetName) {
+        this.sourceCharsetName = charsetName;
+    }
+    
     /**
      * Change the character encoding of all Strings stored in this table.
      * This could be optimized for speed!
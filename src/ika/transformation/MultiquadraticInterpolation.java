@@ -8,6 +8,7 @@ import Jama.*;
 import Jama.util.*;
 import java.awt.geom.*;
 import ika.geo.*;
+import java.util.ArrayList;
 
 /**
  *
@@ -16,12 +17,101 @@ import ika.geo.*;
 
 public class MultiquadraticInterpolation {
     
+    /**
+     * Minimum number of points transformed by a thread.
+     */
+    private static final int MIN_POINTS_PER_THREAD = 256;
+    
+    /**
+     * Minimum number of control points of a local patch.
+     */
+    private static final int MIN_POINTS_PER_PATCH = 8;
+    
     private double[] aCoeffArray;
     
     private double[] bCoeffArray;
     
     private double[][] destControlPoints;
     
+    /**
+     * The maximum number of control points for which a single global system
+     * of equations is solved. Larger sets are interpolated with local patches.
+     */
+    private int maxGlobalPoints = 1500;
+    
+    /**
+     * The approximate number of control points in a local patch.
+     */
+    private int pointsPerPatch = 64;
+    
+    /**
+     * Local patches on a regular grid, or null if the coefficients are global.
+     * Patches without control points are null.
+     */
+    private Patch[] patches;
+    
+    private int patchCols;
+    
+    private int patchRows;
+    
+    private double patchWest;
+    
+    private double patchSouth;
+    
+    /**
+     * The distance between the centers of two neighboring patches.
+     */
+    private double patchSpacing;
+    
+    /**
+     * The largest radius of all patches.
+     */
+    private double maxPatchRadius;
+    
+    /**
+     * A local interpolation for the control points inside a circle. Local
+     * interpolations are blended with compactly supported weights that sum to
+     * 1 (a partition of unity), so that the control points are interpolated
+     * exactly.
+     */
+    private static final class Patch {
+        
+        private final double centerX;
+        
+        private final double centerY;
+        
+        private final double radius;
+        
+        private final double[][] points;
+        
+        private double[] aCoeff;
+        
+        private double[] bCoeff;
+        
+        private Patch(double centerX, double centerY, double radius,
+                double[][] points) {
+            this.centerX = centerX;
+            this.centerY = centerY;
+            this.radius = radius;
+            this.points = points;
+        }
+        
+        /**
+         * Wendland's compactly supported C2 function.
+         */
+        private double weight(double x, double y) {
+            final double dx = x - centerX;
+            final double dy = y - centerY;
+            final double t = Math.sqrt(dx * dx + dy * dy) / radius;
+            if (t >= 1) {
+                return 0;
+            }
+            final double t1 = 1 - t;
+            final double t2 = t1 * t1;
+            return t2 * t2 * (4 * t + 1);
+        }
+    }
+    
     public MultiquadraticInterpolation() {
     }
     
@@ -39,6 +129,7 @@ public class MultiquadraticInterpolation {
             throw new IllegalArgumentException();
         
         this.destControlPoints = dstPoints;
+        this.patches = null;
         int nbrPts = srcPoints.length;
         
         // differences between the two sets of points
@@ -49,6 +140,26 @@ public class MultiquadraticInterpolation {
             w[i][0] = (dstPoints[i][1] - srcPoints[i][1]) * exaggerationFactor;
         }
         
+        if (nbrPts > this.maxGlobalPoints) {
+            this.aCoeffArray = null;
+            this.bCoeffArray = null;
+            this.solvePatches(dstPoints, u, w);
+            return;
+        }
+        
+        double[][] coeff = MultiquadraticInterpolation.solve(dstPoints, u, w);
+        this.aCoeffArray = coeff[0];
+        this.bCoeffArray = coeff[1];
+    }
+    
+    /**
+     * Solves the system of equations for a set of control points.
+     * @return The coefficients a and b in an array[2][nbrPts].
+     */
+    private static double[][] solve(double[][] dstPoints, double[][] u, double[][] w) {
+        
+        final int nbrPts = dstPoints.length;
+        
         // Fill coefficient matrix D (see Beineke p. 30).
         // Java automatically initializes arrays of doubles with 0.
         // So there is no need to initialize the elements on the diagonal with 0.
@@ -69,44 +180,326 @@ public class MultiquadraticInterpolation {
         Matrix mat_b = luDecomposition.solve(new Matrix(w));
         
         // store a and b
-        this.aCoeffArray = new double[nbrPts];
-        this.bCoeffArray = new double[nbrPts];
+        double[][] coeff = new double[2][nbrPts];
         final double[][] a = mat_a.getArray();
         final double[][] b = mat_b.getArray();
         for (int i = 0; i < nbrPts; i++){
-            this.aCoeffArray[i] = -a[i][0];
-            this.bCoeffArray[i] = -b[i][0];
+            coeff[0][i] = -a[i][0];
+            coeff[1][i] = -b[i][0];
         }
+        return coeff;
     }
     
     /**
-     * Transforms a set of points.
-     * @param points The points to be transformed as a an array[n] of xy-arrays[2].
-     * points is changed, i.e. the old values are replaced by the new values.
+     * Distributes the control points among overlapping circular patches,
+     * whose centers are on a regular grid, and solves a small system of
+     * equations for each patch.
      */
-    public void transform(double[][] points) {
+    private void solvePatches(double[][] dstPoints, double[][] u, double[][] w) {
+        
+        final int nbrPts = dstPoints.length;
+        double xMin = Double.POSITIVE_INFINITY, xMax = Double.NEGATIVE_INFINITY;
+        double yMin = Double.POSITIVE_INFINITY, yMax = Double.NEGATIVE_INFINITY;
+        for (int i = 0; i < nbrPts; i++) {
+            xMin = Math.min(xMin, dstPoints[i][0]);
+            xMax = Math.max(xMax, dstPoints[i][0]);
+            yMin = Math.min(yMin, dstPoints[i][1]);
+            yMax = Math.max(yMax, dstPoints[i][1]);
+        }
+        
+        // a circle with a radius of the patch spacing contains on average
+        // pointsPerPatch points.
+        final double width = xMax - xMin;
+        final double height = yMax - yMin;
+        double h = Math.sqrt(width * height * this.pointsPerPatch / (Math.PI * nbrPts));
+        if (!(h > 0) || Double.isInfinite(h)) {
+            // the points are on a line
+            h = Math.max(width, height) * this.pointsPerPatch / nbrPts;
+        }
+        if (!(h > 0) || Double.isInfinite(h)) {
+            throw new IllegalArgumentException("invalid control points");
+        }
+        this.patchSpacing = h;
+        this.patchWest = xMin;
+        this.patchSouth = yMin;
+        this.patchCols = (int)(width / h) + 1;
+        this.patchRows = (int)(height / h) + 1;
         
-        final int nbrPts = points.length;
+        // sort the point indices into the cells of the patch grid
+        final int nbrCells = this.patchCols * this.patchRows;
+        final int[] cellStart = new int[nbrCells + 1];
+        final int[] pointCell = new int[nbrPts];
+        for (int i = 0; i < nbrPts; i++) {
+            final int col = Math.min(this.patchCols - 1, (int)((dstPoints[i][0] - xMin) / h));
+            final int row = Math.min(this.patchRows - 1, (int)((dstPoints[i][1] - yMin) / h));
+            pointCell[i] = row * this.patchCols + col;
+            ++cellStart[pointCell[i] + 1];
+        }
+        for (int i = 0; i < nbrCells; i++) {
+            cellStart[i + 1] += cellStart[i];
+        }
+        final int[] cellPoints = new int[nbrPts];
+        final int[] fill = new int[nbrCells];
+        for (int i = 0; i < nbrPts; i++) {
+            final int cell = pointCell[i];
+            cellPoints[cellStart[cell] + fill[cell]++] = i;
+        }
         
-        double corrX, corrY;
+        // build and solve patches in parallel
+        this.patches = new Patch[nbrCells];
+        int nThreads = Math.max(1, Math.min(Runtime.getRuntime().availableProcessors(),
+                nbrCells / 16));
+        ArrayList<PatchThread> threads = new ArrayList<PatchThread>(nThreads);
+        int chunk = (nbrCells / nThreads) + 1;
+        for (int i = 0; i < nThreads; i++) {
+            int first = i * chunk;
+            int end = Math.min(nbrCells, first + chunk);
+            PatchThread t = new PatchThread(dstPoints, u, w, cellStart,
+                    cellPoints, first, end);
+            threads.add(t);
+            t.start();
+        }
+        for (PatchThread t : threads) {
+            try {
+                t.join();
+            } catch (InterruptedException ex) {
+                throw new IllegalStateException(ex);
+            }
+            if (t.exception != null) {
+                throw t.exception;
+            }
+        }
         
-        // loop over all points
-        for(int i=0; i < nbrPts; i++){
-            corrX = corrY = 0;
-            
-            // for each point: compute the distance to each control point
+        this.maxPatchRadius = 0;
+        for (int i = 0; i < nbrCells; i++) {
+            if (this.patches[i] != null) {
+                this.maxPatchRadius = Math.max(this.maxPatchRadius, this.patches[i].radius);
+            }
+        }
+    }
+    
+    /**
+     * Builds and solves the patch centered on a cell of the patch grid. The
+     * patch contains all control points within the patch spacing, and is
+     * enlarged if this is less than MIN_POINTS_PER_PATCH points.
+     * @return The patch or null if there are no control points close to the
+     * center of the cell.
+     */
+    private Patch createPatch(int cell, double[][] dstPoints,
+            double[][] u, double[][] w, int[] cellStart, int[] cellPoints) {
+        
+        final int col = cell % this.patchCols;
+        final int row = cell / this.patchCols;
+        final double h = this.patchSpacing;
+        final double cx = this.patchWest + (col + 0.5) * h;
+        final double cy = this.patchSouth + (row + 0.5) * h;
+        final int minPoints = Math.min(dstPoints.length, MIN_POINTS_PER_PATCH);
+        
+        // collect candidates in rings of cells around the center until the
+        // circle containing minPoints points lies inside the collected cells
+        double radius = h;
+        int[] ids = new int[64];
+        double[] dist = new double[64];
+        int nbrCandidates = 0;
+        for (int ring = 0; ; ring++) {
+            for (int r = row - ring; r <= row + ring; r++) {
+                if (r < 0 || r >= this.patchRows) {
+                    continue;
+                }
+                final boolean edgeRow = r == row - ring || r == row + ring;
+                for (int c = col - ring; c <= col + ring; c++) {
+                    if (c < 0 || c >= this.patchCols
+                            || (!edgeRow && c != col - ring && c != col + ring)) {
+                        continue;
+                    }
+                    final int cellID = r * this.patchCols + c;
+                    for (int i = cellStart[cellID]; i < cellStart[cellID + 1]; i++) {
+                        if (nbrCandidates == ids.length) {
+                            ids = java.util.Arrays.copyOf(ids, ids.length * 2);
+                            dist = java.util.Arrays.copyOf(dist, dist.length * 2);
+                        }
+                        final int id = cellPoints[i];
+                        final double dx = dstPoints[id][0] - cx;
+                        final double dy = dstPoints[id][1] - cy;
+                        ids[nbrCandidates] = id;
+                        dist[nbrCandidates++] = Math.sqrt(dx * dx + dy * dy);
+                    }
+                }
+            }
+            if (ring == 0) {
+                continue;
+            }
+            if (ring == 1) {
+                // skip patches without points in their standard radius
+                boolean empty = true;
+                for (int i = 0; i < nbrCandidates && empty; i++) {
+                    empty = dist[i] >= h;
+                }
+                if (empty) {
+                    return null;
+                }
+            }
+            final boolean allCells = ring >= Math.max(this.patchCols, this.patchRows);
+            if (nbrCandidates >= minPoints || allCells) {
+                double[] sorted = java.util.Arrays.copyOf(dist, nbrCandidates);
+                java.util.Arrays.sort(sorted);
+                radius = Math.max(h, sorted[minPoints - 1] * (1 + 1e-9));
+                if (radius <= (ring + 0.5) * h || allCells) {
+                    break;
+                }
+            }
+        }
+        
+        // all candidates inside the circle
+        int nbrPatchPts = 0;
+        for (int i = 0; i < nbrCandidates; i++) {
+            if (dist[i] < radius) {
+                ids[nbrPatchPts++] = ids[i];
+            }
+        }
+        double[][] pts = new double[nbrPatchPts][];
+        double[][] patchU = new double[nbrPatchPts][];
+        double[][] patchW = new double[nbrPatchPts][];
+        for (int i = 0; i < nbrPatchPts; i++) {
+            pts[i] = dstPoints[ids[i]];
+            patchU[i] = u[ids[i]];
+            patchW[i] = w[ids[i]];
+        }
+        Patch patch = new Patch(cx, cy, radius, pts);
+        double[][] coeff = MultiquadraticInterpolation.solve(pts, patchU, patchW);
+        patch.aCoeff = coeff[0];
+        patch.bCoeff = coeff[1];
+        return patch;
+    }
+    
+    private class PatchThread extends Thread {
+        
+        private final double[][] dstPoints;
+        private final double[][] u;
+        private final double[][] w;
+        private final int[] cellStart;
+        private final int[] cellPoints;
+        private final int first;
+        private final int end;
+        private RuntimeException exception;
+        
+        public PatchThread(double[][] dstPoints, double[][] u, double[][] w,
+                int[] cellStart, int[] cellPoints, int first, int end) {
+            this.dstPoints = dstPoints;
+            this.u = u;
+            this.w = w;
+            this.cellStart = cellStart;
+            this.cellPoints = cellPoints;
+            this.first = first;
+            this.end = end;
+        }
+        
+        @Override
+        public void run() {
+            try {
+                for (int i = first; i < end; i++) {
+                    patches[i] = createPatch(i, dstPoints, u, w, cellStart, cellPoints);
+                }
+            } catch (RuntimeException exc) {
+                this.exception = exc;
+            }
+        }
+    }
+    
+    /**
+     * Computes the displacement of a point.
+     * @param corr Receives the displacement in x and y.
+     */
+    private void correction(double x, double y, double[] corr) {
+        double corrX = 0, corrY = 0;
+        if (this.patches == null) {
             for(int j=0; j < this.aCoeffArray.length; j++){
-                final double dx = points[i][0] - this.destControlPoints[j][0];
-                final double dy = points[i][1] - this.destControlPoints[j][1];
+                
+                // compute the distance to each control point
+                final double dx = x - this.destControlPoints[j][0];
+                final double dy = y - this.destControlPoints[j][1];
                 final double d = Math.sqrt(dx*dx+dy*dy);
                 
                 corrX += this.aCoeffArray[j] * d;
                 corrY += this.bCoeffArray[j] * d;
             }
-            
-            points[i][0] += corrX;
-            points[i][1] += corrY;
+            corr[0] = corrX;
+            corr[1] = corrY;
+            return;
+        }
+        
+        // blend the patches that overlap the point
+        final double h = this.patchSpacing;
+        final int range = (int)Math.ceil(this.maxPatchRadius / h + 0.5);
+        final int col = (int)Math.floor((x - this.patchWest) / h);
+        final int row = (int)Math.floor((y - this.patchSouth) / h);
+        double totalWeight = 0;
+        for (int r = Math.max(0, row - range); r <= Math.min(this.patchRows - 1, row + range); r++) {
+            for (int c = Math.max(0, col - range); c <= Math.min(this.patchCols - 1, col + range); c++) {
+                final Patch patch = this.patches[r * this.patchCols + c];
+                if (patch == null) {
+                    continue;
+                }
+                final double weight = patch.weight(x, y);
+                if (weight > 0) {
+                    totalWeight += weight;
+                    this.addPatchCorrection(patch, x, y, weight, corr);
+                    corrX += corr[0];
+                    corrY += corr[1];
+                }
+            }
+        }
+        
+        if (totalWeight > 0) {
+            corr[0] = corrX / totalWeight;
+            corr[1] = corrY / totalWeight;
+            return;
+        }
+        
+        // the point is outside of all patches: use the closest patch
+        Patch closest = null;
+        double minDist = Double.POSITIVE_INFINITY;
+        for (int i = 0; i < this.patches.length; i++) {
+            final Patch patch = this.patches[i];
+            if (patch != null) {
+                final double dx = x - patch.centerX;
+                final double dy = y - patch.centerY;
+                final double d = dx * dx + dy * dy;
+                if (d < minDist) {
+                    minDist = d;
+                    closest = patch;
+                }
+            }
         }
+        this.addPatchCorrection(closest, x, y, 1, corr);
+    }
+    
+    /**
+     * Computes the weighted displacement of a point by a patch.
+     * @param corr Receives the displacement in x and y.
+     */
+    private void addPatchCorrection(Patch patch, double x, double y,
+            double weight, double[] corr) {
+        double corrX = 0, corrY = 0;
+        final double[][] pts = patch.points;
+        for (int j = 0; j < pts.length; j++) {
+            final double dx = x - pts[j][0];
+            final double dy = y - pts[j][1];
+            final double d = Math.sqrt(dx*dx+dy*dy);
+            corrX += patch.aCoeff[j] * d;
+            corrY += patch.bCoeff[j] * d;
+        }
+        corr[0] = corrX * weight;
+        corr[1] = corrY * weight;
+    }
+    
+    /**
+     * Transforms a set of points.
+     * @param points The points to be transformed as a an array[n] of xy-arrays[2].
+     * points is changed, i.e. the old values are replaced by the new values.
+     */
+    public void transform(double[][] points) {
+        this.transformInParallel(points, null, points.length);
     }
     
     /**
@@ -116,23 +509,60 @@ public class MultiquadraticInterpolation {
      * @param nbrPts The number of xy pairs that will be transformed.
      */
     public void transform(double[] coords, int nbrPts) {
-        double corrX, corrY;
-        for (int i = 0; i < nbrPts; ++i) {
-            corrX = corrY = 0;
-            
-            for(int j=0; j < this.aCoeffArray.length; j++){
-                
-                // compute the distance to each control point
-                final double dx = coords[i*2] - this.destControlPoints[j][0];
-                final double dy = coords[i*2+1] - this.destControlPoints[j][1];
-                final double d = Math.sqrt(dx*dx+dy*dy);
+        this.transformInParallel(null, coords, nbrPts);
+    }
+    
+    /**
+     * Distributes the points among threads if there are many points.
+     */
+    private void transformInParallel(final double[][] points,
+            final double[] coords, int nbrPts) {
+        
+        int nThreads = Math.max(1, Math.min(Runtime.getRuntime().availableProcessors(),
+                nbrPts / MIN_POINTS_PER_THREAD));
+        if (nThreads == 1) {
+            this.transform(points, coords, 0, nbrPts);
+            return;
+        }
+        ArrayList<Thread> threads = new ArrayList<Thread>(nThreads);
+        int chunk = (nbrPts / nThreads) + 1;
+        for (int i = 0; i < nThreads; i++) {
+            final int first = i * chunk;
+            final int end = Math.min(nbrPts, first + chunk);
+            Thread t = new Thread() {
                 
-                corrX += this.aCoeffArray[j] * d;
-                corrY += this.bCoeffArray[j] * d;
+                @Override
+                public void run() {
+                    MultiquadraticInterpolation.this.transform(points, coords, first, end);
+                }
+            };
+            threads.add(t);
+            t.start();
+        }
+        for (Thread t : threads) {
+            try {
+                t.join();
+            } catch (InterruptedException ex) {
+                throw new IllegalStateException(ex);
+            }
+        }
+    }
+    
+    /**
+     * Transforms a range of points stored either in points or in coords.
+     */
+    private void transform(double[][] points, double[] coords, int first, int end) {
+        final double[] corr = new double[2];
+        for (int i = first; i < end; ++i) {
+            if (points != null) {
+                this.correction(points[i][0], points[i][1], corr);
+                points[i][0] += corr[0];
+                points[i][1] += corr[1];
+            } else {
+                this.correction(coords[i*2], coords[i*2+1], corr);
+                coords[i*2] += corr[0];
+                coords[i*2+1] += corr[1];
             }
-            
-            coords[i*2] += corrX;
-            coords[i*2+1] += corrY;
         }
     }
     
@@ -226,14 +656,55 @@ public class MultiquadraticInterpolation {
      * output the coefficients of the mutltiquadradtc interpolation
      */
     public void printCoefficients(){
+        if (this.patches != null) {
+            for (int i = 0; i < this.patches.length; i++) {
+                if (this.patches[i] != null) {
+                    System.out.println("Patch " + i + ":");
+                    this.printCoefficients(this.patches[i].aCoeff, this.patches[i].bCoeff);
+                }
+            }
+        } else {
+            this.printCoefficients(this.aCoeffArray, this.bCoeffArray);
+        }
+    }
+    
+    private void printCoefficients(double[] aCoeff, double[] bCoeff){
         System.out.println("Coefficient a:");
-        for(int i=0; i < this.aCoeffArray.length; i++){
-            System.out.println(this.aCoeffArray[i]);
+        for(int i=0; i < aCoeff.length; i++){
+            System.out.println(aCoeff[i]);
         }
         System.out.println("Coefficient b:");
-        for(int i=0; i < this.bCoeffArray.length; i++){
-            System.out.println(this.bCoeffArray[i]);
+        for(int i=0; i < bCoeff.length; i++){
+            System.out.println(bCoeff[i]);
         }
     }
+    
+    public int getMaxGlobalPoints() {
+        return maxGlobalPoints;
+    }
+    
+    /**
+     * Sets the maximum number of control points for which a single system of
+     * equations is solved. Solving this system requires time proportional to
+     * the cube of the number of points. Larger sets of control points are
+     * interpolated by blending local interpolations.
+     * Call solveCoefficients() after changing this value.
+     */
+    public void setMaxGlobalPoints(int maxGlobalPoints) {
+        this.maxGlobalPoints = maxGlobalPoints;
+    }
+    
+    public int getPointsPerPatch() {
+        return pointsPerPatch;
+    }
+    
+    /**
+     * Sets the approximate number of control points of local interpolations.
+     * Larger values result in smoother interpolations, but require more time.
+     * Call solveCoefficients() after changing this value.
+     */
+    public void setPointsPerPatch(int pointsPerPatch) {
+        this.pointsPerPatch = Math.max(MIN_POINTS_PER_PATCH, pointsPerPatch);
+    }
 
 }
\ No newline at end of file
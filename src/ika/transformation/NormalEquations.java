@@ -0,0 +1,124 @@
+/*
+ * NormalEquations.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+
+package ika.transformation;
+
+import Jama.Matrix;
+
+/**
+ * The normal equations N = ATPA and n = ATPl of a least squares adjustment,
+ * accumulated one observation at a time. Neither the design matrix A nor
+ * the weight matrix P are stored, P is assumed to be diagonal. Memory is
+ * therefore proportional to the square of the number of unknowns, and not to
+ * the square of the number of observations.<br>
+ * Several vectors of observations l sharing the same design matrix can be
+ * accumulated simultaneously.
+ */
+final class NormalEquations {
+
+    /**
+     * The upper triangle of ATPA.
+     */
+    private final double[][] N;
+
+    /**
+     * ATPl, one column per vector of observations.
+     */
+    private final double[][] n;
+
+    /**
+     * @param nbrUnknowns The number of columns of the design matrix A.
+     * @param nbrObservationVectors The number of vectors of observations l.
+     */
+    NormalEquations(int nbrUnknowns, int nbrObservationVectors) {
+        this.N = new double[nbrUnknowns][nbrUnknowns];
+        this.n = new double[nbrUnknowns][nbrObservationVectors];
+    }
+
+    /**
+     * Adds an observation.
+     * @param a A row of the design matrix A.
+     * @param l The observation.
+     * @param p The weight of the observation.
+     */
+    void add(double[] a, double l, double p) {
+        final int u = this.N.length;
+        for (int r = 0; r < u; r++) {
+            final double pa = p * a[r];
+            if (pa == 0) {
+                continue;
+            }
+            final double[] Nrow = this.N[r];
+            for (int c = r; c < u; c++) {
+                Nrow[c] += pa * a[c];
+            }
+            this.n[r][0] += pa * l;
+        }
+    }
+
+    /**
+     * Adds an observation to each vector of observations.
+     * @param a A row of the design matrix A.
+     * @param l The observations, one for each vector of observations.
+     * @param p The weight of the observations.
+     */
+    void add(double[] a, double[] l, double p) {
+        final int u = this.N.length;
+        for (int r = 0; r < u; r++) {
+            final double pa = p * a[r];
+            if (pa == 0) {
+                continue;
+            }
+            final double[] Nrow = this.N[r];
+            for (int c = r; c < u; c++) {
+                Nrow[c] += pa * a[c];
+            }
+            final double[] nrow = this.n[r];
+            for (int i = 0; i < nrow.length; i++) {
+                nrow[i] += pa * l[i];
+            }
+        }
+    }
+
+    /**
+     * Returns the cofactor matrix Q, the inverse of ATPA.
+     */
+    Matrix getQ() {
+        final int u = this.N.length;
+        double[][] sym = new double[u][u];
+        for (int r = 0; r < u; r++) {
+            for (int c = r; c < u; c++) {
+                sym[r][c] = sym[c][r] = this.N[r][c];
+            }
+        }
+        return new Matrix(sym, u, u).inverse();
+    }
+
+    /**
+     * Solves the normal equations.
+     * @param Q The cofactor matrix returned by getQ().
+     * @return The unknowns, one column per vector of observations.
+     */
+    Matrix solve(Matrix Q) {
+        return Q.times(new Matrix(this.n));
+    }
+
+    /**
+     * Returns the residual of an observation, v = ax - l.
+     * @param a A row of the design matrix A.
+     * @param x The unknowns.
+     * @param col The column of x to use.
+     * @param l The observation.
+     */
+    static double residual(double[] a, double[][] x, int col, double l) {
+        double ax = 0;
+        for (int i = 0; i < a.length; i++) {
+            ax += a[i] * x[i][col];
+        }
+        return ax - l;
+    }
+}
@@ -355,57 +355,36 @@ public class TransformationAffine5 extends Transformation implements Serializabl
         double cosRot = Math.cos(params[ROT]);
         double sinRot = Math.sin(params[ROT]);
         
-        // allocate matrix l and matrix A.
-        double[][] lArray = new double [this.numberOfPoints * 2][1];
-        Matrix mat_A = new Matrix(this.numberOfPoints * 2, 5);
-        Matrix mat_l = new Matrix(lArray,this.numberOfPoints * 2, 1);
-        
-        // loop over all points to fill matrix l and matrix A.
+        // Accumulate ATA and ATl in a single pass over the points, without
+        // constructing matrix l and matrix A.
+        NormalEquations normalEquations = new NormalEquations(5, 1);
+        final double[] ax = new double[5];
+        final double[] ay = new double[5];
+        final double[] l = new double[2];
         for (int i = 0; i < this.numberOfPoints; i++) {
-            
-            final double xCosRot = cosRot*(sourceSet[i][0]-cxSrc);
-            final double xSinRot = sinRot*(sourceSet[i][0]-cxSrc);
-            final double yCosRot = cosRot*(sourceSet[i][1]-cySrc);
-            final double ySinRot = sinRot*(sourceSet[i][1]-cySrc);
-            
-            final double estimationX = this.params[TRANSX]
-                    +this.params[SCALEX]*xCosRot
-                    -this.params[SCALEY]*ySinRot;
-            final double estimationY = this.params[TRANSY]
-                    +this.params[SCALEX]*xSinRot
-                    +this.params[SCALEY]*yCosRot;
-            
-            // fill matrix l
-            lArray[i*2][0] = destSet[i][0] - cxDst - estimationX;
-            lArray[i*2+1][0] = destSet[i][1] - cyDst - estimationY;
-            
-            // fill matrix A
-            final double [][]a = {
-                {1, 0, xCosRot, -ySinRot, -(destSet[i][1]-cyDst)+params[TRANSY]},
-                {0, 1, xSinRot, yCosRot, (destSet[i][0]-cxDst)-params[TRANSX]}
-            };
-            mat_A.setMatrix(i*2, i*2+1, 0, 4, new Matrix(a, 2, 5));
+            this.observation(destSet[i], sourceSet[i], cosRot, sinRot, ax, ay, l);
+            normalEquations.add(ax, l[0], 1.);
+            normalEquations.add(ay, l[1], 1.);
         }
         
         // Compute transformation parameters
-        Matrix mat_Atrans = mat_A.transpose();
-        Matrix mat_Q = mat_Atrans.times(mat_A).inverse();
-        Matrix mat_x = mat_Q.times(mat_Atrans.times(mat_l));
+        Matrix mat_Q = normalEquations.getQ();
+        final double[][] x = normalEquations.solve(mat_Q).getArray();
         
-        // Compute v: Residuals
-        Matrix mat_v = mat_A.times(mat_x).minus(mat_l);
+        // Compute v: Residuals and copy them to this.v
+        double vTv = 0;
+        for (int i = 0; i < this.numberOfPoints; i++) {
+            this.observation(destSet[i], sourceSet[i], cosRot, sinRot, ax, ay, l);
+            final double vx = NormalEquations.residual(ax, x, 0, l[0]);
+            final double vy = NormalEquations.residual(ay, x, 0, l[1]);
+            this.v[i][0] = vx;
+            this.v[i][1] = vy;
+            vTv += vx * vx + vy * vy;
+        }
         
         // Sigma aposteriori of planar vector (sigma0)
-        final double vTv = this.vTv(mat_v);
         this.sigma0 = Math.sqrt(vTv/(2.*this.numberOfPoints-5));
         
-        // copy residuals to this.v
-        final double[][] v_arr = mat_v.getArray();
-        for (int i = 0; i < numberOfPoints; i++) {
-            this.v[i][0] = v_arr[i*2][0];
-            this.v[i][1] = v_arr[i*2+1][0];
-        }
-        
         this.transSigma = this.sigma0 * Math.sqrt(mat_Q.get(0,0));
         this.scaleXSigma = this.sigma0 * Math.sqrt(mat_Q.get(2,2));
         this.scaleYSigma = this.sigma0 * Math.sqrt(mat_Q.get(3,3));
@@ -421,10 +400,52 @@ public class TransformationAffine5 extends Transformation implements Serializabl
          */
         
         // copy results to array
-        double[] x = new double[5];
+        double[] dx = new double[5];
         for (int i = 0; i < 5; i++)
-            x[i] = mat_x.get(i,0);
-        return x;
+            dx[i] = x[i][0];
+        return dx;
+    }
+    
+    /**
+     * Fills the two rows of the design matrix A and the observations l for
+     * a point.
+     * @param dstPt The point of the destination set.
+     * @param srcPt The point of the source set.
+     * @param ax Receives the row of A for the x coordinate.
+     * @param ay Receives the row of A for the y coordinate.
+     * @param l Receives the observations for x and y.
+     */
+    private void observation(double[] dstPt, double[] srcPt,
+            double cosRot, double sinRot,
+            double[] ax, double[] ay, double[] l) {
+        
+        final double xCosRot = cosRot*(srcPt[0]-cxSrc);
+        final double xSinRot = sinRot*(srcPt[0]-cxSrc);
+        final double yCosRot = cosRot*(srcPt[1]-cySrc);
+        final double ySinRot = sinRot*(srcPt[1]-cySrc);
+        
+        final double estimationX = this.params[TRANSX]
+                +this.params[SCALEX]*xCosRot
+                -this.params[SCALEY]*ySinRot;
+        final double estimationY = this.params[TRANSY]
+                +this.params[SCALEX]*xSinRot
+                +this.params[SCALEY]*yCosRot;
+        
+        // observations l
+        l[0] = dstPt[0] - cxDst - estimationX;
+        l[1] = dstPt[1] - cyDst - estimationY;
+        
+        // rows of matrix A
+        ax[0] = 1;
+        ax[1] = 0;
+        ax[2] = xCosRot;
+        ax[3] = -ySinRot;
+        ax[4] = -(dstPt[1]-cyDst)+params[TRANSY];
+        ay[0] = 0;
+        ay[1] = 1;
+        ay[2] = xSinRot;
+        ay[3] = yCosRot;
+        ay[4] = (dstPt[0]-cxDst)-params[TRANSX];
     }
     
     /**
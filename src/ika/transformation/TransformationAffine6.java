@@ -430,49 +430,44 @@ public class TransformationAffine6 extends Transformation implements Serializabl
         this.cxSrc /= this.numberOfPoints;
         this.cySrc /= this.numberOfPoints;
         
-        // allocate matrices x, y, and A.
-        double[][] xArray = new double [numberOfPoints][1];
-        Matrix mat_x = new Matrix(xArray, numberOfPoints, 1);
-        double[][] yArray = new double [numberOfPoints][1];
-        Matrix mat_y = new Matrix(yArray, numberOfPoints, 1);
-        double[][] AArray = new double [numberOfPoints][3];
-        Matrix mat_A = new Matrix(AArray, numberOfPoints, 3);
-        
-        // initialize matrices x, y, and A.
+        // Accumulate ATA, ATx and ATy in a single pass over the points,
+        // without constructing the matrices x, y, and A.
+        NormalEquations normalEquations = new NormalEquations(3, 2);
+        final double[] a = new double[3];
+        final double[] xy = new double[2];
+        a[0] = 1.;
         for (int i = 0; i < numberOfPoints; i++) {
-            xArray[i][0] = destSet[i][0] - cxDst;
-            yArray[i][0] = destSet[i][1] - cyDst;
-            AArray[i][0] = 1.;
-            AArray[i][1] = sourceSet[i][0] - cxSrc;
-            AArray[i][2] = sourceSet[i][1] - cySrc;
+            a[1] = sourceSet[i][0] - cxSrc;
+            a[2] = sourceSet[i][1] - cySrc;
+            xy[0] = destSet[i][0] - cxDst;
+            xy[1] = destSet[i][1] - cyDst;
+            normalEquations.add(a, xy, 1.);
         }
         
-        Matrix mat_Atrans = mat_A.transpose();
-        Matrix mat_Q = mat_Atrans.times(mat_A).inverse();
-        Matrix mat_a = mat_Q.times(mat_Atrans.times(mat_x));
-        Matrix mat_b = mat_Q.times(mat_Atrans.times(mat_y));
+        // a and b are the two columns of ab
+        Matrix mat_Q = normalEquations.getQ();
+        final double[][] ab = normalEquations.solve(mat_Q).getArray();
         
         // Compute residuals u, w, vTv and Sigma aposteriori (sigma0).
-        Matrix mat_u = mat_A.times(mat_a).minus(mat_x);
-        Matrix mat_w = mat_A.times(mat_b).minus(mat_y);
-        
-        final double vTv = this.vTv(mat_u) + this.vTv(mat_w);
-        final double sigma0square= vTv / (2. * numberOfPoints - 6);
-        this.sigma0 = Math.sqrt(sigma0square);
-        
-        // copy residuals to this.v
-        final double[][] v_x = mat_u.getArray();
-        final double[][] v_y = mat_w.getArray();
+        // Copy residuals to this.v
+        double vTv = 0;
         for (int i = 0; i < numberOfPoints; i++) {
-            this.v[i][0] = v_x[i][0];
-            this.v[i][1] = v_y[i][0];
+            a[1] = sourceSet[i][0] - cxSrc;
+            a[2] = sourceSet[i][1] - cySrc;
+            final double u = NormalEquations.residual(a, ab, 0, destSet[i][0] - cxDst);
+            final double w = NormalEquations.residual(a, ab, 1, destSet[i][1] - cyDst);
+            this.v[i][0] = u;
+            this.v[i][1] = w;
+            vTv += u * u + w * w;
         }
+        final double sigma0square= vTv / (2. * numberOfPoints - 6);
+        this.sigma0 = Math.sqrt(sigma0square);
         
         // copy paramters to instance variables
-        this.a1 = mat_a.get(1,0);
-        this.a2 = mat_a.get(2,0);
-        this.a3 = mat_b.get(1,0);
-        this.a4 = mat_b.get(2,0);
+        this.a1 = ab[1][0];
+        this.a2 = ab[2][0];
+        this.a3 = ab[1][1];
+        this.a4 = ab[2][1];
         
         final double s1 = Math.sqrt(sigma0square * mat_Q.get(0,0));
         final double s2 = Math.sqrt(sigma0square * mat_Q.get(1,1));
@@ -27,12 +27,13 @@ public class TransformationRobustHelmert extends Transformation implements Seria
      */
     private RobustEstimator robustEstimator;
     /**
-     * Matrix of differences between the transformed source points and the destination
-     * points. This matrix is needed to compute the P matrix.
+     * Differences between the transformed source points and the destination
+     * points, alternating x and y. The residuals are needed to compute the
+     * weights of the points.
      */
-    private Matrix mat_v = null;
+    private double[] residuals = null;
     /**
-     * MAD: the median of all values of mat_v
+     * MAD: the median of all residuals
      */
     private double s;
     /**
@@ -307,45 +308,43 @@ public class TransformationRobustHelmert extends Transformation implements Seria
     }
     
     /**
-     * Constructs the weight matrix P.
-     * @return Wheight matrix P.
+     * Computes the weight of each point. The weight matrix P is diagonal, and
+     * the x and y coordinates of a point have equal weights.
+     * @return The weights of the points.
      */
-    private Matrix constructP() {
-        if (this.mat_v == null)
-            return Matrix.identity(numberOfPoints*2, numberOfPoints*2);
-        else {
+    private double[] computeWeights() {
+        double[] weights = new double[this.numberOfPoints];
+        if (this.residuals == null) {
+            java.util.Arrays.fill(weights, 1.);
+            return weights;
+        } else {
             // VERSION Beineke 2001 S101
             // Berechnung mit Laengen der Restklaffungsvektoren
             // Liefert gleiche Resultate wie Beineke 2003 Seite 8, Kolonne HU-D.
             // jedoch Fehler(?) in Beineke 2001 (siehe unten)
-            double[] d = new double [this.mat_v.getRowDimension()/2];
+            double[] d = new double [this.residuals.length/2];
             
             for (int i = 0; i < d.length; i++) {
-                final double vx = mat_v.get(i*2, 0);
-                final double vy = mat_v.get(i*2+1, 0);
+                final double vx = this.residuals[i*2];
+                final double vy = this.residuals[i*2+1];
                 d[i] = Math.sqrt(vx*vx+vy*vy);
             }
             
             final double dmed = Median.median(d, true);
-            double[] d_minus_dmed = new double [this.mat_v.getRowDimension()/2];
+            double[] d_minus_dmed = new double [this.residuals.length/2];
             for (int i = 0; i < d_minus_dmed.length; i++) {
                 d_minus_dmed[i] = Math.abs(d[i] - dmed);
             }
             this.s = Median.median(d_minus_dmed, false) / 0.4485;
             
-            // compute P
-            final int pSize = mat_v.getRowDimension();
-            Matrix mat_P = new Matrix(pSize, pSize);
+            // compute weights
             for (int i = 0; i < d.length; i++) {
                 // - dmed vermutlich falsch in Beineke 2001 S.101:
                 // final double ui = (d[i] - dmed) / s;
                 final double ui = d[i] / s;
-                final double w = robustEstimator.w(ui);
-                mat_P.set(i*2, i*2, w);
-                mat_P.set(i*2+1, i*2+1, w);
+                weights[i] = robustEstimator.w(ui);
             }
-            return mat_P;
-            
+            return weights;            
             
             /* -0.01619
              * -0.00770
@@ -444,25 +443,40 @@ public class TransformationRobustHelmert extends Transformation implements Seria
     }
     
     /**
-     * Computes new parameters for this transformation.
-     * @param mat_l Matrix l containing the coordinates of the destination point set.
-     * @param mat_A Model matrix A.
+     * Computes new parameters for this transformation. The normal equations
+     * are accumulated in a single pass over the points, without constructing
+     * the design matrix A and the weight matrix P.
+     * @param destSet The coordinates of the destination point set.
+     * @param sourceSet The coordinates of the source point set.
      * @param result The new parameters are stored in the array referenced by result.
      * Required size of result: 4x1
      */
-    private void solve(Matrix mat_l, Matrix mat_A, double[] result) {
-        // Construct P matrix.
-        Matrix mat_P = this.constructP();
-        //System.out.println();
-        //mat_P.print(15, 3);
+    private void solve(double[][] destSet, double[][] sourceSet, double[] result) {
+        // Compute the weights of the points.
+        final double[] weights = this.computeWeights();
+        
+        // Accumulate ATPA and ATPl
+        NormalEquations normalEquations = new NormalEquations(4, 1);
+        final double[] ax = new double[4];
+        final double[] ay = new double[4];
+        for (int i = 0; i < this.numberOfPoints; i++) {
+            this.designMatrixRows(sourceSet[i], ax, ay);
+            normalEquations.add(ax, destSet[i][0], weights[i]);
+            normalEquations.add(ay, destSet[i][1], weights[i]);
+        }
         
         // Compute transformation parameters
-        Matrix mat_Atrans = mat_A.transpose();
-        Matrix mat_Q = mat_Atrans.times(mat_P).times(mat_A).inverse();
-        Matrix mat_x = mat_Q.times(mat_Atrans.times(mat_P).times(mat_l));
+        Matrix mat_Q = normalEquations.getQ();
+        final double[][] x = normalEquations.solve(mat_Q).getArray();
         
         // Compute v: Residuals
-        this.mat_v = mat_A.times(mat_x).minus(mat_l);
+        if (this.residuals == null)
+            this.residuals = new double[this.numberOfPoints * 2];
+        for (int i = 0; i < this.numberOfPoints; i++) {
+            this.designMatrixRows(sourceSet[i], ax, ay);
+            this.residuals[i*2] = NormalEquations.residual(ax, x, 0, destSet[i][0]);
+            this.residuals[i*2+1] = NormalEquations.residual(ay, x, 0, destSet[i][1]);
+        }
         
         this.q11 = mat_Q.get(0, 0);
         this.q22 = mat_Q.get(1, 1);
@@ -471,7 +485,24 @@ public class TransformationRobustHelmert extends Transformation implements Seria
         
         // copy resulting parameters
         for (int i = 0; i < 4; i++)
-            result[i] = mat_x.get(i,0);
+            result[i] = x[i][0];
+    }
+    
+    /**
+     * Fills the two rows of the design matrix A for a point.
+     * @param srcPt The point of the source set.
+     * @param ax Receives the row for the x coordinate.
+     * @param ay Receives the row for the y coordinate.
+     */
+    private void designMatrixRows(double[] srcPt, double[] ax, double[] ay) {
+        ax[0] = 1.;
+        ax[1] = 0.;
+        ax[2] = srcPt[0];
+        ax[3] = -srcPt[1];
+        ay[0] = 0.;
+        ay[1] = 1.;
+        ay[2] = srcPt[1];
+        ay[3] = srcPt[0];
     }
     
     /**
@@ -499,25 +530,8 @@ public class TransformationRobustHelmert extends Transformation implements Seria
      */
     protected void initWithPoints(double[][] destSet, double[][] sourceSet) {
         
-        // Construct l matrix with points of set 1.
-        double[][] lArray = new double [this.numberOfPoints*2][1];
-        Matrix mat_l = new Matrix(lArray,this.numberOfPoints*2, 1);
-        for (int i = 0; i < this.numberOfPoints; i++) {
-            lArray[i*2][0] = destSet[i][0];
-            lArray[i*2+1][0] = destSet[i][1];
-        }
-        
-        // Construct A matrix.
-        Matrix mat_A = new Matrix(this.numberOfPoints*2, 4, 0.);
-        for (int i = 0; i < this.numberOfPoints; i++) {
-            double [][]a ={
-                {1., 0., sourceSet[i][0], -sourceSet[i][1]},
-                {0., 1., sourceSet[i][1], sourceSet[i][0]}
-            };
-            mat_A.setMatrix(i*2, i*2+1, 0, 3, new Matrix(a, 2, 4));
-        }
-        
         // initialize values
+        this.residuals = null;
         this.s = 0;
         this.numberOfIterations = 0;
         for (int i = 0; i < 4; i++)
@@ -528,7 +542,7 @@ public class TransformationRobustHelmert extends Transformation implements Seria
         do {
             this.numberOfIterations++;
             final double s_old = this.s;
-            this.solve(mat_l, mat_A, params_new);
+            this.solve(destSet, sourceSet, params_new);
             
             // print report for current iteration
             /*
@@ -553,11 +567,11 @@ public class TransformationRobustHelmert extends Transformation implements Seria
             }
         } while (true);
         
-        double[] v = new double [this.mat_v.getRowDimension()];
-        double[] v_abs = new double [this.mat_v.getRowDimension()];
+        double[] v = new double [this.residuals.length];
+        double[] v_abs = new double [this.residuals.length];
         for (int i = 0, j = 0; i < v.length / 2; i++, j+= 2) {
-            final double vx = this.mat_v.get(j, 0);
-            final double vy = this.mat_v.get(j+1, 0);
+            final double vx = this.residuals[j];
+            final double vy = this.residuals[j+1];
             v[j] = vx;
             v[j+1] = vy;
             v_abs[j] = Math.abs(vx);
@@ -568,13 +582,6 @@ public class TransformationRobustHelmert extends Transformation implements Seria
         final double mad = Median.median(v_abs, false);
         this.sigma0 = this.robustEstimator.getSigma0(v, mad);
         
-        /*
-         final double[][] v_arr = mat_v.getArray();
-        for (int i = 0; i < numberOfPoints; i++) {
-            this.v[i][0] = v_arr[i*2][0];
-            this.v[i][1] = v_arr[i*2+1][0];
-        }
-         */
     }
     
     /**
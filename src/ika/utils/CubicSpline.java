@@ -29,6 +29,29 @@ public class CubicSpline implements Cloneable {
      * to 0.
      */
     private double endSlope = Double.NaN;
+    /**
+     * The maximum number of intervals of the lookup table. If the tolerance
+     * cannot be met with this number of intervals, no lookup table is used.
+     */
+    private static final int MAX_LOOKUP_TABLE_INTERVALS = 1 << 14;
+    /**
+     * Maximum absolute error of values evaluated with the lookup table.
+     * If 0, the spline is evaluated exactly and no lookup table is built.
+     */
+    private double lookupTableTolerance = 0;
+    /**
+     * Values sampled at regular intervals along the spline for evaluation by
+     * linear interpolation. Two values are stored for each interval: the
+     * value at the start of the interval and the difference to the value at
+     * the end of the interval. Null if the spline is evaluated exactly.
+     * The table is replaced and never modified after it has been built,
+     * and can therefore be shared between clones.
+     */
+    private double[] lookupTable;
+    /**
+     * The number of lookup table intervals per spline segment.
+     */
+    private double lookupTableIntervalsPerSegment;
 
     /**
      * Create a new instance of CubicSpline.
@@ -96,6 +119,21 @@ public class CubicSpline implements Cloneable {
         }
     }
 
+    /**
+     * Set all knot values. The spline coefficients are only computed once,
+     * which is considerably faster than calling setKnot for each knot.
+     * @param v The new knot values. The length must equal getKnotsCount().
+     */
+    public void setKnots(double[] v) {
+        if (v.length != this.t.length) {
+            throw new IllegalArgumentException();
+        }
+        if (!java.util.Arrays.equals(this.t, v)) {
+            System.arraycopy(v, 0, this.t, 0, v.length);
+            this.computeCubicSpline();
+        }
+    }
+
     /**
      * Returns the knot value at position i. An exception is thrown if i is smaller
      * than 0 or equal or larger than getKnotsCount().
@@ -200,6 +238,81 @@ public class CubicSpline implements Cloneable {
         }
     }
 
+    /**
+     * Returns the maximum absolute error of values returned by eval(double).
+     * @return The tolerance, or 0 if the spline is evaluated exactly.
+     */
+    public double getLookupTableTolerance() {
+        return lookupTableTolerance;
+    }
+
+    /**
+     * Sets the maximum absolute error of values returned by eval(double).
+     * If the tolerance is larger than 0, eval(double) linearly interpolates
+     * values in a table that is built each time the spline changes. The
+     * sampling interval of the table is chosen such that the interpolation
+     * error does not exceed the tolerance. If this would require an
+     * excessively large table, the spline is evaluated exactly.
+     * @param tolerance The tolerance, 0 for exact evaluation.
+     */
+    public void setLookupTableTolerance(double tolerance) {
+        if (tolerance < 0 || Double.isNaN(tolerance)) {
+            throw new IllegalArgumentException();
+        }
+        if (this.lookupTableTolerance != tolerance) {
+            this.lookupTableTolerance = tolerance;
+            this.computeLookupTable();
+        }
+    }
+
+    /**
+     * Returns true if eval(double) interpolates values in a lookup table.
+     */
+    public boolean isUsingLookupTable() {
+        return this.lookupTable != null;
+    }
+
+    /**
+     * Builds the lookup table for the current spline coefficients.
+     * The error of linear interpolation over an interval of length h is
+     * bounded by h * h / 8 * max|f''|, with f''(t) = 2c + 6dt for a spline
+     * segment, which reaches its maximum absolute value at t = 0 or t = 1.
+     */
+    private void computeLookupTable() {
+        this.lookupTable = null;
+        if (this.lookupTableTolerance <= 0) {
+            return;
+        }
+
+        double maxF2 = 0;
+        for (int i = 0; i < this.abcd.length; i++) {
+            final double c2 = 2. * this.abcd[i][2];
+            final double d6 = 6. * this.abcd[i][3];
+            maxF2 = Math.max(maxF2, Math.max(Math.abs(c2), Math.abs(c2 + d6)));
+        }
+        final double m = Math.ceil(Math.sqrt(maxF2 / (8. * this.lookupTableTolerance)));
+        final int intervalsPerSegment = (int) Math.max(1, m);
+        if (m > MAX_LOOKUP_TABLE_INTERVALS
+                || intervalsPerSegment * this.abcd.length > MAX_LOOKUP_TABLE_INTERVALS) {
+            return;
+        }
+
+        final int nIntervals = intervalsPerSegment * this.abcd.length;
+        final double[] table = new double[nIntervals * 2];
+        double v0 = this.abcd[0][0];
+        for (int j = 0; j < nIntervals; j++) {
+            final int i = (j + 1) / intervalsPerSegment;
+            final double v1 = i < this.abcd.length
+                    ? eval(i, (double) (j + 1 - i * intervalsPerSegment) / intervalsPerSegment)
+                    : eval(this.abcd.length - 1, 1.);
+            table[j * 2] = v0;
+            table[j * 2 + 1] = v1 - v0;
+            v0 = v1;
+        }
+        this.lookupTableIntervalsPerSegment = intervalsPerSegment;
+        this.lookupTable = table;
+    }
+
     /**
      * Compute the spline coefficients for a cubic spline. Call this after every
      * change to the knots vector t or changes to the start or end slopes.
@@ -281,6 +394,8 @@ public class CubicSpline implements Cloneable {
             abcd_row[2] = 3 * valDif - 2 * di - diplus1;
             abcd_row[3] = -2 * valDif + di + diplus1;
         }
+
+        this.computeLookupTable();
     }
 
     /**
@@ -297,12 +412,22 @@ public class CubicSpline implements Cloneable {
     }
 
     /**
-     * Evaluates a piecewise cubic spline at position x.
+     * Evaluates a piecewise cubic spline at position x. If a lookup table
+     * tolerance is set, the value is interpolated in the lookup table.
      * @param x The position where the spline is evaluated. Must be in
      * [0..getKnotsCount()-1]. An IndexOutOfBoundsException is thrown otherwise.
      * @return The value defined by the piecewise cubic spline at position x.
      */
     public final double eval(double x) {
+        final double[] table = this.lookupTable;
+        if (table != null) {
+            final double u = x * this.lookupTableIntervalsPerSegment;
+            int j = (int) u;
+            if (j >= table.length / 2) {
+                j = table.length / 2 - 1;
+            }
+            return table[j * 2] + (u - j) * table[j * 2 + 1];
+        }
         int i = (int) x;
         if (i >= this.abcd.length) {
             i = this.abcd.length - 1;
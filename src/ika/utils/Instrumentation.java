@@ -0,0 +1,265 @@
+/*
+ * Instrumentation.java
+ *
+ * Created on October 19, 2026
+ *
+ */
+
+package ika.utils;
+
+import java.io.FileWriter;
+import java.io.IOException;
+import java.io.PrintWriter;
+import java.io.Writer;
+import java.text.DecimalFormat;
+import java.util.ArrayList;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * Timers and counters for the stages of the map pipeline. Disabled by
+ * default, in which case a timer costs a read of a volatile field.
+ * Enable with setEnabled() or by starting the application with
+ * -Dika.instrumentation=true. If -Dika.instrumentation.csv=path is also set,
+ * all recorded events are written to a CSV file when the application quits.
+ * <br>
+ * Usage:
+ * <pre>
+ * final long t = Instrumentation.start();
+ * ...
+ * Instrumentation.stop("stage name", t);
+ * </pre>
+ * The most recent events are kept in a ring buffer for writing to a CSV
+ * file, and statistics per stage are kept for display in the map.
+ */
+public final class Instrumentation {
+
+    /**
+     * Number of events kept for writing to a CSV file.
+     */
+    private static final int MAX_EVENTS = 1 << 16;
+
+    private static volatile boolean enabled = Boolean.getBoolean("ika.instrumentation");
+
+    /**
+     * Statistics per stage name, in the order stages are first recorded.
+     */
+    private static final Map<String, Stage> stages = new LinkedHashMap<String, Stage>();
+
+    /**
+     * Counters, in the order they are first incremented.
+     */
+    private static final Map<String, long[]> counters = new LinkedHashMap<String, long[]>();
+
+    /**
+     * Ring buffer of events.
+     */
+    private static final String[] eventNames = new String[MAX_EVENTS];
+    private static final String[] eventThreads = new String[MAX_EVENTS];
+    private static final long[] eventStarts = new long[MAX_EVENTS];
+    private static final long[] eventDurations = new long[MAX_EVENTS];
+    private static long eventCount = 0;
+
+    static {
+        final String csvPath = System.getProperty("ika.instrumentation.csv");
+        if (csvPath != null) {
+            Runtime.getRuntime().addShutdownHook(new Thread() {
+
+                @Override
+                public void run() {
+                    try {
+                        writeCSV(csvPath);
+                    } catch (IOException exc) {
+                        exc.printStackTrace();
+                    }
+                }
+            });
+        }
+    }
+
+    /**
+     * Statistics for a stage.
+     */
+    private static final class Stage {
+
+        private long count;
+        private long totalNanos;
+        private long lastNanos;
+        private long maxNanos;
+    }
+
+    private Instrumentation() {
+    }
+
+    public static boolean isEnabled() {
+        return enabled;
+    }
+
+    public static void setEnabled(boolean enabled) {
+        Instrumentation.enabled = enabled;
+    }
+
+    /**
+     * Starts a timer.
+     * @return The start time to pass to stop(), or 0 if instrumentation is
+     * disabled.
+     */
+    public static long start() {
+        return enabled ? System.nanoTime() : 0L;
+    }
+
+    /**
+     * Stops a timer and records the elapsed time.
+     * @param name The name of the stage.
+     * @param start The value returned by start(). Nothing is recorded if 0.
+     */
+    public static void stop(String name, long start) {
+        if (start == 0L) {
+            return;
+        }
+        final long duration = System.nanoTime() - start;
+        record(name, start, duration);
+    }
+
+    /**
+     * Records a duration that was not measured with start() and stop().
+     * @param name The name of the stage.
+     * @param duration The duration in nanoseconds.
+     */
+    public static void record(String name, long duration) {
+        if (enabled) {
+            record(name, System.nanoTime() - duration, duration);
+        }
+    }
+
+    /**
+     * Records a duration even if instrumentation is disabled. This is for
+     * rare events, such as the start of the application, that cannot be
+     * measured again after instrumentation is enabled.
+     * @param name The name of the stage.
+     * @param duration The duration in nanoseconds.
+     */
+    public static void recordAlways(String name, long duration) {
+        record(name, System.nanoTime() - duration, duration);
+    }
+
+    private static void record(String name, long start, long duration) {
+        synchronized (stages) {
+            Stage stage = stages.get(name);
+            if (stage == null) {
+                stage = new Stage();
+                stages.put(name, stage);
+            }
+            stage.count++;
+            stage.totalNanos += duration;
+            stage.lastNanos = duration;
+            stage.maxNanos = Math.max(stage.maxNanos, duration);
+
+            final int i = (int) (eventCount++ % MAX_EVENTS);
+            eventNames[i] = name;
+            eventThreads[i] = Thread.currentThread().getName();
+            eventStarts[i] = start;
+            eventDurations[i] = duration;
+        }
+    }
+
+    /**
+     * Increments a counter.
+     * @param name The name of the counter.
+     * @param n The value to add.
+     */
+    public static void count(String name, long n) {
+        if (!enabled) {
+            return;
+        }
+        synchronized (stages) {
+            long[] counter = counters.get(name);
+            if (counter == null) {
+                counter = new long[1];
+                counters.put(name, counter);
+            }
+            counter[0] += n;
+        }
+    }
+
+    /**
+     * Discards all recorded events, statistics and counters.
+     */
+    public static void reset() {
+        synchronized (stages) {
+            stages.clear();
+            counters.clear();
+            eventCount = 0;
+        }
+    }
+
+    /**
+     * Returns one line of text for each stage and counter, with the duration
+     * of the last event, the mean and maximum duration and the number of
+     * events of each stage.
+     */
+    public static List<String> getSummary() {
+        DecimalFormat f = new DecimalFormat("0.0");
+        List<String> lines = new ArrayList<String>();
+        synchronized (stages) {
+            for (Map.Entry<String, Stage> entry : stages.entrySet()) {
+                final Stage s = entry.getValue();
+                lines.add(entry.getKey()
+                        + "  " + f.format(s.lastNanos / 1e6)
+                        + " ms (mean " + f.format(s.totalNanos / 1e6 / s.count)
+                        + ", max " + f.format(s.maxNanos / 1e6)
+                        + ", n " + s.count + ")");
+            }
+            for (Map.Entry<String, long[]> entry : counters.entrySet()) {
+                lines.add(entry.getKey() + "  " + entry.getValue()[0]);
+            }
+        }
+        return lines;
+    }
+
+    /**
+     * Writes the recorded events and the counters to a CSV file.
+     * @param filePath The path of the file.
+     */
+    public static void writeCSV(String filePath) throws IOException {
+        Writer writer = new FileWriter(filePath);
+        try {
+            writeCSV(writer);
+        } finally {
+            writer.close();
+        }
+    }
+
+    /**
+     * Writes the recorded events and the counters in CSV format. Each line
+     * has a type (event or counter), a name, a thread, a start time and a
+     * value. The value of an event is its duration in nanoseconds.
+     * @param writer The destination.
+     */
+    public static void writeCSV(Writer writer) {
+        PrintWriter out = new PrintWriter(writer);
+        out.println("type,name,thread,start_ns,value");
+        synchronized (stages) {
+            final long first = Math.max(0, eventCount - MAX_EVENTS);
+            for (long e = first; e < eventCount; e++) {
+                final int i = (int) (e % MAX_EVENTS);
+                out.println("event," + csv(eventNames[i]) + ","
+                        + csv(eventThreads[i]) + ","
+                        + eventStarts[i] + "," + eventDurations[i]);
+            }
+            for (Map.Entry<String, long[]> entry : counters.entrySet()) {
+                out.println("counter," + csv(entry.getKey()) + ",,,"
+                        + entry.getValue()[0]);
+            }
+        }
+        out.flush();
+    }
+
+    private static String csv(String str) {
+        if (str.indexOf(',') < 0 && str.indexOf('"') < 0) {
+            return str;
+        }
+        return "\"" + str.replace("\"", "\"\"") + "\"";
+    }
+}
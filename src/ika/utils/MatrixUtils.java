@@ -81,12 +81,15 @@ public class MatrixUtils {
         
         final double[][] C = new double[mC][nC];
         
+        // traverse rows of B and C sequentially
         for (int i = 0; i < mC; i++) {
             final double[] C_row = C[i];
             final double[] A_row = A[i];
-            for (int j = 0; j < nC; j++) {
-                for (int k = 0; k < nA; k++) {
-                    C_row[j] += A_row[k] * B[k][j];
+            for (int k = 0; k < nA; k++) {
+                final double a = A_row[k];
+                final double[] B_row = B[k];
+                for (int j = 0; j < nC; j++) {
+                    C_row[j] += a * B_row[j];
                 }
             }
         }
@@ -111,9 +114,12 @@ public class MatrixUtils {
         double[] res = new double [m];
         
         for (int row = 0; row < m; row++) {
+            final double[] mat_row = mat[row];
+            double sum = 0;
             for (int col = 0; col < n; col++){
-                res[col] += mat[row][col] * vector[col][vectorCol];
+                sum += mat_row[col] * vector[col][vectorCol];
             }
+            res[row] = sum;
         }
         
         return res;
@@ -137,22 +143,21 @@ public class MatrixUtils {
         // result is a symetrical square matrix
         double[][] res = new double [n][n];
         
-        // row[] will hold intermediate results
-        double[] row = new double [m];
+        // accumulate the upper triangle in a single pass over the rows of mat
+        for (int i = 0; i < m; i++) {
+            final double[] mat_row = mat[i];
+            for (int r = 0; r < n; r++) {
+                final double pa = mat_row[r] * diag[i];
+                final double[] res_row = res[r];
+                for (int j = r; j < n; j++)
+                    res_row[j] += pa * mat_row[j];
+            }
+        }
         
+        // mirror result on diagonal axis
         for (int r = 0; r < n; r++) {
-            // compute row r of ATP
-            for (int col = 0; col < m; col++)
-                row[col] = mat[col][r] * diag[col];
-            
-            // multiply row r of ATP with the columns of A
-            for (int j = r; j < n; j++) {
-                for (int i = 0; i < m; i++)
-                    res[r][j] += row[i] * mat[i][j];
-                
-                // mirror result on diagonal axis
+            for (int j = r + 1; j < n; j++)
                 res[j][r] = res[r][j];
-            }
         }
         return res;
     }
@@ -169,15 +174,22 @@ public class MatrixUtils {
         // result is a symetrical square matrix
         double[][] res = new double[n][n];
         
-        for (int r = 0; r < n; r++){
-            for (int c = r; c < n; c++){
-                for (int i = 0; i < m; i++) {
-                    res[r][c] += mat[i][r] * mat[i][c];
-                }
-                // mirror result on diagonal axis
-                res[c][r] = res[r][c];
+        // accumulate the upper triangle in a single pass over the rows of mat
+        for (int i = 0; i < m; i++) {
+            final double[] mat_row = mat[i];
+            for (int r = 0; r < n; r++) {
+                final double a = mat_row[r];
+                final double[] res_row = res[r];
+                for (int c = r; c < n; c++)
+                    res_row[c] += a * mat_row[c];
             }
         }
+        
+        // mirror result on diagonal axis
+        for (int r = 0; r < n; r++) {
+            for (int c = r + 1; c < n; c++)
+                res[c][r] = res[r][c];
+        }
         return res;
     }
     
@@ -193,10 +205,15 @@ public class MatrixUtils {
         
         double[][] res = new double[m][n];
         
-        for (int r = 0; r < m; r++){
-            for (int c = 0; c < n; c++){
-                for (int i = 0; i < matA.length; i++) {
-                    res[r][c] += matA[i][r] * matB[i][c];
+        // single pass over the rows of matA and matB
+        for (int i = 0; i < matA.length; i++) {
+            final double[] matA_row = matA[i];
+            final double[] matB_row = matB[i];
+            for (int r = 0; r < m; r++){
+                final double a = matA_row[r];
+                final double[] res_row = res[r];
+                for (int c = 0; c < n; c++){
+                    res_row[c] += a * matB_row[c];
                 }
             }
         }
@@ -109,7 +109,7 @@ public class Median {
         if (preserveOrder) {
             a = (double[])(a.clone());
         }
-        return Median.kth_smallest(a, (n%2==0) ? n/2-1 : n/2);
+        return Median.kth_smallest(a, Median.medianRank(n));
     }
     
     public static float median(float[] a, boolean preserveOrder) {
@@ -117,15 +117,42 @@ public class Median {
         if (preserveOrder) {
             a = (float[])(a.clone());
         }
-        return Median.kth_smallest(a, (n%2==0) ? n/2-1 : n/2);
+        return Median.kth_smallest(a, Median.medianRank(n));
     }
     
     public static float upperQuartile(float[] a) {
-        return Median.kth_smallest(a, a.length * 3 / 4);
+        return Median.kth_smallest(a, Median.upperQuartileRank(a.length));
     }
     
     public static float lowerQuartile(float[] a) {
-        return Median.kth_smallest(a, a.length / 4);
+        return Median.kth_smallest(a, Median.lowerQuartileRank(a.length));
+    }
+    
+    /**
+     * Returns the rank of the median in a sorted array.
+     * @param n The number of elements.
+     * @return The rank, starting with 0.
+     */
+    public static int medianRank(int n) {
+        return (n%2==0) ? n/2-1 : n/2;
+    }
+    
+    /**
+     * Returns the rank of the upper quartile in a sorted array.
+     * @param n The number of elements.
+     * @return The rank, starting with 0.
+     */
+    public static int upperQuartileRank(int n) {
+        return n * 3 / 4;
+    }
+    
+    /**
+     * Returns the rank of the lower quartile in a sorted array.
+     * @param n The number of elements.
+     * @return The rank, starting with 0.
+     */
+    public static int lowerQuartileRank(int n) {
+        return n / 4;
     }
     
     /**
@@ -7,6 +7,8 @@
 
 package ika.utils;
 
+import ika.geo.GeoBinaryCodec;
+import ika.geo.GeoObject;
 import java.io.BufferedInputStream;
 import java.io.BufferedOutputStream;
 import java.io.ByteArrayInputStream;
@@ -20,7 +22,9 @@ import java.io.OutputStream;
 
 /**
  * A collection of static methods for the serialization and deserialization
- * of arbitrary objects.
+ * of arbitrary objects. GeoObjects are encoded with GeoBinaryCodec, all other
+ * objects with Java object serialization. Deserialization detects the
+ * format.
  * @author Bernhard Jenny, Institute of Cartography, ETH Zurich
  */
 public class Serializer {
@@ -43,6 +47,12 @@ public class Serializer {
         if (zip)
             os = new java.util.zip.GZIPOutputStream(os);
         
+        if (obj instanceof GeoObject) {
+            os.write(GeoBinaryCodec.encode((GeoObject)obj));
+            os.close();
+            return bos.toByteArray();
+        }
+        
         os = new BufferedOutputStream(os);
         ObjectOutputStream oos = new ObjectOutputStream(os);
         
@@ -102,12 +112,22 @@ public class Serializer {
         if (b == null || b.length == 0)
             return null;
         
+        if (zip) {
+            InputStream is = new java.util.zip.GZIPInputStream(
+                    new ByteArrayInputStream(b));
+            try {
+                b = readFully(is);
+            } finally {
+                is.close();
+            }
+        }
+        if (GeoBinaryCodec.isEncoded(b))
+            return GeoBinaryCodec.decode(b);
+        
         ObjectInputStream ois = null;
         try {
             // deserialize object
             InputStream is = new ByteArrayInputStream(b);
-            if (zip)
-                is = new java.util.zip.GZIPInputStream(is);
             is = new BufferedInputStream(is);
             ois = new ObjectInputStream(is);
             return ois.readObject();
@@ -127,10 +147,42 @@ public class Serializer {
     throws java.io.IOException, ClassNotFoundException{
         if (zip)
             inputStream = new java.util.zip.GZIPInputStream(inputStream);
+        
+        // peek at the header to detect the format
+        if (!inputStream.markSupported())
+            inputStream = new BufferedInputStream(inputStream);
+        byte[] header = new byte[6];
+        inputStream.mark(header.length);
+        int headerLength = 0;
+        while (headerLength < header.length) {
+            final int n = inputStream.read(header, headerLength, header.length - headerLength);
+            if (n < 0)
+                break;
+            headerLength += n;
+        }
+        inputStream.reset();
+        if (GeoBinaryCodec.isEncoded(header))
+            return GeoBinaryCodec.decode(readFully(inputStream));
+        
         ObjectInputStream objectStream = new ObjectInputStream(inputStream);
         return objectStream.readObject();
     }
     
+    /**
+     * Reads a stream until its end. The stream is not closed.
+     * @param inputStream The stream to read.
+     * @return All bytes of the stream.
+     */
+    private static byte[] readFully(InputStream inputStream)
+    throws java.io.IOException {
+        ByteArrayOutputStream bos = new ByteArrayOutputStream();
+        byte[] buffer = new byte[64 * 1024];
+        int n;
+        while ((n = inputStream.read(buffer)) >= 0)
+            bos.write(buffer, 0, n);
+        return bos.toByteArray();
+    }
+    
     /**
      * Deserializes an object from a file and returns it.
      * @filePath The path to the file that contains the serialized object.
@@ -9,10 +9,13 @@ package ika.utils;
 
 import java.io.ByteArrayOutputStream;
 import java.io.File;
+import java.io.FileInputStream;
 import java.io.IOException;
 import java.io.InputStream;
 import java.net.MalformedURLException;
 import java.net.URL;
+import java.nio.ByteBuffer;
+import java.nio.channels.FileChannel;
 
 /**
  *
@@ -70,6 +73,63 @@ public class URLUtils {
         }
     }
     
+    /**
+     * Returns the local file a URL points to.
+     * @param url The URL.
+     * @return The file, or null if the URL does not point to an existing
+     * local file.
+     */
+    public static File urlToFile(URL url) {
+        if (url == null || !"file".equals(url.getProtocol()))
+            return null;
+        File file;
+        try {
+            file = new File(url.toURI());
+        } catch (Exception exc) {
+            // URLs constructed from file paths may not be valid URIs
+            file = new File(url.getPath());
+        }
+        return file.isFile() ? file : null;
+    }
+    
+    /**
+     * Loads a resource into a buffer. Local files are memory-mapped, other
+     * resources are read into memory.
+     * @param url The URL of the resource.
+     * @return A read-only buffer positioned at 0.
+     */
+    public static ByteBuffer loadBufferFromURL(URL url) throws IOException {
+        File file = urlToFile(url);
+        if (file == null)
+            return loadBufferFromStream(url.openStream());
+        FileInputStream fis = new FileInputStream(file);
+        try {
+            FileChannel channel = fis.getChannel();
+            // the mapping remains valid after the channel is closed
+            return channel.map(FileChannel.MapMode.READ_ONLY, 0, channel.size());
+        } finally {
+            fis.close();
+        }
+    }
+    
+    /**
+     * Reads a stream until its end into a buffer and closes the stream.
+     * @param is The stream to read.
+     * @return A buffer positioned at 0.
+     */
+    public static ByteBuffer loadBufferFromStream(InputStream is) throws IOException {
+        try {
+            ByteArrayOutputStream baos = new ByteArrayOutputStream();
+            byte[] buffer = new byte[64 * 1024];
+            int r;
+            while ((r = is.read(buffer)) >= 0)
+                baos.write(buffer, 0, r);
+            return ByteBuffer.wrap(baos.toByteArray());
+        } finally {
+            is.close();
+        }
+    }
+    
     public static URL filePathToURL (String filePath) {
         try {
         if (filePath.startsWith("/"))